@@ -0,0 +1,78 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of state deduplication in the evolutionary search of auto_scheduler.
+see README.md for the usage of this script.
+"""
+import argparse
+import time
+
+import tvm
+from tvm import te, auto_scheduler
+from tvm.auto_scheduler import _ffi_api
+
+
+@auto_scheduler.register_workload
+def dedup_bench_matmul(N, M, K):
+    A = te.placeholder((N, K), name="A")
+    B = te.placeholder((K, M), name="B")
+    k = te.reduce_axis((0, K), name="k")
+    C = te.compute((N, M), lambda i, j: te.sum(A[i][k] * B[k][j], axis=[k]), name="C")
+    return [A, B, C]
+
+
+def time_keys(states, make_key, repeat):
+    tic = time.time()
+    for _ in range(repeat):
+        keys = set()
+        for s in states:
+            keys.add(make_key(s))
+    return (time.time() - tic) * 1e6 / (repeat * len(states)), len(keys)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=512, help="The size of the matmul")
+    parser.add_argument("--population", type=int, default=256)
+    parser.add_argument("--out-size", type=int, default=64)
+    parser.add_argument("--num-iters", type=int, default=4)
+    parser.add_argument("--repeat", type=int, default=10)
+    args = parser.parse_args()
+
+    target = tvm.target.create("llvm")
+    workload_key = auto_scheduler.make_workload_key(dedup_bench_matmul,
+                                                    (args.size, args.size, args.size))
+    dag = auto_scheduler.ComputeDAG(workload_key)
+    task = auto_scheduler.SearchTask(dag, workload_key, target)
+    policy = auto_scheduler.SketchPolicy(
+        task, params={"evolutionary_search_population": args.population,
+                      "evolutionary_search_num_iters": args.num_iters},
+        seed=1, verbose=0)
+
+    init = policy.sample_initial_population(args.population)
+    tic = time.time()
+    states = policy.evolutionary_search(init, args.out_size)
+    cost = time.time() - tic
+    print("Evolutionary search: %d candidates in %.2f s, %.1f candidates/sec" %
+          (args.population * args.num_iters, cost, args.population * args.num_iters / cost))
+
+    states = list(init) + list(states)
+    print("--------------------------------------------------")
+    print("%-12s %-14s %s" % ("Key", "Unique states", "Time per state"))
+    print("--------------------------------------------------")
+    for name, make_key in [("ToStr", str), ("Fingerprint", _ffi_api.StateFingerprint)]:
+        cost, num_unique = time_keys(states, make_key, args.repeat)
+        print("%-12s %-14d %.2f us" % (name, num_unique, cost))
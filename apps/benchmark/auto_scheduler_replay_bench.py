@@ -0,0 +1,83 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the replay cache of ComputeDAG in the evolutionary search of auto_scheduler.
+see README.md for the usage of this script.
+"""
+import argparse
+import time
+
+import tvm
+from tvm import te, auto_scheduler
+from tvm.auto_scheduler import compute_dag, feature
+
+
+@auto_scheduler.register_workload
+def replay_bench_conv2d_relu(N, H, W, CI, CO, KH, KW):
+    data = te.placeholder((N, CI, H, W), name="data")
+    kernel = te.placeholder((CO, CI, KH, KW), name="kernel")
+    rc = te.reduce_axis((0, CI), name="rc")
+    ry = te.reduce_axis((0, KH), name="ry")
+    rx = te.reduce_axis((0, KW), name="rx")
+    conv = te.compute(
+        (N, CO, H - KH + 1, W - KW + 1),
+        lambda n, f, y, x: te.sum(data[n, rc, y + ry, x + rx] * kernel[f, rc, ry, rx],
+                                  axis=[rc, ry, rx]), name="conv")
+    out = te.compute(conv.shape, lambda *i: te.max(conv(*i), 0.0), name="relu")
+    return [data, kernel, out]
+
+
+def run_search(task, args, capacity):
+    compute_dag.set_replay_cache_capacity(capacity)
+    compute_dag.reset_replay_cache_stats()
+    # Start from an empty feature cache, so that every new state is replayed once
+    feature.set_feature_cache_capacity(0)
+    feature.set_feature_cache_capacity(8192)
+    # Use a fresh DAG so that the replay cache starts empty as well
+    task = auto_scheduler.SearchTask(auto_scheduler.ComputeDAG(task.workload_key),
+                                     task.workload_key, task.target)
+    policy = auto_scheduler.SketchPolicy(
+        task, schedule_cost_model=auto_scheduler.GBDTModel(),
+        params={"evolutionary_search_population": args.population,
+                "evolutionary_search_num_iters": args.num_iters},
+        seed=1, verbose=0)
+    init = policy.sample_initial_population(args.population)
+    tic = time.time()
+    policy.evolutionary_search(init, args.out_size)
+    cost = time.time() - tic
+    return args.population * args.num_iters / cost, compute_dag.get_replay_cache_stats()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--population", type=int, default=512)
+    parser.add_argument("--out-size", type=int, default=64)
+    parser.add_argument("--num-iters", type=int, default=4)
+    args = parser.parse_args()
+
+    target = tvm.target.create("llvm")
+    workload_key = auto_scheduler.make_workload_key(replay_bench_conv2d_relu,
+                                                    (1, 58, 58, 64, 64, 3, 3))
+    task = auto_scheduler.SearchTask(auto_scheduler.ComputeDAG(workload_key), workload_key,
+                                     target)
+
+    print("--------------------------------------------------")
+    print("%-14s %-18s %s" % ("Replay cache", "Candidates/sec", "Reused steps"))
+    print("--------------------------------------------------")
+    for name, capacity in [("off", 0), ("on", 256)]:
+        speed, stats = run_search(task, args, capacity)
+        total = stats["reused_steps"] + stats["replayed_steps"]
+        print("%-14s %-18.1f %.1f%%" % (name, speed, 100.0 * stats["reused_steps"] / max(total, 1)))
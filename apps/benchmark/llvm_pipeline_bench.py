@@ -0,0 +1,151 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the kernels generated by the LLVM optimization pipelines of CodeGenLLVM.
+see README.md for the usage of this script.
+"""
+import argparse
+import subprocess
+import sys
+
+import numpy as np
+
+import tvm
+from tvm import te
+from tvm.contrib import util
+
+PIPELINES = [
+    ("legacy-O3", ""),
+    ("legacy-O2", "-opt-level=2"),
+    ("legacy-novec", "-vectorize-loops=0 -vectorize-slp=0"),
+    ("new-O3", "-pass-manager=new"),
+    ("new-O3-slp", "-pass-manager=new -llvm-options=slp-threshold:-4,slp-max-reg-size:256"),
+    ("new-O3-novec", "-pass-manager=new -vectorize-loops=0 -vectorize-slp=0"),
+]
+
+
+def elementwise_chain(n):
+    """A chain of element-wise operators on a 2-D tensor, unrolled by 4 along the columns.
+    Without an explicit vectorize the SLP vectorizer has to pack the unrolled lanes."""
+    A = te.placeholder((n, n), name="A")
+    B = te.placeholder((n, n), name="B")
+    C = te.compute((n, n), lambda i, j: A[i, j] * B[i, j] + A[i, j], name="C")
+    D = te.compute((n, n), lambda i, j: te.max(C[i, j] * 0.5 - B[i, j], 0.0), name="D")
+    s = te.create_schedule(D.op)
+    s[C].compute_inline()
+    jo, ji = s[D].split(D.op.axis[1], factor=4)
+    s[D].unroll(ji)
+    s[D].parallel(D.op.axis[0])
+    args = [np.random.uniform(size=(n, n)).astype("float32") for _ in range(2)]
+    args.append(np.zeros((n, n), "float32"))
+    return s, [A, B, D], args
+
+
+def row_softmax(n):
+    """Softmax over the rows, a mix of reductions and element-wise operators."""
+    A = te.placeholder((n, n), name="A")
+    k = te.reduce_axis((0, n), name="k")
+    M = te.compute((n,), lambda i: te.max(A[i, k], axis=k), name="M")
+    E = te.compute((n, n), lambda i, j: te.exp(A[i, j] - M[i]), name="E")
+    k2 = te.reduce_axis((0, n), name="k2")
+    S = te.compute((n,), lambda i: te.sum(E[i, k2], axis=k2), name="S")
+    B = te.compute((n, n), lambda i, j: E[i, j] / S[i], name="B")
+    s = te.create_schedule(B.op)
+    s[B].parallel(B.op.axis[0])
+    args = [np.random.uniform(size=(n, n)).astype("float32"), np.zeros((n, n), "float32")]
+    return s, [A, B], args
+
+
+def matmul(n):
+    """A blocked matmul whose inner loop is left to the loop vectorizer."""
+    A = te.placeholder((n, n), name="A")
+    B = te.placeholder((n, n), name="B")
+    k = te.reduce_axis((0, n), name="k")
+    C = te.compute((n, n), lambda i, j: te.sum(A[i, k] * B[k, j], axis=k), name="C")
+    s = te.create_schedule(C.op)
+    io, jo, ii, ji = s[C].tile(C.op.axis[0], C.op.axis[1], 32, 32)
+    (kaxis,) = s[C].op.reduce_axis
+    ko, ki = s[C].split(kaxis, factor=4)
+    s[C].reorder(io, jo, ko, ii, ki, ji)
+    s[C].parallel(io)
+    args = [np.random.uniform(size=(n, n)).astype("float32") for _ in range(2)]
+    args.append(np.zeros((n, n), "float32"))
+    return s, [A, B, C], args
+
+
+def evaluate(name, func, args, repeat):
+    ctx = tvm.cpu(0)
+    nd_args = [tvm.nd.array(x, ctx) for x in args]
+    ftimer = func.time_evaluator(name, ctx, number=10, repeat=repeat)
+    return np.median(np.array(ftimer(*nd_args).results) * 1000)
+
+
+def collect_profile(kernel, n, sch, tensors, temp):
+    """Build an instrumented kernel, run it in a child process and merge its profile."""
+    raw = temp.relpath("%s.profraw" % kernel)
+    lib = temp.relpath("%s_instr.so" % kernel)
+    target = "llvm -pass-manager=new -profile-generate=" + raw
+    tvm.build(sch, tensors, target, name=kernel).export_library(
+        lib, cc="clang", options=["-fprofile-generate"])
+    # The profile runtime writes the counters when the process exits
+    subprocess.check_call([sys.executable, __file__, "--run-instrumented", lib,
+                           "--kernel", kernel, "--size", str(n)])
+    profdata = temp.relpath("%s.profdata" % kernel)
+    subprocess.check_call(["llvm-profdata", "merge", "-o", profdata, raw])
+    return profdata
+
+
+def main(args):
+    kernels = {"elementwise_chain": elementwise_chain, "row_softmax": row_softmax,
+               "matmul": matmul}
+    if args.run_instrumented:
+        _, _, data = kernels[args.kernel](args.size)
+        evaluate(args.kernel, tvm.runtime.load_module(args.run_instrumented), data, 1)
+        return
+
+    pipelines = [p for p in PIPELINES if not args.pipelines or p[0] in args.pipelines]
+    if tvm.target.codegen.llvm_version_major() < 11:
+        pipelines = [p for p in pipelines if "-pass-manager=new" not in p[1]]
+    temp = util.tempdir()
+    for kernel in args.kernels:
+        sch, tensors, data = kernels[kernel](args.size)
+        configs = list(pipelines)
+        if args.pgo:
+            profdata = collect_profile(kernel, args.size, sch, tensors, temp)
+            configs.append(("new-O3-pgo", "-pass-manager=new -profile-use=" + profdata))
+        baseline = None
+        for name, options in configs:
+            func = tvm.build(sch, tensors, "llvm " + options, name=kernel)
+            cost = evaluate(kernel, func, data, args.repeat)
+            baseline = baseline or cost
+            print("%-18s %-14s median %.3f ms  speedup %.2fx" % (
+                kernel, name, cost, baseline / cost))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=1024)
+    parser.add_argument("--repeat", type=int, default=20)
+    parser.add_argument("--kernels", nargs="+", default=["elementwise_chain", "row_softmax",
+                                                          "matmul"])
+    parser.add_argument("--pipelines", nargs="+",
+                        help="The names of the pipelines to compare, all of them by default.")
+    parser.add_argument("--pgo", action="store_true",
+                        help="Also compare with a build that uses a collected profile. "
+                             "Requires clang and llvm-profdata in PATH.")
+    parser.add_argument("--kernel", help=argparse.SUPPRESS)
+    parser.add_argument("--run-instrumented", help=argparse.SUPPRESS)
+    main(parser.parse_args())
@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of synchronous vs. pipelined RPC over the local socket and pipe transports.
+see README.md for the usage of this script.
+"""
+import argparse
+import time
+
+import numpy as np
+
+import tvm
+from tvm import te, rpc
+from tvm.contrib import util, cc
+
+
+def build_add(n, target):
+    A = te.placeholder((n,), name="A")
+    B = te.placeholder((n,), name="B")
+    C = te.compute((n,), lambda i: A[i] + B[i], name="C")
+    s = te.create_schedule(C.op)
+    return tvm.build(s, [A, B, C], target, name="myadd")
+
+
+def socket_session(temp, n):
+    server = rpc.Server("localhost")
+    remote = rpc.connect(server.host, server.port)
+    path = temp.relpath("myadd.so")
+    build_add(n, "llvm").export_library(path)
+    remote.upload(path)
+    return server, remote, remote.load_module("myadd.so")
+
+
+def pipe_session(temp, n):
+    path = temp.relpath("myadd.minrpc")
+    build_add(n, "llvm --system-lib").export_library(path, rpc.with_minrpc(cc.create_executable))
+    remote = rpc.PopenSession(path)
+    return None, remote, remote.system_lib()
+
+
+def measure(remote, func, n, num_inputs, iterations):
+    """One round of an auto-tuning measurement: upload, run, download, free."""
+    ctx = remote.cpu(0)
+    inputs = [np.random.uniform(size=n).astype("float32") for _ in range(num_inputs)]
+    out = np.empty(n, "float32")
+    tic = time.time()
+    for _ in range(iterations):
+        args = [tvm.nd.array(x, ctx) for x in inputs]
+        c = tvm.nd.empty((n,), "float32", ctx)
+        for i in range(0, num_inputs - 1, 2):
+            func(args[i], args[i + 1], c)
+        c.copyto(out)
+        del args, c
+    remote.synchronize()
+    return (time.time() - tic) * 1000 / iterations
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=1 << 20, help="The number of elements")
+    parser.add_argument("--num-inputs", type=int, default=8)
+    parser.add_argument("--iterations", type=int, default=20)
+    parser.add_argument("--chunk-bytes", type=int, default=1 << 20)
+    parser.add_argument("--transport", choices=["socket", "pipe"], nargs="+",
+                        default=["socket", "pipe"])
+    args = parser.parse_args()
+
+    configs = [
+        ("sync", False, 0),
+        ("chunked", False, args.chunk_bytes),
+        ("async+chunked", True, args.chunk_bytes),
+    ]
+    temp = util.tempdir()
+    print("--------------------------------------------------")
+    print("%-10s %-16s %s" % ("Transport", "Mode", "Time per round"))
+    print("--------------------------------------------------")
+    for transport in args.transport:
+        if transport == "pipe" and tvm.get_global_func("rpc.CreatePipeClient", True) is None:
+            continue
+        make_session = socket_session if transport == "socket" else pipe_session
+        server, remote, mod = make_session(temp, args.size)
+        func = mod["myadd"]
+        # warm up
+        measure(remote, func, args.size, args.num_inputs, 1)
+        for mode, async_mode, chunk_bytes in configs:
+            remote.set_async_mode(async_mode, chunk_bytes)
+            cost = measure(remote, func, args.size, args.num_inputs, args.iterations)
+            print("%-10s %-16s %.3f ms" % (transport, mode, cost))
+        remote.set_async_mode(False, 0)
+        if server is not None:
+            server.terminate()
@@ -0,0 +1,145 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Micro-benchmark of the CPU thread pool schedulers on irregular parallel loops.
+see README.md for the usage of this script.
+"""
+import argparse
+
+import numpy as np
+
+import tvm
+from tvm import te
+
+
+def triangular_sum(n):
+    """Row i sums the first i + 1 elements, so the work per row grows linearly."""
+    A = te.placeholder((n, n), name="A")
+
+    def _ir(a, b):
+        ib = tvm.tir.ir_builder.create()
+        a = ib.buffer_ptr(a)
+        b = ib.buffer_ptr(b)
+        with ib.for_range(0, n, name="i", for_type="parallel") as i:
+            b[i] = 0.0
+            with ib.for_range(0, i + 1, name="k") as k:
+                b[i] += a[i * n + k]
+        return ib.get()
+
+    B = te.extern((n,), [A], lambda ins, outs: _ir(ins[0], outs[0]), name="B")
+    s = te.create_schedule(B.op)
+    args = [np.random.uniform(size=(n, n)).astype("float32"), np.zeros((n,), "float32")]
+    return tvm.build(s, [A, B], "llvm", name="triangular"), args
+
+
+def skewed_spmv(n, nnz_per_row):
+    """CSR sparse matrix-vector product with a power-law distribution of row lengths."""
+    rng = np.random.RandomState(0)
+    row_nnz = np.minimum(rng.zipf(1.5, size=n) * nnz_per_row // 4, n).astype("int32")
+    indptr = np.concatenate([[0], np.cumsum(row_nnz)]).astype("int32")
+    nnz = int(indptr[-1])
+    indices = rng.randint(0, n, size=nnz).astype("int32")
+    data = rng.uniform(size=nnz).astype("float32")
+    x = rng.uniform(size=n).astype("float32")
+
+    Data = te.placeholder((nnz,), name="data")
+    Indices = te.placeholder((nnz,), name="indices", dtype="int32")
+    Indptr = te.placeholder((n + 1,), name="indptr", dtype="int32")
+    X = te.placeholder((n,), name="x")
+
+    def _ir(data, indices, indptr, x, y):
+        ib = tvm.tir.ir_builder.create()
+        data = ib.buffer_ptr(data)
+        indices = ib.buffer_ptr(indices)
+        indptr = ib.buffer_ptr(indptr)
+        x = ib.buffer_ptr(x)
+        y = ib.buffer_ptr(y)
+        with ib.for_range(0, n, name="row", for_type="parallel") as row:
+            y[row] = 0.0
+            begin = indptr[row]
+            with ib.for_range(0, indptr[row + 1] - begin, name="j") as j:
+                y[row] += data[begin + j] * x[indices[begin + j]]
+        return ib.get()
+
+    Y = te.extern(
+        (n,),
+        [Data, Indices, Indptr, X],
+        lambda ins, outs: _ir(ins[0], ins[1], ins[2], ins[3], outs[0]),
+        name="y",
+    )
+    s = te.create_schedule(Y.op)
+    args = [data, indices, indptr, x, np.zeros((n,), "float32")]
+    return tvm.build(s, [Data, Indices, Indptr, X, Y], "llvm", name="skewed_spmv"), args
+
+
+def dense_rows(n):
+    """Uniform row sums, the balanced control case."""
+    A = te.placeholder((n, n), name="A")
+    k = te.reduce_axis((0, n), name="k")
+    B = te.compute((n,), lambda i: te.sum(A[i, k], axis=k), name="B")
+    s = te.create_schedule(B.op)
+    s[B].parallel(B.op.axis[0])
+    args = [np.random.uniform(size=(n, n)).astype("float32"), np.zeros((n,), "float32")]
+    return tvm.build(s, [A, B], "llvm", name="dense_rows"), args
+
+
+def evaluate(name, func, args, configs, repeat):
+    ctx = tvm.cpu(0)
+    nd_args = [tvm.nd.array(x, ctx) for x in args]
+    fconfig = tvm.get_global_func("runtime.config_threadpool_scheduler")
+    for kind, tasks_per_worker in configs:
+        fconfig(kind, tasks_per_worker)
+        ftimer = func.time_evaluator(name, ctx, number=10, repeat=repeat)
+        prof_res = np.array(ftimer(*nd_args).results) * 1000
+        print(
+            "%-14s %-14s tasks/worker=%-3d median %.3f ms  p90 %.3f ms  max %.3f ms"
+            % (
+                name,
+                kind,
+                tasks_per_worker,
+                np.median(prof_res),
+                np.percentile(prof_res, 90),
+                np.max(prof_res),
+            )
+        )
+    fconfig("static", 1)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=4096, help="The number of rows")
+    parser.add_argument("--nnz-per-row", type=int, default=64, help="Scale of the spmv row lengths")
+    parser.add_argument(
+        "--tasks-per-worker",
+        type=int,
+        nargs="+",
+        default=[1, 4, 16],
+        help="The over-decomposition factors evaluated for the work-stealing scheduler",
+    )
+    parser.add_argument("--repeat", type=int, default=50)
+    args = parser.parse_args()
+
+    configs = [("static", 1)] + [("work_stealing", t) for t in args.tasks_per_worker]
+    benchmarks = {
+        "triangular": triangular_sum(args.size),
+        "skewed_spmv": skewed_spmv(args.size, args.nnz_per_row),
+        "dense_rows": dense_rows(args.size),
+    }
+    print("--------------------------------------------------")
+    print("%-14s %-14s %s" % ("Kernel", "Scheduler", "Time"))
+    print("--------------------------------------------------")
+    for name, (func, func_args) in benchmarks.items():
+        evaluate(name, func, func_args, configs, args.repeat)
@@ -0,0 +1,101 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Micro-benchmark of the Relay VM dispatch overhead, in nanoseconds per instruction.
+see README.md for the usage of this script.
+"""
+import argparse
+import time
+
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay.scope_builder import ScopeBuilder
+from tvm.runtime import vm as vm_rt
+
+
+def scalar_loop():
+    """A recursive count-down loop, each iteration runs a handful of scalar operators."""
+    mod = tvm.IRModule()
+    sum_up = relay.GlobalVar("sum_up")
+    i = relay.var("i", shape=[], dtype="int32")
+    accum = relay.var("accum", shape=[], dtype="int32")
+    sb = ScopeBuilder()
+    with sb.if_scope(relay.equal(i, relay.const(0, "int32"))):
+        sb.ret(accum)
+    with sb.else_scope():
+        one_less = relay.subtract(i, relay.const(1, "int32"))
+        new_accum = relay.add(accum, i)
+        sb.ret(relay.Call(sum_up, [one_less, new_accum]))
+    mod[sum_up] = relay.Function([i, accum], sb.get())
+    iarg = relay.var("i", shape=[], dtype="int32")
+    aarg = relay.var("accum", shape=[], dtype="int32")
+    mod["main"] = relay.Function([iarg, aarg], sum_up(iarg, aarg))
+    return mod
+
+
+def op_chain(length):
+    """A chain of element-wise operators on a tiny tensor, fusion is disabled to keep them."""
+    x = relay.var("x", shape=(4,), dtype="float32")
+    y = x
+    for k in range(length):
+        y = relay.add(y, relay.const(1.0)) if k % 2 == 0 else relay.multiply(y, relay.const(0.5))
+    return tvm.IRModule.from_expr(relay.Function([x], y))
+
+
+def evaluate(name, mod, args, repeat):
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=["FuseOps"]):
+        exe = relay.vm.compile(mod, target="llvm")
+    vm = vm_rt.VirtualMachine(exe, tvm.cpu())
+    fcount = vm.module["get_num_executed_instructions"]
+    vm.run(*args)
+    costs = []
+    for _ in range(repeat):
+        start_instrs = fcount()
+        start = time.perf_counter()
+        vm.run(*args)
+        elapsed = time.perf_counter() - start
+        costs.append(elapsed * 1e9 / (fcount() - start_instrs))
+    num_instrs = fcount() - start_instrs
+    print(
+        "%-12s %-10d median %.1f ns/instr  min %.1f ns/instr"
+        % (name, num_instrs, np.median(costs), np.min(costs))
+    )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--iterations", type=int, default=10000, help="Trip count of the loop")
+    parser.add_argument("--chain-length", type=int, default=200, help="Operators in the chain")
+    parser.add_argument("--repeat", type=int, default=20)
+    args = parser.parse_args()
+
+    print("--------------------------------------------------")
+    print("%-12s %-10s %s" % ("Program", "Instrs", "Dispatch cost"))
+    print("--------------------------------------------------")
+    evaluate(
+        "scalar_loop",
+        scalar_loop(),
+        [np.array(args.iterations, "int32"), np.array(0, "int32")],
+        args.repeat,
+    )
+    evaluate(
+        "op_chain",
+        op_chain(args.chain_length),
+        [np.random.uniform(size=(4,)).astype("float32")],
+        args.repeat,
+    )
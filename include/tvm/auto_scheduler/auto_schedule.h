@@ -50,6 +50,13 @@ class TuningOptionsNode : public Object {
   ProgramRunner runner;
   /*! \brief MeasureCallback functions to be called after each measure batch */
   Optional<Array<MeasureCallback>> measure_callbacks;
+  /*!
+   * \brief The number of built batches that can wait for a runner. 0 builds and runs every batch
+   * in turn, a positive value overlaps the builds with the runs.
+   */
+  int pipeline_depth;
+  /*! \brief More ProgramRunners to run the built programs in parallel with `runner`. */
+  Array<ProgramRunner> extra_runners;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("num_measure_trials", &num_measure_trials);
@@ -59,6 +66,8 @@ class TuningOptionsNode : public Object {
     v->Visit("builder", &builder);
     v->Visit("runner", &runner);
     v->Visit("measure_callbacks", &measure_callbacks);
+    v->Visit("pipeline_depth", &pipeline_depth);
+    v->Visit("extra_runners", &extra_runners);
   }
 
   static constexpr const char* _type_key = "auto_scheduler.TuningOptions";
@@ -81,10 +90,20 @@ class TuningOptions : public ObjectRef {
    * \param builder ProgramBuilder which builds the program.
    * \param runner ProgramRunner which runs the program and measure time costs.
    * \param measure_callbacks MeasureCallback functions to be called after each measure batch.
+   * \param pipeline_depth The number of built batches that can wait for a runner, 0 to build and
+   * run every batch in turn.
+   * \param extra_runners More ProgramRunners to run the built programs in parallel with `runner`.
    */
   TuningOptions(int num_measure_trials, int early_stopping, int num_measures_per_round, int verbose,
                 ProgramBuilder builder, ProgramRunner runner,
-                Optional<Array<MeasureCallback>> measure_callbacks);
+                Optional<Array<MeasureCallback>> measure_callbacks, int pipeline_depth = 0,
+                Array<ProgramRunner> extra_runners = {});
+
+  /*!
+   * \brief Create the ProgramMeasurer described by these options.
+   * \return The ProgramMeasurer.
+   */
+  ProgramMeasurer MakeMeasurer() const;
 
   TVM_DEFINE_OBJECT_REF_METHODS(TuningOptions, ObjectRef, TuningOptionsNode);
 };
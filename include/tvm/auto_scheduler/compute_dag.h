@@ -38,6 +38,7 @@
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/te/schedule.h>
 
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -46,6 +47,8 @@
 namespace tvm {
 namespace auto_scheduler {
 
+class ComputeDAGReplayCache;
+
 /*! \brief Static analyzer for a ComputeDAG */
 class AccessAnalyzerNode : public Object {
  public:
@@ -181,6 +184,11 @@ class ComputeDAGNode : public Object {
   State init_state;
   /*! \brief The static read-write access analyzer */
   AccessAnalyzer access_analyzer;
+  /*!
+   * \brief The schedules replayed from prefixes of transform steps, which ApplySteps resumes
+   * from. It is not serialized, and a DAG without it replays every step.
+   */
+  std::shared_ptr<ComputeDAGReplayCache> replay_cache;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("tensors", &tensors);
@@ -214,6 +222,8 @@ class ComputeDAG : public ObjectRef {
    * Pass a valid pointer if this information needs to be used outside this function.
    * \return A `te.schedule` and the an Array of `te.Tensor` to be used in `tvm.lower`
    * or `tvm.build`.
+   * \note The schedules after some prefixes of the steps are cached, and the replay resumes from
+   * the longest cached prefix. States mutated by the search usually share most of their steps.
    */
   std::pair<te::Schedule, Array<te::Tensor>> ApplySteps(
       const Array<Step>& transform_steps, Array<te::Stage>* stages = nullptr,
@@ -227,6 +237,14 @@ class ComputeDAG : public ObjectRef {
    */
   String PrintStepsAsPython(const Array<Step>& transform_steps) const;
 
+  /*!
+   * \brief Get a key of the structure of this DAG, which is the printed DAG with every numeric
+   * literal masked. The DAGs of the same operators on different shapes get the same key, so
+   * the schedules tuned for one of them are good starting points for the others.
+   * \return The structural key.
+   */
+  String GetStructuralKey() const;
+
   /*!
    * \brief Fill the correct bound information for a given state by calling ir_pass::InferBound.
    * The states can lose complete bound information after some transform steps (e.g., compute_at).
@@ -266,6 +284,30 @@ class ComputeDAG : public ObjectRef {
   TVM_DEFINE_OBJECT_REF_COW_METHOD(ComputeDAGNode);
 };
 
+/*! \brief Counters of the replay cache of ComputeDAG::ApplySteps. */
+struct ReplayCacheStats {
+  /*! \brief The number of replays that resumed from a cached prefix of at least one step. */
+  int64_t hits{0};
+  /*! \brief The number of replays that started from the initial schedule. */
+  int64_t misses{0};
+  /*! \brief The number of steps restored from the cache. */
+  int64_t reused_steps{0};
+  /*! \brief The number of steps applied to a schedule. */
+  int64_t replayed_steps{0};
+};
+
+/*!
+ * \brief Set the maximum number of schedule snapshots kept by each ComputeDAG.
+ * \param capacity The maximum number of snapshots. 0 disables the replay cache.
+ */
+void SetReplayCacheCapacity(int capacity);
+
+/*! \return The counters of the replay cache. */
+ReplayCacheStats GetReplayCacheStats();
+
+/*! \brief Reset the counters of the replay cache. */
+void ResetReplayCacheStats();
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
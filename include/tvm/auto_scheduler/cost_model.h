@@ -30,6 +30,8 @@
 #include <tvm/node/node.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <random>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -154,6 +156,146 @@ class PythonBasedModel : public CostModel {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(PythonBasedModel, CostModel, PythonBasedModelNode);
 };
 
+/*! \brief A regression tree of GBDTModel */
+struct GBDTTree {
+  /*! \brief A node of the tree, the leaves have feature == -1. */
+  struct Node {
+    /*! \brief The index of the feature to split on. */
+    int32_t feature;
+    /*! \brief Samples with feature < threshold go to the left child. */
+    float threshold;
+    /*! \brief The children of a split node. */
+    int32_t left, right;
+    /*! \brief The output of a leaf. */
+    float value;
+  };
+  /*! \brief The nodes, nodes[0] is the root. */
+  std::vector<Node> nodes;
+
+  /*! \brief Predict the output for one feature vector. */
+  float Predict(const float* feature) const {
+    int32_t idx = 0;
+    while (nodes[idx].feature >= 0) {
+      const Node& node = nodes[idx];
+      idx = feature[node.feature] < node.threshold ? node.left : node.right;
+    }
+    return nodes[idx].value;
+  }
+};
+
+/*!
+ * \brief A gradient boosted tree ensemble that predicts the normalized throughputs of programs.
+ *
+ * It is a native version of the XGBoost based model in python: the score of a program is
+ * the sum of the predictions for the per-store features of its statements, and the trees
+ * are fitted to the pack-sum square error of the normalized throughputs. Later updates
+ * continue boosting from the current ensemble and the ensemble is only retrained from
+ * scratch once it has grown to max_num_trees. Prediction does not call into python and
+ * runs in parallel over the states.
+ */
+class GBDTModelNode : public CostModelNode {
+ public:
+  /*! \brief The maximum depth of a tree. */
+  int max_depth;
+  /*! \brief The maximum number of boosting rounds when the ensemble is trained from scratch. */
+  int num_rounds;
+  /*! \brief The maximum number of boosting rounds added by an incremental update. */
+  int incremental_rounds;
+  /*! \brief The ensemble is retrained from scratch once it would exceed this size. */
+  int max_num_trees;
+  /*! \brief Stop boosting if the training error did not improve in this many rounds. */
+  int early_stopping_rounds;
+  /*! \brief The maximum number of histogram bins per feature, at most 256. */
+  int max_bins;
+  /*! \brief Predict random scores until the model is trained on more samples than this. */
+  int num_warmup_sample;
+  /*! \brief The shrinkage of the leaf values. */
+  double learning_rate;
+  /*! \brief The L2 regularization of the leaf values. */
+  double reg_lambda;
+  /*! \brief The minimum sum of hessians in a child. */
+  double min_child_weight;
+  /*! \brief The minimum loss reduction of a split. */
+  double min_split_gain;
+
+  /*! \brief The trees of the ensemble. */
+  std::vector<GBDTTree> trees;
+  /*! \brief The histogram bin boundaries of each feature. */
+  std::vector<std::vector<float>> bin_cuts;
+
+  void Update(const Array<MeasureInput>& inputs, const Array<MeasureResult>& results) final;
+
+  void Predict(const SearchTask& task, const Array<State>& states,
+               std::vector<float>* scores) final;
+
+  void PredictStages(const SearchTask& task, const Array<State>& states,
+                     std::vector<float>* state_scores,
+                     std::vector<std::vector<float>>* stage_scores) final;
+
+  /*!
+   * \brief Save the trained ensemble to a file.
+   * \param file_name The file name.
+   */
+  void Save(const std::string& file_name) const;
+
+  /*!
+   * \brief Load a trained ensemble from a file. The loaded model predicts without warmup.
+   * \param file_name The file name.
+   */
+  void Load(const std::string& file_name);
+
+  static constexpr const char* _type_key = "auto_scheduler.GBDTModel";
+  TVM_DECLARE_FINAL_OBJECT_INFO(GBDTModelNode, CostModelNode);
+
+ private:
+  /*!
+   * \brief Fit the ensemble to the features of all measured programs.
+   * \param normalized_throughputs The labels of features_.
+   */
+  void Train(const std::vector<float>& normalized_throughputs);
+  /*! \brief Whether the ensemble is used for prediction instead of random scores. */
+  bool UseModel() const;
+  /*!
+   * \brief Predict the scores of the store statements of the states.
+   * \param task The search task of states
+   * \param states The input states
+   * \param store_scores The scores of the stores of each state, empty if the state is invalid.
+   * Without use_model every valid state gets a single zero score.
+   */
+  void PredictPerStore(const SearchTask& task, const Array<State>& states, bool use_model,
+                       std::vector<std::vector<float>>* store_scores);
+
+  /*! \brief All measured programs. */
+  Array<MeasureInput> inputs_;
+  /*! \brief The measurement results of inputs_. */
+  Array<MeasureResult> results_;
+  /*! \brief The extracted features of inputs_. */
+  std::vector<std::vector<float>> features_;
+  /*! \brief Whether a loaded ensemble is used. */
+  bool loaded_{false};
+  /*! \brief Random generator of the warmup predictions. */
+  std::mt19937 rand_gen_;
+
+  friend class GBDTModel;
+};
+
+/*!
+ * \brief Managed reference to GBDTModelNode.
+ * \sa GBDTModelNode
+ */
+class GBDTModel : public CostModel {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param params The training parameters overriding the defaults, the keys are the names of
+   * the fields of GBDTModelNode.
+   * \param seed The random seed.
+   */
+  GBDTModel(Map<String, ObjectRef> params, int seed);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(GBDTModel, CostModel, GBDTModelNode);
+};
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
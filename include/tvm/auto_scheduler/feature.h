@@ -116,6 +116,32 @@ void GetPerStoreFeaturesFromMeasurePairs(const Array<MeasureInput>& inputs,
                                          std::vector<float>* normalized_throughputs,
                                          std::vector<int>* task_ids);
 
+/*! \brief Counters of the per-store feature extraction. */
+struct FeatureExtractionStats {
+  /*! \brief The number of states whose features are found in the feature cache. */
+  int64_t cache_hits{0};
+  /*! \brief The number of states that are lowered to extract their features. */
+  int64_t cache_misses{0};
+  /*! \brief The number of states that fail to be lowered. */
+  int64_t errors{0};
+  /*! \brief The accumulated time of lowering and extraction in seconds, summed over threads. */
+  double extraction_time{0};
+};
+
+/*!
+ * \brief Set the maximum number of states kept in the feature cache.
+ *  The per-store features of a state are cached by the fingerprint of its transform steps,
+ *  so the states that are predicted again by the search are not lowered again.
+ * \param capacity The maximum number of cached states. 0 disables the cache.
+ */
+void SetFeatureCacheCapacity(size_t capacity);
+
+/*! \return The counters of the per-store feature extraction. */
+FeatureExtractionStats GetFeatureExtractionStats();
+
+/*! \brief Reset the counters of the per-store feature extraction. */
+void ResetFeatureExtractionStats();
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
@@ -286,6 +286,15 @@ class State : public ObjectRef {
    */
   String ToStr(bool delete_trivial_loop = true) const;
 
+  /*!
+   * \brief Get the 64-bit fingerprint of the transform step history.
+   * It combines the cached fingerprints of the steps, so it is much cheaper than ToStr() and is
+   * used to detect redundant states during the search. States with the same history have the
+   * same fingerprint, states that reach the same loop structure in different ways usually not.
+   * \return The fingerprint.
+   */
+  uint64_t Fingerprint() const;
+
   /********** Step APIs working on a single stage **********/
   /*!
    * \brief The schedule primitive corresponding to `te::Stage::bind`.
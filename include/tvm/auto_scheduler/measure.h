@@ -41,9 +41,11 @@
 #include <tvm/auto_scheduler/loop_state.h>
 #include <tvm/auto_scheduler/search_task.h>
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace tvm {
 namespace auto_scheduler {
@@ -278,6 +280,14 @@ class ProgramRunnerNode : public Object {
   double cooldown_interval;
   /*! \brief Whether to flush cache on CPU between repeated measurements. */
   bool enable_cpu_cache_flush;
+  /*!
+   * \brief If positive, keep repeating the measurement until the 95% confidence interval of the
+   * median cost is within this fraction of the median. `repeat` becomes the minimum number of
+   * repeats in this case.
+   */
+  double max_rel_ci;
+  /*! \brief The maximum number of repeats when max_rel_ci is set. */
+  int max_repeat;
 
   /*!
    * \brief Run measurement and return results.
@@ -361,9 +371,12 @@ class LocalRunner : public ProgramRunner {
    * \param min_repeat_ms The minimum duration of one repeat in milliseconds.
    * \param cooldown_interval The cool down interval between two measurements.
    * \param enable_cpu_cache_flush Whether to flush cache on CPU between repeated measurements.
+   * \param max_rel_ci If positive, repeat until the confidence interval of the median cost is
+   * within this fraction of the median.
+   * \param max_repeat The maximum number of repeats when max_rel_ci is set.
    */
   LocalRunner(int timeout, int number, int repeat, int min_repeat_ms, double cooldown_interval,
-              bool enable_cpu_cache_flush);
+              bool enable_cpu_cache_flush, double max_rel_ci = 0, int max_repeat = 100);
 
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(LocalRunner, ProgramRunner, LocalRunnerNode);
 };
@@ -413,14 +426,41 @@ class RPCRunner : public ProgramRunner {
    * \param min_repeat_ms The minimum duration of one repeat in milliseconds.
    * \param cooldown_interval The cool down interval between two measurements.
    * \param enable_cpu_cache_flush Whether to flush cache on CPU between repeated measurements.
+   * \param max_rel_ci If positive, repeat until the confidence interval of the median cost is
+   * within this fraction of the median.
+   * \param max_repeat The maximum number of repeats when max_rel_ci is set.
    */
   RPCRunner(const String& key, const String& host, int port, int priority, int n_parallel,
             int timeout, int number, int repeat, int min_repeat_ms, double cooldown_interval,
-            bool enable_cpu_cache_flush);
+            bool enable_cpu_cache_flush, double max_rel_ci = 0, int max_repeat = 100);
 
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RPCRunner, ProgramRunner, RPCRunnerNode);
 };
 
+/*! \brief Utilisation counters of the build and run stages of ProgramMeasurer. */
+struct MeasurePipelineStats {
+  /*! \brief The number of measured batches. */
+  int64_t num_batches{0};
+  /*! \brief The wall time spent in measurement, in seconds. */
+  double wall_time{0};
+  /*! \brief The time the builder spent building, in seconds. */
+  double build_time{0};
+  /*! \brief The time the runners spent running, summed over all runners, in seconds. */
+  double run_time{0};
+  /*! \brief The time the builder waited for a free slot in the queue, in seconds. */
+  double build_stall_time{0};
+  /*! \brief The time the runners waited for built programs, summed over all runners. */
+  double run_stall_time{0};
+  /*! \brief The wall time multiplied by the number of runners, in seconds. */
+  double runner_wall_time{0};
+};
+
+/*! \return The utilisation counters accumulated by all ProgramMeasurers. */
+MeasurePipelineStats GetMeasurePipelineStats();
+
+/*! \brief Reset the utilisation counters of all ProgramMeasurers. */
+void ResetMeasurePipelineStats();
+
 /*!
  * \brief Measurer that measures the time costs of tvm programs
  * This class combines ProgramBuilder and ProgramRunner and provides a simpler API */
@@ -446,6 +486,14 @@ class ProgramMeasurerNode : public Object {
   int verbose;
   /*! \brief The number of max continuous error. */
   int max_continous_error;
+  /*!
+   * \brief The number of built batches that can wait for a runner.
+   * 0 builds and runs every batch in turn. A positive value builds the next batches while the
+   * runners are busy, so that the builder and the runners work at the same time.
+   */
+  int pipeline_depth;
+  /*! \brief More runners to consume the built batches with `runner`, if pipeline_depth > 0. */
+  Array<ProgramRunner> extra_runners;
 
   /*! \brief Reset book keeping variables */
   void Reset();
@@ -471,6 +519,17 @@ class ProgramMeasurerNode : public Object {
   void SilentMeasure(const SearchTask& task, const Array<MeasureInput>& inputs,
                      Array<MeasureResult>* results);
 
+  /*!
+   * \brief Build and run the batches, overlapping the build of a batch with the run of the
+   * previous ones. `on_batch` is called in the calling thread on every batch in order.
+   * \param input_batches The MeasureInput batches.
+   * \param on_batch The function to process the results of one batch.
+   */
+  void PipelinedMeasure(
+      const std::vector<Array<MeasureInput>>& input_batches,
+      const std::function<void(const Array<MeasureInput>&, const Array<MeasureResult>&)>&
+          on_batch);
+
   /*! \brief The default max continuous error setting. */
   static const int DEFAULT_MAX_CONTINOUS_ERROR = 150;
 
@@ -492,10 +551,14 @@ class ProgramMeasurer : public ObjectRef {
    * \param verbose Verbosity level. 0 for silent, 1 to output information during program
    * measuring.
    * \param max_continous_error The number of allowed maximum continuous error.
+   * \param pipeline_depth The number of built batches that can wait for a runner, 0 to build and
+   * run every batch in turn.
+   * \param extra_runners More runners to consume the built batches in parallel with `runner`.
    */
   ProgramMeasurer(ProgramBuilder builder, ProgramRunner runner,
                   Optional<Array<MeasureCallback>> callbacks, int verbose,
-                  int max_continous_error = -1);
+                  int max_continous_error = -1, int pipeline_depth = 0,
+                  Array<ProgramRunner> extra_runners = {});
 
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(ProgramMeasurer, ObjectRef, ProgramMeasurerNode);
 };
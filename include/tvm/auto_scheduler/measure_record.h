@@ -19,7 +19,13 @@
 
 /*!
  * \file tvm/auto_scheduler/measure_record.h
- * \brief Json serialization format for dumping and loading measurement records.
+ * \brief Json and binary serialization formats for dumping and loading measurement records.
+ *
+ *  The json format stores one record per line. The binary format starts with
+ *  kAutoSchedulerBinaryLogMagic and stores length-prefixed records whose headers
+ *  (workload key, target, error number and mean cost) can be read without parsing
+ *  the transform steps, so the records can be indexed and randomly accessed.
+ *  A log file is written in the binary format if its name ends with ".bin".
  */
 
 #ifndef TVM_AUTO_SCHEDULER_MEASURE_RECORD_H_
@@ -29,11 +35,16 @@
 
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace tvm {
 namespace auto_scheduler {
 
+/*! \brief Magic number at the beginning of a binary measure record file. */
+constexpr uint64_t kAutoSchedulerBinaryLogMagic = 0x54564D41534C4F47;
+
 /*! \brief Callback for logging the input and results of measurements to file */
 class RecordToFileNode : public MeasureCallbackNode {
  public:
@@ -62,7 +73,7 @@ class RecordToFile : public MeasureCallback {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RecordToFile, MeasureCallback, RecordToFileNode);
 };
 
-/*! \brief Log reader to load step logs from a file.*/
+/*! \brief Log reader to load step logs from a json or binary file.*/
 class RecordReaderNode : public Object {
  public:
   /*! \brief The name of input file. */
@@ -88,12 +99,83 @@ class RecordReaderNode : public Object {
   std::pair<Array<MeasureInput>, Array<MeasureResult>> ReadLines(int max_size = -1,
                                                                  int skip_size = 0);
 
+  /*! \return Whether the file is in the binary format. */
+  bool IsBinary() const { return binary_; }
+
+  /*!
+   * \brief Get the number of records in the file.
+   * \note This and the following random access functions build the index on first use.
+   * The index of a binary file only reads the record headers, the index of a json file
+   * has to parse every line.
+   */
+  int64_t NumRecords();
+
+  /*!
+   * \brief Read a record by its position in the file. The position of ReadNext is kept.
+   * \param index The index of the record.
+   * \param inp A pointer to a MeasureInputNode, this is used as output.
+   * \param res A pointer to a MeasureResultNode, this is used as output.
+   */
+  void ReadRecord(int64_t index, MeasureInputNode* inp, MeasureResultNode* res);
+
+  /*!
+   * \brief Find the records of a workload.
+   * \param workload_key The workload key.
+   * \return The indices of the records in the file order.
+   */
+  std::vector<int64_t> FindRecords(const std::string& workload_key);
+
+  /*! \return The sorted workload keys of all records. */
+  std::vector<std::string> WorkloadKeys();
+
+  /*!
+   * \brief Read the valid record with the lowest mean cost.
+   * \param workload_key The workload key, empty means any workload.
+   * \param target_kind The name of the target kind, empty means any target.
+   * \param inp A pointer to a MeasureInputNode, this is used as output.
+   * \param res A pointer to a MeasureResultNode, this is used as output.
+   * \return Whether such a record is found.
+   */
+  bool ReadBest(const std::string& workload_key, const std::string& target_kind,
+                MeasureInputNode* inp, MeasureResultNode* res);
+
   static constexpr const char* _type_key = "auto_scheduler.RecordReader";
   TVM_DECLARE_FINAL_OBJECT_INFO(RecordReaderNode, Object);
 
  private:
+  /*! \brief The index entry of one record. */
+  struct IndexEntry {
+    /*! \brief The offset of the record in the file. */
+    int64_t offset;
+    /*! \brief The name of the target kind. */
+    std::string target_kind;
+    /*! \brief The error number of the measurement. */
+    int error_no;
+    /*! \brief The mean cost of the measurement. */
+    double mean_cost;
+  };
+
+  /*! \brief Detect the format of the opened file and move to the first record. */
+  void Init();
+  /*! \brief Read the record at the current position, skipping comment lines of json files. */
+  bool ReadAtCursor(MeasureInputNode* inp, MeasureResultNode* res);
+  /*! \brief Scan the file to build the index if it is not built yet. */
+  void BuildIndex();
+
   /*! \brief A string storing the current line. */
   std::string cur_line_;
+  /*! \brief Whether the file is in the binary format. */
+  bool binary_{false};
+  /*! \brief The offset of the first record. */
+  int64_t data_begin_{0};
+  /*! \brief Whether the index is built. */
+  bool indexed_{false};
+  /*! \brief The index entries of all records. */
+  std::vector<IndexEntry> index_;
+  /*! \brief Workload key -> the indices of its records. */
+  std::unordered_map<std::string, std::vector<int64_t>> workload_index_;
+
+  friend class RecordReader;
 };
 
 /*!
@@ -120,6 +202,40 @@ class RecordReader : public ObjectRef {
 void WriteMeasureRecords(std::ostream* os, const Array<MeasureInput>& inputs,
                          const Array<MeasureResult>& results);
 
+/*!
+ * \brief Write the file header of the binary format to an output stream.
+ * \param os A pointer to a output stream.
+ */
+void WriteBinaryRecordHeader(std::ostream* os);
+
+/*!
+ * \brief Append measure records in the binary format to an output stream.
+ * \param os A pointer to a output stream, which is positioned after the file header.
+ * \param inputs The MeasureInputs to be written.
+ * \param results The MeasureResults to be written.
+ */
+void WriteBinaryMeasureRecords(std::ostream* os, const Array<MeasureInput>& inputs,
+                               const Array<MeasureResult>& results);
+
+/*!
+ * \brief Append measure records to a log file.
+ *  The format of an existing file is kept, a new file is binary if its name ends with ".bin".
+ * \param filename The name of the log file.
+ * \param inputs The MeasureInputs to be written.
+ * \param results The MeasureResults to be written.
+ */
+void AppendMeasureRecords(const std::string& filename, const Array<MeasureInput>& inputs,
+                          const Array<MeasureResult>& results);
+
+/*!
+ * \brief Convert a log file between the json and the binary format.
+ * \param src The name of the input file, in either format.
+ * \param dst The name of the output file, which is overwritten.
+ * \param binary Whether to write the binary format.
+ * \return The number of converted records.
+ */
+int64_t ConvertMeasureRecords(const std::string& src, const std::string& dst, bool binary);
+
 /*!
  * \brief Read one measure record from a string.
  * \param str The record string to be parsed.
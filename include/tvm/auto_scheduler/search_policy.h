@@ -62,10 +62,12 @@
 #ifndef TVM_AUTO_SCHEDULER_SEARCH_POLICY_H_
 #define TVM_AUTO_SCHEDULER_SEARCH_POLICY_H_
 
+#include <tvm/auto_scheduler/measure.h>
 #include <tvm/auto_scheduler/search_task.h>
 #include <tvm/node/node.h>
 
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -129,6 +131,39 @@ class PreloadMeasuredStates : public SearchCallback {
                                         PreloadMeasuredStatesNode);
 };
 
+/*! \brief Preload the states of structurally similar workloads from a log file.
+ * This warm starts the search of a new shape with the schedules tuned for other shapes */
+class PreloadSimilarStatesNode : public SearchCallbackNode {
+ public:
+  /*! \brief The name of the record log file. */
+  String filename;
+  /*! \brief The maximum number of states transferred from each similar workload. */
+  int max_states_per_workload;
+
+  void Callback(SearchPolicyNode* policy) final;
+
+  static constexpr const char* _type_key = "auto_scheduler.PreloadSimilarStates";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PreloadSimilarStatesNode, SearchCallbackNode);
+};
+
+/*!
+ * \brief Managed reference to PreloadSimilarStatesNode.
+ * \sa PreloadSimilarStatesNode
+ */
+class PreloadSimilarStates : public SearchCallback {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param filename The name of the record log file.
+   * \param max_states_per_workload The maximum number of states transferred from each similar
+   * workload.
+   */
+  PreloadSimilarStates(String filename, int max_states_per_workload);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(PreloadSimilarStates, SearchCallback,
+                                        PreloadSimilarStatesNode);
+};
+
 /*! \brief Attribute keys of ops used for SearchPolicy. */
 struct SearchPolicyKey {
   /*! \brief Always apply unroll to the inner most iterator of the specificed iterators. */
@@ -170,12 +205,37 @@ class SearchPolicyNode : public Object {
   virtual State Search(int num_measure_trials, int early_stopping, int num_measures_per_round,
                        ProgramMeasurer measurer) = 0;
 
+  /*!
+   * \brief Continue the search by doing one more round of search and measurement.
+   * This is used by the task scheduler, which interleaves the search rounds of several tasks
+   * and shares one ProgramMeasurer between them.
+   * \param num_measure The number of programs to be measured in this round.
+   * \param measurer A ProgramMeasurer to build and measure programs
+   * \return The measured inputs and results. They are empty if no new state can be found.
+   */
+  virtual std::pair<Array<MeasureInput>, Array<MeasureResult>> ContinueSearchOneRound(
+      int num_measure, ProgramMeasurer measurer) = 0;
+
   /*!
    * \brief Preload measured states from a log file to resume the state of the search policy.
    * \param log_file The name of the record log file.
    */
   void PreloadMeasuredStates(const String& log_file);
 
+  /*!
+   * \brief Preload the records of other workloads whose ComputeDAG has the same structural key
+   * as the current one, i.e. the same operators on different shapes. The best states of each of
+   * them are replayed on the current ComputeDAG to seed the initial population of the search,
+   * and all their valid records are used to pre-train the cost model.
+   * \param log_file The name of the record log file.
+   * \param max_states_per_workload The maximum number of states transferred from each similar
+   * workload.
+   */
+  void PreloadSimilarStates(const String& log_file, int max_states_per_workload);
+
+  /*! \return The states transferred from similar workloads. */
+  const Array<State>& transferred_states() const { return transferred_states_; }
+
   /*!
    * \brief Call SearchCallback with the current SearchPolicyNode
    * \param callbacks SearchCallback to be called.
@@ -188,15 +248,21 @@ class SearchPolicyNode : public Object {
  protected:
   /*!
    * \brief The set of already measured states.
-   * We store the string format of a state for redundancy check. This is used to make sure a
+   * We store the fingerprint of a state for redundancy check. This is used to make sure a
    * measured state will never be measured again.
    */
-  std::unordered_set<String> measured_states_set_;
+  std::unordered_set<uint64_t> measured_states_set_;
   /*! \brief The array of already measured states.
    *  The good states can be used as the initial population in evolutionary search. */
   std::vector<State> measured_states_vector_;
   /*! \brief The throughputs of already measured states */
   std::vector<float> measured_states_throughputs_;
+  /*! \brief The states transferred from similar workloads, sorted by their original costs. */
+  Array<State> transferred_states_;
+  /*! \brief The records of similar workloads that are not fed to the cost model yet. */
+  Array<MeasureInput> transferred_inputs_;
+  /*! \brief The results of transferred_inputs_. */
+  Array<MeasureResult> transferred_results_;
 };
 
 /*!
@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/auto_scheduler/task_scheduler.h
+ * \brief The task scheduler that allocates the tuning budget of a network across its tasks.
+ *
+ * A network is partitioned into several subgraphs (tasks), and tuning every task with the
+ * same number of trials wastes time on the tasks that hardly affect the end-to-end latency.
+ * The task scheduler tunes the tasks in an interleaved way. Each time it picks the task with
+ * the most expected reduction of the objective, which is the sum of the best latencies of all
+ * tasks weighted by the number of times each task appears in the network.
+ *
+ * The expected gain of a task is estimated with the gradient of the objective with respect to
+ * the number of rounds allocated to it. The gradient mixes a backward term (the improvement in
+ * the last few rounds) and a forward term (an optimistic guess of the next improvement, and the
+ * throughput already reached by the structurally similar tasks).
+ */
+
+#ifndef TVM_AUTO_SCHEDULER_TASK_SCHEDULER_H_
+#define TVM_AUTO_SCHEDULER_TASK_SCHEDULER_H_
+
+#include <tvm/auto_scheduler/auto_schedule.h>
+#include <tvm/auto_scheduler/measure.h>
+#include <tvm/auto_scheduler/search_policy.h>
+
+#include <vector>
+
+namespace tvm {
+namespace auto_scheduler {
+
+/*! \brief The task scheduler that allocates the tuning trials across the tasks of a network. */
+class TaskSchedulerNode : public Object {
+ public:
+  /*! \brief All tasks of the network. */
+  Array<SearchTask> tasks;
+  /*! \brief The search policy of each task. */
+  Array<SearchPolicy> search_policies;
+  /*! \brief The weight of each task in the objective, usually the number of its appearances. */
+  Array<FloatImm> task_weights;
+  /*! \brief The allocation strategy, "gradient" or "round-robin". */
+  String strategy;
+  /*! \brief The weight of the backward gradient against the forward gradient. */
+  double alpha;
+  /*! \brief The weight of the throughput of similar tasks in the forward gradient. */
+  double beta;
+  /*! \brief The number of rounds to look back when computing the backward gradient. */
+  int backward_window_size;
+  /*! \brief Verbosity level. 0 for silent, 1 to output the progress of all tasks. */
+  int verbose;
+
+  /*! \brief The best latency of each task in seconds. */
+  std::vector<double> best_costs;
+  /*! \brief The number of search rounds allocated to each task. */
+  std::vector<int> task_cts;
+  /*! \brief The number of measured programs of each task. */
+  std::vector<int> task_trials;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("tasks", &tasks);
+    v->Visit("search_policies", &search_policies);
+    v->Visit("task_weights", &task_weights);
+    v->Visit("strategy", &strategy);
+    v->Visit("alpha", &alpha);
+    v->Visit("beta", &beta);
+    v->Visit("backward_window_size", &backward_window_size);
+    v->Visit("verbose", &verbose);
+  }
+
+  /*!
+   * \brief Tune all tasks.
+   * \param tuning_options Tuning and measurement options. num_measure_trials is the budget of the
+   * whole network, and early_stopping applies to each task separately.
+   */
+  void Tune(TuningOptions tuning_options);
+
+  /*! \return The estimated latency of the network in seconds, i.e. the objective. */
+  double EstimatedLatency() const;
+
+  static constexpr const char* _type_key = "auto_scheduler.TaskScheduler";
+  TVM_DECLARE_FINAL_OBJECT_INFO(TaskSchedulerNode, Object);
+
+ private:
+  /*!
+   * \brief Run one search round of a task and update its bookkeeping.
+   * \param task_id The task to be tuned.
+   * \param num_measure The number of programs to be measured in this round.
+   * \param measurer The ProgramMeasurer shared by all tasks.
+   */
+  void TuneTask(int task_id, int num_measure, ProgramMeasurer measurer);
+
+  /*!
+   * \brief Pick the next task to be tuned.
+   * \return The id of the picked task, or -1 if all tasks have stopped.
+   */
+  int PickNextTask();
+
+  /*! \brief Print the progress of all tasks. */
+  void PrintTable() const;
+
+  /*! \brief The best latency of each task after each of its rounds. */
+  std::vector<std::vector<double>> cost_history_;
+  /*! \brief The measured program counter of each task at its last improvement. */
+  std::vector<int> best_trials_;
+  /*! \brief The number of consecutive rounds of each task without any valid program yet. */
+  std::vector<int> invalid_rounds_;
+  /*! \brief Whether each task has stopped. */
+  std::vector<bool> dead_;
+  /*! \brief The ids of the structurally similar tasks of each task, including itself. */
+  std::vector<std::vector<int>> similar_tasks_;
+  /*! \brief The task picked in the last round, used by the round-robin strategy. */
+  int last_task_{-1};
+  /*! \brief The early stopping threshold of each task. */
+  int early_stopping_{0};
+};
+
+/*!
+ * \brief Managed reference to TaskSchedulerNode.
+ * \sa TaskSchedulerNode
+ */
+class TaskScheduler : public ObjectRef {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param tasks All tasks of the network.
+   * \param search_policies The search policy of each task.
+   * \param task_weights The weight of each task in the objective.
+   * \param strategy The allocation strategy, "gradient" or "round-robin".
+   * \param alpha The weight of the backward gradient against the forward gradient.
+   * \param beta The weight of the throughput of similar tasks in the forward gradient.
+   * \param backward_window_size The number of rounds to look back for the backward gradient.
+   * \param verbose Verbosity level. 0 for silent, 1 to output the progress of all tasks.
+   */
+  TaskScheduler(Array<SearchTask> tasks, Array<SearchPolicy> search_policies,
+                Array<FloatImm> task_weights, String strategy, double alpha, double beta,
+                int backward_window_size, int verbose);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(TaskScheduler, ObjectRef, TaskSchedulerNode);
+};
+
+}  // namespace auto_scheduler
+}  // namespace tvm
+
+#endif  // TVM_AUTO_SCHEDULER_TASK_SCHEDULER_H_
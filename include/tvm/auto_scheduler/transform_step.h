@@ -50,6 +50,8 @@
 #include <tvm/node/node.h>
 #include <tvm/te/schedule.h>
 
+#include <atomic>
+
 namespace tvm {
 namespace auto_scheduler {
 
@@ -163,8 +165,19 @@ class StepNode : public Object {
    */
   virtual void WriteToRecord(dmlc::JSONWriter* writer) const = 0;
 
+  /*!
+   * \brief Get the 64-bit fingerprint of the step record.
+   * Steps are not modified after construction, so it is computed once and cached.
+   * \return The fingerprint, never 0.
+   */
+  uint64_t Fingerprint() const;
+
   static constexpr const char* _type_key = "auto_scheduler.Step";
   TVM_DECLARE_BASE_OBJECT_INFO(StepNode, Object);
+
+ private:
+  /*! \brief The cached fingerprint, 0 if it has not been computed. */
+  mutable std::atomic<uint64_t> fingerprint_{0};
 };
 
 /*!
@@ -139,6 +139,31 @@ TVM_DLL int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, in
  */
 TVM_DLL int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv);
 
+/*!
+ * \brief Get the next chunk of iterations of a dynamically scheduled parallel loop.
+ *
+ *  The tasks that run the loop share an iteration counter and call this function until
+ *  it returns 0. The counter is never reset within a parallel launch: a loop that is
+ *  entered several times takes the counter values [base, base + extent) on each entry,
+ *  where base is the sum of the extents of the previous entries, which every task tracks
+ *  on its own. A task that is late on an entry then cannot take the iterations of the
+ *  next one.
+ *
+ * \param counter The iteration counter shared by the tasks, 0 when the launch starts.
+ * \param base The counter value of the first iteration of this entry of the loop.
+ * \param extent The number of iterations of the loop.
+ * \param chunk_size The number of iterations of a chunk, the minimum one for guided scheduling.
+ * \param num_task The number of tasks that run the loop.
+ * \param guided Whether the chunks shrink with the remaining iterations (guided scheduling),
+ *           instead of having the same size (dynamic scheduling).
+ * \param begin The first iteration of the chunk, relative to the entry.
+ * \param end One past the last iteration of the chunk, relative to the entry.
+ * \return 1 when a chunk is assigned, 0 when all iterations have been assigned.
+ */
+TVM_DLL int TVMBackendParallelGetChunk(int64_t* counter, int64_t base, int64_t extent,
+                                       int64_t chunk_size, int num_task, int guided,
+                                       int64_t* begin, int64_t* end);
+
 /*!
  * \brief Simple static initialization function.
  *  Run f once and set handle to be not null.
@@ -52,6 +52,8 @@ typedef struct TVMGraphRuntimeGraphAttr {
   int64_t* shape;
   uint32_t* ndim;
   uint32_t shape_count;
+  int64_t* storage_offset;  // byte offsets in the storage, set by the arena memory planner
+  uint32_t storage_offset_count;
 } TVMGraphRuntimeGraphAttr;
 
 typedef struct TVMGraphRuntime TVMGraphRuntime;
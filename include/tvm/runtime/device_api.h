@@ -194,6 +194,17 @@ class TVM_DLL DeviceAPI {
   static bool NeedSetDeviceContext(int device_type) {
     return device_type != kDLCPU && device_type != kDLMicroDev;
   }
+
+  /*!
+   * \brief Whether the data pointers of a certain device type are addresses,
+   *        so that a pointer into an allocation can be made by pointer arithmetic.
+   *        Other devices, e.g. OpenCL, Vulkan and Metal, use opaque handles.
+   * \param device_type The device type.
+   */
+  static bool SupportsPointerArithmetic(int device_type) {
+    return device_type == kDLCPU || device_type == kDLCPUPinned || device_type == kDLGPU ||
+           device_type == kDLROCM;
+  }
 };
 
 /*! \brief The device type bigger than this is RPC device */
@@ -122,9 +122,13 @@ class NDArray : public ObjectRef {
    * \brief Create a NDArray that shares the data memory with the current one.
    * \param shape The shape of the new array.
    * \param dtype The data type of the new array.
-   * \note The memory size of new array must be smaller than the current one.
+   * \param relative_byte_offset The offset of the view in bytes from the start of the current one.
+   *  It is added to the data pointer on devices that support pointer arithmetic,
+   *  and to the byte_offset of the view otherwise.
+   * \note The memory size of new array plus the offset must be smaller than the current one.
    */
-  TVM_DLL NDArray CreateView(std::vector<int64_t> shape, DLDataType dtype);
+  TVM_DLL NDArray CreateView(std::vector<int64_t> shape, DLDataType dtype,
+                             size_t relative_byte_offset = 0);
   /*!
    * \brief Create a reference view of NDArray that
    *  represents as DLManagedTensor.
@@ -75,10 +75,15 @@ class ThreadGroup {
    *        If  `true`, worker0 will not be launched in a new thread and
    *        `worker_callback` will only be called for values >= 1. This
    *        allows use of the main thread as a worker.
+   * \param core_offset The position of the first core to bind in the
+   *        preferred order, which allows several groups to use disjoint cores.
+   *        The main thread is then bound to the cores of the group as well.
+   *        -1 (default) binds the workers from the first core and lets the
+   *        main thread run on all cores.
    *
    * \return The number of workers to use.
    */
-  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0);
+  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0, int core_offset = -1);
 
  private:
   Impl* impl_;
@@ -29,12 +29,16 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/vm/bytecode.h>
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
+
+class MappedFile;
+
 namespace vm {
 
 struct VMFunction;
@@ -81,6 +85,19 @@ class Executable : public ModuleNode {
    */
   static runtime::Module Load(const std::string& code, const runtime::Module lib);
 
+  /*!
+   * \brief Load a saved VM executable from a file without copying its constants.
+   *
+   *  The file is memory mapped and the constants alias the mapping, so they are only
+   *  read from disk when first used and their pages are shared between processes.
+   *
+   * \param path The path of the saved executable.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static runtime::Module LoadFromFile(const std::string& path, const runtime::Module lib);
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -173,11 +190,11 @@ class Executable : public ModuleNode {
   void SaveGlobalSection(dmlc::Stream* strm);
 
   /*!
-   * \brief Save the constant pool.
+   * \brief Save the constant pool, the data of each constant is aligned in the stream.
    *
    * \param strm The input stream.
    */
-  void SaveConstantSection(dmlc::Stream* strm);
+  void SaveConstantSection(dmlc::SeekStream* strm);
 
   /*!
    * \brief Save primitive op names.
@@ -204,8 +221,17 @@ class Executable : public ModuleNode {
    * \brief Load the constant pool.
    *
    * \param strm The input stream.
+   * \param mapping The mapped file strm reads from, the constants alias it when given.
+   */
+  void LoadConstantSection(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapping);
+
+  /*!
+   * \brief Load all the sections of a saved executable.
+   *
+   * \param strm The input stream.
+   * \param mapping The mapped file strm reads from, or nullptr.
    */
-  void LoadConstantSection(dmlc::Stream* strm);
+  void LoadSections(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapping);
 
   /*!
    * \brief Load primitive op names.
@@ -69,6 +69,31 @@ enum AllocatorType {
   kPooled,
 };
 
+/*! \brief Counters reported by an allocator. */
+struct AllocatorStats {
+  /*! \brief The number of allocations served from cached buffers. */
+  size_t hits{0};
+  /*! \brief The number of allocations that reached the device API. */
+  size_t misses{0};
+  /*! \brief The bytes currently held from the device, both in use and cached. */
+  size_t allocated_bytes{0};
+  /*! \brief The bytes held in free lists and available for reuse. */
+  size_t pooled_bytes{0};
+  /*! \brief The total bytes returned to the device by trimming. */
+  size_t trimmed_bytes{0};
+  /*! \brief The total bytes requested by callers over the allocator lifetime. */
+  size_t requested_bytes{0};
+  /*! \brief The total bytes handed out for those requests, after size-class rounding. */
+  size_t served_bytes{0};
+  /*!
+   * \brief The internal fragmentation caused by rounding requests up.
+   * \return The fraction of served bytes that was not requested.
+   */
+  double Fragmentation() const {
+    return served_bytes == 0 ? 0.0 : 1.0 - static_cast<double>(requested_bytes) / served_bytes;
+  }
+};
+
 class Allocator {
  public:
   explicit Allocator(AllocatorType type) : type_(type) {}
@@ -97,6 +122,17 @@ class Allocator {
    *  \return The amount of memory currently allocated.
    */
   virtual size_t UsedMemory() const = 0;
+  /*! \brief Return the counters of the allocator. */
+  virtual AllocatorStats Stats() const {
+    AllocatorStats stats;
+    stats.allocated_bytes = UsedMemory();
+    return stats;
+  }
+  /*!
+   * \brief Return cached buffers to the device until at most target_bytes remain cached.
+   * \param target_bytes The number of cached bytes that may be kept.
+   */
+  virtual void Trim(size_t target_bytes = 0) {}
 
  private:
   AllocatorType type_;
@@ -118,6 +154,16 @@ class MemoryManager {
    * \return The memory allocator.
    */
   static Allocator* GetAllocator(TVMContext ctx);
+  /*!
+   * \brief Get the counters of the allocator of a context.
+   * \param ctx The TVM context
+   * \return The allocator counters.
+   */
+  static AllocatorStats GetStats(TVMContext ctx);
+  /*!
+   * \brief Return the cached memory of every allocator to the devices.
+   */
+  static void TrimAll();
 
  private:
   MemoryManager() {}
@@ -198,7 +198,7 @@ class VirtualMachine : public runtime::ModuleNode {
    * \param reg The register to read from.
    * \return The read object.
    */
-  inline ObjectRef ReadRegister(RegName reg) const;
+  inline const ObjectRef& ReadRegister(RegName reg) const;
 
   /*!
    * \brief Read a VM register and cast it to int32_t
@@ -248,6 +248,16 @@ class VirtualMachine : public runtime::ModuleNode {
   /*! \brief Run VM dispatch loop. */
   void RunLoop();
 
+  /*!
+   * \brief Get the cached scalar tensor holding a constant.
+   * \param cache The cache for the data type of the scalar.
+   * \param val The value of the scalar.
+   * \param dtype The data type of the scalar.
+   * \return The scalar tensor on CPU.
+   */
+  const NDArray& GetScalarConstant(std::unordered_map<int64_t, NDArray>* cache, int64_t val,
+                                   DLDataType dtype);
+
   /*! \brief Get context from the context list based on a given device type. */
   TVMContext GetContext(Index device_type) const;
 
@@ -284,6 +294,23 @@ class VirtualMachine : public runtime::ModuleNode {
    * object to avoid rellocation of constants during inference.
    */
   std::vector<ObjectRef> const_pool_;
+  /*! \brief The int64 scalars produced by LoadConsti, keyed by value. */
+  std::unordered_map<int64_t, NDArray> consti_pool_;
+  /*! \brief The int32 scalars produced by GetTag, keyed by value. */
+  std::unordered_map<int64_t, NDArray> tag_pool_;
+  /*!
+   * \brief Scratch space for the arguments of Invoke, InvokeClosure and InvokePacked.
+   *  It keeps its capacity across instructions so dispatch does not allocate.
+   */
+  std::vector<ObjectRef> arg_scratch_;
+  /*! \brief Scratch space for the marshalled arguments of packed calls. */
+  std::vector<TVMValue> packed_values_;
+  /*! \brief Scratch space for the type codes of packed calls. */
+  std::vector<int> packed_codes_;
+  /*! \brief Register files of popped frames, recycled by the next calls. */
+  std::vector<std::vector<ObjectRef>> free_register_files_;
+  /*! \brief The number of instructions executed since the VM was created. */
+  uint64_t num_executed_instructions_{0};
 };
 
 }  // namespace vm
@@ -67,6 +67,20 @@ TVM_DLL std::vector<std::vector<int>> rr_partitioner(int begin, int end, int ste
 TVM_DLL void parallel_for(int begin, int end, const std::function<void(int)>& f, int step = 1,
                           const PartitionerFuncType partitioner = rr_partitioner);
 
+/*!
+ * \brief Run the task function in parallel with dynamic scheduling.
+ *  Every thread repeatedly takes the next unprocessed index, so loops whose iterations have very
+ *  different costs are balanced across the threads.
+ * \param begin The start index of this parallel loop(inclusive).
+ * \param end The end index of this parallel loop(exclusive).
+ * \param num_threads The number of threads, the number of hardware threads if it is not positive.
+ * \param f The task function to be excuted. Assert to take an int index as input with no output.
+ * \note Same as parallel_for, nested parallel loops are not supported and the task function should
+ * be thread safe.
+ */
+TVM_DLL void parallel_for_dynamic(int begin, int end, int num_threads,
+                                  const std::function<void(int)>& f);
+
 }  // namespace support
 }  // namespace tvm
 
@@ -25,6 +25,7 @@
 #define TVM_TARGET_TARGET_INFO_H_
 
 #include <tvm/ir/expr.h>
+#include <tvm/target/target.h>
 
 #include <string>
 
@@ -72,5 +73,48 @@ class MemoryInfo : public ObjectRef {
  */
 TVM_DLL MemoryInfo GetMemoryInfo(const std::string& scope);
 
+/*!
+ * \brief Register file information of a target, which bounds the size of the
+ *  straight-line loop bodies that code generation can keep in registers.
+ *  Use RegisterInfo as its container type
+ */
+class RegisterInfoNode : public Object {
+ public:
+  /*! \brief Number of registers available to the values of a loop body */
+  int num_registers;
+  /*! \brief Number of bits of a register, the vector width on CPUs */
+  int register_bits;
+  /*! \brief Maximum number of instructions of an unrolled loop body */
+  int max_unrolled_instructions;
+
+  void VisitAttrs(AttrVisitor* v) {
+    v->Visit("num_registers", &num_registers);
+    v->Visit("register_bits", &register_bits);
+    v->Visit("max_unrolled_instructions", &max_unrolled_instructions);
+  }
+
+  static constexpr const char* _type_key = "RegisterInfo";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RegisterInfoNode, Object);
+};
+
+/*! \brief Defines register info */
+class RegisterInfo : public ObjectRef {
+ public:
+  TVM_DLL RegisterInfo(int num_registers, int register_bits, int max_unrolled_instructions);
+
+  TVM_DEFINE_OBJECT_REF_METHODS(RegisterInfo, ObjectRef, RegisterInfoNode);
+};
+
+/*!
+ * \brief get register info of a target
+ *
+ *  A function registered as "tvm.info.register.<target kind>" overrides the
+ *  built-in estimate, which depends on the target kind, mtriple, mcpu and mattr.
+ *
+ * \param target The target, the generic estimate is used when it is undefined.
+ * \return info The register info.
+ */
+TVM_DLL RegisterInfo GetRegisterInfo(const Target& target);
+
 }  // namespace tvm
 #endif  // TVM_TARGET_TARGET_INFO_H_
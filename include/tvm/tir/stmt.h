@@ -887,6 +887,11 @@ constexpr const char* device_context_type = "device_context_type";
 constexpr const char* loop_scope = "loop_scope";
 /*! \brief Mark of reduce scope */
 constexpr const char* reduce_scope = "reduce_scope";
+/*!
+ * \brief Mark of the unrolling decision made on a loop, node is the loop variable,
+ *  value is a StringImm that describes the decision.
+ */
+constexpr const char* unroll_decision = "unroll_decision";
 /*! \brief Mark region is guarded by the pragma extension */
 constexpr const char* pragma_scope_prefix = "pragma_";
 /*! \brief Import C source or file into the final code gen module */
@@ -188,7 +188,7 @@ def _make_tvm_args(args, temp_args):
 
 class PackedFuncBase(object):
     """Function base."""
-    __slots__ = ["handle", "is_global"]
+    __slots__ = ["handle", "is_global", "release_gil"]
     # pylint: disable=no-member
     def __init__(self, handle, is_global):
         """Initialize the function with handle
@@ -203,6 +203,8 @@ class PackedFuncBase(object):
         """
         self.handle = handle
         self.is_global = is_global
+        # ctypes releases the GIL in every foreign call, kept for parity with cython
+        self.release_gil = False
 
     def __del__(self):
         if not self.is_global and _LIB is not None:
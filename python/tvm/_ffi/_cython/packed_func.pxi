@@ -235,36 +235,53 @@ cdef inline int FuncCall3(void* chandle,
                           tuple args,
                           int nargs,
                           TVMValue* ret_val,
-                          int* ret_tcode) except -1:
+                          int* ret_tcode,
+                          int release_gil) except -1:
     cdef TVMValue[3] values
     cdef int[3] tcodes
+    cdef int c_api_ret_code
     nargs = len(args)
     temp_args = []
     for i in range(nargs):
         make_arg(args[i], &values[i], &tcodes[i], temp_args)
-    CALL(TVMFuncCall(chandle, &values[0], &tcodes[0],
-                     nargs, ret_val, ret_tcode))
+    if release_gil:
+        # let other threads of the call enter packed functions implemented in python
+        with nogil:
+            c_api_ret_code = TVMFuncCall(chandle, &values[0], &tcodes[0],
+                                         nargs, ret_val, ret_tcode)
+        CALL(c_api_ret_code)
+    else:
+        CALL(TVMFuncCall(chandle, &values[0], &tcodes[0],
+                         nargs, ret_val, ret_tcode))
     return 0
 
 cdef inline int FuncCall(void* chandle,
                          tuple args,
                          TVMValue* ret_val,
-                         int* ret_tcode) except -1:
+                         int* ret_tcode,
+                         int release_gil=0) except -1:
     cdef int nargs
     nargs = len(args)
     if nargs <= 3:
-        FuncCall3(chandle, args, nargs, ret_val, ret_tcode)
+        FuncCall3(chandle, args, nargs, ret_val, ret_tcode, release_gil)
         return 0
 
     cdef vector[TVMValue] values
     cdef vector[int] tcodes
+    cdef int c_api_ret_code
     values.resize(max(nargs, 1))
     tcodes.resize(max(nargs, 1))
     temp_args = []
     for i in range(nargs):
         make_arg(args[i], &values[i], &tcodes[i], temp_args)
-    CALL(TVMFuncCall(chandle, &values[0], &tcodes[0],
-                     nargs, ret_val, ret_tcode))
+    if release_gil:
+        with nogil:
+            c_api_ret_code = TVMFuncCall(chandle, &values[0], &tcodes[0],
+                                         nargs, ret_val, ret_tcode)
+        CALL(c_api_ret_code)
+    else:
+        CALL(TVMFuncCall(chandle, &values[0], &tcodes[0],
+                         nargs, ret_val, ret_tcode))
     return 0
 
 
@@ -284,6 +301,7 @@ cdef inline int ConstructorCall(void* constructor_handle,
 cdef class PackedFuncBase:
     cdef TVMPackedFuncHandle chandle
     cdef int is_global
+    cdef int c_release_gil
 
     cdef inline _set_handle(self, handle):
         if handle is None:
@@ -298,6 +316,13 @@ cdef class PackedFuncBase:
         def __set__(self, value):
             self.c_is_global = value
 
+    property release_gil:
+        def __get__(self):
+            return self.c_release_gil != 0
+
+        def __set__(self, value):
+            self.c_release_gil = value
+
     property handle:
         def __get__(self):
             if self.chandle == NULL:
@@ -318,7 +343,7 @@ cdef class PackedFuncBase:
     def __call__(self, *args):
         cdef TVMValue ret_val
         cdef int ret_tcode
-        FuncCall(self.chandle, args, &ret_val, &ret_tcode)
+        FuncCall(self.chandle, args, &ret_val, &ret_tcode, self.c_release_gil)
         return make_ret(ret_val, ret_tcode)
 
 
@@ -24,15 +24,18 @@ from . import loop_state
 from . import utils
 from . import workload_registry
 from . import feature
+from . import task_scheduler
 
 # Shortcut
 from .auto_schedule import SearchTask, TuningOptions, HardwareParams, \
     auto_schedule
 from .compute_dag import ComputeDAG
-from .cost_model import RandomModel, XGBModel
+from .cost_model import RandomModel, GBDTModel, XGBModel
 from .measure import MeasureInput, MeasureResult, LocalBuilder, LocalRunner, RPCRunner, \
     LocalRPCMeasureContext
 from .measure_record import RecordToFile, RecordReader, load_best, \
-    load_records, save_records
-from .search_policy import EmptyPolicy, SketchPolicy, PreloadMeasuredStates
+    load_records, save_records, convert_records
+from .search_policy import EmptyPolicy, SketchPolicy, PreloadMeasuredStates, \
+    PreloadSimilarStates
+from .task_scheduler import TaskScheduler
 from .workload_registry import register_workload, make_workload_key
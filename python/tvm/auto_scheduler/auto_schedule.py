@@ -102,15 +102,24 @@ class TuningOptions(Object):
       Verbosity level. 0 for silent, 1 to output information during schedule search.
     builder: Union[ProgramBuilder, str] = 'local'
       ProgramBuilder which builds the program.
-    runner: Union[ProgramRunner, str] = 'local'
+    runner: Union[ProgramRunner, str, List[ProgramRunner]] = 'local'
       ProgramRunner which runs the program and measures time costs.
+      With a list of runners and `pipeline_depth` > 0, all of them run the built programs in
+      parallel, e.g. several RPCRunners with different device keys.
     measure_callbacks: Optional[List[MeasureCallback]]
       Callback functions called after each measurement.
       Candidates:
         - auto_scheduler.RecordToFile
+    pipeline_depth: int = 0
+      The number of built batches that can wait for a runner.
+      With 0, every batch is built and then run, so the builder is idle while the programs run
+      and vice versa. A positive value builds the next batches while the runners are busy.
+      Builds running beside a LocalRunner can disturb its timing, so the pipeline is best used
+      with RPCRunners or with builder cores isolated from the measured ones.
     """
     def __init__(self, num_measure_trials=0, early_stopping=None, num_measures_per_round=64,
-                 verbose=1, builder='local', runner='local', measure_callbacks=None):
+                 verbose=1, builder='local', runner='local', measure_callbacks=None,
+                 pipeline_depth=0):
         if isinstance(builder, str):
             if builder == 'local':
                 builder = LocalBuilder()
@@ -120,18 +129,23 @@ class TuningOptions(Object):
             raise ValueError("Invalid builder: " + builder +
                              " . TuningOptions expects a ProgramBuilder or string.")
 
-        if isinstance(runner, str):
-            if runner == 'local':
-                runner = LocalRunner()
-            else:
-                raise ValueError("Invalid runner: " + runner)
-        elif not isinstance(runner, tvm.auto_scheduler.measure.ProgramRunner):
-            raise ValueError("Invalid runner: " + runner +
-                             " . TuningOptions expects a ProgramRunner or string.")
+        runners = list(runner) if isinstance(runner, (list, tuple)) else [runner]
+        if not runners:
+            raise ValueError("TuningOptions expects at least one runner.")
+        for i, runner in enumerate(runners):
+            if isinstance(runner, str):
+                if runner == 'local':
+                    runners[i] = LocalRunner()
+                else:
+                    raise ValueError("Invalid runner: " + runner)
+            elif not isinstance(runner, tvm.auto_scheduler.measure.ProgramRunner):
+                raise ValueError("Invalid runner: " + runner +
+                                 " . TuningOptions expects a ProgramRunner or string.")
 
         self.__init_handle_by_constructor__(
             _ffi_api.TuningOptions, num_measure_trials, early_stopping or -1,
-            num_measures_per_round, verbose, builder, runner, measure_callbacks)
+            num_measures_per_round, verbose, builder, runners[0], measure_callbacks,
+            pipeline_depth, runners[1:])
 
 
 def auto_schedule(task, search_policy=None, tuning_options=TuningOptions()):
@@ -138,6 +138,19 @@ class ComputeDAG(Object):
                 updated_state.stage_id_map[k] = v
         return updated_state
 
+    def get_structural_key(self):
+        """
+        Get a key of the structure of this DAG, in which every numeric literal such as a shape
+        or a loop extent is masked. The DAGs of the same operators on different shapes get the
+        same key.
+
+        Returns
+        -------
+        key : str
+            The structural key.
+        """
+        return _ffi_api.ComputeDAGGetStructuralKey(self)
+
     def __hash__(self):
         # TODO(merrymercy): Implement this more carefully and move this to c++ as a member function
         # of ComputeDAG
@@ -157,3 +170,35 @@ class ComputeDAG(Object):
 
         str_key = str_key.encode(encoding='utf-8')
         return hashlib.md5(str_key).hexdigest()
+
+
+def set_replay_cache_capacity(capacity):
+    """Set the maximum number of schedule snapshots kept by each ComputeDAG.
+
+    ApplySteps and InferBound resume the replay of transform steps from the longest cached
+    prefix, so the states that differ only in their last steps are replayed cheaply.
+
+    Parameters
+    ----------
+    capacity: int
+        The maximum number of snapshots. 0 disables the replay cache.
+    """
+    _ffi_api.SetReplayCacheCapacity(capacity)
+
+
+def get_replay_cache_stats():
+    """Get the counters of the replay cache.
+
+    Returns
+    -------
+    stats: Dict[str, int]
+        The number of replays resumed from a cached prefix ("hits") or started from scratch
+        ("misses"), and the number of steps restored from the cache ("reused_steps") or
+        applied to a schedule ("replayed_steps").
+    """
+    return {k: v.value for k, v in _ffi_api.GetReplayCacheStats().items()}
+
+
+def reset_replay_cache_stats():
+    """Reset the counters of the replay cache."""
+    _ffi_api.ResetReplayCacheStats()
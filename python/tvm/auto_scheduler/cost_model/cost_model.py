@@ -22,6 +22,7 @@ import numpy as np
 import tvm._ffi
 from tvm.runtime import Object
 from .. import _ffi_api
+from ..measure_record import RecordReader
 
 
 @tvm._ffi.register_object("auto_scheduler.CostModel")
@@ -64,6 +65,96 @@ class RandomModel(CostModel):
         return [x.value for x in _ffi_api.CostModelPredict(self, search_task, states)]
 
 
+@tvm._ffi.register_object("auto_scheduler.GBDTModel")
+class GBDTModel(CostModel):
+    """A native gradient boosted tree model that predicts the normalized throughputs of programs.
+
+    It fits the same pack-sum objective as :any:`XGBModel` on the per-store features,
+    but trains and predicts in C++ without going through python for every prediction.
+    Later updates continue boosting from the current trees instead of retraining.
+
+    Parameters
+    ----------
+    num_warmup_sample : int
+        Predict random scores until the model is trained on more samples than this.
+    seed : Optional[int]
+        The random seed.
+    **params
+        Overrides of the training parameters: max_depth, num_rounds, incremental_rounds,
+        max_num_trees, early_stopping_rounds, max_bins, learning_rate, reg_lambda,
+        min_child_weight and min_split_gain.
+    """
+    def __init__(self, num_warmup_sample=100, seed=None, **params):
+        params["num_warmup_sample"] = num_warmup_sample
+        self.__init_handle_by_constructor__(_ffi_api.GBDTModel, params, seed or 43)
+
+    def update(self, inputs, results):
+        """Update the cost model according to new measurement results (training data).
+
+        Parameters
+        ----------
+        inputs : List[MeasureInput]
+            The measurement inputs
+        results : List[MeasureResult]
+            The measurement results
+        """
+        _ffi_api.CostModelUpdate(self, inputs, results)
+
+    def predict(self, search_task, states):
+        """Predict the scores of states
+
+        Parameters
+        ----------
+        search_task : SearchTask
+            The search task of states
+        statse : List[State]
+            The input states
+
+        Returns
+        -------
+        scores: List[float]
+            The predicted scores for all states
+        """
+        return [x.value for x in _ffi_api.CostModelPredict(self, search_task, states)]
+
+    def update_from_file(self, file_name, n_lines=None):
+        """Load measure records from a log file to update the cost model.
+
+        Parameters
+        ----------
+        file_name: str
+            The filename
+        n_lines: Optional[int]
+            Only load first n lines of the log file
+        """
+        inputs, results = RecordReader(file_name).read_lines(n_lines)
+        self.update(inputs, results)
+
+    def num_trees(self):
+        """The number of trees in the ensemble."""
+        return _ffi_api.GBDTModelNumTrees(self)
+
+    def save(self, file_name):
+        """Save the model to a file
+
+        Parameters
+        ----------
+        file_name: str
+            The filename
+        """
+        _ffi_api.GBDTModelSave(self, file_name)
+
+    def load(self, file_name):
+        """Load the model from a file
+
+        Parameters
+        ----------
+        file_name: str
+            The filename
+        """
+        _ffi_api.GBDTModelLoad(self, file_name)
+
+
 @tvm._ffi.register_func("auto_scheduler.cost_model.random_fill_float")
 def random_fill_float(size, return_ptr):
     """Fills a c++ float array with random numbers in [0, 1]
@@ -26,7 +26,7 @@ the predicted score of each BufferStoreNode as the score of a TIR Stmt.
 The feature specification is defined by `src/auto_scheduler/feature.cc::FeatureSet`
 """
 
-from typing import List, Tuple, Union, Optional
+from typing import Dict, List, Tuple, Union, Optional
 import struct
 
 import numpy as np
@@ -248,3 +248,38 @@ def get_per_store_feature_names(max_n_bufs: Optional[int] = None) -> List[str]:
         The names of elements in the flatten feature vector
     """
     return _ffi_api.GetPerStoreFeatureNames(max_n_bufs or DEFAULT_MAX_N_BUFS)
+
+
+def set_feature_cache_capacity(capacity: int):
+    """Set the maximum number of states kept in the feature cache.
+
+    The per-store features of a state are cached by the fingerprint of its transform steps,
+    so the states that are predicted again during the search are not lowered again.
+    Setting the capacity also clears the cache.
+
+    Parameters
+    ----------
+    capacity: int
+        The maximum number of cached states. 0 disables the cache.
+    """
+    _ffi_api.SetFeatureCacheCapacity(capacity)
+
+
+def get_feature_extraction_stats() -> Dict[str, float]:
+    """Get the counters of the per-store feature extraction.
+
+    Returns
+    -------
+    stats: Dict[str, float]
+        The number of cache hits, cache misses and lowering errors, the accumulated time of
+        lowering and extraction in seconds ("extraction_time") and its average over the
+        missed states ("time_per_state").
+    """
+    stats = {k: v.value for k, v in _ffi_api.GetFeatureExtractionStats().items()}
+    stats["time_per_state"] = stats["extraction_time"] / max(stats["cache_misses"], 1)
+    return stats
+
+
+def reset_feature_extraction_stats():
+    """Reset the counters of the per-store feature extraction."""
+    _ffi_api.ResetFeatureExtractionStats()
@@ -637,6 +637,19 @@ class State:
         raise ValueError("Invalid item: " + key +
                          " . Expect to be a Operation or Tensor")
 
+    def fingerprint(self):
+        """ Get the 64-bit fingerprint of the transform step history.
+
+        It is much cheaper than the string format and is used by the search policies to
+        detect redundant states.
+
+        Returns
+        -------
+        fingerprint : int
+            The fingerprint as a signed 64-bit integer.
+        """
+        return _ffi_api.StateFingerprint(self.state_object)
+
     def __str__(self):
         return str(self.state_object)
 
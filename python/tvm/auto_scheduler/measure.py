@@ -36,6 +36,7 @@ import time
 import shutil
 import traceback
 import tempfile
+import threading
 import multiprocessing
 
 import tvm._ffi
@@ -59,6 +60,9 @@ MAX_ERROR_MSG_LEN = 512
 # This can avoid expensive serialization of TVM IR when using multiprocessing.Pool
 GLOBAL_BUILD_ARGUMENTS = None
 GLOBAL_RUN_ARGUMENTS = None
+# The pipelined ProgramMeasurer builds and runs in different threads. The lock keeps another
+# thread from replacing the arguments before the pool of a call has been forked.
+GLOBAL_ARGUMENTS_LOCK = threading.Lock()
 
 @tvm._ffi.register_object("auto_scheduler.MeasureCallback")
 class MeasureCallback(Object):
@@ -231,6 +235,13 @@ class LocalRunner(ProgramRunner):
         its actual latency during end-to-end inference.
         To make this option effective, the argument `number` should also be set to 1.
         This is only has effect on CPU task.
+    max_rel_ci : float = 0.0
+        If positive, `repeat` becomes the minimum number of repeats, and the measurement is
+        repeated until the 95% confidence interval of the median cost is within `max_rel_ci`
+        of the median (e.g. 0.02 for +-2%), or `max_repeat` is reached. The warm-up runs and
+        the outlier repeats are discarded, so `costs` of a MeasureResult holds the kept repeats.
+    max_repeat : int = 100
+        The maximum number of repeats when `max_rel_ci` is set.
     """
 
     def __init__(self,
@@ -239,10 +250,12 @@ class LocalRunner(ProgramRunner):
                  repeat=1,
                  min_repeat_ms=0,
                  cooldown_interval=0.0,
-                 enable_cpu_cache_flush=False):
+                 enable_cpu_cache_flush=False,
+                 max_rel_ci=0.0,
+                 max_repeat=100):
         self.__init_handle_by_constructor__(
             _ffi_api.LocalRunner, timeout, number, repeat, min_repeat_ms, cooldown_interval,
-            enable_cpu_cache_flush)
+            enable_cpu_cache_flush, max_rel_ci, max_repeat)
 
 
 @tvm._ffi.register_object("auto_scheduler.RPCRunner")
@@ -290,14 +303,23 @@ class RPCRunner(ProgramRunner):
         its actual latency during end-to-end inference.
         To make this option effective, the argument `number` should also be set to 1.
         This is only has effect on CPU task.
+    max_rel_ci : float = 0.0
+        If positive, `repeat` becomes the minimum number of repeats, and the measurement is
+        repeated until the 95% confidence interval of the median cost is within `max_rel_ci`
+        of the median (e.g. 0.02 for +-2%), or `max_repeat` is reached. The warm-up runs and
+        the outlier repeats are discarded, so `costs` of a MeasureResult holds the kept repeats.
+    max_repeat : int = 100
+        The maximum number of repeats when `max_rel_ci` is set.
     """
 
     def __init__(self, key, host, port,
                  priority=1, n_parallel=1, timeout=10, number=3, repeat=1,
-                 min_repeat_ms=0, cooldown_interval=0.0, enable_cpu_cache_flush=False):
+                 min_repeat_ms=0, cooldown_interval=0.0, enable_cpu_cache_flush=False,
+                 max_rel_ci=0.0, max_repeat=100):
         self.__init_handle_by_constructor__(
             _ffi_api.RPCRunner, key, host, port, priority, n_parallel, timeout,
-            number, repeat, min_repeat_ms, cooldown_interval, enable_cpu_cache_flush)
+            number, repeat, min_repeat_ms, cooldown_interval, enable_cpu_cache_flush,
+            max_rel_ci, max_repeat)
 
         if check_remote(key, host, port, priority, timeout):
             print("Get devices for measurement successfully!")
@@ -345,10 +367,18 @@ class LocalRPCMeasureContext:
         its actual latency during end-to-end inference.
         To make this option effective, the argument `number` should also be set to 1.
         This is only has effect on CPU task.
+    max_rel_ci : float = 0.0
+        If positive, `repeat` becomes the minimum number of repeats, and the measurement is
+        repeated until the 95% confidence interval of the median cost is within `max_rel_ci`
+        of the median (e.g. 0.02 for +-2%), or `max_repeat` is reached. The warm-up runs and
+        the outlier repeats are discarded, so `costs` of a MeasureResult holds the kept repeats.
+    max_repeat : int = 100
+        The maximum number of repeats when `max_rel_ci` is set.
     """
 
     def __init__(self, priority=1, n_parallel=1, timeout=10, number=3, repeat=1,
-                 min_repeat_ms=0, cooldown_interval=0.0, enable_cpu_cache_flush=False):
+                 min_repeat_ms=0, cooldown_interval=0.0, enable_cpu_cache_flush=False,
+                 max_rel_ci=0.0, max_repeat=100):
         ctx = tvm.context("cuda", 0)
         if ctx.exist:
             cuda_arch = "sm_" + "".join(ctx.compute_version.split('.'))
@@ -361,7 +391,8 @@ class LocalRPCMeasureContext:
                              tracker_addr=(self.tracker.host, self.tracker.port))
         self.runner = RPCRunner(device_key, host, self.tracker.port, priority,
                                 n_parallel, timeout, number, repeat,
-                                min_repeat_ms, cooldown_interval, enable_cpu_cache_flush)
+                                min_repeat_ms, cooldown_interval, enable_cpu_cache_flush,
+                                max_rel_ci, max_repeat)
         # Wait for the processes to start
         time.sleep(0.5)
 
@@ -503,9 +534,9 @@ def local_builder_build(inputs, timeout, n_parallel, build_func='default', verbo
     # This can avoid expensive serialization of TVM IR when using multiprocessing.Pool
     global GLOBAL_BUILD_ARGUMENTS
 
-    GLOBAL_BUILD_ARGUMENTS = (inputs, build_func, timeout, verbose)
-
-    pool = NoDaemonPool(n_parallel)
+    with GLOBAL_ARGUMENTS_LOCK:
+        GLOBAL_BUILD_ARGUMENTS = (inputs, build_func, timeout, verbose)
+        pool = NoDaemonPool(n_parallel)
     tuple_res = pool.map(local_build_worker, range(len(inputs)))
     pool.terminate()
     pool.join()
@@ -521,7 +552,7 @@ def local_builder_build(inputs, timeout, n_parallel, build_func='default', verbo
 @tvm._ffi.register_func("auto_scheduler.local_runner.run")
 def local_run(inputs, build_results,
               timeout=10, number=3, repeat=1, min_repeat_ms=0, cooldown_interval=0,
-              enable_cpu_cache_flush=False, verbose=1):
+              enable_cpu_cache_flush=False, max_rel_ci=0.0, max_repeat=100, verbose=1):
     """
     Run function of LocalRunner to test the performance of the input BuildResults.
 
@@ -558,6 +589,11 @@ def local_run(inputs, build_results,
         its actual latency during end-to-end inference.
         To make this option effective, the argument `number` should also be set to 1.
         This is only has effect on CPU task.
+    max_rel_ci : float = 0.0
+        If positive, repeat the measurement until the 95% confidence interval of the median
+        cost is within `max_rel_ci` of the median, with `repeat` as the minimum number of repeats.
+    max_repeat : int = 100
+        The maximum number of repeats when `max_rel_ci` is set.
     verbose: int = 1
         Verbosity level. 0 for silent, 1 to output information during program measuring.
 
@@ -583,7 +619,7 @@ def local_run(inputs, build_results,
             f_prepare = 'cache_flush_cpu_non_first_arg' if enable_cpu_cache_flush else ''
             time_f = func.time_evaluator(
                 func.entry_name, ctx, number=number, repeat=repeat, min_repeat_ms=min_repeat_ms,
-                f_preproc=f_prepare)
+                f_preproc=f_prepare, max_rel_ci=max_rel_ci, max_repeat=max_repeat)
         # pylint: disable=broad-except
         except Exception:
             costs = (max_float,)
@@ -655,8 +691,8 @@ def rpc_run_worker(index):
     """
     global GLOBAL_RUN_ARGUMENTS
     inputs, build_results, key, host, port, priority, timeout, number, \
-        repeat, min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, \
-        verbose = GLOBAL_RUN_ARGUMENTS
+        repeat, min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, max_rel_ci, \
+        max_repeat, verbose = GLOBAL_RUN_ARGUMENTS
 
     max_float = 1e10  # We use 1e10 instead of sys.float_info.max for better readability in log
     inp = inputs[index]
@@ -684,7 +720,7 @@ def rpc_run_worker(index):
             f_prepare = 'cache_flush_cpu_non_first_arg' if enable_cpu_cache_flush else ''
             time_f = func.time_evaluator(
                 func.entry_name, ctx, number=number, repeat=repeat, min_repeat_ms=min_repeat_ms,
-                f_preproc=f_prepare)
+                f_preproc=f_prepare, max_rel_ci=max_rel_ci, max_repeat=max_repeat)
         # pylint: disable=broad-except
         except Exception:
             costs = (max_float,)
@@ -740,7 +776,8 @@ def rpc_run_worker(index):
 @tvm._ffi.register_func("auto_scheduler.rpc_runner.run")
 def rpc_runner_run(inputs, build_results, key, host, port,
                    priority=1, n_parallel=1, timeout=10, number=3, repeat=1, min_repeat_ms=0,
-                   cooldown_interval=0.0, enable_cpu_cache_flush=False, verbose=1):
+                   cooldown_interval=0.0, enable_cpu_cache_flush=False, max_rel_ci=0.0,
+                   max_repeat=100, verbose=1):
     """ Run function of RPCRunner to test the performance of the input BuildResults.
 
     Parameters
@@ -786,6 +823,11 @@ def rpc_runner_run(inputs, build_results, key, host, port,
         its actual latency during end-to-end inference.
         To make this option effective, the argument `number` should also be set to 1.
         This is only has effect on CPU task.
+    max_rel_ci : float = 0.0
+        If positive, repeat the measurement until the 95% confidence interval of the median
+        cost is within `max_rel_ci` of the median, with `repeat` as the minimum number of repeats.
+    max_repeat : int = 100
+        The maximum number of repeats when `max_rel_ci` is set.
     verbose: int = 1
         Verbosity level. 0 for silent, 1 to output information during program measuring.
 
@@ -795,13 +837,14 @@ def rpc_runner_run(inputs, build_results, key, host, port,
         The measure results of these MeasureInputs.
     """
     global GLOBAL_RUN_ARGUMENTS
-    GLOBAL_RUN_ARGUMENTS = (inputs, build_results, key, host, port, priority, timeout, number,
-                            repeat, min_repeat_ms, cooldown_interval, enable_cpu_cache_flush,
-                            verbose)
-
     assert len(inputs) == len(build_results), \
         "Measure input size should be equal to build results"
-    pool = NoDaemonPool(n_parallel)
+
+    with GLOBAL_ARGUMENTS_LOCK:
+        GLOBAL_RUN_ARGUMENTS = (inputs, build_results, key, host, port, priority, timeout,
+                                number, repeat, min_repeat_ms, cooldown_interval,
+                                enable_cpu_cache_flush, max_rel_ci, max_repeat, verbose)
+        pool = NoDaemonPool(n_parallel)
     tuple_res = pool.map(rpc_run_worker, range(len(build_results)))
     pool.terminate()
     pool.join()
@@ -815,3 +858,24 @@ def rpc_runner_run(inputs, build_results, key, host, port,
         print("")
 
     return results
+
+
+def get_measure_pipeline_stats():
+    """ Get the utilisation counters of the build and run stages of all ProgramMeasurers.
+
+    Returns
+    -------
+    stats: Dict[str, float]
+        The number of measured batches, the wall time of measurement, the busy and stall times
+        of the builder and the runners in seconds, and the utilisation of the builder
+        ("build_utilisation") and of the runners ("run_utilisation") in [0, 1].
+    """
+    stats = {k: v.value for k, v in _ffi_api.GetMeasurePipelineStats().items()}
+    stats["build_utilisation"] = stats["build_time"] / max(stats["wall_time"], 1e-9)
+    stats["run_utilisation"] = stats["run_time"] / max(stats["runner_wall_time"], 1e-9)
+    return stats
+
+
+def reset_measure_pipeline_stats():
+    """ Reset the utilisation counters of all ProgramMeasurers. """
+    _ffi_api.ResetMeasurePipelineStats()
@@ -15,13 +15,16 @@
 # specific language governing permissions and limitations
 # under the License.
 
-""" Serialization and other I/O support for measurement records (tuning logs). """
+""" Serialization and other I/O support for measurement records (tuning logs).
 
-import numpy as np
+Logs are either json files with one record per line, or binary files with an index of the
+records. A new log file is written in the binary format if its name ends with ".bin".
+Use `convert_records` to convert an existing log between the two formats.
+"""
 
 import tvm._ffi
 from tvm.runtime import Object
-from .measure import MeasureCallback, MeasureErrorNo
+from .measure import MeasureCallback
 from . import _ffi_api
 
 
@@ -34,6 +37,7 @@ class RecordToFile(MeasureCallback):
     ----------
     filename : str
         File name for this callback to write log to.
+        A new file is written in the binary format if the name ends with ".bin".
     """
     def __init__(self, filename="auto_scheduler_tuning.json"):
         self.__init_handle_by_constructor__(_ffi_api.RecordToFile, filename)
@@ -42,7 +46,7 @@ class RecordToFile(MeasureCallback):
 @tvm._ffi.register_object("auto_scheduler.RecordReader")
 class RecordReader(Object):
     """
-    Reader of the json log file.
+    Reader of the json or binary log file.
 
     Parameters
     ----------
@@ -73,6 +77,80 @@ class RecordReader(Object):
                                                          skip_lines)
         return inputs, results
 
+    def is_binary(self):
+        """ Whether the log file is in the binary format. """
+        return bool(_ffi_api.RecordReaderIsBinary(self))
+
+    def num_records(self):
+        """ Get the number of records in the log file.
+
+        This and the other random access functions build an index of the file on first use.
+        Only the record headers are read for a binary file, while every line of a json file
+        has to be parsed.
+
+        Returns
+        -------
+        num : int
+            The number of records.
+        """
+        return int(_ffi_api.RecordReaderNumRecords(self))
+
+    def read_record(self, index):
+        """ Read a record by its position in the file.
+
+        Parameters
+        ----------
+        index : int
+            The index of the record.
+
+        Returns
+        -------
+        input : MeasureInput
+            The MeasureInput of the record.
+        result : MeasureResult
+            The MeasureResult of the record.
+        """
+        ret = _ffi_api.RecordReaderReadRecord(self, index)
+        return ret[0], ret[1]
+
+    def find_records(self, workload_key):
+        """ Find the records of a workload.
+
+        Parameters
+        ----------
+        workload_key : str
+            The workload key of the compute declaration.
+
+        Returns
+        -------
+        indices : List[int]
+            The indices of the records in the file order.
+        """
+        return [x.value for x in _ffi_api.RecordReaderFindRecords(self, workload_key)]
+
+    def read_best(self, workload_key=None, target=None):
+        """ Read the valid record with the lowest mean cost.
+
+        Parameters
+        ----------
+        workload_key : Optional[str]
+            The workload key of the compute declaration. With `None`, all workloads are searched.
+        target : Optional[tvm.target.Target]
+            The target device. With `None`, all target devices are searched.
+
+        Returns
+        -------
+        input : Optional[MeasureInput]
+            The MeasureInput of the best record, None if no record is found.
+        result : Optional[MeasureResult]
+            The MeasureResult of the best record, None if no record is found.
+        """
+        ret = _ffi_api.RecordReaderReadBest(self, workload_key or "",
+                                            target.kind.name if target else "")
+        if not ret:
+            return None, None
+        return ret[0], ret[1]
+
     def __iter__(self):
         while True:
             ret = _ffi_api.RecordReaderReadNext(self)
@@ -104,7 +182,8 @@ def save_records(filename, inputs, results):
     Parameters
     ----------
     filename : str
-        File name to write log to.
+        File name to write log to. The format of an existing file is kept,
+        a new file is written in the binary format if the name ends with ".bin".
     inputs: List[MeasureInputs]
         The MeasureInputs to be written.
     results: List[MeasureResults]
@@ -112,6 +191,27 @@ def save_records(filename, inputs, results):
     """
     _ffi_api.SaveRecords(filename, inputs, results)
 
+
+def convert_records(src, dst, binary=True):
+    """
+    Convert a log file between the json and the binary format.
+
+    Parameters
+    ----------
+    src : str
+        File name of the input log, in either format.
+    dst : str
+        File name of the output log, which is overwritten.
+    binary : bool = True
+        Whether to write the binary format.
+
+    Returns
+    -------
+    num : int
+        The number of converted records.
+    """
+    return int(_ffi_api.ConvertRecords(src, dst, binary))
+
 def load_best(filename, workload_key=None, target=None):
     """ Return the best measurement pair form a log file. This may return none results if
     there is no legal measure pair with the specified workload_key/target found from the log file.
@@ -134,24 +234,4 @@ def load_best(filename, workload_key=None, target=None):
     result : MeasureResult
         The best State's MeasureResult from this log fine.
     """
-    log_reader = RecordReader(filename)
-    best_cost = 1e30
-    best_inp = None
-    best_res = None
-
-    for inp, res in log_reader:
-        if res.error_no != MeasureErrorNo.NO_ERROR:
-            continue
-        if workload_key and inp.task.workload_key != workload_key:
-            continue
-        if target and inp.task.target.kind.name != target.kind.name:
-            continue
-
-        costs = [v.value for v in res.costs]
-        cost = np.mean(costs)
-        if cost < best_cost:
-            best_cost = cost
-            best_inp = inp
-            best_res = res
-
-    return best_inp, best_res
+    return RecordReader(filename).read_best(workload_key, target)
@@ -58,6 +58,28 @@ class PreloadMeasuredStates(SearchCallback):
         self.__init_handle_by_constructor__(_ffi_api.PreloadMeasuredStates, filename)
 
 
+@tvm._ffi.register_object("auto_scheduler.PreloadSimilarStates")
+class PreloadSimilarStates(SearchCallback):
+    """ A SearchCallback to warm start the search with the records of similar workloads.
+
+    The workloads in the log file whose ComputeDAG has the same structure as the one of the
+    search task, i.e. the same operators on different shapes, are considered similar.
+    Their best states are replayed on the current ComputeDAG to seed the initial population,
+    and all their valid records are used to pre-train the cost model.
+    The workloads must be registered by `register_workload` in the current process.
+
+    Parameters
+    ----------
+    filename : str
+        The name of the record file.
+    max_states_per_workload : int = 64
+        The maximum number of states transferred from each similar workload.
+    """
+    def __init__(self, filename="auto_scheduler_tuning.json", max_states_per_workload=64):
+        self.__init_handle_by_constructor__(_ffi_api.PreloadSimilarStates, filename,
+                                            max_states_per_workload)
+
+
 @tvm._ffi.register_object("auto_scheduler.SearchPolicy")
 class SearchPolicy(Object):
     """ The base class of search policies. """
@@ -104,6 +126,7 @@ class SketchPolicy(SearchPolicy):
         initializations.
         Possible callbacks:
             - auto_scheduler.PreloadMeasuredStates
+            - auto_scheduler.PreloadSimilarStates
             - auto_scheduler.PreloadCustomSketchRule
             TODO(jcf94): Add these search callback implementations.
     """
@@ -116,6 +139,10 @@ class SketchPolicy(SearchPolicy):
         'evolutionary_search_num_iters': 10,
         'evolutionary_search_mutation_prob': 0.85,
         "evolutionary_search_use_measured_ratio": 0.2,
+        # Adapt the selection probabilities of the mutation rules to their recent success
+        'evolutionary_search_adaptive_mutation': 1,
+        'evolutionary_search_mutation_reward_decay': 0.8,
+        'evolutionary_search_mutation_min_weight': 0.05,
 
         'cpu_multi_level_tiling_structure': 'SSRSRS',
         'gpu_multi_level_tiling_structure': 'SSSRRSRS',
@@ -181,6 +208,17 @@ class SketchPolicy(SearchPolicy):
         states = _ffi_api.SketchPolicySampleInitialPopulation(self, pop_size)
         return states
 
+    def transferred_states(self):
+        """Get the states transferred from similar workloads by `PreloadSimilarStates`.
+        This python interface is mainly used for debugging and testing.
+
+        Returns
+        -------
+        states: List[State]
+            The transferred states
+        """
+        return _ffi_api.SearchPolicyGetTransferredStates(self)
+
     def evolutionary_search(self, init_populuations, out_size):
         """Evolutionary search.
         This python interface is mainly used for debugging and testing.
@@ -198,3 +236,16 @@ class SketchPolicy(SearchPolicy):
         """
         states = _ffi_api.SketchPolicyEvolutionarySearch(self, init_populuations, out_size)
         return states
+
+    def mutation_rule_stats(self):
+        """Get the online statistics of the mutation rules in the evolutionary search.
+
+        Returns
+        -------
+        stats: Dict[str, Dict[str, float]]
+            For each mutation rule, the number of tries, the number of mutated states scored
+            higher than their parents, the decayed reward, and the current selection probability.
+        """
+        stats = _ffi_api.SketchPolicyGetMutationRuleStats(self)
+        return {str(name): {str(k): v.value for k, v in rule_stats.items()}
+                for name, rule_stats in stats.items()}
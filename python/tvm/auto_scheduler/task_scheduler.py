@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+The task scheduler that allocates the tuning budget of a network across its tasks.
+
+A network is partitioned into several tasks. Instead of tuning them one by one with the same
+number of trials, the task scheduler tunes them in an interleaved way and spends more trials on
+the tasks that are expected to reduce the end-to-end latency the most.
+
+Reference:
+L. Zheng, C. Jia, M. Sun, Z. Wu, C. Yu, et al. "Ansor : Generating High-Performance Tensor
+Programs for Deep Learning." arXiv preprint arXiv:2006.06762 (2020).
+"""
+
+import tvm._ffi
+from tvm.runtime import Object
+from .cost_model import GBDTModel
+from .search_policy import SketchPolicy
+from . import _ffi_api
+
+
+@tvm._ffi.register_object("auto_scheduler.TaskScheduler")
+class TaskScheduler(Object):
+    """ The task scheduler that allocates the tuning trials across the tasks of a network.
+
+    Parameters
+    ----------
+    tasks : List[SearchTask]
+        All tasks of the network.
+    task_weights : Optional[List[float]]
+        The weight of each task in the objective, usually the number of times the task appears
+        in the network. All weights are 1 by default.
+    search_policies : Optional[List[SearchPolicy]]
+        The search policy of each task. By default every task gets a SketchPolicy, and all of
+        them share one GBDTModel so that the cost model learns from the whole network.
+    strategy : str = "gradient"
+        The allocation strategy.
+        "gradient" picks the task with the most expected reduction of the weighted latency,
+        "round-robin" tunes the tasks in turn.
+    alpha : float = 0.2
+        The weight of the backward gradient (the recent improvement of a task) against the
+        forward gradient (the expected improvement of its next round).
+    beta : float = 2
+        The weight of the throughput of structurally similar tasks in the forward gradient.
+    backward_window_size : int = 3
+        The number of rounds to look back when computing the backward gradient.
+    verbose : int = 1
+        Verbosity level. 0 for silent, 1 to output the progress of all tasks.
+    """
+    def __init__(self, tasks, task_weights=None, search_policies=None, strategy="gradient",
+                 alpha=0.2, beta=2, backward_window_size=3, verbose=1):
+        if search_policies is None:
+            cost_model = GBDTModel()
+            search_policies = [SketchPolicy(task, cost_model, verbose=verbose) for task in tasks]
+        task_weights = [float(w) for w in task_weights] if task_weights else []
+        self.__init_handle_by_constructor__(
+            _ffi_api.TaskScheduler, tasks, search_policies, task_weights, strategy, alpha, beta,
+            backward_window_size, verbose)
+
+    def tune(self, tuning_options):
+        """ Tune all tasks.
+
+        Parameters
+        ----------
+        tuning_options : TuningOptions
+            Tuning and measurement options. `num_measure_trials` is the budget of the whole
+            network, and `early_stopping` applies to each task separately.
+        """
+        _ffi_api.TaskSchedulerTune(self, tuning_options)
+
+    def best_costs(self):
+        """ Get the best latency of each task.
+
+        Returns
+        -------
+        costs : List[float]
+            The best latency of each task in seconds, 1e10 for a task without a valid program.
+        """
+        return [c.value for c in _ffi_api.TaskSchedulerGetBestCosts(self)]
+
+    def task_trials(self):
+        """ Get the number of measured programs of each task.
+
+        Returns
+        -------
+        trials : List[int]
+            The number of measured programs of each task.
+        """
+        return [int(t) for t in _ffi_api.TaskSchedulerGetTaskTrials(self)]
@@ -135,7 +135,11 @@ class GraphModule(object):
         self._get_num_outputs = module["get_num_outputs"]
         self._get_num_inputs = module["get_num_inputs"]
         self._load_params = module["load_params"]
+        self._load_params_from_file = module["load_params_from_file"]
         self._share_params = module["share_params"]
+        self._create_session = module["create_session"]
+        self._run_in_session = module["run_in_session"]
+        self._set_inter_op_parallelism = module["set_inter_op_parallelism"]
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
@@ -181,6 +185,64 @@ class GraphModule(object):
             self.set_input(**input_dict)
         self._run()
 
+    def set_inter_op_parallelism(self, num_streams, threads_per_op=0):
+        """Run independent operators of the graph at the same time.
+
+        Parameters
+        ----------
+        num_streams : int
+            The number of operators that can run at the same time,
+            1 runs the operators one by one in graph order.
+
+        threads_per_op : int, optional
+            The number of threads used by each operator, the default
+            splits the available cores evenly between the streams.
+        """
+        self._set_inter_op_parallelism(num_streams, threads_per_op)
+
+    def create_session(self, shared_inputs=None):
+        """Create an execution session of this module.
+
+        The session shares the graph, the compiled functions and the parameters
+        with this module, and only allocates the storage of the activations.
+        Different sessions can run concurrently on different threads.
+
+        Parameters
+        ----------
+        shared_inputs : list of str, optional
+            Names of additional inputs to share with the session, e.g. weights
+            set by set_input instead of load_params.
+
+        Returns
+        -------
+        session : GraphModule
+            The session, which can be used as a normal graph module.
+        """
+        return GraphModule(self._create_session(*(shared_inputs or [])))
+
+    def run_in_session(self, **input_dict):
+        """Run the graph on an idle session of this module.
+
+        This function is thread-safe, a new session is created when all
+        existing ones are busy.
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values to be feed to
+
+        Returns
+        -------
+        outputs : list of NDArray
+            The outputs of the graph.
+        """
+        args = []
+        for key, value in input_dict.items():
+            if not isinstance(value, tvm.nd.NDArray):
+                value = tvm.nd.array(value, self._get_input(key).ctx)
+            args += [key, value]
+        return list(self._run_in_session(*args))
+
     def get_num_outputs(self):
         """Get the number of outputs from the graph
 
@@ -259,6 +321,21 @@ class GraphModule(object):
         """
         self._load_params(bytearray(params_bytes))
 
+    def load_params_from_file(self, path):
+        """Load parameters from a file holding a serialized parameter dict.
+
+        The file is memory mapped. Parameters saved with
+        ``relay.save_param_dict(params, aligned=True)`` that live on CPU use the
+        mapping in place, so they are read lazily and shared between processes.
+        Other parameters are copied to their device.
+
+        Parameters
+        ----------
+        path : str
+            The path of the parameter file.
+        """
+        self._load_params_from_file(path)
+
     def share_params(self, other, params_bytes):
         """Share parameters from pre-existing GraphRuntime instance.
 
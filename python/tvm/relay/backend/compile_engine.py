@@ -18,6 +18,7 @@
 """Backend code generation engine."""
 from __future__ import absolute_import
 
+import hashlib
 import logging
 import numpy as np
 import tvm
@@ -295,6 +296,64 @@ def lower_call(call, inputs, target):
     return LoweredOutput(outputs, best_impl)
 
 
+def _dispatch_context_fingerprint(ctx):
+    """Summarize the tuning configs an AutoTVM dispatch context can hand out.
+
+    Returns None when the context cannot be summarized, e.g. ApplyConfig during tuning.
+    """
+    if isinstance(ctx, autotvm.task.FallbackContext):
+        items = [str((key, cfg)) for key, cfg in ctx.memory.items()
+                 if not isinstance(cfg, autotvm.task.space.FallbackConfigEntity)]
+        return "fallback:" + hashlib.sha1("\n".join(sorted(items)).encode()).hexdigest()
+    if not isinstance(ctx, autotvm.task.ApplyHistoryBest):
+        return None
+    # pylint: disable=protected-access
+    tables = (ctx.best_by_targetkey, ctx.best_by_model, ctx._best_user_defined)
+    # Records are replaced rather than mutated, so the identities tell whether it changed.
+    state = tuple(tuple(id(v) for v in table.values()) for table in tables)
+    cached = getattr(ctx, "_compile_cache_fingerprint", None)
+    if cached is None or cached[0] != state:
+        items = [str((key, inp.config)) for key, (inp, _) in ctx.best_by_targetkey.items()]
+        items += [str((key, inp.config)) for key, (inp, _) in ctx.best_by_model.items()]
+        items += [str((key, cfg)) for key, cfg in ctx._best_user_defined.items()]
+        digest = hashlib.sha1("\n".join(sorted(items)).encode()).hexdigest()
+        cached = ctx._compile_cache_fingerprint = (state, digest)
+    parent = _dispatch_context_fingerprint(ctx._old_ctx)
+    if parent is None:
+        return None
+    return cached[1] + "/" + parent
+
+
+@tvm._ffi.register_func("relay.backend.compile_cache_context")
+def compile_cache_context():
+    """Fingerprint of the frontend state that affects lowering, used in the keys of
+    the persistent compile cache. None disables the cache for the current function."""
+    env = autotvm.task.TaskExtractEnv.current
+    if env is not None and env.tracing:
+        # Task extraction relies on scheduling every function.
+        return None
+    return _dispatch_context_fingerprint(autotvm.task.DispatchContext.current)
+
+
+def persistent_cache_stats():
+    """Get the statistics of the persistent compile cache.
+
+    The cache is enabled through the "relay.backend.CompileCache" config of the
+    PassContext, e.g. ``{"dir": "/path/to/cache", "max_bytes": 1 << 30}``.
+
+    Returns
+    -------
+    stats : Dict[str, int]
+        The hits, misses, insertions, evictions, errors and bytes in the cache.
+    """
+    return {k: v.value for k, v in _backend._CompileCacheStats().items()}
+
+
+def reset_persistent_cache_stats():
+    """Reset the counters of the persistent compile cache."""
+    _backend._CompileCacheResetStats()
+
+
 @tvm._ffi.register_object("relay.CompileEngine")
 class CompileEngine(Object):
     """CompileEngine to get lowered code.
@@ -45,6 +45,8 @@ class GraphRuntimeCodegen(object):
         self._mod = _build_module._GraphRuntimeCodegen()
         self._init = self._mod["init"]
         self._codegen = self._mod["codegen"]
+        # the lowering threads of relay.backend.num_lower_threads call back into python
+        self._codegen.release_gil = True
         self._get_graph_json = self._mod["get_graph_json"]
         self._list_params_name = self._mod["list_params_name"]
         self._get_param_by_name = self._mod["get_param_by_name"]
@@ -21,9 +21,10 @@ import tvm._ffi
 
 
 _save_param_dict = tvm._ffi.get_global_func("tvm.relay._save_param_dict")
+_save_param_dict_aligned = tvm._ffi.get_global_func("tvm.relay._save_param_dict_aligned")
 _load_param_dict = tvm._ffi.get_global_func("tvm.relay._load_param_dict")
 
-def save_param_dict(params):
+def save_param_dict(params, aligned=False):
     """Save parameter dictionary to binary bytes.
 
     The result binary bytes can be loaded by the
@@ -34,6 +35,11 @@ def save_param_dict(params):
     params : dict of str to NDArray
         The parameter dictionary.
 
+    aligned : bool, optional
+        Whether to align the data of each parameter in the result. When the result is
+        written to a file, GraphModule.load_params_from_file can then memory map it and
+        use the CPU parameters in place. Older runtimes cannot read the aligned format.
+
     Returns
     -------
     param_bytes: bytearray
@@ -56,6 +62,8 @@ def save_param_dict(params):
     for k, v in params.items():
         args.append(k)
         args.append(tvm.nd.array(v))
+    if aligned:
+        return _save_param_dict_aligned(*args)
     return _save_param_dict(*args)
 
 
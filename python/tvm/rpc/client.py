@@ -162,6 +162,28 @@ class RPCSession(object):
         """
         return _ffi_api.LoadRemoteModule(self._sess, path)
 
+    def set_async_mode(self, enable=True, copy_chunk_bytes=1 << 20):
+        """Configure how requests are pipelined over the channel.
+
+        Copies larger than copy_chunk_bytes are split into chunks that are
+        all sent before the first reply is read. In async mode, copies to
+        the remote and frees of remote objects return without waiting for
+        the remote, their errors are raised by the next blocking request.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to enable the async mode.
+
+        copy_chunk_bytes : int
+            The chunk size of large copies, 0 disables chunking.
+        """
+        _ffi_api.SessionSetAsyncMode(self._sess, enable, copy_chunk_bytes)
+
+    def synchronize(self):
+        """Wait until the remote has handled all the requests in flight."""
+        _ffi_api.SessionSynchronize(self._sess)
+
     def cpu(self, dev_id=0):
         """Construct CPU device."""
         return self.context(1, dev_id)
@@ -163,7 +163,8 @@ class Module(object):
         """
         _ffi_api.ModuleSaveToFile(self, file_name, fmt)
 
-    def time_evaluator(self, func_name, ctx, number=10, repeat=1, min_repeat_ms=0, f_preproc=''):
+    def time_evaluator(self, func_name, ctx, number=10, repeat=1, min_repeat_ms=0, f_preproc='',
+                       max_rel_ci=0.0, max_repeat=100):
         """Get an evaluator that measures time cost of running function.
 
         Parameters
@@ -195,6 +196,15 @@ class Module(object):
         f_preproc: str, optional
             The preprocess function name we want to execute before executing the time evaluator.
 
+        max_rel_ci: float, optional
+            If positive, `repeat` becomes the minimum number of repeats, and more repeats are
+            taken until the 95% confidence interval of the median cost is within `max_rel_ci`
+            of the median (e.g. 0.02 for +-2%), or `max_repeat` is reached. The calibration runs
+            of `min_repeat_ms` are discarded as warm-up, and the outlier repeats are dropped.
+
+        max_repeat: int, optional
+            The maximum number of repeats when `max_rel_ci` is set.
+
         Note
         ----
         The function will be invoked  (1 + number x repeat) times,
@@ -204,20 +214,27 @@ class Module(object):
         -------
         ftimer : function
             The function that takes same argument as func and returns a ProfileResult.
-            The ProfileResult reports `repeat` time costs in seconds.
+            The ProfileResult reports `repeat` time costs in seconds, or the kept costs
+            if `max_rel_ci` is set.
         """
         try:
-            feval = _ffi_api.RPCTimeEvaluator(
-                self, func_name, ctx.device_type, ctx.device_id,
-                number, repeat, min_repeat_ms, f_preproc)
+            if max_rel_ci > 0:
+                feval = _ffi_api.RPCAdaptiveTimeEvaluator(
+                    self, func_name, ctx.device_type, ctx.device_id,
+                    number, repeat, max(repeat, max_repeat), min_repeat_ms, max_rel_ci, f_preproc)
+            else:
+                feval = _ffi_api.RPCTimeEvaluator(
+                    self, func_name, ctx.device_type, ctx.device_id,
+                    number, repeat, min_repeat_ms, f_preproc)
 
             def evaluator(*args):
                 """Internal wrapped evaluator."""
                 # Wrap feval so we can add more stats in future.
                 blob = feval(*args)
-                fmt = "@" + ("d" * repeat)
+                num_results = len(blob) // 8
+                fmt = "@" + ("d" * num_results)
                 results = struct.unpack(fmt, blob)
-                mean = sum(results) / float(repeat)
+                mean = sum(results) / float(num_results)
                 return ProfileResult(mean=mean, results=results)
 
             return evaluator
@@ -166,6 +166,32 @@ class Executable(object):
 
         return Executable(_ffi_api.Load_Executable(bytecode, lib))
 
+    @staticmethod
+    def load_exec_from_file(path, lib):
+        """Construct an executable from a file holding the saved bytecode.
+
+        The file is memory mapped and the constants alias the mapping instead of being
+        copied, so they are read lazily and their pages are shared between processes.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file written with the bytecode returned by :py:meth:`save`.
+
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable constructed using the provided artifacts.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError("lib is expected to be the type of tvm.runtime.Module" +
+                            ", but received {}".format(type(lib)))
+
+        return Executable(_ffi_api.Load_ExecutableFromFile(path, lib))
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -412,3 +438,38 @@ class VirtualMachine(object):
             The output.
         """
         return self.invoke("main", *args, **kwargs)
+
+    @staticmethod
+    def allocator_stats(ctx):
+        """Get the counters of the memory allocator of a context.
+
+        Parameters
+        ----------
+        ctx : tvm.runtime.TVMContext
+            The context whose allocator is queried.
+
+        Returns
+        -------
+        stats : Dict[str, int or float]
+            The hits, misses, allocated, pooled, trimmed, requested and served bytes,
+            and the internal fragmentation caused by size-class rounding.
+        """
+        names = [
+            "hits",
+            "misses",
+            "allocated_bytes",
+            "pooled_bytes",
+            "trimmed_bytes",
+            "requested_bytes",
+            "served_bytes",
+            "fragmentation",
+        ]
+        return {
+            name: _ffi_api.VMAllocatorStats(ctx.device_type, ctx.device_id, name) for name in names
+        }
+
+    @staticmethod
+    def trim_allocators():
+        """Return the memory cached by the allocators of the calling thread and the
+        shared pools to the devices."""
+        _ffi_api.VMAllocatorTrimAll()
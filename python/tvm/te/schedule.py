@@ -461,6 +461,23 @@ class Stage(Object):
           Hint parallel loop to execute in strided pattern.
           :code:`for (int i = task_id; i < end; i += num_task)`
 
+        - **parallel_schedule**
+
+          Specify how the iterations of the parallel loops in the
+          marked region are distributed over the threads, one of
+          "static", "dynamic" or "guided". "static" splits them
+          evenly ahead of time, "dynamic" lets every thread grab
+          the next chunk when it is done with the previous one, and
+          "guided" does the same with chunks that shrink as the loop
+          proceeds. The latter two suit loops with uneven iterations.
+
+        - **parallel_chunk_size**
+
+          The number of iterations of a chunk of the parallel loops
+          in the marked region, a positive constant. A static
+          schedule with a chunk size assigns the chunks round robin,
+          and a guided schedule uses it as the minimum chunk size.
+
         """
         if isinstance(pragma_value, string_types):
             pragma_value = convert(pragma_value)
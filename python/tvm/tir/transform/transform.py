@@ -208,6 +208,13 @@ def UnrollLoop():
 
     This pass also automatically attach pragma unroll tag to loops which meets the standard.
 
+    With the ``auto_cost_model`` option of the "tir.UnrollLoop" config, the loops are
+    unrolled as long as the estimated register pressure and instruction count of the
+    unrolled body fit the register file of the target (see ``target.GetRegisterInfo``),
+    and outer loops are partially unrolled and jammed into their inner loop when the
+    copies share loaded values. The ``record_decisions`` option marks every serial loop
+    with an ``unroll_decision`` attribute that describes what was done to it.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -36,7 +36,8 @@ TVM_REGISTER_NODE_TYPE(TuningOptionsNode);
 
 TuningOptions::TuningOptions(int num_measure_trials, int early_stopping, int num_measures_per_round,
                              int verbose, ProgramBuilder builder, ProgramRunner runner,
-                             Optional<Array<MeasureCallback>> measure_callbacks) {
+                             Optional<Array<MeasureCallback>> measure_callbacks,
+                             int pipeline_depth, Array<ProgramRunner> extra_runners) {
   auto node = make_object<TuningOptionsNode>();
   node->num_measure_trials = num_measure_trials;
   node->early_stopping = early_stopping;
@@ -45,15 +46,21 @@ TuningOptions::TuningOptions(int num_measure_trials, int early_stopping, int num
   node->builder = std::move(builder);
   node->runner = std::move(runner);
   node->measure_callbacks = std::move(measure_callbacks);
+  node->pipeline_depth = pipeline_depth;
+  node->extra_runners = std::move(extra_runners);
   data_ = std::move(node);
 }
 
+ProgramMeasurer TuningOptions::MakeMeasurer() const {
+  const TuningOptionsNode* node = operator->();
+  return ProgramMeasurer(node->builder, node->runner, node->measure_callbacks, node->verbose, -1,
+                         node->pipeline_depth, node->extra_runners);
+}
+
 std::pair<te::Schedule, Array<te::Tensor>> AutoSchedule(SearchPolicy search_policy,
                                                         TuningOptions tuning_options) {
   // Create a ProgramMeasurer to handle the schedule build and performance measure
-  ProgramMeasurer measurer =
-      ProgramMeasurer(tuning_options->builder, tuning_options->runner,
-                      tuning_options->measure_callbacks, tuning_options->verbose);
+  ProgramMeasurer measurer = tuning_options.MakeMeasurer();
   // Search for the best schedule
   State state =
       search_policy->Search(tuning_options->num_measure_trials, tuning_options->early_stopping,
@@ -73,9 +80,10 @@ std::pair<te::Schedule, Array<te::Tensor>> AutoSchedule(SearchPolicy search_poli
 TVM_REGISTER_GLOBAL("auto_scheduler.TuningOptions")
     .set_body_typed([](int num_measure_trials, int early_stopping, int num_measures_per_round,
                        int verbose, ProgramBuilder builder, ProgramRunner runner,
-                       Optional<Array<MeasureCallback>> measure_callbacks) {
+                       Optional<Array<MeasureCallback>> measure_callbacks, int pipeline_depth,
+                       Array<ProgramRunner> extra_runners) {
       return TuningOptions(num_measure_trials, early_stopping, num_measures_per_round, verbose,
-                           builder, runner, measure_callbacks);
+                           builder, runner, measure_callbacks, pipeline_depth, extra_runners);
     });
 
 TVM_REGISTER_GLOBAL("auto_scheduler.AutoSchedule")
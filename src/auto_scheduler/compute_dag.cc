@@ -35,7 +35,12 @@
 #include <tvm/tir/stmt_functor.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
 #include <queue>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -656,6 +661,133 @@ class FlopEstimator : public ExprFunctor<double(const PrimExpr& n)> {
   int cur_type_code_;
 };
 
+/********** Replay cache **********/
+
+/*! \brief The maximum number of snapshots kept by each ComputeDAG. */
+static std::atomic<int> replay_cache_capacity{256};
+static std::atomic<int64_t> replay_cache_hits{0};
+static std::atomic<int64_t> replay_cache_misses{0};
+static std::atomic<int64_t> replay_cache_reused_steps{0};
+static std::atomic<int64_t> replay_cache_replayed_steps{0};
+
+/*! \brief Besides the first and the last boundaries, take a snapshot every this many steps. */
+static constexpr size_t kReplaySnapshotStride = 4;
+
+/*!
+ * \brief Deep copy a schedule, along with the stages and the axes map that refer to its stages.
+ *  The IterVars and operations are immutable and shared by the copy.
+ */
+static void CopySchedule(const te::Schedule& sch, const Array<te::Stage>& stages,
+                         const StageToAxesMap& stage_to_axes, te::Schedule* out_sch,
+                         Array<te::Stage>* out_stages, StageToAxesMap* out_stage_to_axes) {
+  te::Schedule copy = sch.copy();
+  // Schedule::copy keeps the order of the stages and the groups
+  std::unordered_map<te::Stage, te::Stage, ObjectPtrHash, ObjectPtrEqual> smap;
+  for (size_t i = 0; i < sch->stages.size(); ++i) {
+    smap[sch->stages[i]] = copy->stages[i];
+  }
+  for (size_t i = 0; i < sch->groups.size(); ++i) {
+    smap[sch->groups[i]] = copy->groups[i];
+  }
+
+  Array<te::Stage> new_stages;
+  for (const auto& stage : stages) {
+    auto it = smap.find(stage);
+    CHECK(it != smap.end()) << "Stage " << stage << " is not in the schedule";
+    new_stages.push_back(it->second);
+  }
+  StageToAxesMap new_stage_to_axes;
+  for (const auto& kv : stage_to_axes) {
+    auto it = smap.find(kv.first);
+    new_stage_to_axes.Set(it != smap.end() ? it->second : kv.first, kv.second);
+  }
+
+  *out_sch = std::move(copy);
+  *out_stages = std::move(new_stages);
+  *out_stage_to_axes = std::move(new_stage_to_axes);
+}
+
+/*!
+ * \brief The schedules of a ComputeDAG after some prefixes of transform steps.
+ *  A prefix is keyed by the fingerprints of its steps. The snapshots are never modified, every
+ *  replay resumes from a copy.
+ */
+class ComputeDAGReplayCache {
+ public:
+  /*!
+   * \brief Restore a copy of the longest cached prefix.
+   * \param prefix_keys The keys of all prefixes, prefix_keys[i] is the key of the first i steps.
+   * \return The number of restored steps, or -1 if no prefix is cached.
+   */
+  int Restore(const std::vector<uint64_t>& prefix_keys, te::Schedule* sch,
+              Array<te::Stage>* stages, StageToAxesMap* stage_to_axes) {
+    std::shared_ptr<const Snapshot> snapshot;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = prefix_keys.size(); i-- > 0;) {
+        auto it = snapshots_.find(prefix_keys[i]);
+        if (it != snapshots_.end() && it->second->num_steps == i) {
+          snapshot = it->second;
+          break;
+        }
+      }
+    }
+    if (snapshot == nullptr) {
+      return -1;
+    }
+    CopySchedule(snapshot->schedule, snapshot->stages, snapshot->stage_to_axes, sch, stages,
+                 stage_to_axes);
+    return static_cast<int>(snapshot->num_steps);
+  }
+
+  /*! \brief Store a copy of the schedule after the first num_steps steps. */
+  void Insert(uint64_t key, size_t num_steps, const te::Schedule& sch,
+              const Array<te::Stage>& stages, const StageToAxesMap& stage_to_axes) {
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->num_steps = num_steps;
+    CopySchedule(sch, stages, stage_to_axes, &snapshot->schedule, &snapshot->stages,
+                 &snapshot->stage_to_axes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (snapshots_.size() >= static_cast<size_t>(replay_cache_capacity.load())) {
+      // The working set of a search moves with its population, start over instead of
+      // keeping the recency of every entry.
+      snapshots_.clear();
+    }
+    snapshots_.emplace(key, std::move(snapshot));
+  }
+
+ private:
+  /*! \brief The schedule after a prefix of steps. */
+  struct Snapshot {
+    size_t num_steps;
+    te::Schedule schedule;
+    Array<te::Stage> stages;
+    StageToAxesMap stage_to_axes;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<const Snapshot>> snapshots_;
+};
+
+void SetReplayCacheCapacity(int capacity) { replay_cache_capacity = std::max(capacity, 0); }
+
+ReplayCacheStats GetReplayCacheStats() {
+  ReplayCacheStats stats;
+  stats.hits = replay_cache_hits;
+  stats.misses = replay_cache_misses;
+  stats.reused_steps = replay_cache_reused_steps;
+  stats.replayed_steps = replay_cache_replayed_steps;
+  return stats;
+}
+
+void ResetReplayCacheStats() {
+  replay_cache_hits = 0;
+  replay_cache_misses = 0;
+  replay_cache_reused_steps = 0;
+  replay_cache_replayed_steps = 0;
+}
+
 ComputeDAG::ComputeDAG(Array<te::Tensor> tensors) {
   auto node = make_object<ComputeDAGNode>();
   node->tensors = std::move(tensors);
@@ -663,6 +795,7 @@ ComputeDAG::ComputeDAG(Array<te::Tensor> tensors) {
   node->ops = node->access_analyzer->ops_topo_order;
   node->flop_ct = FlopEstimator().EstimateFlop(node->ops);
   node->init_state = State(node->ops);
+  node->replay_cache = std::make_shared<ComputeDAGReplayCache>();
   data_ = std::move(node);
 }
 
@@ -678,28 +811,67 @@ std::pair<te::Schedule, Array<te::Tensor>> ComputeDAG::ApplySteps(
   if (stage_to_axes == nullptr) {
     stage_to_axes = &temp_stage_to_axes;
   }
-  Array<te::Operation> ops;
-  for (const auto& op : operator->()->ops) {
-    if (!op->IsInstance<te::PlaceholderOpNode>()) {
-      ops.push_back(op);
+
+  ComputeDAGReplayCache* cache =
+      replay_cache_capacity > 0 ? operator->()->replay_cache.get() : nullptr;
+  size_t n_steps = transform_steps.size();
+  std::vector<uint64_t> prefix_keys;
+  int restored = -1;
+  te::Schedule schedule;
+  if (cache != nullptr) {
+    // The key of a prefix folds the fingerprints of its steps, as in State::Fingerprint
+    prefix_keys.reserve(n_steps + 1);
+    prefix_keys.push_back(0);
+    for (const auto& step : transform_steps) {
+      uint64_t key = prefix_keys.back();
+      key ^= step->Fingerprint() + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+      prefix_keys.push_back(key);
+    }
+    restored = cache->Restore(prefix_keys, &schedule, stages, stage_to_axes);
+    if (restored > 0) {
+      replay_cache_hits++;
+      replay_cache_reused_steps += restored;
+    } else {
+      replay_cache_misses++;
     }
   }
-  // Create the initial schedule
-  // TODO(jcf94): Currently we only checked single output dag for TVM Auto-scheduler,
-  // update this after testing with multiple outputs.
-  te::Schedule schedule = te::create_schedule({ops.back()});
 
-  // init axes
-  for (const auto& x : operator->()->ops) {
-    const te::Stage& stage = schedule[x];
-    stages->push_back(stage);
-    UpdateStageToAxesMap(stage, stage_to_axes);
+  if (restored < 0) {
+    Array<te::Operation> ops;
+    for (const auto& op : operator->()->ops) {
+      if (!op->IsInstance<te::PlaceholderOpNode>()) {
+        ops.push_back(op);
+      }
+    }
+    // Create the initial schedule
+    // TODO(jcf94): Currently we only checked single output dag for TVM Auto-scheduler,
+    // update this after testing with multiple outputs.
+    schedule = te::create_schedule({ops.back()});
+
+    // init axes
+    for (const auto& x : operator->()->ops) {
+      const te::Stage& stage = schedule[x];
+      stages->push_back(stage);
+      UpdateStageToAxesMap(stage, stage_to_axes);
+    }
+    if (cache != nullptr) {
+      cache->Insert(prefix_keys[0], 0, schedule, *stages, *stage_to_axes);
+    }
   }
 
   // Apply the history steps to TVM schedule
   // Call each step's ApplyToSchedule method
-  for (const auto& step : transform_steps) {
-    StepApplyToSchedule(step, stages, stage_to_axes, &schedule, transform_steps);
+  for (size_t i = std::max(restored, 0); i < n_steps; ++i) {
+    StepApplyToSchedule(transform_steps[i], stages, stage_to_axes, &schedule, transform_steps);
+    // Snapshot the complete replay, the boundary before the last step, which the mutations of
+    // the search often touch, and every few steps in between
+    size_t boundary = i + 1;
+    if (cache != nullptr && (boundary + 1 >= n_steps || boundary % kReplaySnapshotStride == 0)) {
+      cache->Insert(prefix_keys[boundary], boundary, schedule, *stages, *stage_to_axes);
+    }
+  }
+  if (cache != nullptr) {
+    replay_cache_replayed_steps += static_cast<int64_t>(n_steps) - std::max(restored, 0);
   }
 
   return std::make_pair(schedule, operator->()->tensors);
@@ -946,6 +1118,32 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
       p->stream << ss.str();
     });
 
+String ComputeDAG::GetStructuralKey() const {
+  std::ostringstream os;
+  os << *this;
+  const std::string& text = os.str();
+
+  // Replace the numbers that are not part of an identifier, such as "512" in "[512, 512]" or
+  // "(i*512)", by "?", while keeping names such as "float32" or "T_add_1"
+  auto is_word_char = [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  };
+  std::string key;
+  key.reserve(text.size());
+  for (size_t i = 0; i < text.size();) {
+    if (std::isdigit(static_cast<unsigned char>(text[i])) &&
+        (i == 0 || !is_word_char(text[i - 1]))) {
+      while (i < text.size() && (is_word_char(text[i]) || text[i] == '.')) {
+        i++;
+      }
+      key.push_back('?');
+    } else {
+      key.push_back(text[i++]);
+    }
+  }
+  return key;
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.ComputeDAG").set_body_typed([](Array<te::Tensor> tensors) {
   return ComputeDAG(tensors);
 });
@@ -968,5 +1166,21 @@ TVM_REGISTER_GLOBAL("auto_scheduler.ComputeDAGInferBoundFromState")
       return dag.InferBound(state);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.ComputeDAGGetStructuralKey")
+    .set_body_typed([](const ComputeDAG& dag) { return dag.GetStructuralKey(); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.SetReplayCacheCapacity").set_body_typed(SetReplayCacheCapacity);
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GetReplayCacheStats").set_body_typed([]() {
+  ReplayCacheStats stats = GetReplayCacheStats();
+  return Map<String, PrimExpr>(
+      {{"hits", IntImm(DataType::Int(64), stats.hits)},
+       {"misses", IntImm(DataType::Int(64), stats.misses)},
+       {"reused_steps", IntImm(DataType::Int(64), stats.reused_steps)},
+       {"replayed_steps", IntImm(DataType::Int(64), stats.replayed_steps)}});
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ResetReplayCacheStats").set_body_typed(ResetReplayCacheStats);
+
 }  // namespace auto_scheduler
 }  // namespace tvm
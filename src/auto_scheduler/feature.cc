@@ -36,8 +36,12 @@
 #include <tvm/tir/transform.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <mutex>
 #include <numeric>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -1259,6 +1263,123 @@ void GetPerStoreFeatureName(int max_n_bufs, std::vector<std::string>* ret) {
   // section total : 3
 }
 
+/*!
+ * \brief Cache of the per-store features of states.
+ *
+ *  The evolutionary search predicts the surviving states again in every iteration and the
+ *  cost models extract the features of the measured states again when they are retrained,
+ *  so most of the states passed to the feature extraction have been lowered before.
+ *  An entry is keyed by the task and the fingerprint of the transform steps of the state.
+ */
+class FeatureCache {
+ public:
+  /*! \return The global cache. */
+  static FeatureCache* Global() {
+    static FeatureCache inst;
+    return &inst;
+  }
+
+  /*!
+   * \brief Make the part of the key that is shared by all states of a task.
+   *  It covers everything that the lowering and the extraction depend on besides the steps.
+   */
+  static std::string TaskKey(const SearchTask& task, int max_n_bufs) {
+    auto pass_ctx = tvm::transform::PassContext::Current();
+    const auto& params = task->hardware_params;
+    std::ostringstream os;
+    os << task->workload_key << '\n'
+       << task->target->str() << '\n'
+       << max_n_bufs << ' ' << params->cache_line_bytes << ' '
+       << params->max_shared_memory_per_block << ' ' << params->max_registers_per_block << ' '
+       << params->max_threads_per_block << ' ' << params->vector_unit_bytes << ' '
+       << params->max_vthread_extent << ' '
+       << pass_ctx->GetConfig<Bool>("tir.noalias", Bool(true)).value() << ' '
+       << pass_ctx->GetConfig<Bool>("tir.disable_vectorize", Bool(false)).value() << ' '
+       << pass_ctx->GetConfig<Bool>("tir.instrument_bound_checkers", Bool(false)).value() << '\n'
+       << task->compute_dag;
+    return os.str();
+  }
+
+  bool Enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_ > 0;
+  }
+
+  bool Lookup(const std::string& task_key, uint64_t fingerprint, std::vector<float>* feature) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto task_it = entries_.find(task_key);
+    if (task_it != entries_.end()) {
+      auto it = task_it->second.find(fingerprint);
+      if (it != task_it->second.end()) {
+        *feature = it->second;
+        stats_.cache_hits++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Insert(const std::string& task_key, uint64_t fingerprint,
+              const std::vector<float>& feature) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity_ == 0) {
+      return;
+    }
+    if (size_ >= capacity_) {
+      // The working set of a search moves with its population, start over instead of
+      // keeping the recency of every entry.
+      entries_.clear();
+      size_ = 0;
+    }
+    if (entries_[task_key].emplace(fingerprint, feature).second) {
+      size_++;
+    }
+  }
+
+  void SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    entries_.clear();
+    size_ = 0;
+  }
+
+  void AddExtraction(int64_t num_states, int64_t num_errors, double seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.cache_misses += num_states;
+    stats_.errors += num_errors;
+    stats_.extraction_time += seconds;
+  }
+
+  FeatureExtractionStats Stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  void ResetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = FeatureExtractionStats();
+  }
+
+ private:
+  /*! \brief The default maximum number of cached states. */
+  static constexpr size_t kDefaultCapacity = 8192;
+
+  std::mutex mutex_;
+  /*! \brief Task key -> state fingerprint -> per-store features. */
+  std::unordered_map<std::string, std::unordered_map<uint64_t, std::vector<float>>> entries_;
+  /*! \brief The number of cached states. */
+  size_t size_{0};
+  /*! \brief The maximum number of cached states. */
+  size_t capacity_{kDefaultCapacity};
+  FeatureExtractionStats stats_;
+};
+
+void SetFeatureCacheCapacity(size_t capacity) { FeatureCache::Global()->SetCapacity(capacity); }
+
+FeatureExtractionStats GetFeatureExtractionStats() { return FeatureCache::Global()->Stats(); }
+
+void ResetFeatureExtractionStats() { FeatureCache::Global()->ResetStats(); }
+
 void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, int max_n_bufs,
                                    std::vector<float>* feature, std::atomic<int>* error_ct) {
   te::Schedule sch;
@@ -1333,21 +1454,8 @@ void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, i
 void GetPerStoreFeaturesFromStates(const Array<State>& states, const SearchTask& task,
                                    int skip_first_n_feature_extraction, int max_n_bufs,
                                    std::vector<std::vector<float>>* features) {
-  // extract features
-  features->assign(states.size(), std::vector<float>());
-
-  std::atomic<int> error_ct(0);
-
-  support::parallel_for(skip_first_n_feature_extraction, states.size(),
-                        [&task, &states, &max_n_bufs, &features, &error_ct](int i) {
-                          GetPerStoreFeaturesWorkerFunc(task, states[i], max_n_bufs,
-                                                        &(*features)[i], &error_ct);
-                        });
-
-  if (error_ct > 0) {
-    std::cerr << "Encountered " << error_ct
-              << " errors during feature extraction, which are safely ignored." << std::endl;
-  }
+  GetPerStoreFeaturesFromStates(states, std::vector<SearchTask>(states.size(), task),
+                                skip_first_n_feature_extraction, max_n_bufs, features);
 }
 
 void GetPerStoreFeaturesFromStates(const Array<State>& states, const std::vector<SearchTask>& tasks,
@@ -1356,17 +1464,54 @@ void GetPerStoreFeaturesFromStates(const Array<State>& states, const std::vector
   // extract features
   features->assign(states.size(), std::vector<float>());
 
-  std::atomic<int> error_ct(0);
+  // Look up the cache first, only the missed states are lowered
+  FeatureCache* cache = FeatureCache::Global();
+  bool use_cache = cache->Enabled();
+  std::unordered_map<const Object*, std::string> task_keys;
+  std::vector<const std::string*> keys(states.size(), nullptr);
+  std::vector<uint64_t> fingerprints(states.size(), 0);
+  std::vector<int> misses;
+  for (size_t i = skip_first_n_feature_extraction; i < states.size(); ++i) {
+    if (use_cache) {
+      auto it = task_keys.find(tasks[i].get());
+      if (it == task_keys.end()) {
+        it = task_keys.emplace(tasks[i].get(), FeatureCache::TaskKey(tasks[i], max_n_bufs)).first;
+      }
+      keys[i] = &it->second;
+      fingerprints[i] = states[i].Fingerprint();
+      if (cache->Lookup(*keys[i], fingerprints[i], &(*features)[i])) {
+        continue;
+      }
+    }
+    misses.push_back(i);
+  }
 
-  support::parallel_for(skip_first_n_feature_extraction, states.size(),
-                        [&tasks, &states, &max_n_bufs, &features, &error_ct](int i) {
-                          GetPerStoreFeaturesWorkerFunc(tasks[i], states[i], max_n_bufs,
-                                                        &(*features)[i], &error_ct);
-                        });
+  std::atomic<int> error_ct(0);
+  std::atomic<int64_t> extraction_ns(0);
+
+  // The lowering time varies a lot between states, so the threads take the states one by one
+  support::parallel_for_dynamic(
+      0, static_cast<int>(misses.size()), -1,
+      [&tasks, &states, &max_n_bufs, &features, &error_ct, &extraction_ns, &misses](int j) {
+        int i = misses[j];
+        auto tic = std::chrono::high_resolution_clock::now();
+        GetPerStoreFeaturesWorkerFunc(tasks[i], states[i], max_n_bufs, &(*features)[i],
+                                      &error_ct);
+        extraction_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::high_resolution_clock::now() - tic)
+                             .count();
+      });
+
+  if (use_cache) {
+    for (int i : misses) {
+      cache->Insert(*keys[i], fingerprints[i], (*features)[i]);
+    }
+  }
+  cache->AddExtraction(misses.size(), error_ct, extraction_ns * 1e-9);
 
   if (error_ct > 0) {
     std::cerr << "Encountered " << error_ct
-              << " errors during feature extraction. which are safely ignored." << std::endl;
+              << " errors during feature extraction, which are safely ignored." << std::endl;
   }
 }
 
@@ -1632,6 +1777,23 @@ TVM_REGISTER_GLOBAL("auto_scheduler.GetPerStoreFeaturesFromStates")
                                std::move(task_ids), &byte_data);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.SetFeatureCacheCapacity").set_body_typed([](int capacity) {
+  CHECK_GE(capacity, 0);
+  SetFeatureCacheCapacity(capacity);
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GetFeatureExtractionStats").set_body_typed([]() {
+  FeatureExtractionStats stats = GetFeatureExtractionStats();
+  return Map<String, PrimExpr>(
+      {{"cache_hits", IntImm(DataType::Int(64), stats.cache_hits)},
+       {"cache_misses", IntImm(DataType::Int(64), stats.cache_misses)},
+       {"errors", IntImm(DataType::Int(64), stats.errors)},
+       {"extraction_time", FloatImm(DataType::Float(64), stats.extraction_time)}});
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ResetFeatureExtractionStats")
+    .set_body_typed(ResetFeatureExtractionStats);
+
 TVM_REGISTER_GLOBAL("auto_scheduler.GetPerStoreFeatureNames")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
       int max_n_bufs = args[0];
@@ -0,0 +1,529 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_scheduler/gbdt_model.cc
+ * \brief Native gradient boosted tree cost model.
+ */
+
+#include <dmlc/io.h>
+#include <tvm/auto_scheduler/cost_model.h>
+#include <tvm/auto_scheduler/feature.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+
+namespace tvm {
+namespace auto_scheduler {
+
+TVM_REGISTER_OBJECT_TYPE(GBDTModelNode);
+
+/*! \brief Magic number of a saved GBDTModel. */
+constexpr uint64_t kGBDTModelMagic = 0x5DB7A1C3E09F4B02;
+/*! \brief The maximum number of buffers in a per-store feature, same as the python models. */
+constexpr int kMaxNumBufs = 5;
+/*! \brief Histograms of nodes with less work than this are built serially. */
+constexpr size_t kMinParallelWork = 1 << 16;
+/*! \brief A boosting round counts as an improvement if it reduces the error by this fraction. */
+constexpr double kMinRelativeImprovement = 1e-3;
+
+namespace {
+
+/*!
+ * \brief Get the layout of a per-store feature vector of one program.
+ * \return Whether the program is valid, i.e. it has stores and not all features are zero.
+ */
+bool ParseFeature(const std::vector<float>& feature, int* n_stores, int* length) {
+  if (feature.size() <= 1) return false;
+  *n_stores = static_cast<int>(feature[0] + 0.5);
+  if (*n_stores <= 0) return false;
+  *length = static_cast<int>(feature.size() - 1) / *n_stores;
+  CHECK_EQ(static_cast<size_t>(*length) * *n_stores, feature.size() - 1);
+  return std::any_of(feature.begin() + 1, feature.end(), [](float x) { return x != 0.0f; });
+}
+
+/*! \brief The training set in the pack-sum format, a pack holds the stores of one program. */
+struct PackSumData {
+  /*! \brief The length of one row. */
+  int num_features{0};
+  /*! \brief The rows in row-major order, one row per store. */
+  std::vector<float> x;
+  /*! \brief The pack of each row. */
+  std::vector<int> pack_ids;
+  /*! \brief The normalized throughput of each pack. */
+  std::vector<float> labels;
+  /*! \brief The histogram bin of each element of x. */
+  std::vector<uint8_t> bins;
+
+  size_t NumRows() const { return pack_ids.size(); }
+  const float* Row(size_t i) const { return &x[i * num_features]; }
+};
+
+/*! \brief Quantile bin boundaries of each feature, the boundaries are the split candidates. */
+std::vector<std::vector<float>> ComputeBinCuts(const PackSumData& data, int max_bins) {
+  std::vector<std::vector<float>> cuts(data.num_features);
+  size_t n_rows = data.NumRows();
+  support::parallel_for(0, data.num_features, [&](int j) {
+    std::vector<float> column(n_rows);
+    for (size_t i = 0; i < n_rows; ++i) column[i] = data.x[i * data.num_features + j];
+    std::sort(column.begin(), column.end());
+    std::vector<float> unique(column.begin(), std::unique(column.begin(), column.end()));
+    std::vector<float>& out = cuts[j];
+    if (unique.size() <= static_cast<size_t>(max_bins)) {
+      for (size_t k = 1; k < unique.size(); ++k) {
+        out.push_back(unique[k - 1] + (unique[k] - unique[k - 1]) / 2);
+      }
+    } else {
+      for (int k = 1; k < max_bins; ++k) {
+        float cut = column[k * n_rows / max_bins];
+        if (cut > column[0] && (out.empty() || cut > out.back())) out.push_back(cut);
+      }
+    }
+  });
+  return cuts;
+}
+
+/*! \brief Map every element to the number of cuts that are not greater than it. */
+void ComputeBins(const std::vector<std::vector<float>>& cuts, PackSumData* data) {
+  int num_features = data->num_features;
+  data->bins.resize(data->x.size());
+  support::parallel_for(0, num_features, [&](int j) {
+    const std::vector<float>& c = cuts[j];
+    for (size_t i = 0; i < data->NumRows(); ++i) {
+      size_t idx = i * num_features + j;
+      data->bins[idx] =
+          static_cast<uint8_t>(std::upper_bound(c.begin(), c.end(), data->x[idx]) - c.begin());
+    }
+  });
+}
+
+/*! \brief Grow one regression tree on the gradients of the pack-sum square error. */
+class TreeBuilder {
+ public:
+  TreeBuilder(const GBDTModelNode* param, const PackSumData& data,
+              const std::vector<std::vector<float>>& cuts, const std::vector<double>& grad,
+              const std::vector<double>& hess)
+      : param_(param), data_(data), cuts_(cuts), grad_(grad), hess_(hess) {}
+
+  GBDTTree Build() {
+    GBDTTree tree;
+    std::vector<int> rows(data_.NumRows());
+    for (size_t i = 0; i < rows.size(); ++i) rows[i] = static_cast<int>(i);
+    BuildNode(std::move(rows), 0, &tree);
+    return tree;
+  }
+
+ private:
+  /*! \brief The best split of one feature. */
+  struct Split {
+    double gain{0};
+    int feature{-1};
+    int bin{-1};
+  };
+
+  int BuildNode(std::vector<int> rows, int depth, GBDTTree* tree) {
+    double sum_grad = 0, sum_hess = 0;
+    for (int r : rows) {
+      sum_grad += grad_[r];
+      sum_hess += hess_[r];
+    }
+    int node_id = static_cast<int>(tree->nodes.size());
+    GBDTTree::Node node;
+    node.feature = -1;
+    node.threshold = 0;
+    node.left = node.right = -1;
+    node.value = static_cast<float>(-sum_grad / (sum_hess + param_->reg_lambda) *
+                                    param_->learning_rate);
+    tree->nodes.push_back(node);
+
+    if (depth >= param_->max_depth || rows.size() < 2 ||
+        sum_hess < 2 * param_->min_child_weight) {
+      return node_id;
+    }
+
+    int num_features = data_.num_features;
+    std::vector<Split> splits(num_features);
+    auto fsplit = [&](int j) { splits[j] = BestSplit(rows, j, sum_grad, sum_hess); };
+    if (rows.size() * num_features >= kMinParallelWork) {
+      support::parallel_for(0, num_features, fsplit);
+    } else {
+      for (int j = 0; j < num_features; ++j) fsplit(j);
+    }
+    Split best;
+    for (const Split& split : splits) {
+      if (split.feature >= 0 && split.gain > best.gain) best = split;
+    }
+    // Same as xgboost, the gain of a split is half the reduction of the objective.
+    if (best.feature < 0 || best.gain / 2 <= param_->min_split_gain) {
+      return node_id;
+    }
+
+    std::vector<int> left_rows, right_rows;
+    for (int r : rows) {
+      if (data_.bins[static_cast<size_t>(r) * num_features + best.feature] <= best.bin) {
+        left_rows.push_back(r);
+      } else {
+        right_rows.push_back(r);
+      }
+    }
+    rows.clear();
+    rows.shrink_to_fit();
+    int left = BuildNode(std::move(left_rows), depth + 1, tree);
+    int right = BuildNode(std::move(right_rows), depth + 1, tree);
+    GBDTTree::Node& split_node = tree->nodes[node_id];
+    split_node.feature = best.feature;
+    split_node.threshold = cuts_[best.feature][best.bin];
+    split_node.left = left;
+    split_node.right = right;
+    return node_id;
+  }
+
+  Split BestSplit(const std::vector<int>& rows, int feature, double sum_grad,
+                  double sum_hess) const {
+    Split best;
+    size_t n_bins = cuts_[feature].size() + 1;
+    if (n_bins < 2) return best;
+    std::vector<double> hist_grad(n_bins, 0), hist_hess(n_bins, 0);
+    int num_features = data_.num_features;
+    for (int r : rows) {
+      uint8_t bin = data_.bins[static_cast<size_t>(r) * num_features + feature];
+      hist_grad[bin] += grad_[r];
+      hist_hess[bin] += hess_[r];
+    }
+    double lambda = param_->reg_lambda;
+    double parent = sum_grad * sum_grad / (sum_hess + lambda);
+    double left_grad = 0, left_hess = 0;
+    for (size_t b = 0; b + 1 < n_bins; ++b) {
+      left_grad += hist_grad[b];
+      left_hess += hist_hess[b];
+      double right_grad = sum_grad - left_grad;
+      double right_hess = sum_hess - left_hess;
+      if (left_hess < param_->min_child_weight || right_hess < param_->min_child_weight) {
+        continue;
+      }
+      double gain = left_grad * left_grad / (left_hess + lambda) +
+                    right_grad * right_grad / (right_hess + lambda) - parent;
+      if (gain > best.gain) {
+        best.gain = gain;
+        best.feature = feature;
+        best.bin = static_cast<int>(b);
+      }
+    }
+    return best;
+  }
+
+  const GBDTModelNode* param_;
+  const PackSumData& data_;
+  const std::vector<std::vector<float>>& cuts_;
+  const std::vector<double>& grad_;
+  const std::vector<double>& hess_;
+};
+
+/*! \brief Sum up the row predictions of each pack. */
+std::vector<double> PackSum(const PackSumData& data, const std::vector<double>& preds) {
+  std::vector<double> sums(data.labels.size(), 0);
+  for (size_t i = 0; i < data.NumRows(); ++i) sums[data.pack_ids[i]] += preds[i];
+  return sums;
+}
+
+/*! \brief The root mean square error of the pack sums. */
+double PackSumRMSE(const PackSumData& data, const std::vector<double>& sums) {
+  double sum_sq = 0;
+  for (size_t p = 0; p < sums.size(); ++p) {
+    double diff = sums[p] - data.labels[p];
+    sum_sq += diff * diff;
+  }
+  return std::sqrt(sum_sq / std::max(sums.size(), static_cast<size_t>(1)));
+}
+
+/*! \brief Turn the store scores into state scores, -inf marks invalid states. */
+void SumStoreScores(const std::vector<std::vector<float>>& store_scores, bool use_model,
+                    std::mt19937* rand_gen, std::vector<float>* scores) {
+  std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+  scores->resize(store_scores.size());
+  for (size_t i = 0; i < store_scores.size(); ++i) {
+    if (store_scores[i].empty()) {
+      (*scores)[i] = -std::numeric_limits<float>::infinity();
+    } else if (use_model) {
+      (*scores)[i] = std::accumulate(store_scores[i].begin(), store_scores[i].end(), 0.0f);
+    } else {
+      (*scores)[i] = dis(*rand_gen);
+    }
+  }
+}
+
+}  // namespace
+
+GBDTModel::GBDTModel(Map<String, ObjectRef> params, int seed) {
+  auto node = make_object<GBDTModelNode>();
+  node->max_depth = 8;
+  node->num_rounds = 200;
+  node->incremental_rounds = 30;
+  node->max_num_trees = 500;
+  node->early_stopping_rounds = 20;
+  node->max_bins = 64;
+  node->num_warmup_sample = 100;
+  node->learning_rate = 0.2;
+  node->reg_lambda = 1.0;
+  node->min_child_weight = 0;
+  node->min_split_gain = 0.001;
+
+  auto get_int = [](const std::string& key, const ObjectRef& value) -> int {
+    const auto* pint = value.as<IntImmNode>();
+    CHECK(pint != nullptr) << "GBDTModel parameter " << key << " must be an integer";
+    return static_cast<int>(pint->value);
+  };
+  auto get_double = [](const std::string& key, const ObjectRef& value) -> double {
+    if (const auto* pint = value.as<IntImmNode>()) return static_cast<double>(pint->value);
+    const auto* pdouble = value.as<FloatImmNode>();
+    CHECK(pdouble != nullptr) << "GBDTModel parameter " << key << " must be a number";
+    return pdouble->value;
+  };
+  for (const auto& kv : params) {
+    const std::string key = kv.first;
+    if (key == "max_depth") {
+      node->max_depth = get_int(key, kv.second);
+    } else if (key == "num_rounds") {
+      node->num_rounds = get_int(key, kv.second);
+    } else if (key == "incremental_rounds") {
+      node->incremental_rounds = get_int(key, kv.second);
+    } else if (key == "max_num_trees") {
+      node->max_num_trees = get_int(key, kv.second);
+    } else if (key == "early_stopping_rounds") {
+      node->early_stopping_rounds = get_int(key, kv.second);
+    } else if (key == "max_bins") {
+      node->max_bins = get_int(key, kv.second);
+    } else if (key == "num_warmup_sample") {
+      node->num_warmup_sample = get_int(key, kv.second);
+    } else if (key == "learning_rate") {
+      node->learning_rate = get_double(key, kv.second);
+    } else if (key == "reg_lambda") {
+      node->reg_lambda = get_double(key, kv.second);
+    } else if (key == "min_child_weight") {
+      node->min_child_weight = get_double(key, kv.second);
+    } else if (key == "min_split_gain") {
+      node->min_split_gain = get_double(key, kv.second);
+    } else {
+      LOG(FATAL) << "Unknown GBDTModel parameter: " << key;
+    }
+  }
+  CHECK(node->max_bins >= 2 && node->max_bins <= 256) << "max_bins must be in [2, 256]";
+  node->rand_gen_.seed(seed);
+  data_ = std::move(node);
+}
+
+void GBDTModelNode::Update(const Array<MeasureInput>& inputs,
+                           const Array<MeasureResult>& results) {
+  if (inputs.empty()) return;
+  CHECK_EQ(inputs.size(), results.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    inputs_.push_back(inputs[i]);
+    results_.push_back(results[i]);
+  }
+
+  // Only extract the features of the new measurements, the labels of all of them are
+  // recomputed because they are normalized by the best cost of each task.
+  size_t n_cached = features_.size();
+  std::vector<std::vector<float>> features;
+  std::vector<float> normalized_throughputs;
+  std::vector<int> task_ids;
+  GetPerStoreFeaturesFromMeasurePairs(inputs_, results_, n_cached, kMaxNumBufs, &features,
+                                      &normalized_throughputs, &task_ids);
+  for (size_t i = 0; i < n_cached; ++i) features[i] = std::move(features_[i]);
+  features_ = std::move(features);
+
+  Train(normalized_throughputs);
+}
+
+void GBDTModelNode::Train(const std::vector<float>& normalized_throughputs) {
+  PackSumData data;
+  for (size_t i = 0; i < features_.size(); ++i) {
+    int n_stores, length;
+    if (!ParseFeature(features_[i], &n_stores, &length)) continue;
+    if (data.num_features == 0) data.num_features = length;
+    CHECK_EQ(data.num_features, length);
+    int pack_id = static_cast<int>(data.labels.size());
+    data.labels.push_back(normalized_throughputs[i]);
+    data.x.insert(data.x.end(), features_[i].begin() + 1, features_[i].end());
+    data.pack_ids.insert(data.pack_ids.end(), n_stores, pack_id);
+  }
+  if (data.NumRows() == 0) return;
+
+  int rounds = incremental_rounds;
+  if (trees.empty() || static_cast<int>(bin_cuts.size()) != data.num_features ||
+      static_cast<int>(trees.size()) + incremental_rounds > max_num_trees) {
+    trees.clear();
+    bin_cuts = ComputeBinCuts(data, max_bins);
+    rounds = num_rounds;
+  }
+  ComputeBins(bin_cuts, &data);
+
+  // Continue boosting from the predictions of the current ensemble.
+  size_t n_rows = data.NumRows();
+  std::vector<double> preds(n_rows, 0);
+  if (!trees.empty()) {
+    support::parallel_for(0, static_cast<int>(n_rows), [&](int i) {
+      for (const GBDTTree& tree : trees) preds[i] += tree.Predict(data.Row(i));
+    });
+  }
+
+  // The square error of the pack sums weighted by the normalized throughputs, so that the
+  // fast programs which matter for the search are fitted best.
+  std::vector<double> grad(n_rows), hess(n_rows);
+  std::vector<double> sums = PackSum(data, preds);
+  double best_rmse = PackSumRMSE(data, sums);
+  size_t best_num_trees = trees.size();
+  for (int round = 0; round < rounds; ++round) {
+    for (size_t i = 0; i < n_rows; ++i) {
+      int p = data.pack_ids[i];
+      double weight = data.labels[p];
+      grad[i] = (sums[p] - data.labels[p]) * weight;
+      hess[i] = weight;
+    }
+    GBDTTree tree = TreeBuilder(this, data, bin_cuts, grad, hess).Build();
+    for (size_t i = 0; i < n_rows; ++i) preds[i] += tree.Predict(data.Row(i));
+    trees.push_back(std::move(tree));
+
+    sums = PackSum(data, preds);
+    double rmse = PackSumRMSE(data, sums);
+    if (rmse < best_rmse * (1 - kMinRelativeImprovement)) {
+      best_rmse = rmse;
+      best_num_trees = trees.size();
+    } else if (static_cast<int>(trees.size() - best_num_trees) >= early_stopping_rounds) {
+      break;
+    }
+  }
+  trees.resize(best_num_trees);
+}
+
+bool GBDTModelNode::UseModel() const {
+  return !trees.empty() && (loaded_ || static_cast<int>(inputs_.size()) > num_warmup_sample);
+}
+
+void GBDTModelNode::PredictPerStore(const SearchTask& task, const Array<State>& states,
+                                    bool use_model,
+                                    std::vector<std::vector<float>>* store_scores) {
+  std::vector<std::vector<float>> features;
+  GetPerStoreFeaturesFromStates(states, task, 0, kMaxNumBufs, &features);
+
+  store_scores->assign(states.size(), std::vector<float>());
+  support::parallel_for(0, static_cast<int>(states.size()), [&](int i) {
+    int n_stores, length;
+    if (!ParseFeature(features[i], &n_stores, &length)) return;
+    std::vector<float>& scores = (*store_scores)[i];
+    if (!use_model) {
+      scores.push_back(0.0f);
+      return;
+    }
+    CHECK_EQ(static_cast<size_t>(length), bin_cuts.size());
+    scores.assign(n_stores, 0.0f);
+    for (int k = 0; k < n_stores; ++k) {
+      const float* row = &features[i][1 + static_cast<size_t>(k) * length];
+      for (const GBDTTree& tree : trees) scores[k] += tree.Predict(row);
+    }
+  });
+}
+
+void GBDTModelNode::Predict(const SearchTask& task, const Array<State>& states,
+                            std::vector<float>* scores) {
+  bool use_model = UseModel();
+  std::vector<std::vector<float>> store_scores;
+  PredictPerStore(task, states, use_model, &store_scores);
+  SumStoreScores(store_scores, use_model, &rand_gen_, scores);
+}
+
+void GBDTModelNode::PredictStages(const SearchTask& task, const Array<State>& states,
+                                  std::vector<float>* state_scores,
+                                  std::vector<std::vector<float>>* stage_scores) {
+  bool use_model = UseModel();
+  std::vector<std::vector<float>> store_scores;
+  PredictPerStore(task, states, use_model, &store_scores);
+  SumStoreScores(store_scores, use_model, &rand_gen_, state_scores);
+
+  stage_scores->assign(states.size(), std::vector<float>());
+  if (!use_model) return;
+  for (size_t i = 0; i < states.size(); ++i) {
+    // Placeholders and inlined stages have no store, the others have one each.
+    std::vector<float> scores;
+    size_t next = 0;
+    for (const Stage& stage : states[i]->stages) {
+      if (stage->op_type == StageKind::kPlaceholder ||
+          stage->compute_at == ComputeAtKind::kInlined) {
+        scores.push_back(0);
+      } else if (next < store_scores[i].size()) {
+        scores.push_back(store_scores[i][next++]);
+      } else {
+        break;
+      }
+    }
+    if (next == store_scores[i].size() && scores.size() == states[i]->stages.size()) {
+      (*stage_scores)[i] = std::move(scores);
+    }
+  }
+}
+
+void GBDTModelNode::Save(const std::string& file_name) const {
+  std::unique_ptr<dmlc::Stream> fs(dmlc::Stream::Create(file_name.c_str(), "w"));
+  uint64_t magic = kGBDTModelMagic;
+  uint64_t num_trees = trees.size();
+  fs->Write(magic);
+  fs->Write(bin_cuts);
+  fs->Write(num_trees);
+  for (const GBDTTree& tree : trees) {
+    fs->Write(tree.nodes);
+  }
+}
+
+void GBDTModelNode::Load(const std::string& file_name) {
+  std::unique_ptr<dmlc::Stream> fs(dmlc::Stream::Create(file_name.c_str(), "r"));
+  uint64_t magic, num_trees;
+  CHECK(fs->Read(&magic)) << "Invalid GBDTModel file " << file_name;
+  CHECK_EQ(magic, kGBDTModelMagic) << "Invalid GBDTModel file " << file_name;
+  CHECK(fs->Read(&bin_cuts)) << "Invalid GBDTModel file " << file_name;
+  CHECK(fs->Read(&num_trees)) << "Invalid GBDTModel file " << file_name;
+  trees.resize(num_trees);
+  for (GBDTTree& tree : trees) {
+    CHECK(fs->Read(&tree.nodes)) << "Invalid GBDTModel file " << file_name;
+  }
+  loaded_ = true;
+}
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModel")
+    .set_body_typed([](Map<String, ObjectRef> params, int seed) {
+      return GBDTModel(params, seed);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModelSave")
+    .set_body_typed([](GBDTModel model, String file_name) { model->Save(file_name); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModelLoad")
+    .set_body_typed([](GBDTModel model, String file_name) { model->Load(file_name); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModelNumTrees").set_body_typed([](GBDTModel model) {
+  return static_cast<int>(model->trees.size());
+});
+
+}  // namespace auto_scheduler
+}  // namespace tvm
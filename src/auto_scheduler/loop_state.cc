@@ -442,6 +442,16 @@ String State::ToStr(bool delete_trivial_loop) const {
   return os.str();
 }
 
+uint64_t State::Fingerprint() const {
+  uint64_t fingerprint = static_cast<uint64_t>((*this)->transform_steps.size());
+  for (const auto& step : (*this)->transform_steps) {
+    // Order sensitive combination, as in boost::hash_combine.
+    fingerprint ^= step->Fingerprint() + 0x9e3779b97f4a7c15ULL + (fingerprint << 6) +
+                   (fingerprint >> 2);
+  }
+  return fingerprint;
+}
+
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
     .set_dispatch<StateNode>([](const ObjectRef& ref, ReprPrinter* p) {
       PrintState(&p->stream, tvm::Downcast<State>(ref), true);
@@ -562,5 +572,9 @@ TVM_REGISTER_GLOBAL("auto_scheduler.StateEqual").set_body_typed([](State state1,
   return std::equal_to<State>()(state1, state2);
 });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.StateFingerprint").set_body_typed([](State state) {
+  return static_cast<int64_t>(state.Fingerprint());
+});
+
 }  // namespace auto_scheduler
 }  // namespace tvm
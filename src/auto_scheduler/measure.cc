@@ -26,6 +26,12 @@
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include "utils.h"
 
@@ -123,7 +129,8 @@ Array<BuildResult> LocalBuilderNode::Build(const Array<MeasureInput>& inputs, in
 
 /********** LocalRunner **********/
 LocalRunner::LocalRunner(int timeout, int number, int repeat, int min_repeat_ms,
-                         double cooldown_interval, bool enable_cpu_cache_flush) {
+                         double cooldown_interval, bool enable_cpu_cache_flush, double max_rel_ci,
+                         int max_repeat) {
   ObjectPtr<LocalRunnerNode> node = make_object<LocalRunnerNode>();
   node->timeout = timeout;
   node->number = number;
@@ -131,6 +138,8 @@ LocalRunner::LocalRunner(int timeout, int number, int repeat, int min_repeat_ms,
   node->min_repeat_ms = min_repeat_ms;
   node->cooldown_interval = cooldown_interval;
   node->enable_cpu_cache_flush = enable_cpu_cache_flush;
+  node->max_rel_ci = max_rel_ci;
+  node->max_repeat = max_repeat;
   data_ = std::move(node);
 }
 
@@ -139,7 +148,7 @@ Array<MeasureResult> LocalRunnerNode::Run(const Array<MeasureInput>& inputs,
   if (const auto* f = runtime::Registry::Get("auto_scheduler.local_runner.run")) {
     Array<MeasureResult> results =
         (*f)(inputs, build_results, timeout, number, repeat, min_repeat_ms, cooldown_interval,
-             enable_cpu_cache_flush, verbose);
+             enable_cpu_cache_flush, max_rel_ci, max_repeat, verbose);
     return results;
   }
   LOG(FATAL) << "auto_scheduler.local_runner.run is not registered. "
@@ -151,7 +160,8 @@ Array<MeasureResult> LocalRunnerNode::Run(const Array<MeasureInput>& inputs,
 /********** RPCRunner **********/
 RPCRunner::RPCRunner(const String& key, const String& host, int port, int priority, int n_parallel,
                      int timeout, int number, int repeat, int min_repeat_ms,
-                     double cooldown_interval, bool enable_cpu_cache_flush) {
+                     double cooldown_interval, bool enable_cpu_cache_flush, double max_rel_ci,
+                     int max_repeat) {
   auto node = make_object<RPCRunnerNode>();
   node->key = key;
   node->host = host;
@@ -164,6 +174,8 @@ RPCRunner::RPCRunner(const String& key, const String& host, int port, int priori
   node->min_repeat_ms = min_repeat_ms;
   node->cooldown_interval = cooldown_interval;
   node->enable_cpu_cache_flush = enable_cpu_cache_flush;
+  node->max_rel_ci = max_rel_ci;
+  node->max_repeat = max_repeat;
   data_ = std::move(node);
 }
 
@@ -172,7 +184,8 @@ Array<MeasureResult> RPCRunnerNode::Run(const Array<MeasureInput>& inputs,
   if (const auto* f = runtime::Registry::Get("auto_scheduler.rpc_runner.run")) {
     Array<MeasureResult> results =
         (*f)(inputs, build_results, key, host, port, priority, n_parallel, timeout, number, repeat,
-             min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, verbose);
+             min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, max_rel_ci, max_repeat,
+             verbose);
     return results;
   } else {
     LOG(FATAL) << "auto_scheduler.rpc_runner.run is not registered. "
@@ -183,9 +196,51 @@ Array<MeasureResult> RPCRunnerNode::Run(const Array<MeasureInput>& inputs,
 }
 
 /********** ProgramMeasurer **********/
+/*! \brief The utilisation counters shared by all ProgramMeasurers. */
+struct GlobalMeasurePipelineStats {
+  std::mutex mutex;
+  MeasurePipelineStats stats;
+
+  static GlobalMeasurePipelineStats* Global() {
+    static GlobalMeasurePipelineStats* inst = new GlobalMeasurePipelineStats();
+    return inst;
+  }
+
+  void Add(const MeasurePipelineStats& other) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.num_batches += other.num_batches;
+    stats.wall_time += other.wall_time;
+    stats.build_time += other.build_time;
+    stats.run_time += other.run_time;
+    stats.build_stall_time += other.build_stall_time;
+    stats.run_stall_time += other.run_stall_time;
+    stats.runner_wall_time += other.runner_wall_time;
+  }
+};
+
+MeasurePipelineStats GetMeasurePipelineStats() {
+  GlobalMeasurePipelineStats* global = GlobalMeasurePipelineStats::Global();
+  std::lock_guard<std::mutex> lock(global->mutex);
+  return global->stats;
+}
+
+void ResetMeasurePipelineStats() {
+  GlobalMeasurePipelineStats* global = GlobalMeasurePipelineStats::Global();
+  std::lock_guard<std::mutex> lock(global->mutex);
+  global->stats = MeasurePipelineStats();
+}
+
+/*! \brief Seconds elapsed since tic. */
+static double SecondsSince(const std::chrono::high_resolution_clock::time_point& tic) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(
+             std::chrono::high_resolution_clock::now() - tic)
+      .count();
+}
+
 ProgramMeasurer::ProgramMeasurer(ProgramBuilder builder, ProgramRunner runner,
                                  Optional<Array<MeasureCallback>> callbacks, int verbose,
-                                 int max_continous_error) {
+                                 int max_continous_error, int pipeline_depth,
+                                 Array<ProgramRunner> extra_runners) {
   auto node = make_object<ProgramMeasurerNode>();
   node->builder = std::move(builder);
   node->runner = std::move(runner);
@@ -194,6 +249,8 @@ ProgramMeasurer::ProgramMeasurer(ProgramBuilder builder, ProgramRunner runner,
   node->max_continous_error = max_continous_error < 0
                                   ? ProgramMeasurerNode::DEFAULT_MAX_CONTINOUS_ERROR
                                   : max_continous_error;
+  node->pipeline_depth = std::max(pipeline_depth, 0);
+  node->extra_runners = std::move(extra_runners);
   data_ = std::move(node);
 }
 
@@ -218,14 +275,14 @@ void ProgramMeasurerNode::Measure(const SearchTask& task, const SearchPolicy& po
   StdCout(verbose) << "Get " << inputs.size() << " programs for measure. (This may take a while)"
                    << std::endl;
 
+  std::vector<Array<MeasureInput>> input_batches;
   for (size_t i = 0; i < inputs.size(); i += batch_size) {
-    Array<MeasureInput> input_batch(inputs.begin() + i,
-                                    inputs.begin() + std::min(i + batch_size, inputs.size()));
-    Array<MeasureResult> result_batch;
-
-    // build and run
-    SilentMeasure(task, input_batch, &result_batch);
+    input_batches.emplace_back(inputs.begin() + i,
+                               inputs.begin() + std::min(i + batch_size, inputs.size()));
+  }
 
+  auto on_batch = [&](const Array<MeasureInput>& input_batch,
+                      const Array<MeasureResult>& result_batch) {
     // update current best state according to the new measure result
     for (size_t j = 0; j < input_batch.size(); ++j) {
       double flops;
@@ -267,7 +324,26 @@ void ProgramMeasurerNode::Measure(const SearchTask& task, const SearchPolicy& po
     if (error_ct > max_continous_error) {
       LOG(FATAL) << "Too many errors happened during tuning";
     }
+  };
+
+  auto tic = std::chrono::high_resolution_clock::now();
+  int num_runners = 1;
+  if (pipeline_depth > 0 && input_batches.size() > 1) {
+    num_runners += extra_runners.size();
+    PipelinedMeasure(input_batches, on_batch);
+  } else {
+    for (const auto& input_batch : input_batches) {
+      Array<MeasureResult> result_batch;
+      // build and run
+      SilentMeasure(task, input_batch, &result_batch);
+      on_batch(input_batch, result_batch);
+    }
   }
+
+  MeasurePipelineStats stats;
+  stats.wall_time = SecondsSince(tic);
+  stats.runner_wall_time = stats.wall_time * num_runners;
+  GlobalMeasurePipelineStats::Global()->Add(stats);
 }
 
 void ProgramMeasurerNode::SilentMeasure(const SearchTask& task, const Array<MeasureInput>& inputs,
@@ -276,8 +352,15 @@ void ProgramMeasurerNode::SilentMeasure(const SearchTask& task, const Array<Meas
   results->reserve(inputs.size());
 
   // Call builder and runner
+  MeasurePipelineStats stats;
+  auto tic = std::chrono::high_resolution_clock::now();
   Array<BuildResult> build_res_batch = builder->Build(inputs, verbose);
+  stats.build_time = SecondsSince(tic);
+  tic = std::chrono::high_resolution_clock::now();
   Array<MeasureResult> result_batch = runner->Run(inputs, build_res_batch, verbose);
+  stats.run_time = SecondsSince(tic);
+  stats.num_batches = 1;
+  GlobalMeasurePipelineStats::Global()->Add(stats);
 
   // Store result batch
   for (auto& res : result_batch) {
@@ -285,6 +368,139 @@ void ProgramMeasurerNode::SilentMeasure(const SearchTask& task, const Array<Meas
   }
 }
 
+void ProgramMeasurerNode::PipelinedMeasure(
+    const std::vector<Array<MeasureInput>>& input_batches,
+    const std::function<void(const Array<MeasureInput>&, const Array<MeasureResult>&)>&
+        on_batch) {
+  using Clock = std::chrono::high_resolution_clock;
+  size_t n_batches = input_batches.size();
+  std::vector<ProgramRunner> runners{runner};
+  runners.insert(runners.end(), extra_runners.begin(), extra_runners.end());
+
+  // All the fields below are guarded by mutex
+  std::mutex mutex;
+  std::condition_variable cv;
+  // The built batches waiting for a runner, at most pipeline_depth of them
+  std::deque<std::pair<size_t, Array<BuildResult>>> built;
+  std::vector<Array<MeasureResult>> run_results(n_batches);
+  std::vector<bool> finished(n_batches, false);
+  bool build_done = false;
+  bool stop = false;
+  std::exception_ptr error;
+  MeasurePipelineStats stats;
+
+  auto fail = [&](std::exception_ptr e) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) {
+        error = e;
+      }
+      stop = true;
+    }
+    cv.notify_all();
+  };
+
+  // The builder streams the built batches into the queue, and blocks when it is full
+  std::thread build_thread([&]() {
+    try {
+      for (size_t i = 0; i < n_batches; ++i) {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          auto tic = Clock::now();
+          cv.wait(lock, [&]() { return stop || static_cast<int>(built.size()) < pipeline_depth; });
+          stats.build_stall_time += SecondsSince(tic);
+          if (stop) {
+            break;
+          }
+        }
+        auto tic = Clock::now();
+        Array<BuildResult> build_results = builder->Build(input_batches[i], verbose);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stats.build_time += SecondsSince(tic);
+          built.emplace_back(i, std::move(build_results));
+        }
+        cv.notify_all();
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      build_done = true;
+    }
+    cv.notify_all();
+  });
+
+  // Every runner takes the oldest built batch
+  std::vector<std::thread> run_threads;
+  for (const ProgramRunner& batch_runner : runners) {
+    run_threads.emplace_back([&, batch_runner]() {
+      try {
+        while (true) {
+          size_t i;
+          Array<BuildResult> build_results;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto tic = Clock::now();
+            cv.wait(lock, [&]() { return stop || !built.empty() || build_done; });
+            stats.run_stall_time += SecondsSince(tic);
+            if (stop || built.empty()) {
+              break;
+            }
+            i = built.front().first;
+            build_results = std::move(built.front().second);
+            built.pop_front();
+          }
+          // A slot in the queue is free for the builder
+          cv.notify_all();
+
+          auto tic = Clock::now();
+          Array<MeasureResult> results =
+              batch_runner->Run(input_batches[i], build_results, verbose);
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.run_time += SecondsSince(tic);
+            run_results[i] = std::move(results);
+            finished[i] = true;
+          }
+          cv.notify_all();
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+    });
+  }
+
+  // Process the results in the calling thread, in the order of the batches
+  try {
+    for (size_t i = 0; i < n_batches; ++i) {
+      Array<MeasureResult> results;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return stop || finished[i]; });
+        if (!finished[i]) {
+          break;
+        }
+        results = run_results[i];
+      }
+      on_batch(input_batches[i], results);
+    }
+  } catch (...) {
+    fail(std::current_exception());
+  }
+
+  build_thread.join();
+  for (auto& thread : run_threads) {
+    thread.join();
+  }
+  stats.num_batches = n_batches;
+  GlobalMeasurePipelineStats::Global()->Add(stats);
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 /********** Printing functions **********/
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
     .set_dispatch<MeasureInputNode>([](const ObjectRef& ref, ReprPrinter* p) {
@@ -305,8 +521,11 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
             p->stream << ",";
           }
         }
-        p->stream.precision(old_config);
         p->stream << "], ";
+        if (node->costs.size() > 1) {
+          p->stream << "std:" << FloatArrayStd(node->costs) << ", ";
+        }
+        p->stream.precision(old_config);
         p->stream << "error_no:" << 0 << ", "
                   << "all_cost:" << node->all_cost << ", "
                   << "Tstamp:" << node->timestamp << ")";
@@ -359,18 +578,36 @@ TVM_REGISTER_GLOBAL("auto_scheduler.LocalBuilder")
 
 TVM_REGISTER_GLOBAL("auto_scheduler.LocalRunner")
     .set_body_typed([](int timeout, int number, int repeat, int min_repeat_ms,
-                       double cooldown_interval, bool enable_cpu_cache_flush) {
+                       double cooldown_interval, bool enable_cpu_cache_flush, double max_rel_ci,
+                       int max_repeat) {
       return LocalRunner(timeout, number, repeat, min_repeat_ms, cooldown_interval,
-                         enable_cpu_cache_flush);
+                         enable_cpu_cache_flush, max_rel_ci, max_repeat);
     });
 
 TVM_REGISTER_GLOBAL("auto_scheduler.RPCRunner")
     .set_body_typed([](const String& key, const String& host, int port, int priority,
                        int n_parallel, int timeout, int number, int repeat, int min_repeat_ms,
-                       double cooldown_interval, bool enable_cpu_cache_flush) {
+                       double cooldown_interval, bool enable_cpu_cache_flush, double max_rel_ci,
+                       int max_repeat) {
       return RPCRunner(key, host, port, priority, n_parallel, timeout, number, repeat,
-                       min_repeat_ms, cooldown_interval, enable_cpu_cache_flush);
+                       min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, max_rel_ci,
+                       max_repeat);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.GetMeasurePipelineStats").set_body_typed([]() {
+  MeasurePipelineStats stats = GetMeasurePipelineStats();
+  return Map<String, PrimExpr>(
+      {{"num_batches", IntImm(DataType::Int(64), stats.num_batches)},
+       {"wall_time", FloatImm(DataType::Float(64), stats.wall_time)},
+       {"build_time", FloatImm(DataType::Float(64), stats.build_time)},
+       {"run_time", FloatImm(DataType::Float(64), stats.run_time)},
+       {"build_stall_time", FloatImm(DataType::Float(64), stats.build_stall_time)},
+       {"run_stall_time", FloatImm(DataType::Float(64), stats.run_stall_time)},
+       {"runner_wall_time", FloatImm(DataType::Float(64), stats.runner_wall_time)}});
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ResetMeasurePipelineStats")
+    .set_body_typed(ResetMeasurePipelineStats);
+
 }  // namespace auto_scheduler
 }  // namespace tvm
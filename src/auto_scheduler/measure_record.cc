@@ -19,7 +19,7 @@
 
 /*!
  * \file auto_scheduler/measure_record.cc
- * \brief Json serialization format for dumping and loading tuning records.
+ * \brief Json and binary serialization formats for dumping and loading tuning records.
  */
 
 #include <dmlc/json.h>
@@ -28,7 +28,9 @@
 #include <tvm/auto_scheduler/transform_step.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -257,24 +259,239 @@ void ReadMeasureRecord(const std::string& str, MeasureInputNode* inp, MeasureRes
   }
 }
 
+/********** Binary format **********/
+// A binary file is the magic number and the log version, followed by the records.
+// Every record is its payload size followed by the payload:
+//   workload_key, target, target_kind, error_no, mean_cost,  // the header used by the index
+//   costs, all_cost, timestamp, steps                        // steps are in the json format
+// Integers and doubles are stored in the native byte order, strings and arrays are
+// prefixed by their uint64 length.
+
+namespace {
+
+template <typename T>
+void WriteBinary(std::string* buf, const T& value) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void WriteBinary(std::string* buf, const std::string& value) {
+  WriteBinary<uint64_t>(buf, value.size());
+  buf->append(value);
+}
+
+template <typename T>
+bool ReadBinary(std::istream* is, T* value) {
+  return static_cast<bool>(is->read(reinterpret_cast<char*>(value), sizeof(T)));
+}
+
+bool ReadBinary(std::istream* is, std::string* value) {
+  uint64_t size;
+  if (!ReadBinary(is, &size)) {
+    return false;
+  }
+  value->resize(size);
+  return size == 0 || static_cast<bool>(is->read(&(*value)[0], size));
+}
+
+/*! \brief The header of a binary record. */
+struct BinaryRecordHeader {
+  std::string workload_key;
+  std::string target;
+  std::string target_kind;
+  int32_t error_no;
+  double mean_cost;
+
+  bool Read(std::istream* is) {
+    return ReadBinary(is, &workload_key) && ReadBinary(is, &target) &&
+           ReadBinary(is, &target_kind) && ReadBinary(is, &error_no) &&
+           ReadBinary(is, &mean_cost);
+  }
+};
+
+/*! \brief Mean cost of a measurement, errors are the most expensive. */
+double MeanCost(const MeasureResultNode& res) {
+  return res.error_no == 0 ? FloatArrayMean(res.costs) : std::numeric_limits<double>::max();
+}
+
+void WriteBinaryRecord(std::string* buf, const MeasureInputNode& inp,
+                       const MeasureResultNode& res) {
+  std::string payload;
+  WriteBinary(&payload, std::string(inp.task->workload_key));
+  WriteBinary(&payload, inp.task->target->str());
+  WriteBinary(&payload, std::string(inp.task->target->kind->name));
+  WriteBinary<int32_t>(&payload, res.error_no);
+  WriteBinary(&payload, MeanCost(res));
+  WriteBinary<uint64_t>(&payload, res.costs.size());
+  for (const auto& x : res.costs) {
+    auto pf = x.as<FloatImmNode>();
+    CHECK(pf != nullptr) << "Cost can only contain float values";
+    WriteBinary(&payload, pf->value);
+  }
+  WriteBinary(&payload, res.all_cost);
+  WriteBinary(&payload, res.timestamp);
+  std::ostringstream steps;
+  dmlc::JSONWriter writer(&steps);
+  writer.Write(inp.state->transform_steps);
+  WriteBinary(&payload, steps.str());
+
+  WriteBinary(buf, payload);
+}
+
+void ReadBinaryRecord(const std::string& payload, MeasureInputNode* inp,
+                      MeasureResultNode* res) {
+  std::istringstream is(payload);
+  BinaryRecordHeader header;
+  uint64_t num_costs;
+  std::string steps;
+  CHECK(header.Read(&is) && ReadBinary(&is, &num_costs)) << "Corrupted binary record";
+  res->costs.clear();
+  for (uint64_t i = 0; i < num_costs; ++i) {
+    double cost;
+    CHECK(ReadBinary(&is, &cost)) << "Corrupted binary record";
+    res->costs.push_back(FloatImm(DataType::Float(64), cost));
+  }
+  CHECK(ReadBinary(&is, &res->all_cost) && ReadBinary(&is, &res->timestamp) &&
+        ReadBinary(&is, &steps))
+      << "Corrupted binary record";
+  res->error_no = header.error_no;
+  res->error_msg = "";
+
+  auto task_node = make_object<SearchTaskNode>();
+  task_node->workload_key = std::move(header.workload_key);
+  task_node->target = Target::Create(header.target);
+  auto state_node = make_object<StateNode>();
+  state_node->concrete = true;
+  std::istringstream steps_is(steps);
+  dmlc::JSONReader reader(&steps_is);
+  reader.Read(&state_node->transform_steps);
+
+  inp->task = SearchTask(task_node);
+  inp->state = State(state_node);
+}
+
+/*! \brief Whether a new log file with this name should be in the binary format. */
+bool IsBinaryRecordFileName(const std::string& filename) {
+  const std::string suffix = ".bin";
+  return filename.size() >= suffix.size() &&
+         filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+void WriteBinaryRecordHeader(std::ostream* os) {
+  std::string buf;
+  WriteBinary(&buf, kAutoSchedulerBinaryLogMagic);
+  WriteBinary(&buf, AUTO_SCHEDULER_LOG_VERSION);
+  os->write(buf.data(), buf.size());
+}
+
+void WriteBinaryMeasureRecords(std::ostream* os, const Array<MeasureInput>& inputs,
+                               const Array<MeasureResult>& results) {
+  std::string buf;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    WriteBinaryRecord(&buf, *inputs[i].operator->(), *results[i].operator->());
+  }
+  os->write(buf.data(), buf.size());
+}
+
+void AppendMeasureRecords(const std::string& filename, const Array<MeasureInput>& inputs,
+                          const Array<MeasureResult>& results) {
+  bool binary, empty;
+  {
+    std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+    uint64_t magic;
+    empty = !ifs.is_open() || ifs.peek() == std::ifstream::traits_type::eof();
+    binary = empty ? IsBinaryRecordFileName(filename)
+                   : ReadBinary(&ifs, &magic) && magic == kAutoSchedulerBinaryLogMagic;
+  }
+  if (binary) {
+    std::ofstream ofs(filename, std::ofstream::app | std::ofstream::binary);
+    if (empty) {
+      WriteBinaryRecordHeader(&ofs);
+    }
+    WriteBinaryMeasureRecords(&ofs, inputs, results);
+  } else {
+    std::ofstream ofs(filename, std::ofstream::app);
+    WriteMeasureRecords(&ofs, inputs, results);
+  }
+}
+
+int64_t ConvertMeasureRecords(const std::string& src, const std::string& dst, bool binary) {
+  const size_t batch_size = 1024;
+  RecordReader reader(src);
+  std::ofstream ofs(dst, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+  CHECK(ofs.is_open()) << "Cannot open " << dst;
+  if (binary) {
+    WriteBinaryRecordHeader(&ofs);
+  }
+
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  int64_t ct = 0;
+  auto flush = [&]() {
+    if (binary) {
+      WriteBinaryMeasureRecords(&ofs, inputs, results);
+    } else {
+      WriteMeasureRecords(&ofs, inputs, results);
+    }
+    inputs.clear();
+    results.clear();
+  };
+  while (reader->ReadNext(inp.get(), res.get())) {
+    inputs.push_back(inp->copy());
+    results.push_back(res->copy());
+    ct++;
+    if (inputs.size() >= batch_size) {
+      flush();
+    }
+  }
+  flush();
+  return ct;
+}
+
 void RecordToFileNode::Callback(const SearchPolicy& policy, const Array<MeasureInput>& inputs,
                                 const Array<MeasureResult>& results) {
-  std::ofstream ofs(filename, std::ofstream::app);
-  WriteMeasureRecords(&ofs, inputs, results);
+  AppendMeasureRecords(filename, inputs, results);
 }
 
 RecordReader::RecordReader(String filename) {
   auto node = make_object<RecordReaderNode>();
   node->filename = filename;
-  node->infile.open(filename, std::ifstream::in);
+  node->infile.open(filename, std::ifstream::in | std::ifstream::binary);
+  node->Init();
   data_ = std::move(node);
 }
 
 RecordReaderNode::~RecordReaderNode() { infile.close(); }
 
-bool RecordReaderNode::ReadNext(MeasureInputNode* inp, MeasureResultNode* res) {
+void RecordReaderNode::Init() {
+  uint64_t magic;
   std::string log_version;
+  if (ReadBinary(&infile, &magic) && magic == kAutoSchedulerBinaryLogMagic) {
+    CHECK(ReadBinary(&infile, &log_version)) << "Corrupted binary log file " << filename;
+    binary_ = true;
+    data_begin_ = infile.tellg();
+  } else {
+    infile.clear();
+    infile.seekg(0);
+    binary_ = false;
+    data_begin_ = 0;
+  }
+}
 
+bool RecordReaderNode::ReadAtCursor(MeasureInputNode* inp, MeasureResultNode* res) {
+  if (binary_) {
+    // A truncated record at the end is left by an interrupted writer, stop there
+    if (!ReadBinary(&infile, &cur_line_)) {
+      return false;
+    }
+    ReadBinaryRecord(cur_line_, inp, res);
+    return true;
+  }
+
+  std::string log_version;
   while (std::getline(infile, cur_line_)) {
     if (cur_line_[0] == '#' || cur_line_[0] == ' ') {
       // skip comment lines begin with '#' or ' '
@@ -287,6 +504,10 @@ bool RecordReaderNode::ReadNext(MeasureInputNode* inp, MeasureResultNode* res) {
   return false;
 }
 
+bool RecordReaderNode::ReadNext(MeasureInputNode* inp, MeasureResultNode* res) {
+  return ReadAtCursor(inp, res);
+}
+
 std::pair<Array<MeasureInput>, Array<MeasureResult>> RecordReaderNode::ReadLines(int max_size,
                                                                                  int skip_size) {
   auto inp = make_object<MeasureInputNode>();
@@ -311,6 +532,128 @@ std::pair<Array<MeasureInput>, Array<MeasureResult>> RecordReaderNode::ReadLines
   return std::make_pair(inputs, results);
 }
 
+void RecordReaderNode::BuildIndex() {
+  if (indexed_) {
+    return;
+  }
+  infile.clear();
+  std::streampos cursor = infile.tellg();
+  infile.seekg(0, std::ifstream::end);
+  int64_t file_size = infile.tellg();
+  infile.seekg(data_begin_);
+
+  while (true) {
+    IndexEntry entry;
+    entry.offset = infile.tellg();
+    if (entry.offset < 0) {
+      break;
+    }
+    std::string workload_key;
+    if (binary_) {
+      // Only read the header and jump over the rest of the payload
+      uint64_t size;
+      BinaryRecordHeader header;
+      if (!ReadBinary(&infile, &size) ||
+          entry.offset + static_cast<int64_t>(sizeof(size) + size) > file_size ||
+          !header.Read(&infile)) {
+        break;
+      }
+      infile.seekg(entry.offset + sizeof(size) + size);
+      workload_key = std::move(header.workload_key);
+      entry.target_kind = std::move(header.target_kind);
+      entry.error_no = header.error_no;
+      entry.mean_cost = header.mean_cost;
+    } else {
+      if (!std::getline(infile, cur_line_)) {
+        break;
+      }
+      if (cur_line_[0] == '#' || cur_line_[0] == ' ') {
+        continue;
+      }
+      auto inp = make_object<MeasureInputNode>();
+      auto res = make_object<MeasureResultNode>();
+      std::string log_version;
+      ReadMeasureRecord(cur_line_, inp.get(), res.get(), &log_version);
+      workload_key = inp->task->workload_key;
+      entry.target_kind = inp->task->target->kind->name;
+      entry.error_no = res->error_no;
+      entry.mean_cost = MeanCost(*res);
+    }
+    workload_index_[workload_key].push_back(index_.size());
+    index_.push_back(std::move(entry));
+  }
+
+  infile.clear();
+  infile.seekg(cursor);
+  indexed_ = true;
+}
+
+int64_t RecordReaderNode::NumRecords() {
+  BuildIndex();
+  return index_.size();
+}
+
+void RecordReaderNode::ReadRecord(int64_t index, MeasureInputNode* inp, MeasureResultNode* res) {
+  BuildIndex();
+  CHECK(index >= 0 && index < static_cast<int64_t>(index_.size()))
+      << "Record index " << index << " is out of range [0, " << index_.size() << ")";
+  infile.clear();
+  std::streampos cursor = infile.tellg();
+  infile.seekg(index_[index].offset);
+  CHECK(ReadAtCursor(inp, res)) << "Failed to read record " << index << " from " << filename;
+  infile.clear();
+  infile.seekg(cursor);
+}
+
+std::vector<int64_t> RecordReaderNode::FindRecords(const std::string& workload_key) {
+  BuildIndex();
+  auto it = workload_index_.find(workload_key);
+  return it == workload_index_.end() ? std::vector<int64_t>() : it->second;
+}
+
+std::vector<std::string> RecordReaderNode::WorkloadKeys() {
+  BuildIndex();
+  std::vector<std::string> ret;
+  ret.reserve(workload_index_.size());
+  for (const auto& kv : workload_index_) {
+    ret.push_back(kv.first);
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+bool RecordReaderNode::ReadBest(const std::string& workload_key, const std::string& target_kind,
+                                MeasureInputNode* inp, MeasureResultNode* res) {
+  BuildIndex();
+  int64_t best = -1;
+  auto visit = [&](int64_t i) {
+    const IndexEntry& entry = index_[i];
+    if (entry.error_no != 0 || (!target_kind.empty() && entry.target_kind != target_kind)) {
+      return;
+    }
+    if (best < 0 || entry.mean_cost < index_[best].mean_cost) {
+      best = i;
+    }
+  };
+  if (workload_key.empty()) {
+    for (size_t i = 0; i < index_.size(); ++i) {
+      visit(i);
+    }
+  } else {
+    auto it = workload_index_.find(workload_key);
+    if (it != workload_index_.end()) {
+      for (int64_t i : it->second) {
+        visit(i);
+      }
+    }
+  }
+  if (best < 0) {
+    return false;
+  }
+  ReadRecord(best, inp, res);
+  return true;
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.RecordToFile").set_body_typed([](const String& filename) {
   return RecordToFile(filename);
 });
@@ -335,10 +678,49 @@ TVM_REGISTER_GLOBAL("auto_scheduler.RecordReaderReadNext").set_body_typed([](Rec
   }
 });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordReaderIsBinary").set_body_typed([](RecordReader reader) {
+  return reader->IsBinary();
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordReaderNumRecords")
+    .set_body_typed([](RecordReader reader) { return reader->NumRecords(); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordReaderReadRecord")
+    .set_body_typed([](RecordReader reader, int64_t index) {
+      auto inp = make_object<MeasureInputNode>();
+      auto res = make_object<MeasureResultNode>();
+      reader->ReadRecord(index, inp.get(), res.get());
+      return Array<ObjectRef>{ObjectRef(inp), ObjectRef(res)};
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordReaderFindRecords")
+    .set_body_typed([](RecordReader reader, String workload_key) {
+      Array<Integer> ret;
+      for (int64_t i : reader->FindRecords(workload_key)) {
+        ret.push_back(Integer(static_cast<int>(i)));
+      }
+      return ret;
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordReaderReadBest")
+    .set_body_typed([](RecordReader reader, String workload_key, String target_kind) {
+      auto inp = make_object<MeasureInputNode>();
+      auto res = make_object<MeasureResultNode>();
+      if (reader->ReadBest(workload_key, target_kind, inp.get(), res.get())) {
+        return Array<ObjectRef>{ObjectRef(inp), ObjectRef(res)};
+      } else {
+        return Array<ObjectRef>();
+      }
+    });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.SaveRecords")
     .set_body_typed([](String filename, Array<MeasureInput> in, Array<MeasureResult> res) {
-      std::ofstream ofs(filename, std::ofstream::app);
-      WriteMeasureRecords(&ofs, in, res);
+      AppendMeasureRecords(filename, in, res);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ConvertRecords")
+    .set_body_typed([](String src, String dst, bool binary) {
+      return ConvertMeasureRecords(src, dst, binary);
     });
 }  // namespace auto_scheduler
 }  // namespace tvm
@@ -26,6 +26,11 @@
 #include <tvm/auto_scheduler/search_policy.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "utils.h"
 
 namespace tvm {
@@ -34,19 +39,20 @@ namespace auto_scheduler {
 TVM_REGISTER_OBJECT_TYPE(SearchCallbackNode);
 TVM_REGISTER_OBJECT_TYPE(SearchPolicyNode);
 TVM_REGISTER_OBJECT_TYPE(PreloadMeasuredStatesNode);
+TVM_REGISTER_OBJECT_TYPE(PreloadSimilarStatesNode);
 
 void SearchPolicyNode::PreloadMeasuredStates(const String& log_file) {
   RecordReader reader = RecordReader(log_file);
-  const auto& res = reader->ReadLines(-1);
-  size_t log_size = res.first.size();
-  CHECK_EQ(log_size, res.second.size());
-  if (log_size) {
+  // Only the records of this workload are parsed, the index of a binary log skips the others
+  const auto& record_ids = reader->FindRecords(search_task->workload_key);
+  if (record_ids.size()) {
+    auto inp = make_object<MeasureInputNode>();
+    auto res = make_object<MeasureResultNode>();
     Array<State> measured_states;
     std::vector<float> measured_throughputs;
-    for (size_t i = 0; i < log_size; i++) {
-      const auto& inp = res.first[i];
-      if (inp->task->workload_key == search_task->workload_key &&
-          inp->task->target->kind->name.compare(search_task->target->kind->name) == 0) {
+    for (int64_t record_id : record_ids) {
+      reader->ReadRecord(record_id, inp.get(), res.get());
+      if (inp->task->target->kind->name.compare(search_task->target->kind->name) == 0) {
         State state = search_task->compute_dag->init_state;
         auto pstate = state.CopyOnWrite();
         pstate->transform_steps = inp->state->transform_steps;
@@ -54,17 +60,15 @@ void SearchPolicyNode::PreloadMeasuredStates(const String& log_file) {
           StepApplyToState(step, &state, search_task->compute_dag);
         }
         measured_states.push_back(std::move(state));
-        measured_throughputs.push_back(
-            res.second[i]->error_no == 0 ? (1.0 / FloatArrayMean(res.second[i]->costs)) : 0.0);
+        measured_throughputs.push_back(res->error_no == 0 ? (1.0 / FloatArrayMean(res->costs))
+                                                          : 0.0);
       }
     }
     // We can assume the recorded states will all be valid after infer bound
     measured_states = search_task->compute_dag.InferBound(measured_states);
     for (size_t i = 0; i < measured_states.size(); i++) {
       auto& state = measured_states[i];
-      const auto& state_str = state.ToStr();
-      if (!measured_states_set_.count(state_str)) {
-        measured_states_set_.insert(state_str);
+      if (measured_states_set_.insert(state.Fingerprint()).second) {
         if (measured_throughputs[i] != 0.0) {
           measured_states_vector_.emplace_back(std::move(state));
           measured_states_throughputs_.emplace_back(measured_throughputs[i]);
@@ -81,6 +85,88 @@ void SearchPolicyNode::PreloadMeasuredStates(const String& log_file) {
   }
 }
 
+void SearchPolicyNode::PreloadSimilarStates(const String& log_file, int max_states_per_workload) {
+  const auto* workload_key_to_tensors =
+      tvm::runtime::Registry::Get("auto_scheduler.workload_key_to_tensors");
+  CHECK(workload_key_to_tensors != nullptr);
+
+  RecordReader reader = RecordReader(log_file);
+  const String& structural_key = search_task->compute_dag.GetStructuralKey();
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  // The transferred states of every similar workload, from the best to the worst
+  std::vector<std::vector<State>> states_per_workload;
+  for (const auto& workload_key : reader->WorkloadKeys()) {
+    if (workload_key == search_task->workload_key) {
+      continue;
+    }
+    ComputeDAG dag;
+    try {
+      Array<te::Tensor> tensors = (*workload_key_to_tensors)(workload_key);
+      dag = ComputeDAG(tensors);
+    } catch (dmlc::Error& e) {
+      // The workload is not registered in this process
+      continue;
+    }
+    if (dag.GetStructuralKey() != structural_key) {
+      continue;
+    }
+
+    Array<MeasureInput> inputs;
+    std::vector<std::pair<double, int>> costs;
+    for (int64_t record_id : reader->FindRecords(workload_key)) {
+      reader->ReadRecord(record_id, inp.get(), res.get());
+      if (res->error_no != 0 ||
+          inp->task->target->kind->name != search_task->target->kind->name) {
+        continue;
+      }
+      costs.emplace_back(FloatArrayMean(res->costs), inputs.size());
+      inputs.push_back(inp->copy());
+      transferred_inputs_.push_back(inputs.back());
+      transferred_results_.push_back(res->copy());
+    }
+    std::sort(costs.begin(), costs.end());
+
+    Array<State> states;
+    for (size_t i = 0; i < costs.size() && static_cast<int>(i) < max_states_per_workload; ++i) {
+      State state = TransferState(inputs[costs[i].second]->state, search_task->compute_dag);
+      if (state.defined()) {
+        states.push_back(std::move(state));
+      }
+    }
+    states = search_task->compute_dag.InferBound(states);
+    std::vector<State> valid_states;
+    for (const auto& state : states) {
+      if (state.defined()) {
+        valid_states.push_back(state);
+      }
+    }
+    if (!valid_states.empty()) {
+      states_per_workload.push_back(std::move(valid_states));
+    }
+  }
+
+  // Interleave the workloads so that the best states of all of them come first
+  std::unordered_set<uint64_t> added;
+  for (size_t rank = 0, left = states_per_workload.size(); left > 0; ++rank) {
+    left = 0;
+    for (const auto& states : states_per_workload) {
+      if (rank < states.size()) {
+        left++;
+        if (added.insert(states[rank].Fingerprint()).second) {
+          transferred_states_.push_back(states[rank]);
+        }
+      }
+    }
+  }
+  PruneInvalidState(search_task, &transferred_states_);
+
+  StdCout(verbose) << "SearchPolicy: Transferred " << transferred_states_.size() << " states and "
+                   << transferred_inputs_.size() << " measurement records of "
+                   << states_per_workload.size() << " similar workloads from " << log_file
+                   << " for " << search_task->workload_key << std::endl;
+}
+
 void SearchPolicyNode::RunCallbacks(const Array<SearchCallback>& callbacks) {
   for (const auto& callback : callbacks) {
     callback->Callback(this);
@@ -97,6 +183,17 @@ void PreloadMeasuredStatesNode::Callback(SearchPolicyNode* policy) {
   policy->PreloadMeasuredStates(filename);
 }
 
+PreloadSimilarStates::PreloadSimilarStates(String filename, int max_states_per_workload) {
+  auto node = make_object<PreloadSimilarStatesNode>();
+  node->filename = std::move(filename);
+  node->max_states_per_workload = max_states_per_workload;
+  data_ = std::move(node);
+}
+
+void PreloadSimilarStatesNode::Callback(SearchPolicyNode* policy) {
+  policy->PreloadSimilarStates(filename, max_states_per_workload);
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.SearchPolicyRunCallbacks")
     .set_body_typed([](SearchPolicy policy, Optional<Array<SearchCallback>> callbacks) {
       if (callbacks) {
@@ -110,9 +207,17 @@ TVM_REGISTER_GLOBAL("auto_scheduler.SearchPolicySetTask")
 TVM_REGISTER_GLOBAL("auto_scheduler.SearchPolicySetVerbose")
     .set_body_typed([](SearchPolicy policy, int verbose) { policy->verbose = verbose; });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.SearchPolicyGetTransferredStates")
+    .set_body_typed([](SearchPolicy policy) { return policy->transferred_states(); });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.PreloadMeasuredStates").set_body_typed([](String filename) {
   return PreloadMeasuredStates(filename);
 });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.PreloadSimilarStates")
+    .set_body_typed([](String filename, int max_states_per_workload) {
+      return PreloadSimilarStates(filename, max_states_per_workload);
+    });
+
 }  // namespace auto_scheduler
 }  // namespace tvm
@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <iomanip>
 #include <limits>
+#include <numeric>
 #include <queue>
 #include <set>
 #include <string>
@@ -142,6 +143,7 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel schedule_cost_model,
   node->mutation_rules.push_back(&mutate_max_unroll_factor);
   node->mutation_rules.push_back(&mutate_compute_location);
   node->mutation_rules.push_back(&mutate_parallel);
+  node->mutation_rule_stats.resize(node->mutation_rules.size());
 
   data_ = std::move(node);
 }
@@ -149,6 +151,7 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel schedule_cost_model,
 State SketchPolicyNode::Search(int n_trials, int early_stopping, int num_measure_per_iter,
                                ProgramMeasurer measurer) {
   num_measure_per_iter_ = num_measure_per_iter;
+  PretrainWithTransferredRecords();
 
   if (n_trials <= 1) {
     // No measurement is allowed
@@ -172,20 +175,8 @@ State SketchPolicyNode::Search(int n_trials, int early_stopping, int num_measure
         schedule_cost_model->Update(inputs, results);
       }
 
-      // Search one round to get promising states
-      PrintTitle("Search", verbose);
-      Array<State> random_states;
-      Array<State> best_states = SearchOneRound(num_random, &random_states);
-
-      // Infer bound. This is necessary for computing the correct ToStr() for redundancy check
-      best_states = search_task->compute_dag.InferBound(best_states);
-      PruneInvalidState(search_task, &best_states);
-      random_states = search_task->compute_dag.InferBound(random_states);
-      PruneInvalidState(search_task, &random_states);
-
-      // Pick `num_measure_per_iter` states to measure, check hash to remove already measured state
-      // Also pick some random states to do eps-greedy
-      inputs = PickStatesWithEpsGreedy(best_states, random_states, n_trials - ct);
+      // Search one round to get promising states and pick the ones to measure
+      inputs = SearchAndPickStates(num_random, n_trials - ct);
 
       // Currently it's hard to detect if all of the search space has been traversed
       // Stop if no extra valid states found in several retries
@@ -226,6 +217,71 @@ State SketchPolicyNode::Search(int n_trials, int early_stopping, int num_measure
   }
 }
 
+std::pair<Array<MeasureInput>, Array<MeasureResult>> SketchPolicyNode::ContinueSearchOneRound(
+    int num_measure, ProgramMeasurer measurer) {
+  num_measure_per_iter_ = num_measure;
+  PretrainWithTransferredRecords();
+
+  int num_random =
+      static_cast<int>(GetDoubleParam(params, SketchParamKey::eps_greedy) * num_measure);
+  int empty_retry_count = GetIntParam(params, SketchParamKey::empty_retry_count);
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  do {
+    inputs = SearchAndPickStates(num_random, num_measure);
+  } while (inputs.empty() && empty_retry_count-- > 0);
+
+  if (inputs.empty()) {
+    StdCout(verbose) << "It seems all candidates in the search space have been measured."
+                     << std::endl;
+    return std::make_pair(std::move(inputs), std::move(results));
+  }
+
+  // Measure candidate states
+  PrintTitle("Measure", verbose);
+  measurer->Measure(search_task, GetRef<SearchPolicy>(this), inputs, &results);
+
+  // Update measured states throughputs. These states will join the EvolutionarySearch in later
+  // search rounds.
+  for (const auto& res : results) {
+    measured_states_throughputs_.push_back(1.0 / FloatArrayMean(res->costs));
+  }
+
+  // Retrain the cost model, so that it is up to date whenever this task is picked again
+  PrintTitle("Train cost model", verbose);
+  schedule_cost_model->Update(inputs, results);
+
+  return std::make_pair(std::move(inputs), std::move(results));
+}
+
+void SketchPolicyNode::PretrainWithTransferredRecords() {
+  if (!transferred_inputs_.empty()) {
+    // Pre-train the cost model with the records of similar workloads
+    PrintTitle("Train cost model", verbose);
+    schedule_cost_model->Update(transferred_inputs_, transferred_results_);
+    transferred_inputs_.clear();
+    transferred_results_.clear();
+  }
+}
+
+Array<MeasureInput> SketchPolicyNode::SearchAndPickStates(int num_random_states,
+                                                          int remaining_n_trials) {
+  // Search one round to get promising states
+  PrintTitle("Search", verbose);
+  Array<State> random_states;
+  Array<State> best_states = SearchOneRound(num_random_states, &random_states);
+
+  // Infer bound. This is necessary for pruning the invalid states
+  best_states = search_task->compute_dag.InferBound(best_states);
+  PruneInvalidState(search_task, &best_states);
+  random_states = search_task->compute_dag.InferBound(random_states);
+  PruneInvalidState(search_task, &random_states);
+
+  // Pick `num_measure_per_iter` states to measure, check hash to remove already measured state
+  // Also pick some random states to do eps-greedy
+  return PickStatesWithEpsGreedy(best_states, random_states, remaining_n_trials);
+}
+
 Array<State> SketchPolicyNode::SearchOneRound(int num_random_states, Array<State>* random_states) {
   // Temporal object to be used if the input pointer is nullptr
   Array<State> temp_random_states;
@@ -242,6 +298,14 @@ Array<State> SketchPolicyNode::SearchOneRound(int num_random_states, Array<State
                static_cast<int>(
                    GetDoubleParam(params, SketchParamKey::EvolutionarySearch::use_measured_ratio) *
                    population));
+  // The states transferred from similar workloads share the budget of the measured states,
+  // so they give way to the measured states of this workload as the search goes on
+  int num_use_transferred = std::min(
+      static_cast<int>(transferred_states_.size()),
+      std::max(static_cast<int>(GetDoubleParam(
+                   params, SketchParamKey::EvolutionarySearch::use_measured_ratio) *
+                   population) - num_use_measured,
+               0));
   bool is_cost_model_reasonable = !schedule_cost_model->IsInstance<RandomModelNode>();
 
   // 1. Generate sketches
@@ -249,7 +313,12 @@ Array<State> SketchPolicyNode::SearchOneRound(int num_random_states, Array<State
 
   // 2. Sample the init population
   Array<State> init_population = SampleInitPopulation(
-      sketches, is_cost_model_reasonable ? population - num_use_measured : population);
+      sketches, (is_cost_model_reasonable ? population - num_use_measured : population) -
+                    num_use_transferred);
+  // Also insert the best states transferred from similar workloads
+  for (int i = 0; i < num_use_transferred; i++) {
+    init_population.push_back(transferred_states_[i]);
+  }
 
   // 3. If the cost model is useless (i.e. RandomCostModel), just random pick some generated
   // states, else perform evolutionary search
@@ -382,6 +451,10 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
   size_t population = init_population.size();
   int num_iters = GetIntParam(params, SketchParamKey::EvolutionarySearch::num_iters);
   double mutation_prob = GetDoubleParam(params, SketchParamKey::EvolutionarySearch::mutation_prob);
+  bool adaptive_mutation =
+      GetIntParam(params, SketchParamKey::EvolutionarySearch::adaptive_mutation);
+  double reward_decay =
+      GetDoubleParam(params, SketchParamKey::EvolutionarySearch::mutation_reward_decay);
 
   // Two ping pong buffers to avoid copy.
   Array<State> states_buf1{init_population}, states_buf2;
@@ -391,7 +464,7 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
   Array<State>* pnext = &states_buf2;
 
   // The set of explored states to avoid redundancy.
-  std::unordered_set<std::string> explored_set;
+  std::unordered_set<uint64_t> explored_set;
 
   // The heap to maintain the so far best states.
   using StateHeapItem = std::pair<State, float>;
@@ -405,13 +478,11 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
     float max_score = 0.0;
     for (size_t i = 0; i < states.size(); ++i) {
       const State& state = states[i];
-      std::string state_str = state.ToStr();
 
       // Skip redundant states.
-      if (explored_set.count(state_str) > 0) {
+      if (!explored_set.insert(state.Fingerprint()).second) {
         continue;
       }
-      explored_set.insert(state_str);
 
       if (static_cast<int>(heap.size()) < out_size) {
         // Directly push item if the heap is not full yet.
@@ -451,12 +522,24 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
 
   // Mutation rule selection probabilities.
   std::vector<double> rule_select_probs;
-  rule_select_probs.reserve(mutation_rules.size());
-  std::vector<float> rule_levels;
-  for (const auto& rule : mutation_rules) {
-    rule_levels.push_back(rule->GetLevel(search_task));
-  }
-  assign_prob(rule_levels, &rule_select_probs);
+  auto assign_rule_prob = [this, &rule_select_probs]() {
+    rule_select_probs = GetMutationRuleProbs();
+    std::partial_sum(rule_select_probs.begin(), rule_select_probs.end(),
+                     rule_select_probs.begin());
+    // Make the last prefix sum exactly 1 despite the rounding errors.
+    double total = rule_select_probs.back();
+    for (auto& prob : rule_select_probs) {
+      prob /= total;
+    }
+  };
+  assign_rule_prob();
+
+  // The rule that mutated each new state (-1 for an unmutated one) and the score of its parent,
+  // used to reward the rules whose mutations are scored higher than their parents.
+  std::vector<int> origin_rules;
+  std::vector<float> parent_scores;
+  std::vector<int> rule_tries(mutation_rules.size());
+  std::vector<int> kept_indices;
 
   // Evaluate the init populations.
   *pnow = search_task->compute_dag.InferBound(*pnow);
@@ -476,32 +559,64 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
 
     // Perform mutations.
     size_t fail_ct = 0;
+    origin_rules.clear();
+    parent_scores.clear();
+    std::fill(rule_tries.begin(), rule_tries.end(), 0);
     while (pnext->size() < population && fail_ct < population * 2) {
       // Select a state to be mutated.
-      State tmp_s = (*pnow)[RandomChoose(state_select_probs, &rand_gen)];
+      int parent_id = RandomChoose(state_select_probs, &rand_gen);
+      State tmp_s = (*pnow)[parent_id];
       if (uniform_dist(rand_gen) < mutation_prob) {
         // Select a rule and mutate the state.
-        const auto& rule = mutation_rules[RandomChoose(rule_select_probs, &rand_gen)];
-        if (rule->Apply(this, &tmp_s) == PopulationGenerationRule::ResultKind::kValid) {
+        int rule_id = RandomChoose(rule_select_probs, &rand_gen);
+        rule_tries[rule_id]++;
+        if (mutation_rules[rule_id]->Apply(this, &tmp_s) ==
+            PopulationGenerationRule::ResultKind::kValid) {
           pnext->push_back(std::move(tmp_s));
+          origin_rules.push_back(rule_id);
+          parent_scores.push_back(scores[parent_id]);
         } else {
           fail_ct++;
         }
       } else {
         // Do not mutate this state in this round.
         pnext->push_back(std::move(tmp_s));
+        origin_rules.push_back(-1);
+        parent_scores.push_back(scores[parent_id]);
       }
     }
 
     // Evaluate the new populations.
     *pnext = search_task->compute_dag.InferBound(*pnext);
-    PruneInvalidState(search_task, pnext);
+    PruneInvalidState(search_task, pnext, &kept_indices);
 
     // Throw away all states generated in this iterations if all new states are invalid.
     if (pnext->size() > 0) {
       std::swap(pnext, pnow);
       schedule_cost_model->Predict(search_task, *pnow, &scores);
 
+      if (adaptive_mutation && kept_indices.size() == pnow->size()) {
+        // Reward each rule with the fraction of its tries in this generation that improved the
+        // score. The failed and the pruned mutations count as tries without improvement.
+        std::vector<int> rule_improvements(mutation_rules.size());
+        for (size_t i = 0; i < kept_indices.size(); ++i) {
+          int rule_id = origin_rules[kept_indices[i]];
+          if (rule_id >= 0 && scores[i] > parent_scores[kept_indices[i]]) {
+            rule_improvements[rule_id]++;
+          }
+        }
+        for (size_t i = 0; i < mutation_rules.size(); ++i) {
+          if (rule_tries[i] > 0) {
+            MutationRuleStats& stats = mutation_rule_stats[i];
+            stats.num_tries += rule_tries[i];
+            stats.num_improvements += rule_improvements[i];
+            double improved_ratio = static_cast<double>(rule_improvements[i]) / rule_tries[i];
+            stats.reward = reward_decay * stats.reward + (1 - reward_decay) * improved_ratio;
+          }
+        }
+        assign_rule_prob();
+      }
+
       // Maintain the best states in the heap.
       float iter_max_score = update_heap(*pnow, scores, out_size);
       max_score = (iter_max_score > max_score) ? iter_max_score : max_score;
@@ -528,9 +643,44 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
   StdCout(verbose) << "EvolutionarySearch\t\t#s: " << best_states.size()
                    << "\tTime elapsed: " << std::fixed << std::setprecision(2) << duration
                    << std::endl;
+  if (adaptive_mutation) {
+    std::vector<double> probs = GetMutationRuleProbs();
+    StdCout(verbose) << "Mutation rules (prob/improvements/tries):";
+    for (size_t i = 0; i < mutation_rules.size(); ++i) {
+      StdCout(verbose) << "  " << mutation_rules[i]->GetName() << ": " << std::setprecision(2)
+                       << probs[i] << "/" << mutation_rule_stats[i].num_improvements << "/"
+                       << mutation_rule_stats[i].num_tries;
+    }
+    StdCout(verbose) << std::endl;
+  }
   return best_states;
 }
 
+std::vector<double> SketchPolicyNode::GetMutationRuleProbs() const {
+  bool adaptive_mutation =
+      GetIntParam(params, SketchParamKey::EvolutionarySearch::adaptive_mutation);
+  double min_weight =
+      adaptive_mutation
+          ? GetDoubleParam(params, SketchParamKey::EvolutionarySearch::mutation_min_weight)
+          : 0.0;
+
+  std::vector<double> probs;
+  double sum = 0.0;
+  for (size_t i = 0; i < mutation_rules.size(); ++i) {
+    double weight = mutation_rules[i]->GetLevel(search_task);
+    if (adaptive_mutation) {
+      weight *= min_weight + mutation_rule_stats[i].reward;
+    }
+    probs.push_back(weight);
+    sum += weight;
+  }
+  CHECK_GT(sum, 0) << "All mutation rules have zero weight";
+  for (auto& prob : probs) {
+    prob /= sum;
+  }
+  return probs;
+}
+
 Array<MeasureInput> SketchPolicyNode::PickStatesWithEpsGreedy(const Array<State>& best_states,
                                                               const Array<State>& random_states,
                                                               int remaining_n_trials) {
@@ -568,9 +718,7 @@ Array<MeasureInput> SketchPolicyNode::PickStatesWithEpsGreedy(const Array<State>
     }
 
     // Check if it has already been measured
-    std::string state_str = state.ToStr();
-    if (!measured_states_set_.count(state_str)) {
-      measured_states_set_.insert(std::move(state_str));
+    if (measured_states_set_.insert(state.Fingerprint()).second) {
       measured_states_vector_.push_back(state);
       inputs.push_back(MeasureInput(search_task, state));
     }
@@ -603,5 +751,21 @@ TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyEvolutionarySearch")
       return states;
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyGetMutationRuleStats")
+    .set_body_typed([](SketchPolicy policy) {
+      std::vector<double> probs = policy->GetMutationRuleProbs();
+      Map<String, Map<String, PrimExpr>> ret;
+      for (size_t i = 0; i < policy->mutation_rules.size(); ++i) {
+        const MutationRuleStats& stats = policy->mutation_rule_stats[i];
+        ret.Set(policy->mutation_rules[i]->GetName(),
+                Map<String, PrimExpr>(
+                    {{"num_tries", IntImm(DataType::Int(64), stats.num_tries)},
+                     {"num_improvements", IntImm(DataType::Int(64), stats.num_improvements)},
+                     {"reward", FloatImm(DataType::Float(64), stats.reward)},
+                     {"prob", FloatImm(DataType::Float(64), probs[i])}}));
+      }
+      return ret;
+    });
+
 }  // namespace auto_scheduler
 }  // namespace tvm
@@ -63,6 +63,13 @@ struct SketchParamKey {
     /*! \brief The maximum percentage of measured states in the initial population for evolutionary
      * search. */
     static constexpr const char* use_measured_ratio = "evolutionary_search_use_measured_ratio";
+    /*! \brief Whether to adapt the selection probabilities of the mutation rules online. */
+    static constexpr const char* adaptive_mutation = "evolutionary_search_adaptive_mutation";
+    /*! \brief The decay of the reward of a mutation rule per generation. */
+    static constexpr const char* mutation_reward_decay =
+        "evolutionary_search_mutation_reward_decay";
+    /*! \brief The weight kept by a mutation rule without reward, to keep exploring it. */
+    static constexpr const char* mutation_min_weight = "evolutionary_search_mutation_min_weight";
   };
 
   struct MultiLevelTiling {
@@ -80,6 +87,16 @@ struct SketchParamKey {
   static constexpr const char* disable_change_compute_location = "disable_change_compute_location";
 };
 
+/*! \brief The online statistics of a mutation rule in the evolutionary search. */
+struct MutationRuleStats {
+  /*! \brief The number of times the rule is applied. */
+  int64_t num_tries{0};
+  /*! \brief The number of mutated states that the cost model scores higher than their parents. */
+  int64_t num_improvements{0};
+  /*! \brief The exponentially decayed fraction of the improving mutations per generation. */
+  double reward{0};
+};
+
 /*!
  * \brief The search policy that searches in a hierarchical search space defined by sketches.
  * The policy randomly samples programs from the space defined by sketches
@@ -97,6 +114,8 @@ class SketchPolicyNode : public SearchPolicyNode {
   std::vector<PopulationGenerationRule*> init_rules;
   /*! \brief The rules to mutate states. */
   std::vector<PopulationMutationRule*> mutation_rules;
+  /*! \brief The statistics of each mutation rule, kept across the search rounds. */
+  std::vector<MutationRuleStats> mutation_rule_stats;
   /*! \brief Random generator. */
   std::mt19937 rand_gen;
   /*! \brief Memorize split space for Split. */
@@ -105,6 +124,9 @@ class SketchPolicyNode : public SearchPolicyNode {
   State Search(int num_measure_trials, int early_stopping, int num_measures_per_round,
                ProgramMeasurer measurer) final;
 
+  std::pair<Array<MeasureInput>, Array<MeasureResult>> ContinueSearchOneRound(
+      int num_measure, ProgramMeasurer measurer) final;
+
   /*!
    * \brief Generate sketches.
    * \return The generated sketches(states).
@@ -127,6 +149,13 @@ class SketchPolicyNode : public SearchPolicyNode {
    */
   Array<State> EvolutionarySearch(const Array<State>& init_populations, int out_size);
 
+  /*!
+   * \brief Get the selection probabilities of the mutation rules.
+   * With adaptive mutation, the level of each rule is scaled by the reward it has earned.
+   * \return The probability of each rule in mutation_rules.
+   */
+  std::vector<double> GetMutationRuleProbs() const;
+
   static constexpr const char* _type_key = "auto_scheduler.SketchPolicy";
 
   TVM_DECLARE_FINAL_OBJECT_INFO(SketchPolicyNode, SearchPolicyNode);
@@ -141,6 +170,18 @@ class SketchPolicyNode : public SearchPolicyNode {
    */
   Array<State> SearchOneRound(int num_random_states, Array<State>* random_states = nullptr);
 
+  /*!
+   * \brief Run one round of the search pipeline, infer the bounds of the resulting states and
+   * pick the ones to be measured.
+   * \param num_random_states Number of states that are picked randomly.
+   * \param remaining_n_trials The remaining number of states need to be generated.
+   * \return The states to be measured, wrapped in MeasureInput.
+   */
+  Array<MeasureInput> SearchAndPickStates(int num_random_states, int remaining_n_trials);
+
+  /*! \brief Train the cost model with the records preloaded from similar workloads, if any. */
+  void PretrainWithTransferredRecords();
+
   /*!
    * \brief Pick states from best states and random states with eps-greedy policy.
    * \param best_states States picked by cost model.
@@ -175,6 +175,9 @@ class PopulationMutationRule : public PopulationGenerationRule {
    * \return The priority level of this mutation rule. Higher the better.
    */
   virtual int GetLevel(const SearchTask& task) const = 0;
+
+  /*! \brief Get the name of this mutation rule, used in the statistics of the rules. */
+  virtual const char* GetName() const = 0;
 };
 
 // A helper to define mutation rules with a constant rule level.
@@ -183,6 +186,7 @@ class PopulationMutationRule : public PopulationGenerationRule {
    public:                                                                  \
     ResultKind Apply(SketchPolicyNode* policy, State* state) const final;   \
     int GetLevel(const SearchTask& task) const final { return rule_level; } \
+    const char* GetName() const final { return #rule_name; }                \
   };
 
 /*! \brief The rule that mutates tile size by randomly dividing a tile size by a factor
@@ -197,6 +201,7 @@ class MutateMaxUnrollFactor : public PopulationMutationRule {
  public:
   ResultKind Apply(SketchPolicyNode* policy, State* state) const final;
   int GetLevel(const SearchTask& task) const final { return 10; }
+  const char* GetName() const final { return "MutateMaxUnrollFactor"; }
 
   const std::vector<int> cpu_unroll_cands_ = {0, 16, 64, 512, 1024};
   const std::vector<int> gpu_unroll_cands_ = {0, 16, 64, 512};
@@ -213,6 +218,7 @@ class MutateComputeLocation : public PopulationMutationRule {
     }
     return 5;
   }
+  const char* GetName() const final { return "MutateComputeLocation"; }
 };
 
 }  // namespace auto_scheduler
@@ -310,8 +310,12 @@ bool HasNestedParallel(const State& state) {
   return false;
 }
 
-void PruneInvalidState(const SearchTask& task, Array<State>* states) {
+void PruneInvalidState(const SearchTask& task, Array<State>* states,
+                       std::vector<int>* kept_indices) {
   size_t pt = 0;
+  if (kept_indices != nullptr) {
+    kept_indices->clear();
+  }
   for (size_t i = 0; i < states->size(); ++i) {
     if (!(*states)[i].defined()) {
       continue;
@@ -323,6 +327,9 @@ void PruneInvalidState(const SearchTask& task, Array<State>* states) {
     if (i != pt) {
       states->Set(pt, (*states)[i]);
     }
+    if (kept_indices != nullptr) {
+      kept_indices->push_back(static_cast<int>(i));
+    }
     pt++;
   }
 
@@ -333,6 +340,45 @@ void PruneInvalidState(const SearchTask& task, Array<State>* states) {
   }
 }
 
+State TransferState(const State& state, const ComputeDAG& dag) {
+  State ret = dag->init_state;
+  try {
+    for (const auto& step : state->transform_steps) {
+      if (auto ps = step.as<SplitStepNode>()) {
+        const Iterator& it = ret->stages[ps->stage_id]->iters[ps->iter_id];
+        const IntImmNode* extent = it->range.defined() ? it->range->extent.as<IntImmNode>()
+                                                        : nullptr;
+        if (extent == nullptr) {
+          ret.split(ps->stage_id, it, ps->lengths, ps->inner_to_outer);
+          continue;
+        }
+        // Shrink every length to the largest divisor of what is left of the new extent
+        int64_t remain = extent->value;
+        Array<Optional<Integer>> lengths;
+        for (const auto& length : ps->lengths) {
+          if (!length) {
+            lengths.push_back(length);
+            continue;
+          }
+          int64_t l = std::max<int64_t>(std::min<int64_t>(length.value()->value, remain), 1);
+          while (remain % l != 0) {
+            l--;
+          }
+          remain /= l;
+          lengths.push_back(Integer(static_cast<int>(l)));
+        }
+        ret.split(ps->stage_id, it, lengths, ps->inner_to_outer);
+      } else {
+        ret.CopyOnWrite()->transform_steps.push_back(step);
+        StepApplyToState(step, &ret, dag);
+      }
+    }
+  } catch (dmlc::Error& e) {
+    return State();
+  }
+  return ret;
+}
+
 const Array<Array<Integer>>& SplitFactorizationMemo::GetFactorizationSchemes(
     int extent, int n_lengths, int max_innermost_factor) {
   QueryKey key = std::make_tuple(extent, n_lengths, max_innermost_factor);
@@ -674,7 +674,14 @@ inline int RandomChoose(const std::vector<double>& prefix_sum_probs, std::mt1993
 }
 
 // Prune invalid states and return the results in-place.
-void PruneInvalidState(const SearchTask& task, Array<State>* states);
+// If `kept_indices` is not null, it is set to the original indices of the kept states.
+void PruneInvalidState(const SearchTask& task, Array<State>* states,
+                       std::vector<int>* kept_indices = nullptr);
+
+// Replay the transform steps of a state tuned for a structurally similar ComputeDAG on `dag`.
+// The lengths of the split steps are adapted to the new extents so that they still divide them.
+// Return an undefined state if the steps cannot be applied.
+State TransferState(const State& state, const ComputeDAG& dag);
 
 }  // namespace auto_scheduler
 }  // namespace tvm
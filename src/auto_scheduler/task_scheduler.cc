@@ -0,0 +1,303 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_scheduler/task_scheduler.cc
+ * \brief The task scheduler that allocates the tuning budget of a network across its tasks.
+ */
+
+#include <tvm/auto_scheduler/task_scheduler.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "search_policy/utils.h"
+#include "utils.h"
+
+namespace tvm {
+namespace auto_scheduler {
+
+TVM_REGISTER_NODE_TYPE(TaskSchedulerNode);
+
+/*! \brief The latency of a task which has no valid program yet. */
+static constexpr double kInvalidCost = 1e10;
+/*! \brief The number of rounds after which a task without any valid program stops. */
+static constexpr int kMaxInvalidRounds = 3;
+
+TaskScheduler::TaskScheduler(Array<SearchTask> tasks, Array<SearchPolicy> search_policies,
+                             Array<FloatImm> task_weights, String strategy, double alpha,
+                             double beta, int backward_window_size, int verbose) {
+  CHECK_EQ(tasks.size(), search_policies.size())
+      << "Every task of the TaskScheduler needs a search policy.";
+  if (task_weights.empty()) {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      task_weights.push_back(FloatImm(DataType::Float(64), 1.0));
+    }
+  }
+  CHECK_EQ(tasks.size(), task_weights.size())
+      << "Every task of the TaskScheduler needs a weight.";
+  CHECK(strategy == "gradient" || strategy == "round-robin")
+      << "Invalid task scheduling strategy: " << strategy;
+  CHECK_GT(backward_window_size, 0);
+
+  auto node = make_object<TaskSchedulerNode>();
+  node->tasks = std::move(tasks);
+  node->search_policies = std::move(search_policies);
+  node->task_weights = std::move(task_weights);
+  node->strategy = std::move(strategy);
+  node->alpha = alpha;
+  node->beta = beta;
+  node->backward_window_size = backward_window_size;
+  node->verbose = verbose;
+  data_ = std::move(node);
+}
+
+void TaskSchedulerNode::Tune(TuningOptions tuning_options) {
+  size_t n_tasks = tasks.size();
+  best_costs.assign(n_tasks, kInvalidCost);
+  task_cts.assign(n_tasks, 0);
+  task_trials.assign(n_tasks, 0);
+  cost_history_.assign(n_tasks, std::vector<double>());
+  best_trials_.assign(n_tasks, 0);
+  invalid_rounds_.assign(n_tasks, 0);
+  dead_.assign(n_tasks, false);
+  last_task_ = -1;
+  early_stopping_ = tuning_options->early_stopping < 0 ? std::numeric_limits<int>::max() >> 1
+                                                       : tuning_options->early_stopping;
+
+  // Group the tasks that share the structure and the target. The throughput of the best task in
+  // a group is a hint of what the others can reach.
+  similar_tasks_.assign(n_tasks, std::vector<int>());
+  std::unordered_map<std::string, std::vector<int>> groups;
+  for (size_t i = 0; i < n_tasks; ++i) {
+    std::string key = std::string(tasks[i]->compute_dag.GetStructuralKey()) + "/" +
+                      tasks[i]->target->str();
+    groups[key].push_back(static_cast<int>(i));
+  }
+  for (const auto& group : groups) {
+    for (int task_id : group.second) {
+      similar_tasks_[task_id] = group.second;
+    }
+  }
+
+  // All tasks share one ProgramMeasurer, which invokes the measure callbacks of every task
+  ProgramMeasurer measurer = tuning_options.MakeMeasurer();
+  measurer->Reset();
+
+  int n_trials = tuning_options->num_measure_trials;
+  int num_measure_per_round = tuning_options->num_measures_per_round;
+  int ct = 0;
+
+  // Warm up: every task gets one round so that all of them have a latency to compare with
+  for (size_t i = 0; i < n_tasks && ct < n_trials; ++i) {
+    TuneTask(i, std::min(num_measure_per_round, n_trials - ct), measurer);
+    ct += task_trials[i];
+  }
+
+  while (ct < n_trials) {
+    int task_id = PickNextTask();
+    if (task_id < 0) {
+      StdCout(verbose) << "All tasks have stopped." << std::endl;
+      break;
+    }
+    int before = task_trials[task_id];
+    TuneTask(task_id, std::min(num_measure_per_round, n_trials - ct), measurer);
+    ct += task_trials[task_id] - before;
+  }
+
+  PrintTitle("Done", verbose);
+  PrintTable();
+}
+
+void TaskSchedulerNode::TuneTask(int task_id, int num_measure, ProgramMeasurer measurer) {
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  std::tie(inputs, results) =
+      search_policies[task_id]->ContinueSearchOneRound(num_measure, measurer);
+  last_task_ = task_id;
+  task_cts[task_id]++;
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (results[i]->error_no == static_cast<int>(MeasureErrorNO::kNoError)) {
+      double cost = FloatArrayMean(results[i]->costs);
+      if (cost < best_costs[task_id]) {
+        best_costs[task_id] = cost;
+        best_trials_[task_id] = task_trials[task_id] + static_cast<int>(i) + 1;
+      }
+    }
+  }
+  task_trials[task_id] += inputs.size();
+  cost_history_[task_id].push_back(best_costs[task_id]);
+
+  // A task without any valid program is always picked first, so one whose programs keep
+  // failing would take the whole budget.
+  invalid_rounds_[task_id] = best_costs[task_id] >= kInvalidCost ? invalid_rounds_[task_id] + 1 : 0;
+
+  if (inputs.empty()) {
+    dead_[task_id] = true;
+    StdCout(verbose) << "Task #" << task_id << " stops since no new state is found." << std::endl;
+  } else if (invalid_rounds_[task_id] >= kMaxInvalidRounds) {
+    dead_[task_id] = true;
+    StdCout(verbose) << "Task #" << task_id << " stops since no valid program is found in "
+                     << invalid_rounds_[task_id] << " rounds." << std::endl;
+  } else if (task_trials[task_id] - best_trials_[task_id] > early_stopping_) {
+    dead_[task_id] = true;
+    StdCout(verbose) << "Task #" << task_id << " stops early since no performance improvement in "
+                     << "the last " << early_stopping_ << " measure steps." << std::endl;
+  }
+
+  PrintTable();
+}
+
+int TaskSchedulerNode::PickNextTask() {
+  int n_tasks = static_cast<int>(tasks.size());
+  if (strategy == "round-robin") {
+    for (int i = 1; i <= n_tasks; ++i) {
+      int task_id = (last_task_ + i) % n_tasks;
+      if (!dead_[task_id]) {
+        return task_id;
+      }
+    }
+    return -1;
+  }
+
+  // The objective is sum(w_i * cost_i). Pick the task whose next round is expected to reduce
+  // the objective the most, i.e. the task with the most negative gradient.
+  int best_id = -1;
+  double best_grad = 0;
+  for (int i = 0; i < n_tasks; ++i) {
+    if (dead_[i]) {
+      continue;
+    }
+    if (best_costs[i] >= kInvalidCost) {
+      // A task without any valid program yet blocks the estimation of the whole network
+      return i;
+    }
+    const std::vector<double>& history = cost_history_[i];
+    int window = backward_window_size;
+
+    // The backward gradient: the average improvement in the last rounds
+    double backward_grad = 0;
+    if (static_cast<int>(history.size()) > window) {
+      backward_grad = (history.back() - history[history.size() - 1 - window]) / window;
+    }
+
+    // The forward gradient: the cost is optimistically expected to drop by cost / rounds, or to
+    // what the throughput of the similar tasks suggests, whichever is lower
+    double next_cost = best_costs[i] - best_costs[i] / std::max(task_cts[i], 1);
+    if (similar_tasks_[i].size() > 1 && tasks[i]->compute_dag->flop_ct > 0) {
+      double best_flops = 0;
+      for (int j : similar_tasks_[i]) {
+        if (best_costs[j] < kInvalidCost) {
+          best_flops = std::max(best_flops, tasks[j]->compute_dag->flop_ct / best_costs[j]);
+        }
+      }
+      if (best_flops > 0) {
+        next_cost = std::min(next_cost, beta * tasks[i]->compute_dag->flop_ct / best_flops);
+      }
+    }
+    double forward_grad = next_cost - best_costs[i];
+
+    double grad =
+        task_weights[i]->value * (alpha * backward_grad + (1 - alpha) * forward_grad);
+    // Break the ties by the number of rounds, so that equal tasks are tuned in turn
+    if (best_id < 0 || grad < best_grad ||
+        (grad == best_grad && task_cts[i] < task_cts[best_id])) {
+      best_id = i;
+      best_grad = grad;
+    }
+  }
+  return best_id;
+}
+
+double TaskSchedulerNode::EstimatedLatency() const {
+  double latency = 0;
+  for (size_t i = 0; i < best_costs.size(); ++i) {
+    if (best_costs[i] < kInvalidCost) {
+      latency += task_weights[i]->value * best_costs[i];
+    }
+  }
+  return latency;
+}
+
+void TaskSchedulerNode::PrintTable() const {
+  if (verbose < 1) {
+    return;
+  }
+  PrintTitle("Task Scheduler", verbose);
+  StdCout(verbose) << "|  ID  | Latency (ms) | Speed (GFLOPS) | Trials |\n"
+                   << "------------------------------------------------\n";
+  int total_trials = 0;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    StdCout(verbose) << "| " << std::setw(4) << i << " | ";
+    if (best_costs[i] < kInvalidCost) {
+      StdCout(verbose) << std::fixed << std::setprecision(3) << std::setw(12)
+                       << best_costs[i] * 1e3 << " | " << std::setprecision(2) << std::setw(14)
+                       << tasks[i]->compute_dag->flop_ct / best_costs[i] / 1e9 << " | ";
+    } else {
+      StdCout(verbose) << std::setw(12) << "-" << " | " << std::setw(14) << "-" << " | ";
+    }
+    StdCout(verbose) << std::setw(6) << task_trials[i] << " |\n";
+    total_trials += task_trials[i];
+  }
+  StdCout(verbose) << "------------------------------------------------\n"
+                   << "Estimated total latency: " << std::fixed << std::setprecision(3)
+                   << EstimatedLatency() * 1e3 << " ms\tTrials: " << total_trials << std::endl;
+}
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TaskScheduler")
+    .set_body_typed([](Array<SearchTask> tasks, Array<SearchPolicy> search_policies,
+                       Array<FloatImm> task_weights, String strategy, double alpha, double beta,
+                       int backward_window_size, int verbose) {
+      return TaskScheduler(tasks, search_policies, task_weights, strategy, alpha, beta,
+                           backward_window_size, verbose);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TaskSchedulerTune")
+    .set_body_typed([](TaskScheduler scheduler, TuningOptions tuning_options) {
+      scheduler->Tune(tuning_options);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TaskSchedulerGetBestCosts")
+    .set_body_typed([](TaskScheduler scheduler) {
+      Array<FloatImm> costs;
+      for (double cost : scheduler->best_costs) {
+        costs.push_back(FloatImm(DataType::Float(64), cost));
+      }
+      return costs;
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TaskSchedulerGetTaskTrials")
+    .set_body_typed([](TaskScheduler scheduler) {
+      Array<Integer> trials;
+      for (int ct : scheduler->task_trials) {
+        trials.push_back(Integer(ct));
+      }
+      return trials;
+    });
+
+}  // namespace auto_scheduler
+}  // namespace tvm
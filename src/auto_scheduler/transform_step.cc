@@ -29,6 +29,7 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
 
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -121,6 +122,28 @@ const char* IteratorAnnotationString[] = {
     "tensorize"     // kTensorized = 11
 };
 
+uint64_t StepNode::Fingerprint() const {
+  uint64_t fingerprint = fingerprint_.load(std::memory_order_relaxed);
+  if (fingerprint != 0) {
+    return fingerprint;
+  }
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.BeginArray(false);
+  WriteToRecord(&writer);
+  writer.EndArray();
+  // 64-bit FNV-1a of the record.
+  fingerprint = 0xcbf29ce484222325ULL;
+  for (char c : os.str()) {
+    fingerprint = (fingerprint ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  if (fingerprint == 0) {
+    fingerprint = 1;
+  }
+  fingerprint_.store(fingerprint, std::memory_order_relaxed);
+  return fingerprint;
+}
+
 Step StepReadFromRecord(dmlc::JSONReader* reader) {
   std::string name;
   bool s;
@@ -29,6 +29,7 @@
 #include <tvm/tir/expr.h>
 
 #include <algorithm>
+#include <cmath>
 #include <deque>
 #include <exception>
 #include <future>
@@ -175,6 +176,20 @@ inline double FloatArrayMean(const Array<PrimExpr>& float_array) {
   return sum / float_array.size();
 }
 
+/*! \brief Compute the sample standard deviation of a FloatImm array */
+inline double FloatArrayStd(const Array<PrimExpr>& float_array) {
+  if (float_array.size() < 2) {
+    return 0.0;
+  }
+  double mean = FloatArrayMean(float_array);
+  double sum = 0;
+  for (const auto& x : float_array) {
+    double diff = x.as<tir::FloatImmNode>()->value - mean;
+    sum += diff * diff;
+  }
+  return std::sqrt(sum / (float_array.size() - 1));
+}
+
 /*! \brief Return whether a string starts with another substring */
 inline bool StrStartsWith(const String& a, const String& b) {
   if (b.size() > a.size()) return false;
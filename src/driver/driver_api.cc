@@ -26,14 +26,21 @@
 #include <tvm/ir/transform.h>
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/target/codegen.h>
+#include <tvm/target/target_kind.h>
 #include <tvm/te/operation.h>
 #include <tvm/tir/analysis.h>
+#include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
 #include <algorithm>
 #include <mutex>
 #include <stack>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 
@@ -44,6 +51,7 @@ TVM_REGISTER_PASS_CONFIG_OPTION("tir.instrument_bound_checkers", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.disable_assert", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.disable_vectorize", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.add_lower_pass", Array<Array<ObjectRef>>);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.num_codegen_partitions", Integer);
 
 using runtime::PackedFunc;
 using runtime::TVMArgs;
@@ -248,6 +256,89 @@ std::pair<IRModule, IRModule> SplitDevHostFuncs(IRModule mod_mixed, const Target
   return {mhost, mdevice};
 }
 
+/*!
+ * \brief Split the host functions into modules of similar size.
+ * \param mhost The host functions.
+ * \param num_partitions The maximum number of modules.
+ * \return The modules, ordered by the name of their first function.
+ */
+std::vector<IRModule> PartitionHostFuncs(const IRModule& mhost, size_t num_partitions) {
+  std::vector<std::pair<std::string, size_t>> funcs;
+  for (const auto& kv : mhost->functions) {
+    size_t cost = 0;
+    if (const auto* f = kv.second.as<tir::PrimFuncNode>()) {
+      tir::PostOrderVisit(f->body, [&cost](const ObjectRef&) { ++cost; });
+    }
+    funcs.emplace_back(kv.first->name_hint, cost);
+  }
+  // Sort by name first so that the partition does not depend on the hash map order.
+  std::sort(funcs.begin(), funcs.end());
+  std::stable_sort(funcs.begin(), funcs.end(),
+                   [](const auto& a, const auto& b) { return a.second > b.second; });
+  num_partitions = std::min(num_partitions, funcs.size());
+  // Longest processing time first: each function goes to the least loaded module.
+  std::vector<size_t> load(num_partitions, 0);
+  std::vector<Map<GlobalVar, BaseFunc>> parts(num_partitions);
+  for (const auto& it : funcs) {
+    size_t k = std::min_element(load.begin(), load.end()) - load.begin();
+    GlobalVar gvar = mhost->GetGlobalVar(it.first);
+    parts[k].Set(gvar, mhost->Lookup(gvar));
+    load[k] += it.second + 1;
+  }
+  std::vector<IRModule> ret;
+  for (const auto& part : parts) {
+    ret.push_back(IRModule(part));
+  }
+  return ret;
+}
+
+/*!
+ * \brief Generate the host module, compiling partitions of it concurrently when
+ *  "tir.num_codegen_partitions" is set. The first partition is the root, it imports
+ *  the rest, and every partition imports the device modules it may launch.
+ */
+runtime::Module BuildHostModule(const IRModule& mhost, const Target& target_host,
+                                const std::vector<runtime::Module>& device_modules,
+                                const transform::PassContext& pass_ctx) {
+  int num_partitions =
+      pass_ctx->GetConfig<Integer>("tir.num_codegen_partitions", Integer(1)).value()->value;
+  if (num_partitions <= 0) {
+    num_partitions = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  // Each LLVM module is a separate object file. A system library registers its
+  // symbols in a single constructor, so keep it in one module.
+  bool partitionable = target_host->kind->name == "llvm" &&
+                       !target_host->GetAttr<Bool>("system-lib").value_or(Bool(false)) &&
+                       target_host->GetAttr<String>("runtime").value_or("") != kTvmRuntimeCrt;
+  if (num_partitions == 1 || !partitionable || mhost->functions.size() < 2) {
+    runtime::Module ret = codegen::Build(mhost, target_host);
+    for (const auto& it : device_modules) {
+      if (it.operator->()) {
+        ret.Import(it);
+      }
+    }
+    return ret;
+  }
+
+  std::vector<IRModule> parts = PartitionHostFuncs(mhost, num_partitions);
+  std::vector<runtime::Module> modules(parts.size());
+  support::parallel_for(0, static_cast<int>(parts.size()), [&](int i) {
+    With<transform::PassContext> pass_ctx_scope(pass_ctx);
+    modules[i] = codegen::Build(parts[i], target_host);
+  });
+  for (auto& module : modules) {
+    for (const auto& it : device_modules) {
+      if (it.operator->()) {
+        module.Import(it);
+      }
+    }
+  }
+  for (size_t i = 1; i < modules.size(); ++i) {
+    modules[0].Import(modules[i]);
+  }
+  return modules[0];
+}
+
 // Build for heterogeneous execution.
 runtime::Module build(const Map<Target, IRModule>& inputs, const Target& target_host) {
   auto pass_ctx = transform::PassContext::Current();
@@ -280,14 +371,8 @@ runtime::Module build(const Map<Target, IRModule>& inputs, const Target& target_
     }
   }
 
-  runtime::Module mhost = codegen::Build(mhost_all, target_host_val);
   // Import all modules
-  for (const auto& it : device_modules) {
-    if (it.operator->()) {
-      mhost.Import(it);
-    }
-  }
-  return mhost;
+  return BuildHostModule(mhost_all, target_host_val, device_modules, pass_ctx);
 }
 
 // Build for heterogeneous execution when target is a string.
@@ -0,0 +1,408 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/compile_cache.cc
+ * \brief Persistent on-disk cache of lowered primitive functions.
+ */
+#include "compile_cache.h"
+
+#include <dmlc/memory_io.h>
+#include <tvm/ir/attrs.h>
+#include <tvm/ir/transform.h>
+#include <tvm/node/serialization.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/function.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+struct CompileCacheConfigNode : public tvm::AttrsNode<CompileCacheConfigNode> {
+  String dir;
+  int64_t max_bytes;
+  String salt;
+
+  TVM_DECLARE_ATTRS(CompileCacheConfigNode, "relay.backend.CompileCacheConfig") {
+    TVM_ATTR_FIELD(dir)
+        .describe("Directory of the persistent compile cache, the cache is disabled when empty")
+        .set_default("");
+    TVM_ATTR_FIELD(max_bytes)
+        .describe("Size budget of the cache directory in bytes, 0 means unbounded")
+        .set_default(int64_t(1) << 30);
+    TVM_ATTR_FIELD(salt)
+        .describe("Extra string mixed into every key, e.g. to separate toolchains")
+        .set_default("");
+  }
+};
+
+class CompileCacheConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(CompileCacheConfig, Attrs, CompileCacheConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(CompileCacheConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.CompileCache", CompileCacheConfig);
+
+/*! \brief Suffix of the entry files. */
+static constexpr const char* kEntrySuffix = ".tvmcc";
+
+/*! \brief FNV-1a, stable across processes unlike std::hash. */
+static uint64_t StableHash(const std::string& str) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : str) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static std::string JoinPath(const std::string& dir, const std::string& name) {
+#if defined(_WIN32)
+  return dir + "\\" + name;
+#else
+  return dir + "/" + name;
+#endif
+}
+
+static bool EnsureDirectory(const std::string& dir) {
+  struct stat sb;
+  if (stat(dir.c_str(), &sb) == 0) return (sb.st_mode & S_IFMT) == S_IFDIR;
+#if defined(_WIN32)
+  return _mkdir(dir.c_str()) == 0 || errno == EEXIST;
+#else
+  return mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+/*! \brief List the entry files of dir with their size and modification time. */
+static std::vector<std::pair<std::string, struct stat>> ListEntries(const std::string& dir) {
+  std::vector<std::string> names;
+#if defined(_WIN32)
+  WIN32_FIND_DATAA data;
+  HANDLE handle = FindFirstFileA(JoinPath(dir, std::string("*") + kEntrySuffix).c_str(), &data);
+  if (handle != INVALID_HANDLE_VALUE) {
+    do {
+      names.push_back(data.cFileName);
+    } while (FindNextFileA(handle, &data));
+    FindClose(handle);
+  }
+#else
+  if (DIR* d = opendir(dir.c_str())) {
+    while (struct dirent* ent = readdir(d)) {
+      std::string name = ent->d_name;
+      size_t n = std::char_traits<char>::length(kEntrySuffix);
+      if (name.size() > n && name.compare(name.size() - n, n, kEntrySuffix) == 0) {
+        names.push_back(name);
+      }
+    }
+    closedir(d);
+  }
+#endif
+  std::vector<std::pair<std::string, struct stat>> ret;
+  for (const std::string& name : names) {
+    struct stat sb;
+    if (stat(JoinPath(dir, name).c_str(), &sb) == 0) ret.emplace_back(name, sb);
+  }
+  return ret;
+}
+
+static bool ReadFile(const std::string& path, std::string* data) {
+  std::ifstream fs(path, std::ios::in | std::ios::binary);
+  if (fs.fail()) return false;
+  std::ostringstream os;
+  os << fs.rdbuf();
+  *data = os.str();
+  return !fs.bad();
+}
+
+/*! \brief Write through a temporary file and a rename so readers never see a partial entry. */
+static bool WriteFileAtomic(const std::string& path, const std::string& data) {
+  static std::atomic<uint64_t> counter{0};
+  std::ostringstream tmp;
+#if defined(_WIN32)
+  tmp << path << ".tmp." << _getpid() << "." << counter++;
+#else
+  tmp << path << ".tmp." << getpid() << "." << counter++;
+#endif
+  {
+    std::ofstream fs(tmp.str(), std::ios::out | std::ios::binary);
+    if (fs.fail()) return false;
+    fs.write(data.data(), data.size());
+    if (fs.fail()) {
+      fs.close();
+      std::remove(tmp.str().c_str());
+      return false;
+    }
+  }
+#if defined(_WIN32)
+  std::remove(path.c_str());
+#endif
+  if (std::rename(tmp.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+IRModule RenameLoweredFunction(const IRModule& funcs, const std::string& old_name,
+                               const std::string& new_name) {
+  if (old_name == new_name) return funcs;
+  Map<GlobalVar, BaseFunc> functions;
+  for (const auto& kv : funcs->functions) {
+    if (kv.first->name_hint != old_name) {
+      functions.Set(kv.first, kv.second);
+      continue;
+    }
+    BaseFunc func = kv.second;
+    if (const auto* prim_func = func.as<tir::PrimFuncNode>()) {
+      func = WithAttr(GetRef<tir::PrimFunc>(prim_func), tvm::attr::kGlobalSymbol,
+                      String(new_name));
+    }
+    functions.Set(GlobalVar(new_name), func);
+  }
+  return IRModule(functions);
+}
+
+PersistentCompileCache* PersistentCompileCache::Global() {
+  static PersistentCompileCache* inst = new PersistentCompileCache();
+  return inst;
+}
+
+bool PersistentCompileCache::MakeKey(const Function& source_func, const Target& target,
+                                     CompileCacheKey* key) {
+  using tvm::transform::PassContext;
+  PassContext pass_ctx = PassContext::Current();
+  auto cfg = pass_ctx->GetConfig<CompileCacheConfig>("relay.backend.CompileCache");
+  if (!cfg.defined() || cfg.value()->dir.empty()) return false;
+
+  std::ostringstream os;
+  os << "version=" << TVM_VERSION << "\ntarget=" << target->str()
+     << "\nsalt=" << cfg.value()->salt;
+  // Tuning records and tracing change what the schedules produce without changing the
+  // function, let the frontend veto caching or contribute a fingerprint.
+  if (const auto* fcontext = runtime::Registry::Get("relay.backend.compile_cache_context")) {
+    runtime::TVMRetValue context = (*fcontext)();
+    if (context.type_code() == kTVMNullptr) return false;
+    os << "\ncontext=" << context.operator std::string();
+  }
+  os << "\nopt_level=" << pass_ctx->opt_level;
+  std::vector<std::string> passes;
+  for (const String& pass : pass_ctx->required_pass) passes.push_back("+" + std::string(pass));
+  for (const String& pass : pass_ctx->disabled_pass) passes.push_back("-" + std::string(pass));
+  std::sort(passes.begin(), passes.end());
+  for (const std::string& pass : passes) os << "\npass=" << pass;
+  std::map<std::string, std::string> config;
+  for (const auto& kv : pass_ctx->config) {
+    if (kv.first == "relay.backend.CompileCache") continue;
+    config[kv.first] = SaveJSON(kv.second);
+  }
+  for (const auto& kv : config) os << "\nconfig." << kv.first << "=" << kv.second;
+
+  uint64_t func_hash = StructuralHash()(source_func);
+  os << "\nfunc=" << func_hash;
+  key->dir = cfg.value()->dir;
+  key->max_bytes = cfg.value()->max_bytes;
+  key->text = os.str();
+  std::ostringstream name;
+  name << std::hex << std::setfill('0') << std::setw(16) << func_hash << std::setw(16)
+       << StableHash(key->text) << kEntrySuffix;
+  key->file_name = name.str();
+  return true;
+}
+
+bool PersistentCompileCache::Lookup(const CompileCacheKey& key, const Function& source_func,
+                                    std::string* base_name, std::string* func_name,
+                                    IRModule* funcs) {
+  std::string path = JoinPath(key.dir, key.file_name);
+  std::string data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DirIndex* index = GetIndex(key.dir);
+    if (!ReadFile(path, &data)) {
+      misses_++;
+      return false;
+    }
+    // The entry may have been written by another process after the directory was scanned.
+    FileInfo& info = index->files[key.file_name];
+    index->total_bytes += static_cast<int64_t>(data.size()) - info.size;
+    info.size = static_cast<int64_t>(data.size());
+    info.last_use = ++clock_;
+  }
+  // Refresh the modification time so other processes see the use when evicting.
+  utime(path.c_str(), nullptr);
+  try {
+    dmlc::MemoryStringStream strm(&data);
+    uint64_t magic;
+    std::string text, source_json, base, name, funcs_json;
+    CHECK(strm.Read(&magic)) << "Invalid compile cache entry";
+    CHECK_EQ(magic, kTVMCompileCacheMagic) << "Invalid compile cache entry";
+    CHECK(strm.Read(&text)) << "Invalid compile cache entry";
+    CHECK(strm.Read(&source_json)) << "Invalid compile cache entry";
+    CHECK(strm.Read(&base)) << "Invalid compile cache entry";
+    CHECK(strm.Read(&name)) << "Invalid compile cache entry";
+    CHECK(strm.Read(&funcs_json)) << "Invalid compile cache entry";
+    // A hash collision is a miss, the entry stays for the function it belongs to.
+    if (text != key.text || !StructuralEqual()(LoadJSON(source_json), source_func)) {
+      misses_++;
+      return false;
+    }
+    *base_name = base;
+    *func_name = name;
+    *funcs = Downcast<IRModule>(LoadJSON(funcs_json));
+  } catch (const dmlc::Error& e) {
+    LOG(WARNING) << "Discarding corrupted compile cache entry " << path << ": " << e.what();
+    std::lock_guard<std::mutex> lock(mutex_);
+    DirIndex* index = GetIndex(key.dir);
+    auto it = index->files.find(key.file_name);
+    if (it != index->files.end()) {
+      index->total_bytes -= it->second.size;
+      index->files.erase(it);
+    }
+    std::remove(path.c_str());
+    errors_++;
+    misses_++;
+    return false;
+  }
+  hits_++;
+  return true;
+}
+
+void PersistentCompileCache::Insert(const CompileCacheKey& key, const Function& source_func,
+                                    const std::string& base_name, const std::string& func_name,
+                                    const IRModule& funcs) {
+  std::string data;
+  dmlc::MemoryStringStream strm(&data);
+  strm.Write(kTVMCompileCacheMagic);
+  strm.Write(key.text);
+  strm.Write(SaveJSON(source_func));
+  strm.Write(base_name);
+  strm.Write(func_name);
+  strm.Write(SaveJSON(funcs));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!EnsureDirectory(key.dir) || !WriteFileAtomic(JoinPath(key.dir, key.file_name), data)) {
+    LOG(WARNING) << "Cannot write compile cache entry " << key.file_name << " to " << key.dir;
+    errors_++;
+    return;
+  }
+  DirIndex* index = GetIndex(key.dir);
+  FileInfo& info = index->files[key.file_name];
+  index->total_bytes += static_cast<int64_t>(data.size()) - info.size;
+  info.size = static_cast<int64_t>(data.size());
+  info.last_use = ++clock_;
+  insertions_++;
+  Evict(key.dir, index, key.max_bytes);
+}
+
+PersistentCompileCache::DirIndex* PersistentCompileCache::GetIndex(const std::string& dir) {
+  auto it = indices_.find(dir);
+  if (it != indices_.end()) return &it->second;
+  DirIndex& index = indices_[dir];
+  clock_ = std::max<int64_t>(clock_, std::time(nullptr));
+  for (const auto& entry : ListEntries(dir)) {
+    FileInfo& info = index.files[entry.first];
+    info.size = entry.second.st_size;
+    info.last_use = entry.second.st_mtime;
+    index.total_bytes += info.size;
+    clock_ = std::max<int64_t>(clock_, info.last_use);
+  }
+  return &index;
+}
+
+void PersistentCompileCache::Evict(const std::string& dir, DirIndex* index, int64_t max_bytes) {
+  if (max_bytes <= 0 || index->total_bytes <= max_bytes) return;
+  std::vector<std::pair<int64_t, std::string>> order;
+  for (const auto& kv : index->files) order.emplace_back(kv.second.last_use, kv.first);
+  std::sort(order.begin(), order.end());
+  for (const auto& victim : order) {
+    if (index->total_bytes <= max_bytes) break;
+    // Removal may fail when another process evicted it first, drop it from the index anyway.
+    std::remove(JoinPath(dir, victim.second).c_str());
+    index->total_bytes -= index->files[victim.second].size;
+    index->files.erase(victim.second);
+    evictions_++;
+  }
+}
+
+CompileCacheStats PersistentCompileCache::Stats() {
+  CompileCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.insertions = insertions_;
+  stats.evictions = evictions_;
+  stats.errors = errors_;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& kv : indices_) stats.bytes += kv.second.total_bytes;
+  return stats;
+}
+
+void PersistentCompileCache::ResetStats() {
+  hits_ = 0;
+  misses_ = 0;
+  insertions_ = 0;
+  evictions_ = 0;
+  errors_ = 0;
+}
+
+TVM_REGISTER_GLOBAL("relay.backend._CompileCacheStats").set_body_typed([]() {
+  CompileCacheStats stats = PersistentCompileCache::Global()->Stats();
+  Map<String, ObjectRef> ret;
+  ret.Set("hits", IntImm(DataType::Int(64), stats.hits));
+  ret.Set("misses", IntImm(DataType::Int(64), stats.misses));
+  ret.Set("insertions", IntImm(DataType::Int(64), stats.insertions));
+  ret.Set("evictions", IntImm(DataType::Int(64), stats.evictions));
+  ret.Set("errors", IntImm(DataType::Int(64), stats.errors));
+  ret.Set("bytes", IntImm(DataType::Int(64), stats.bytes));
+  return ret;
+});
+
+TVM_REGISTER_GLOBAL("relay.backend._CompileCacheResetStats").set_body_typed([]() {
+  PersistentCompileCache::Global()->ResetStats();
+});
+
+}  // namespace relay
+}  // namespace tvm
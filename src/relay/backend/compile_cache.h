@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/compile_cache.h
+ * \brief Persistent on-disk cache of lowered primitive functions.
+ *
+ *  The cache is shared by all processes that point at the same directory,
+ *  entries are written atomically and evicted in least-recently-used order
+ *  once the directory grows beyond the configured size.
+ */
+#ifndef TVM_RELAY_BACKEND_COMPILE_CACHE_H_
+#define TVM_RELAY_BACKEND_COMPILE_CACHE_H_
+
+#include <tvm/ir/module.h>
+#include <tvm/relay/function.h>
+#include <tvm/target/target.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tvm {
+namespace relay {
+
+/*! \brief Magic number of a persistent compile cache entry. */
+constexpr uint64_t kTVMCompileCacheMagic = 0x7C0A3F1E5B2D4C01;
+
+/*! \brief Resolved cache key of one primitive function. */
+struct CompileCacheKey {
+  /*! \brief Directory holding the cache entries. */
+  std::string dir;
+  /*! \brief Size budget of the directory in bytes, 0 means unbounded. */
+  int64_t max_bytes;
+  /*! \brief Full description of the key, stored in the entry as a collision guard. */
+  std::string text;
+  /*! \brief Name of the entry file inside dir. */
+  std::string file_name;
+};
+
+/*! \brief Counters of the persistent compile cache. */
+struct CompileCacheStats {
+  int64_t hits{0};
+  int64_t misses{0};
+  int64_t insertions{0};
+  int64_t evictions{0};
+  int64_t errors{0};
+  int64_t bytes{0};
+};
+
+/*!
+ * \brief Rename a lowered function so that it does not clash with the module it is reused in.
+ * \param funcs The lowered functions.
+ * \param old_name The name the function was lowered with.
+ * \param new_name The new name.
+ * \return The renamed functions.
+ */
+IRModule RenameLoweredFunction(const IRModule& funcs, const std::string& old_name,
+                               const std::string& new_name);
+
+/*!
+ * \brief Persistent cache of lowered primitive functions.
+ *
+ *  It is enabled through the "relay.backend.CompileCache" pass config option.
+ *  An entry is keyed by the structural hash of the primitive function, the
+ *  target, the compiler version, the current PassContext and the fingerprint
+ *  of the tuning context reported by "relay.backend.compile_cache_context".
+ */
+class PersistentCompileCache {
+ public:
+  /*! \return The global cache. */
+  static PersistentCompileCache* Global();
+  /*!
+   * \brief Compute the key of a primitive function under the current PassContext.
+   * \param source_func The primitive function.
+   * \param target The target it is lowered for.
+   * \param key The resulting key.
+   * \return Whether the cache is enabled for this function.
+   */
+  bool MakeKey(const Function& source_func, const Target& target, CompileCacheKey* key);
+  /*!
+   * \brief Look up a lowered function.
+   * \param key The key from MakeKey.
+   * \param source_func The primitive function, compared against the stored one.
+   * \param base_name The name of the function before it was made unique.
+   * \param func_name The name the function was lowered with.
+   * \param funcs The lowered functions.
+   * \return Whether the entry is found.
+   */
+  bool Lookup(const CompileCacheKey& key, const Function& source_func, std::string* base_name,
+              std::string* func_name, IRModule* funcs);
+  /*!
+   * \brief Store a lowered function, evicting old entries if the directory is over budget.
+   * \param key The key from MakeKey.
+   * \param source_func The primitive function.
+   * \param base_name The name of the function before it was made unique.
+   * \param func_name The name the function was lowered with.
+   * \param funcs The lowered functions.
+   */
+  void Insert(const CompileCacheKey& key, const Function& source_func,
+              const std::string& base_name, const std::string& func_name, const IRModule& funcs);
+  /*! \return The current counters. */
+  CompileCacheStats Stats();
+  /*! \brief Reset the hit, miss, insertion, eviction and error counters. */
+  void ResetStats();
+
+ private:
+  /*! \brief Bookkeeping of one entry file. */
+  struct FileInfo {
+    int64_t size{0};
+    int64_t last_use{0};
+  };
+  /*! \brief Index of one cache directory. */
+  struct DirIndex {
+    std::unordered_map<std::string, FileInfo> files;
+    int64_t total_bytes{0};
+  };
+  /*! \brief Get the index of dir, scanning it on first use. */
+  DirIndex* GetIndex(const std::string& dir);
+  /*! \brief Remove the least recently used entries until dir fits in max_bytes. */
+  void Evict(const std::string& dir, DirIndex* index, int64_t max_bytes);
+
+  /*! \brief Lock of the indices. */
+  std::mutex mutex_;
+  /*! \brief Directory indices. */
+  std::unordered_map<std::string, DirIndex> indices_;
+  /*! \brief Monotonic counter of in-process uses, ordered after the scanned mtimes. */
+  int64_t clock_{0};
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> insertions_{0};
+  std::atomic<int64_t> evictions_{0};
+  std::atomic<int64_t> errors_{0};
+};
+
+}  // namespace relay
+}  // namespace tvm
+
+#endif  // TVM_RELAY_BACKEND_COMPILE_CACHE_H_
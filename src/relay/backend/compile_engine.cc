@@ -33,19 +33,24 @@
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule.h>
 #include <tvm/te/schedule_pass.h>
 #include <tvm/topi/tags.h>
 
+#include <algorithm>
 #include <functional>
 #include <limits>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "../transforms/pass_util.h"
+#include "compile_cache.h"
 #include "utils.h"
 
 namespace tvm {
@@ -554,6 +559,63 @@ class CompileEngineImpl : public CompileEngineNode {
   // Lower the function.
   CachedFunc Lower(const CCacheKey& key) { return LowerInternal(key)->cached_func; }
 
+  void LowerBatch(const Array<CCacheKey>& keys, int num_threads) final {
+    std::vector<CCacheKey> pending;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::unordered_set<CCacheKey> visited;
+      for (const CCacheKey& key : keys) {
+        if (cache_.count(key) || !visited.insert(key).second) continue;
+        // External and device copy functions are cheap, leave them to Lower.
+        if (key->source_func->GetAttr<String>(attr::kCompiler).defined()) continue;
+        if (IsDeviceCopy(key->source_func)) continue;
+        pending.push_back(key);
+      }
+    }
+    if (pending.size() < 2) return;
+
+    // Functions are lowered under temporary names, and renamed in the order of keys
+    // afterwards so that the names do not depend on the thread interleaving.
+    std::vector<CachedFunc> lowered(pending.size());
+    std::vector<std::string> base_names(pending.size());
+    auto pass_ctx = transform::PassContext::Current();
+    auto partitioner = [num_threads](int begin, int end, int step, int max_threads) {
+      if (num_threads > 0) max_threads = std::min(max_threads, num_threads);
+      return support::rr_partitioner(begin, end, step, max_threads);
+    };
+    support::parallel_for(
+        0, static_cast<int>(pending.size()),
+        [&](int i) {
+          // The scopes are thread local, forward the ones of the caller.
+          With<transform::PassContext> pass_ctx_scope(pass_ctx);
+          With<Target> target_scope(pending[i]->target);
+          auto temp_name = [i](std::string name) {
+            std::replace(name.begin(), name.end(), '.', '_');
+            return name + "__batch" + std::to_string(i);
+          };
+          try {
+            lowered[i] = LowerPrimitive(pending[i], temp_name, &base_names[i]);
+          } catch (const dmlc::Error& e) {
+            // Lower will retry it and report the error with the full context.
+            DLOG(INFO) << "Failed to lower function in parallel: " << e.what();
+          }
+        },
+        1, partitioner);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < pending.size(); ++i) {
+      if (!lowered[i].defined() || cache_.count(pending[i])) continue;
+      auto cache_node = make_object<CachedFuncNode>(*(lowered[i].operator->()));
+      cache_node->func_name = GetUniqueName(base_names[i]);
+      cache_node->funcs =
+          RenameLoweredFunction(lowered[i]->funcs, lowered[i]->func_name, cache_node->func_name);
+      auto value = CCacheValue(make_object<CCacheValueNode>());
+      value->use_count = 0;
+      value->cached_func = CachedFunc(cache_node);
+      cache_[pending[i]] = value;
+    }
+  }
+
   // For now, build one module per function.
   PackedFunc JIT(const CCacheKey& key) final {
     CCacheValue value = LowerInternal(key);
@@ -565,7 +627,8 @@ class CompileEngineImpl : public CompileEngineNode {
     } else {
       m = build(value->cached_func->funcs, key->target, Target(nullptr));
     }
-    value->packed_func = m.GetFunction(value->cached_func->func_name);
+    // The function may sit in an imported partition when tir.num_codegen_partitions is set.
+    value->packed_func = m.GetFunction(value->cached_func->func_name, true);
     return value->packed_func;
   }
 
@@ -672,19 +735,49 @@ class CompileEngineImpl : public CompileEngineNode {
     With<Target> target_scope(key->target);
 
     CHECK(!value->cached_func.defined());
+    value->cached_func = LowerPrimitive(
+        key, [this](const std::string& name) { return GetUniqueName(name); }, nullptr);
+    return value;
+  }
+  /*!
+   * \brief Schedule and lower a primitive function, or reuse it from the persistent cache.
+   * \param key The key to the function.
+   * \param make_name Maps the name derived from the function to the name it is lowered with.
+   * \param base_name If not nullptr, set to the name derived from the function.
+   * \return The lowered function.
+   */
+  CachedFunc LowerPrimitive(const CCacheKey& key,
+                            const std::function<std::string(const std::string&)>& make_name,
+                            std::string* base_name) {
+    bool is_device_copy = IsDeviceCopy(key->source_func);
+    // Reuse the lowered function from the persistent cache, without scheduling.
+    // Only func_name and funcs are consumed downstream of Lower.
+    CompileCacheKey disk_key;
+    bool use_disk_cache = !is_device_copy && PersistentCompileCache::Global()->MakeKey(
+                                                 key->source_func, key->target, &disk_key);
+    if (use_disk_cache) {
+      std::string cached_base_name, lowered_name;
+      IRModule lowered;
+      if (PersistentCompileCache::Global()->Lookup(disk_key, key->source_func, &cached_base_name,
+                                                   &lowered_name, &lowered)) {
+        auto cache_node = make_object<CachedFuncNode>();
+        cache_node->target = key->target;
+        cache_node->func_name = make_name(cached_base_name);
+        cache_node->funcs = RenameLoweredFunction(lowered, lowered_name, cache_node->func_name);
+        if (base_name != nullptr) *base_name = cached_base_name;
+        return CachedFunc(cache_node);
+      }
+    }
+
     auto cfunc = CreateSchedule(key->source_func, key->target);
     auto cache_node = make_object<CachedFuncNode>(*(cfunc.operator->()));
+    if (base_name != nullptr) *base_name = cache_node->func_name;
 
     // Skip lowering for device copy node.
-    const Expr body = (key->source_func)->body;
-    if (const CallNode* call_node = body.as<CallNode>()) {
-      if (call_node->attrs.as<DeviceCopyAttrs>()) {
-        value->cached_func = CachedFunc(cache_node);
-        return value;
-      }
-    }
+    if (is_device_copy) return CachedFunc(cache_node);
 
-    cache_node->func_name = GetUniqueName(cache_node->func_name);
+    std::string name = cache_node->func_name;
+    cache_node->func_name = make_name(name);
     // NOTE: array will copy on write.
     Array<te::Tensor> all_args = cache_node->inputs;
     for (te::Tensor arg : cache_node->outputs) {
@@ -700,8 +793,16 @@ class CompileEngineImpl : public CompileEngineNode {
       std::unordered_map<te::Tensor, tir::Buffer> binds;
       cache_node->funcs = tvm::lower(cfunc->schedule, all_args, cache_node->func_name, binds);
     }
-    value->cached_func = CachedFunc(cache_node);
-    return value;
+    if (use_disk_cache) {
+      PersistentCompileCache::Global()->Insert(disk_key, key->source_func, name,
+                                               cache_node->func_name, cache_node->funcs);
+    }
+    return CachedFunc(cache_node);
+  }
+  /*! \return Whether the function only copies data across devices. */
+  static bool IsDeviceCopy(const Function& func) {
+    const CallNode* call_node = func->body.as<CallNode>();
+    return call_node != nullptr && call_node->attrs.as<DeviceCopyAttrs>() != nullptr;
   }
   // implement lowered shape func
   CCacheValue LowerShapeFuncInternal(const CCacheKey& key) {
@@ -202,6 +202,14 @@ class CompileEngineNode : public Object {
    * \return The result.
    */
   virtual CachedFunc Lower(const CCacheKey& key) = 0;
+  /*!
+   * \brief Lower independent functions concurrently and populate the cache,
+   *  so that the following calls to Lower on the keys are cache hits.
+   *  Function names are assigned in the order of keys, as if lowered serially.
+   * \param keys The keys to the functions.
+   * \param num_threads The number of threads to use, 0 means all the cores.
+   */
+  virtual void LowerBatch(const Array<CCacheKey>& keys, int num_threads) = 0;
   /*!
    * \brief Just in time compile to get a PackedFunc.
    * \param key The key to the cached function.
@@ -22,11 +22,17 @@
  * \brief Memory index assignment pass for executing
  *   the program in the graph runtime.
  */
+#include <tvm/ir/transform.h>
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/expr.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
+#include <limits>
+#include <map>
+
 #include "../../support/arena.h"
 
 namespace tvm {
@@ -46,6 +52,12 @@ struct StorageToken {
   int device_type{0};
   /*! \brief The storage id */
   int64_t storage_id{-1};
+  /*! \brief The first step at which the token is alive, used by the arena planner. */
+  int64_t start_step{0};
+  /*! \brief The last step at which the token is alive, used by the arena planner. */
+  int64_t end_step{0};
+  /*! \brief The byte offset in the storage, used by the arena planner. */
+  int64_t offset{0};
 };
 
 class StorageAllocaBaseVisitor : public ExprVisitor {
@@ -376,11 +388,260 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
   std::unordered_map<const ExprNode*, std::vector<StorageToken*> > prototype_;
 };
 
-Map<Expr, Array<IntegerArray> > GraphPlanMemory(const Function& func) {
+/*!
+ * \brief Plan the memory as offsets into one arena per device.
+ *
+ *  Each intermediate tensor gets its exact lifetime, from the step of the
+ *  call producing it to the step of its last consumer. Tensors are then
+ *  placed greedily by decreasing size at the lowest offset that does not
+ *  overlap a placed tensor with an intersecting lifetime. Inputs, params
+ *  and constants keep a storage of their own so that they can still be
+ *  set or shared individually.
+ */
+class StorageArenaPlanner : public StorageAllocaBaseVisitor {
+ public:
+  /*!
+   * \brief Run the planning.
+   * \return The storage ids, device types and byte offsets of each expression.
+   */
+  Map<Expr, Array<IntegerArray> > Plan(const Function& func) {
+    prototype_ = StorageAllocaInit(&arena_).GetInitTokenMap(func);
+    this->Run(func);
+    // must always keep output alive.
+    for (StorageToken* tok : GetToken(func->body)) {
+      tok->end_step = std::numeric_limits<int64_t>::max();
+    }
+    this->AssignOffsets();
+
+    Map<Expr, Array<IntegerArray> > smap;
+    for (const auto& kv : token_map_) {
+      std::vector<Integer> storage_ids;
+      std::vector<Integer> device_types;
+      std::vector<Integer> offsets;
+      for (StorageToken* tok : kv.second) {
+        storage_ids.push_back(tok->storage_id);
+        device_types.push_back(tok->device_type);
+        offsets.push_back(tok->offset);
+      }
+      smap.Set(GetRef<Expr>(kv.first), Array<IntegerArray>({storage_ids, device_types, offsets}));
+    }
+    return smap;
+  }
+
+  /*!
+   * \brief Whether the runtime can create the planned views, the views at an offset
+   *  of an arena require devices whose data pointers support pointer arithmetic.
+   * \param default_device_type The device type of the tensors without a device annotation.
+   */
+  bool IsSupported(int default_device_type) const {
+    for (StorageToken* tok : arena_tokens_) {
+      int device_type = tok->device_type != 0 ? tok->device_type : default_device_type;
+      if (!runtime::DeviceAPI::SupportsPointerArithmetic(device_type)) return false;
+    }
+    return true;
+  }
+
+  /*! \return The total size of the allocated storage in bytes. */
+  size_t TotalAllocBytes() const { return total_bytes_; }
+
+  /*!
+   * \return The lower bound of the storage size in bytes, which is the
+   *  largest total size of the tensors alive at the same step.
+   */
+  size_t LowerBoundBytes() const { return lower_bound_bytes_; }
+
+ protected:
+  using StorageAllocaBaseVisitor::VisitExpr_;
+
+  void CreateToken(const ExprNode* op, bool can_realloc) final {
+    CHECK(!token_map_.count(op));
+    auto it = prototype_.find(op);
+    CHECK(it != prototype_.end());
+    std::vector<StorageToken*> tokens;
+    for (StorageToken* tok : it->second) {
+      tok->max_bytes = GetMemorySize(tok);
+      if (can_realloc) {
+        tok->start_step = step_;
+        tok->end_step = step_;
+        arena_tokens_.push_back(tok);
+      } else {
+        // inputs, params and constants are alive during the whole program.
+        tok->storage_id = static_cast<int64_t>(num_storage_++);
+        tok->start_step = 0;
+        tok->end_step = std::numeric_limits<int64_t>::max();
+        total_bytes_ += tok->max_bytes;
+        lower_bound_bytes_ += tok->max_bytes;
+      }
+      tokens.push_back(tok);
+    }
+    token_map_[op] = tokens;
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    std::vector<StorageToken*> args;
+    for (Expr arg : op->args) {
+      for (StorageToken* tok : GetToken(arg)) {
+        args.push_back(tok);
+      }
+    }
+    ++step_;
+    CreateToken(op, true);
+    for (StorageToken* tok : args) {
+      tok->end_step = std::max(tok->end_step, step_);
+    }
+  }
+
+  /*! \brief Place the tokens of each device in the arena of the device. */
+  void AssignOffsets() {
+    std::map<int, std::vector<StorageToken*> > device_tokens;
+    for (StorageToken* tok : arena_tokens_) {
+      device_tokens[tok->device_type].push_back(tok);
+    }
+    for (auto& kv : device_tokens) {
+      std::vector<StorageToken*>& tokens = kv.second;
+      std::stable_sort(tokens.begin(), tokens.end(), [](StorageToken* lhs, StorageToken* rhs) {
+        return lhs->max_bytes > rhs->max_bytes;
+      });
+      int64_t storage_id = static_cast<int64_t>(num_storage_++);
+      std::vector<StorageToken*> placed;
+      size_t arena_bytes = 0;
+      for (StorageToken* tok : tokens) {
+        size_t size = AlignedSize(tok);
+        std::vector<StorageToken*> conflicts;
+        for (StorageToken* other : placed) {
+          if (other->start_step <= tok->end_step && tok->start_step <= other->end_step) {
+            conflicts.push_back(other);
+          }
+        }
+        std::sort(conflicts.begin(), conflicts.end(),
+                  [](StorageToken* lhs, StorageToken* rhs) { return lhs->offset < rhs->offset; });
+        // find the lowest gap that fits the token.
+        size_t offset = 0;
+        for (StorageToken* other : conflicts) {
+          size_t other_begin = static_cast<size_t>(other->offset);
+          if (other_begin >= offset + size) break;
+          offset = std::max(offset, other_begin + AlignedSize(other));
+        }
+        tok->offset = static_cast<int64_t>(offset);
+        tok->storage_id = storage_id;
+        placed.push_back(tok);
+        arena_bytes = std::max(arena_bytes, offset + size);
+      }
+      total_bytes_ += arena_bytes;
+      lower_bound_bytes_ += LiveBytesLowerBound(tokens);
+    }
+  }
+
+  /*! \brief The largest total size of the tokens alive at the same step. */
+  static size_t LiveBytesLowerBound(const std::vector<StorageToken*>& tokens) {
+    std::vector<std::pair<int64_t, int64_t> > events;
+    for (StorageToken* tok : tokens) {
+      int64_t size = static_cast<int64_t>(AlignedSize(tok));
+      events.emplace_back(tok->start_step, size);
+      if (tok->end_step != std::numeric_limits<int64_t>::max()) {
+        events.emplace_back(tok->end_step + 1, -size);
+      }
+    }
+    // releases at a step happen before allocations at the same step.
+    std::sort(events.begin(), events.end());
+    int64_t live = 0, peak = 0;
+    for (const auto& e : events) {
+      live += e.second;
+      peak = std::max(peak, live);
+    }
+    return static_cast<size_t>(peak);
+  }
+
+  // The offsets stay multiples of runtime::kAllocAlignment, the alignment of the storage the
+  // runtime allocates, which the generated kernels assert on their arguments.
+  static size_t AlignedSize(const StorageToken* tok) {
+    return DivRoundUp(tok->max_bytes, runtime::kAllocAlignment) * runtime::kAllocAlignment;
+  }
+
+  static size_t DivRoundUp(size_t size, size_t word_size) {
+    return (size + word_size - 1) / word_size;
+  }
+
+  static size_t GetMemorySize(StorageToken* prototype) {
+    const TensorTypeNode* ttype = prototype->ttype;
+    CHECK(ttype != nullptr);
+    size_t size = 1;
+    for (IndexExpr dim : ttype->shape) {
+      const int64_t* pval = tir::as_const_int(dim);
+      CHECK(pval != nullptr) << "Cannot allocate memory symbolic tensor shape " << ttype->shape;
+      CHECK_GE(*pval, 0) << "Cannot allocate memory for tensor with negative shape" << *pval;
+      size *= static_cast<size_t>(pval[0]);
+    }
+    size *= DivRoundUp(ttype->dtype.bits() * ttype->dtype.lanes(), 8);
+    return size;
+  }
+
+ private:
+  // allocator
+  support::Arena arena_;
+  // the current step, one step per call
+  int64_t step_{0};
+  // number of storage ids assigned
+  size_t num_storage_{0};
+  // the tokens placed in the arenas
+  std::vector<StorageToken*> arena_tokens_;
+  // total size of the storage
+  size_t total_bytes_{0};
+  // lower bound of the size of the arenas plus the size of the other storage
+  size_t lower_bound_bytes_{0};
+  /*! \brief internal prototype token map */
+  std::unordered_map<const ExprNode*, std::vector<StorageToken*> > prototype_;
+};
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.GraphPlanMemory.use_arena", Bool);
+
+Map<Expr, Array<IntegerArray> > GraphPlanMemory(const Function& func, int default_device_type) {
+  bool use_arena = transform::PassContext::Current()
+                       ->GetConfig<Bool>("relay.GraphPlanMemory.use_arena", Bool(false))
+                       .value();
+  if (use_arena) {
+    StorageArenaPlanner planner;
+    auto smap = planner.Plan(func);
+    if (planner.IsSupported(default_device_type)) {
+      DLOG(INFO) << "Arena memory plan uses " << planner.TotalAllocBytes()
+                 << " bytes, the lower bound is " << planner.LowerBoundBytes() << " bytes";
+      return smap;
+    }
+    LOG(WARNING) << "The arena memory planner only supports devices whose data pointers are "
+                 << "addresses, fall back to the default memory planner";
+  }
   return StorageAllocator().Plan(func);
 }
 
-TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemory").set_body_typed(GraphPlanMemory);
+/*!
+ * \brief Compare the memory footprint of the planners.
+ * \param func The function to plan.
+ * \return The bytes used by the default planner, by the arena planner and
+ *  the lower bound of the arena planner.
+ */
+Array<Integer> GraphPlanMemoryFootprint(const Function& func) {
+  StorageAllocator allocator;
+  allocator.Plan(func);
+  StorageArenaPlanner planner;
+  planner.Plan(func);
+  return {Integer(static_cast<int64_t>(allocator.TotalAllocBytes())),
+          Integer(static_cast<int64_t>(planner.TotalAllocBytes())),
+          Integer(static_cast<int64_t>(planner.LowerBoundBytes()))};
+}
+
+TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemory")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      Function func = args[0];
+      // The device type of the tensors without a device annotation, CPU by default.
+      int default_device_type = kDLCPU;
+      if (args.size() > 1) {
+        default_device_type = args[1];
+      }
+      *rv = GraphPlanMemory(func, default_device_type);
+    });
+
+TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemoryFootprint")
+    .set_body_typed(GraphPlanMemoryFootprint);
 
 }  // namespace relay
 }  // namespace tvm
@@ -25,6 +25,7 @@
 #include <dmlc/any.h>
 #include <dmlc/json.h>
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/runtime/device_api.h>
 
@@ -51,6 +52,8 @@ using GraphInputObjectPtr = std::shared_ptr<GraphInputNode>;
 using GraphOpObjectPtr = std::shared_ptr<GraphOpNode>;
 using TargetsMap = std::unordered_map<int, Target>;
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.num_lower_threads", Integer);
+
 /*! \brief Lowered outputs */
 struct LoweredOutput {
   std::string graph_json;
@@ -181,6 +184,27 @@ class GraphOpNode : public GraphNode {
   const std::string op_type_name_{"tvm_op"};
 };
 
+/*!
+ * \brief Collect the calls to primitive functions lowered by the CompileEngine,
+ *  in the order GraphRuntimeCodegen visits them.
+ */
+class PrimitiveCallCollector : public ExprVisitor {
+ public:
+  void VisitExpr_(const CallNode* op) final {
+    if (const auto* func = op->op.as<FunctionNode>()) {
+      if (func->HasNonzeroAttr(attr::kPrimitive) &&
+          !func->GetAttr<String>(attr::kCompiler).defined()) {
+        calls.push_back(op);
+      }
+    }
+    for (const Expr& arg : op->args) {
+      VisitExpr(arg);
+    }
+  }
+
+  std::vector<const CallNode*> calls;
+};
+
 /*! \brief Code generator for graph runtime */
 class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<GraphNodeRef>> {
  public:
@@ -191,12 +215,22 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
 
   LoweredOutput Codegen(relay::Function func) {
     auto pf = GetPackedFunc("relay.backend.GraphPlanMemory");
-    storage_device_map_ = (*pf)(func);
+    // The calls without a device annotation run on the only target, or on the CPU.
+    int default_device_type = kDLCPU;
+    if (targets_.size() == 1) {
+      default_device_type = targets_.begin()->first;
+    }
+    storage_device_map_ = (*pf)(func, default_device_type);
     // First we convert all the parameters into input nodes.
     for (auto param : func->params) {
       auto node_ptr = GraphInputNode::make_node_ptr(param->name_hint(), GraphAttrs());
       var_map_[param.get()] = AddNode(node_ptr, param);
     }
+    auto num_lower_threads = transform::PassContext::Current()->GetConfig<Integer>(
+        "relay.backend.num_lower_threads", Integer(1));
+    if (num_lower_threads.value()->value != 1) {
+      LowerPrimitiveFunctions(func, num_lower_threads.value()->value);
+    }
     heads_ = VisitExpr(func->body);
     std::ostringstream os;
     dmlc::JSONWriter writer(&os);
@@ -245,7 +279,7 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
     size_t count = storage_device_map_.count(expr);
     CHECK_GT(count, 0) << "Expr is not existing in storage plan";
     auto storage_device_info = storage_device_map_[expr];
-    CHECK_EQ(storage_device_info.size(), 2);
+    CHECK(storage_device_info.size() == 2 || storage_device_info.size() == 3);
     // storage
     std::vector<int64_t> storage_info;
     for (auto& v : storage_device_info[0]) {
@@ -266,6 +300,14 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
     if (num_unknown_devices == 0) {
       node->attrs_["device_index"] = device_types;
     }
+    // byte offsets in the storage, only given by the arena planner
+    if (storage_device_info.size() == 3) {
+      std::vector<int64_t> storage_offsets;
+      for (auto& v : storage_device_info[2]) {
+        storage_offsets.push_back(v->value);
+      }
+      node->attrs_["storage_offset"] = std::move(storage_offsets);
+    }
     auto node_id = nodes_.size();
     nodes_.push_back(node);
     // Tuple return value, flatten as tuple
@@ -379,34 +421,59 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       return GraphAddCallNode(op, ext_func->func_name, ext_func->func_name);
     }
 
+    // Normal Relay Function
+    target = GetCallTarget(expr);
+    CCacheKey key = (*pf0)(func, target);
+    CachedFunc lowered_func = (*pf1)(compile_engine_, key);
+    if (!lowered_funcs_.count(target->str())) {
+      lowered_funcs_[target->str()] = IRModule();
+    }
+    lowered_funcs_[target->str()]->Update(lowered_func->funcs);
+    return GraphAddCallNode(op, _GetUniqueName(lowered_func->func_name), lowered_func->func_name);
+  }
+
+  /*!
+   * \brief Get the target a call to a primitive function is lowered for.
+   * \param expr The call.
+   * \return The target.
+   */
+  Target GetCallTarget(const Expr& expr) {
     CHECK_GE(storage_device_map_.count(expr), 0);
     auto& device_type = storage_device_map_[expr][1];
     auto call_dev_type = device_type[0]->value;
-    // Normal Relay Function
     if (targets_.size() == 1) {
       // homogeneous execution.
       const auto& it = targets_.begin();
-      target = (*it).second;
+      return (*it).second;
+    }
+    // heterogeneous execution.
+    std::string call_dev_name;
+    if (call_dev_type == 0) {
+      call_dev_name = "llvm";
     } else {
-      // heterogeneous execution.
-      std::string call_dev_name;
-      if (call_dev_type == 0) {
-        call_dev_name = "llvm";
-      } else {
-        call_dev_name = runtime::DeviceName(call_dev_type);
-      }
-      if (targets_.count(call_dev_type) == 0) {
-        LOG(FATAL) << "No target is provided for device " << call_dev_name;
-      }
-      target = targets_[call_dev_type];
+      call_dev_name = runtime::DeviceName(call_dev_type);
     }
-    CCacheKey key = (*pf0)(func, target);
-    CachedFunc lowered_func = (*pf1)(compile_engine_, key);
-    if (!lowered_funcs_.count(target->str())) {
-      lowered_funcs_[target->str()] = IRModule();
+    if (targets_.count(call_dev_type) == 0) {
+      LOG(FATAL) << "No target is provided for device " << call_dev_name;
     }
-    lowered_funcs_[target->str()]->Update(lowered_func->funcs);
-    return GraphAddCallNode(op, _GetUniqueName(lowered_func->func_name), lowered_func->func_name);
+    return targets_[call_dev_type];
+  }
+
+  /*!
+   * \brief Lower all the primitive functions called in func concurrently,
+   *  the visitor then finds them in the CompileEngine cache.
+   * \param func The function to be compiled.
+   * \param num_threads The number of threads, 0 means all the cores.
+   */
+  void LowerPrimitiveFunctions(const Function& func, int num_threads) {
+    PrimitiveCallCollector collector;
+    collector(func->body);
+    Array<CCacheKey> keys;
+    for (const CallNode* call : collector.calls) {
+      Function prim_func = GetRef<Function>(call->op.as<FunctionNode>());
+      keys.push_back(CCacheKey(prim_func, GetCallTarget(GetRef<Expr>(call))));
+    }
+    compile_engine_->LowerBatch(keys, num_threads);
   }
 
   std::vector<GraphNodeRef> VisitExpr_(const LetNode* op) override {
@@ -472,6 +539,7 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
     ShapeVector shapes;
     std::vector<size_t> storage_ids;
     std::vector<size_t> device_types;
+    std::vector<int64_t> storage_offsets;
     std::vector<std::string> dltypes;
     std::vector<size_t> node_row_ptr{0};
     for (auto node : nodes_) {
@@ -489,6 +557,10 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
         const auto& dev_types = dmlc::get<std::vector<int64_t>>(node->attrs_["device_index"]);
         device_types.insert(device_types.end(), dev_types.begin(), dev_types.end());
       }
+      if (node->attrs_.count("storage_offset")) {
+        const auto& offsets = dmlc::get<std::vector<int64_t>>(node->attrs_["storage_offset"]);
+        storage_offsets.insert(storage_offsets.end(), offsets.begin(), offsets.end());
+      }
       node_row_ptr.push_back(num_entry);
     }
     writer->BeginObject();
@@ -504,6 +576,11 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       attrs["device_index"].emplace_back(std::string("list_int"));
       attrs["device_index"].emplace_back(device_types);
     }
+    if (storage_offsets.size()) {
+      CHECK_EQ(storage_offsets.size(), storage_ids.size());
+      attrs["storage_offset"].emplace_back(std::string("list_int"));
+      attrs["storage_offset"].emplace_back(storage_offsets);
+    }
     attrs["dltype"].emplace_back(std::string("list_str"));
     attrs["dltype"].emplace_back(dltypes);
     writer->WriteObjectKeyValue("attrs", attrs);
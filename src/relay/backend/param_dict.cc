@@ -31,12 +31,20 @@
 #include <utility>
 #include <vector>
 
+#include "../../runtime/mapped_file.h"
+
 namespace tvm {
 namespace relay {
 
 using namespace runtime;
 
-TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict").set_body([](TVMArgs args, TVMRetValue* rv) {
+/*!
+ * \brief Serialize a parameter dictionary.
+ * \param args The names and arrays, in the form "key, value, key, value, ...".
+ * \param aligned Whether to align the data of each array so the file can be memory mapped.
+ * \param bytes The serialized dictionary.
+ */
+static void SaveParamDict(const TVMArgs& args, bool aligned, std::string* bytes) {
   CHECK_EQ(args.size() % 2, 0u);
   // `args` is in the form "key, value, key, value, ..."
   size_t num_params = args.size() / 2;
@@ -48,10 +56,9 @@ TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict").set_body([](TVMArgs args, TVMR
     names.emplace_back(args[i].operator String());
     arrays.emplace_back(args[i + 1].operator DLTensor*());
   }
-  std::string bytes;
-  dmlc::MemoryStringStream strm(&bytes);
+  dmlc::MemoryStringStream strm(bytes);
   dmlc::Stream* fo = &strm;
-  uint64_t header = kTVMNDArrayListMagic, reserved = 0;
+  uint64_t header = aligned ? kTVMNDArrayListAlignedMagic : kTVMNDArrayListMagic, reserved = 0;
   fo->Write(header);
   fo->Write(reserved);
   fo->Write(names);
@@ -59,15 +66,34 @@ TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict").set_body([](TVMArgs args, TVMR
     uint64_t sz = static_cast<uint64_t>(arrays.size());
     fo->Write(sz);
     for (size_t i = 0; i < sz; ++i) {
-      tvm::runtime::SaveDLTensor(fo, arrays[i]);
+      if (aligned) {
+        tvm::runtime::SaveAlignedDLTensor(&strm, arrays[i]);
+      } else {
+        tvm::runtime::SaveDLTensor(fo, arrays[i]);
+      }
     }
   }
+}
+
+TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string bytes;
+  SaveParamDict(args, false, &bytes);
   TVMByteArray arr;
   arr.data = bytes.c_str();
   arr.size = bytes.length();
   *rv = arr;
 });
 
+TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict_aligned")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      std::string bytes;
+      SaveParamDict(args, true, &bytes);
+      TVMByteArray arr;
+      arr.data = bytes.c_str();
+      arr.size = bytes.length();
+      *rv = arr;
+    });
+
 TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict").set_body([](TVMArgs args, TVMRetValue* rv) {
   std::string bytes = args[0];
   std::vector<std::string> names;
@@ -75,7 +101,8 @@ TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict").set_body([](TVMArgs args, TVMR
   dmlc::Stream* strm = &memstrm;
   uint64_t header, reserved;
   CHECK(strm->Read(&header)) << "Invalid parameters file format";
-  CHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
+  CHECK(header == kTVMNDArrayListMagic || header == kTVMNDArrayListAlignedMagic)
+      << "Invalid parameters file format";
   CHECK(strm->Read(&reserved)) << "Invalid parameters file format";
   CHECK(strm->Read(&names)) << "Invalid parameters file format";
   uint64_t sz;
@@ -85,7 +112,11 @@ TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict").set_body([](TVMArgs args, TVMR
   tvm::Array<NamedNDArray> ret;
   for (size_t i = 0; i < size; ++i) {
     tvm::runtime::NDArray temp;
-    temp.Load(strm);
+    if (header == kTVMNDArrayListAlignedMagic) {
+      temp = tvm::runtime::LoadAlignedDLTensor(&memstrm);
+    } else {
+      temp.Load(strm);
+    }
     auto n = tvm::make_object<NamedNDArrayNode>();
     n->name = std::move(names[i]);
     n->array = temp;
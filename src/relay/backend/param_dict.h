@@ -36,6 +36,8 @@ namespace relay {
 
 /*! \brief Magic number for NDArray list file  */
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
+/*! \brief Magic number for NDArray list file whose tensor data is aligned */
+constexpr uint64_t kTVMNDArrayListAlignedMagic = 0xF7E58D4F05049CB8;
 
 /*!
  * \brief Wrapper node for naming `NDArray`s.
@@ -287,6 +287,40 @@ int TVMGraphRuntimeGraphAttr_Load(TVMGraphRuntimeGraphAttr* attr, JSONReader* re
         break;
       }
       bitmask |= 2;
+    } else if (!strcmp(key, "storage_offset")) {
+      reader->BeginArray(reader);
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      status = reader->ReadString(reader, type, sizeof(type));
+      if (status != 0) {
+        fprintf(stderr, "error reading storage_offset array item");
+        break;
+      }
+      if (strcmp(type, "list_int")) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      reader->BeginArray(reader);
+      while (reader->NextArrayItem(reader)) {
+        attr->storage_offset =
+            vrealloc(attr->storage_offset, sizeof(int64_t) * (attr->storage_offset_count + 1));
+        reader->ReadInteger(reader, &(attr->storage_offset[attr->storage_offset_count]));
+        attr->storage_offset_count++;
+      }
+      if (reader->NextArrayItem(reader)) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
     } else if (!strcmp(key, "shape")) {
       reader->BeginArray(reader);
       if (!(reader->NextArrayItem(reader))) {
@@ -423,6 +457,10 @@ int TVMGraphRuntimeGraphAttr_Load(TVMGraphRuntimeGraphAttr* attr, JSONReader* re
     fprintf(stderr, "invalid format\n");
     status = -1;
   }
+  if (attr->storage_offset_count != 0 && attr->storage_offset_count != storage_id_count) {
+    fprintf(stderr, "storage_offset and storage_id have different sizes\n");
+    status = -1;
+  }
   return status;
 }
 
@@ -450,6 +488,10 @@ void TVMGraphRuntimeGraphAttr_Release(TVMGraphRuntimeGraphAttr* attr) {
     vfree(attr->ndim);
     attr->ndim = 0;
   }
+  if (attr->storage_offset) {
+    vfree(attr->storage_offset);
+    attr->storage_offset = 0;
+  }
 }
 
 int TVMGraphRuntime_Load(TVMGraphRuntime* runtime, JSONReader* reader) {
@@ -716,6 +758,10 @@ void TVMGraphRuntime_SetupStorage(TVMGraphRuntime* runtime) {
     DLDataType t = vtype[idx];
     uint32_t bits = t.bits * t.lanes;
     size_t bytes = ((bits + 7U) / 8U) * size;
+    // entries planned into an arena are placed at an offset of the storage.
+    if (attrs->storage_offset_count > 0) {
+      bytes += attrs->storage_offset[idx];
+    }
 
     uint32_t sid = storage_id;
     if (sid >= pool_entry_count) {
@@ -753,6 +799,10 @@ void TVMGraphRuntime_SetupStorage(TVMGraphRuntime* runtime) {
     runtime->data_entry[idx] =
         TVMNDArray_CreateView(&(runtime->storage_pool[storage_id]),
                               attrs->shape + idx * TVM_CRT_MAX_NDIM, attrs->ndim[idx], vtype[idx]);
+    if (attrs->storage_offset_count > 0) {
+      runtime->data_entry[idx].dl_tensor.data =
+          (char*)(runtime->data_entry[idx].dl_tensor.data) + attrs->storage_offset[idx];
+    }
     CHECK_NE(runtime->data_entry[idx].dl_tensor.data, 0,
              "fail to create for node with idx=%d, storage_id=%u\n", idx, storage_id);
   }
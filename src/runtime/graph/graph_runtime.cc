@@ -28,12 +28,16 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -49,14 +53,217 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
 }  // namespace details
 
 /*!
- * \brief Run all the operations one by one.
+ * \brief Runs the operators of a graph on a set of stream threads,
+ *  each operator is dispatched as soon as its dependencies have finished.
+ */
+class GraphRuntime::InterOpExecutor {
+ public:
+  InterOpExecutor(GraphRuntime* runtime, int num_streams, int threads_per_op)
+      : runtime_(runtime), num_streams_(num_streams), threads_per_op_(threads_per_op) {
+    for (int i = 0; i < num_streams; ++i) {
+      streams_.emplace_back([this, i]() { this->RunStream(i); });
+    }
+  }
+
+  ~InterOpExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_now_ = true;
+    }
+    ready_cv_.notify_all();
+    for (std::thread& t : streams_) {
+      t.join();
+    }
+  }
+
+  /*! \brief Run all operators and wait for them to finish. */
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_deps_ = runtime_->op_num_deps_;
+    num_remaining_ = 0;
+    error_.clear();
+    for (uint32_t nid = 0; nid < runtime_->GetNumOfNodes(); ++nid) {
+      if (!runtime_->op_execs_[nid]) continue;
+      ++num_remaining_;
+      if (pending_deps_[nid] == 0) ready_.push_back(nid);
+    }
+    ready_cv_.notify_all();
+    done_cv_.wait(lock, [this]() { return num_remaining_ == 0; });
+    if (!error_.empty()) {
+      LOG(FATAL) << error_;
+    }
+  }
+
+  int num_streams() const { return num_streams_; }
+
+  int threads_per_op() const { return threads_per_op_; }
+
+ private:
+  void RunStream(int stream_id) {
+    // Bind the thread pool of this stream to its own partition of the cores, the pool then
+    // only keeps threads_per_op workers so that the streams do not oversubscribe the cores.
+    const PackedFunc* fconfig = Registry::Get("runtime.config_threadpool");
+    if (fconfig != nullptr) {
+      (*fconfig)(static_cast<int>(threading::ThreadGroup::kBig), threads_per_op_,
+                 stream_id * threads_per_op_);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      ready_cv_.wait(lock, [this]() { return exit_now_ || !ready_.empty(); });
+      if (exit_now_) return;
+      uint32_t nid = ready_.front();
+      ready_.pop_front();
+      bool skip = !error_.empty();
+      lock.unlock();
+      std::string error;
+      if (!skip) {
+        try {
+          runtime_->op_execs_[nid]();
+        } catch (const std::exception& e) {
+          error = e.what();
+        }
+      }
+      lock.lock();
+      if (!error.empty() && error_.empty()) {
+        error_ = "Error in operator " + runtime_->nodes_[nid].name + ": " + error;
+      }
+      for (uint32_t succ : runtime_->op_successors_[nid]) {
+        if (--pending_deps_[succ] == 0) {
+          ready_.push_back(succ);
+          ready_cv_.notify_one();
+        }
+      }
+      if (--num_remaining_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+
+  /*! \brief The runtime whose operators are executed. */
+  GraphRuntime* runtime_;
+  /*! \brief Number of stream threads. */
+  int num_streams_;
+  /*! \brief Number of threads in the thread pool of each stream. */
+  int threads_per_op_;
+  /*! \brief The stream threads. */
+  std::vector<std::thread> streams_;
+  /*! \brief Protects the fields below. */
+  std::mutex mutex_;
+  /*! \brief Signaled when an operator becomes ready or on exit. */
+  std::condition_variable ready_cv_;
+  /*! \brief Signaled when all operators of a run have finished. */
+  std::condition_variable done_cv_;
+  /*! \brief The operators ready to run. */
+  std::deque<uint32_t> ready_;
+  /*! \brief Number of unfinished dependencies of each node in the current run. */
+  std::vector<uint32_t> pending_deps_;
+  /*! \brief Number of unfinished operators in the current run. */
+  size_t num_remaining_{0};
+  /*! \brief The first error of the current run. */
+  std::string error_;
+  /*! \brief Whether the stream threads should exit. */
+  bool exit_now_{false};
+};
+
+GraphRuntime::~GraphRuntime() {}
+
+/*!
+ * \brief Run all the operations one by one, or in dependency order
+ *  when inter-operator parallelism is enabled.
  */
 void GraphRuntime::Run() {
+  if (inter_op_ != nullptr) {
+    inter_op_->Run();
+    return;
+  }
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
     if (op_execs_[i]) op_execs_[i]();
   }
 }
+
+void GraphRuntime::SetInterOpParallelism(int num_streams, int threads_per_op) {
+  CHECK_GE(num_streams, 1) << "The number of streams must be positive";
+  CHECK_GE(threads_per_op, 0) << "The number of threads per operator must not be negative";
+  inter_op_.reset();
+  if (num_streams == 1) return;
+  if (threads_per_op == 0) {
+    threads_per_op = std::max(threading::MaxConcurrency() / num_streams, 1);
+  }
+  this->SetupOpDependencies();
+  inter_op_.reset(new InterOpExecutor(this, num_streams, threads_per_op));
+}
+
+void GraphRuntime::SetupOpDependencies() {
+  uint32_t num_nodes = this->GetNumOfNodes();
+  op_successors_.assign(num_nodes, {});
+  op_num_deps_.assign(num_nodes, 0);
+  // The storage is reused by the memory planner, so besides data and control
+  // dependencies an operator writing to a byte range of a storage entry must
+  // wait for the earlier operators reading or writing an overlapping range.
+  struct Access {
+    uint32_t nid;
+    size_t begin;
+    size_t end;
+    bool is_write;
+  };
+  size_t num_storage = 0;
+  for (int sid : attrs_.storage_id) {
+    num_storage = std::max(num_storage, static_cast<size_t>(sid) + 1);
+  }
+  std::vector<std::vector<Access>> accesses(num_storage);
+  auto get_access = [this](uint32_t nid, uint32_t eid, bool is_write) {
+    size_t begin = attrs_.storage_offset.empty() ? 0 : attrs_.storage_offset[eid];
+    const DLTensor* t = data_entry_[eid].operator->();
+    return Access{nid, begin, begin + GetDataSize(*t), is_write};
+  };
+  auto overlap = [](const Access& a, const Access& b) {
+    // empty tensors still order the operators touching the same entry.
+    return a.begin == b.begin || (a.begin < b.end && b.begin < a.end);
+  };
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (!op_execs_[nid]) continue;
+    const auto& inode = nodes_[nid];
+    std::vector<std::pair<int, Access>> node_accesses;
+    for (const auto& e : inode.inputs) {
+      uint32_t eid = this->entry_id(e);
+      node_accesses.emplace_back(attrs_.storage_id[eid], get_access(nid, eid, false));
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      uint32_t eid = this->entry_id(nid, index);
+      node_accesses.emplace_back(attrs_.storage_id[eid], get_access(nid, eid, true));
+    }
+    std::unordered_set<uint32_t> deps;
+    for (uint32_t dep : inode.control_deps) {
+      if (op_execs_[dep]) deps.insert(dep);
+    }
+    for (const auto& kv : node_accesses) {
+      for (const Access& prev : accesses[kv.first]) {
+        if ((prev.is_write || kv.second.is_write) && overlap(prev, kv.second)) {
+          deps.insert(prev.nid);
+        }
+      }
+    }
+    deps.erase(nid);
+    for (uint32_t dep : deps) {
+      op_successors_[dep].push_back(nid);
+    }
+    op_num_deps_[nid] = static_cast<uint32_t>(deps.size());
+    for (const auto& kv : node_accesses) {
+      std::vector<Access>& prev = accesses[kv.first];
+      if (kv.second.is_write) {
+        // accesses covered by this write are ordered through it from now on.
+        const Access& cur = kv.second;
+        prev.erase(std::remove_if(prev.begin(), prev.end(),
+                                  [&cur](const Access& a) {
+                                    return cur.begin <= a.begin && a.end <= cur.end;
+                                  }),
+                   prev.end());
+      }
+      prev.push_back(kv.second);
+    }
+  }
+}
 /*!
  * \brief Initialize the graph executor with graph and context.
  * \param graph_json The execution graph.
@@ -101,8 +308,20 @@ int GraphRuntime::GetInputIndex(const std::string& name) {
 void GraphRuntime::SetInput(int index, DLTensor* data_in) {
   CHECK_LT(static_cast<size_t>(index), input_nodes_.size());
   uint32_t eid = this->entry_id(input_nodes_[index], 0);
+  CHECK(!is_session_ || param_eids_.count(eid) == 0)
+      << "Cannot set input " << nodes_[input_nodes_[index]].name
+      << " from a session since it is shared with other sessions";
   data_entry_[eid].CopyFrom(data_in);
 }
+/*!
+ * \brief set index-th input to the graph and mark it as a parameter.
+ * \param index The input index.
+ * \param data_in The input data.
+ */
+void GraphRuntime::SetParam(int index, DLTensor* data_in) {
+  this->SetInput(index, data_in);
+  param_eids_.insert(this->entry_id(input_nodes_[index], 0));
+}
 /*!
  * \brief set index-th input to the graph without copying the data.
  * \param index The input index.
@@ -119,6 +338,9 @@ void GraphRuntime::SetInputZeroCopy(int index, DLTensor* data_ref) {
   CHECK_EQ(old_t->ndim, static_cast<size_t>(data_ref->ndim));
   CHECK_EQ(old_t->ctx.device_type, data_ref->ctx.device_type);
   CHECK_EQ(old_t->ctx.device_id, data_ref->ctx.device_id);
+  CHECK(!is_session_ || param_eids_.count(eid) == 0)
+      << "Cannot set input " << nodes_[input_nodes_[index]].name
+      << " from a session since it is shared with other sessions";
   for (auto i = 0; i < data_ref->ndim; ++i) {
     CHECK_EQ(old_t->shape[i], data_ref->shape[i]);
   }
@@ -190,11 +412,19 @@ void GraphRuntime::LoadParams(const std::string& param_blob) {
   this->LoadParams(&strm);
 }
 
-void GraphRuntime::LoadParams(dmlc::Stream* strm) {
+void GraphRuntime::LoadParamsFromFile(const std::string& path) {
+  std::shared_ptr<MappedFile> mapping = MappedFile::Open(path);
+  dmlc::MemoryFixedSizeStream strm(mapping->data(), mapping->size());
+  this->LoadParams(&strm, mapping);
+}
+
+void GraphRuntime::LoadParams(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapping) {
   uint64_t header, reserved;
   CHECK(strm->Read(&header)) << "Invalid parameters file format";
-  CHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
+  CHECK(header == kTVMNDArrayListMagic || header == kTVMNDArrayListAlignedMagic)
+      << "Invalid parameters file format";
   CHECK(strm->Read(&reserved)) << "Invalid parameters file format";
+  bool aligned = header == kTVMNDArrayListAlignedMagic;
 
   std::vector<std::string> names;
   CHECK(strm->Read(&names)) << "Invalid parameters file format";
@@ -202,27 +432,55 @@ void GraphRuntime::LoadParams(dmlc::Stream* strm) {
   strm->Read(&sz);
   size_t size = static_cast<size_t>(sz);
   CHECK(size == names.size()) << "Invalid parameters file format";
+  // A parameter can only alias the file when no other entry shares its storage.
+  std::vector<int> storage_users;
+  if (mapping != nullptr && aligned) {
+    for (int sid : attrs_.storage_id) {
+      if (static_cast<size_t>(sid) >= storage_users.size()) storage_users.resize(sid + 1, 0);
+      ++storage_users[sid];
+    }
+  }
+  bool aliased = false;
   for (size_t i = 0; i < size; ++i) {
-    int in_idx = GetInputIndex(names[i]);
-    if (in_idx < 0) {
-      NDArray temp;
+    // The data_entry is allocated on device, NDArray.load always load the array into CPU.
+    NDArray temp;
+    if (aligned) {
+      temp = LoadAlignedDLTensor(strm, mapping);
+    } else {
       temp.Load(strm);
-      continue;
     }
+    int in_idx = GetInputIndex(names[i]);
+    if (in_idx < 0) continue;
     uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
     CHECK_LT(eid, data_entry_.size());
+    CHECK(!is_session_) << "Cannot load parameters into a session";
 
-    // The data_entry is allocated on device, NDArray.load always load the array into CPU.
-    NDArray temp;
-    temp.Load(strm);
-    data_entry_[eid].CopyFrom(temp);
+    const DLTensor* old_t = data_entry_[eid].operator->();
+    const DLTensor* new_t = temp.operator->();
+    bool can_alias = mapping != nullptr && aligned && old_t->ctx.device_type == kDLCPU &&
+                     storage_users[attrs_.storage_id[eid]] == 1 && old_t->ndim == new_t->ndim &&
+                     old_t->dtype.code == new_t->dtype.code &&
+                     old_t->dtype.bits == new_t->dtype.bits &&
+                     old_t->dtype.lanes == new_t->dtype.lanes &&
+                     std::equal(old_t->shape, old_t->shape + old_t->ndim, new_t->shape);
+    if (can_alias) {
+      data_entry_[eid] = temp;
+      data_alignment_[eid] = details::GetDataAlignment(*new_t);
+      aliased = true;
+    } else {
+      data_entry_[eid].CopyFrom(temp);
+    }
+    param_eids_.insert(eid);
   }
+  // The operators captured the data pointers of the replaced entries.
+  if (aliased) this->SetupOpExecs();
 }
 
 void GraphRuntime::ShareParams(const GraphRuntime& other, dmlc::Stream* strm) {
   uint64_t header, reserved;
   CHECK(strm->Read(&header)) << "Invalid parameters file format";
-  CHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
+  CHECK(header == kTVMNDArrayListMagic || header == kTVMNDArrayListAlignedMagic)
+      << "Invalid parameters file format";
   CHECK(strm->Read(&reserved)) << "Invalid parameters file format";
   std::vector<std::string> names;
   CHECK(strm->Read(&names)) << "Invalid parameters file format";
@@ -240,11 +498,77 @@ void GraphRuntime::ShareParams(const GraphRuntime& other, dmlc::Stream* strm) {
     CHECK_GT(data_entry_[eid].use_count(), 1);
     const DLTensor* tmp = data_entry_[eid].operator->();
     data_alignment_[eid] = details::GetDataAlignment(*tmp);
+    param_eids_.insert(eid);
   }
   this->SetupOpExecs();
 }
 
-void GraphRuntime::SetupStorage() {
+Module GraphRuntime::CreateSession(const std::vector<std::string>& shared_inputs) {
+  CHECK(!is_session_) << "Cannot create a session from another session";
+  auto sess = make_object<GraphRuntime>();
+  sess->nodes_ = nodes_;
+  sess->input_nodes_ = input_nodes_;
+  sess->input_map_ = input_map_;
+  sess->node_row_ptr_ = node_row_ptr_;
+  sess->outputs_ = outputs_;
+  sess->attrs_ = attrs_;
+  sess->module_ = module_;
+  sess->ctxs_ = ctxs_;
+  sess->param_eids_ = param_eids_;
+  for (const std::string& name : shared_inputs) {
+    int in_idx = GetInputIndex(name);
+    CHECK_GE(in_idx, 0) << "Cannot find input " << name << " to share";
+    sess->param_eids_.insert(this->entry_id(input_nodes_[in_idx], 0));
+  }
+  sess->is_session_ = true;
+  std::vector<NDArray> shared_entries(num_node_entries());
+  for (uint32_t eid : sess->param_eids_) {
+    shared_entries[eid] = data_entry_[eid];
+  }
+  sess->SetupStorage(shared_entries);
+  sess->SetupOpExecs();
+  if (inter_op_ != nullptr) {
+    sess->SetInterOpParallelism(inter_op_->num_streams(), inter_op_->threads_per_op());
+  }
+  return Module(sess);
+}
+
+Array<NDArray> GraphRuntime::RunInSession(const TVMArgs& args) {
+  CHECK_EQ(args.size() % 2, 0) << "Expect pairs of input index or name and input data";
+  Module sess_mod;
+  {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    if (!idle_sessions_.empty()) {
+      sess_mod = idle_sessions_.back();
+      idle_sessions_.pop_back();
+    }
+  }
+  if (!sess_mod.defined()) {
+    sess_mod = this->CreateSession({});
+  }
+  GraphRuntime* sess = static_cast<GraphRuntime*>(sess_mod.operator->());
+  for (int i = 0; i < args.size(); i += 2) {
+    int in_idx = 0;
+    if (String::CanConvertFrom(args[i])) {
+      in_idx = sess->GetInputIndex(args[i].operator String());
+    } else {
+      in_idx = args[i];
+    }
+    CHECK_GE(in_idx, 0) << "Cannot find input " << i / 2;
+    sess->SetInput(in_idx, args[i + 1]);
+  }
+  sess->Run();
+  Array<NDArray> outputs;
+  for (int i = 0; i < sess->NumOutputs(); ++i) {
+    NDArray out = sess->GetOutput(i);
+    outputs.push_back(out.CopyTo(out->ctx));
+  }
+  std::lock_guard<std::mutex> lock(session_mutex_);
+  idle_sessions_.push_back(sess_mod);
+  return outputs;
+}
+
+void GraphRuntime::SetupStorage(const std::vector<NDArray>& shared_entries) {
   // Grab saved optimization plan from graph.
   std::vector<DLDataType> vtype;
   for (const std::string& s_type : attrs_.dltype) {
@@ -253,6 +577,8 @@ void GraphRuntime::SetupStorage() {
 
   // Size and device type of each storage pool entry.
   std::vector<PoolEntry> pool_entry;
+  // Whether a storage pool entry hosts any entry that is not shared.
+  std::vector<bool> pool_owned;
   // Find the maximum space size.
   for (size_t i = 0; i < attrs_.shape.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
@@ -270,20 +596,33 @@ void GraphRuntime::SetupStorage() {
     size_t bits = t.bits * t.lanes;
     CHECK(bits % 8U == 0U || bits == 1U);
     size_t bytes = ((bits + 7U) / 8U) * size;
+    // entries planned into an arena are placed at an offset of the storage.
+    if (!attrs_.storage_offset.empty()) {
+      bytes += static_cast<size_t>(attrs_.storage_offset[i]);
+    }
 
     uint32_t sid = static_cast<uint32_t>(storage_id);
     if (sid >= pool_entry.size()) {
       pool_entry.resize(sid + 1, {0, -1});
+      pool_owned.resize(sid + 1, false);
     } else {
       CHECK(pool_entry[sid].device_type == -1 || pool_entry[sid].device_type == device_type)
           << "The same pool entry cannot be assigned to multiple devices";
     }
-    pool_entry[sid].size = std::max(pool_entry[sid].size, bytes);
     pool_entry[sid].device_type = device_type;
+    if (i < shared_entries.size() && shared_entries[i].defined()) continue;
+    pool_entry[sid].size = std::max(pool_entry[sid].size, bytes);
+    pool_owned[sid] = true;
   }
 
   // Allocate the space.
-  for (const auto& pit : pool_entry) {
+  for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+    if (!pool_owned[sid]) {
+      // Only referred by shared entries.
+      storage_pool_.push_back(NDArray());
+      continue;
+    }
+    const PoolEntry& pit = pool_entry[sid];
     std::vector<int64_t> shape;
     // This for loop is very fast since there are usually only a couple of
     // devices available on the same hardware.
@@ -303,7 +642,12 @@ void GraphRuntime::SetupStorage() {
   for (size_t i = 0; i < data_entry_.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
     CHECK_LT(static_cast<size_t>(storage_id), storage_pool_.size());
-    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    if (i < shared_entries.size() && shared_entries[i].defined()) {
+      data_entry_[i] = shared_entries[i];
+    } else {
+      size_t offset = attrs_.storage_offset.empty() ? 0 : attrs_.storage_offset[i];
+      data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i], offset);
+    }
     const DLTensor* tmp = data_entry_[i].operator->();
     data_alignment_[i] = details::GetDataAlignment(*tmp);
   }
@@ -448,6 +792,10 @@ PackedFunc GraphRuntime::GetFunction(const std::string& name,
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       this->LoadParams(args[0].operator std::string());
     });
+  } else if (name == "load_params_from_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParamsFromFile(args[0].operator std::string());
+    });
   } else if (name == "share_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       const auto& module = args[0].operator Module();
@@ -456,6 +804,25 @@ PackedFunc GraphRuntime::GetFunction(const std::string& name,
       dmlc::MemoryStringStream strm(const_cast<std::string*>(&param_blob));
       this->ShareParams(dynamic_cast<const GraphRuntime&>(*module.operator->()), &strm);
     });
+  } else if (name == "create_session") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::vector<std::string> shared_inputs;
+      for (int i = 0; i < args.size(); ++i) {
+        shared_inputs.push_back(args[i].operator String());
+      }
+      *rv = this->CreateSession(shared_inputs);
+    });
+  } else if (name == "set_inter_op_parallelism") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int threads_per_op = 0;
+      if (args.size() > 1) {
+        threads_per_op = args[1];
+      }
+      this->SetInterOpParallelism(args[0], threads_per_op);
+    });
+  } else if (name == "run_in_session") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->RunInSession(args); });
   } else {
     return PackedFunc();
   }
@@ -28,15 +28,20 @@
 #include <dlpack/dlpack.h>
 #include <dmlc/json.h>
 #include <dmlc/memory_io.h>
+#include <tvm/runtime/container.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "../mapped_file.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -49,6 +54,8 @@ namespace runtime {
 
 /*! \brief Magic number for NDArray list file  */
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
+/*! \brief Magic number for NDArray list file whose tensor data is aligned */
+constexpr uint64_t kTVMNDArrayListAlignedMagic = 0xF7E58D4F05049CB8;
 
 /*! \brief operator attributes about tvm op */
 struct TVMOpParam {
@@ -87,6 +94,24 @@ class TVM_DLL GraphRuntime : public ModuleNode {
   const char* type_key() const final { return "GraphRuntime"; }
   void Run();
 
+  ~GraphRuntime();
+
+  /*!
+   * \brief Configure inter-operator parallel execution.
+   *
+   *  Operators are dispatched as soon as all operators they depend on,
+   *  through data, control or reuse of the same storage, have finished.
+   *  Each stream is a thread whose thread pool is bound to its own partition
+   *  of threads_per_op cores, so intra-operator parallelism does not
+   *  oversubscribe the machine.
+   *
+   * \param num_streams The number of operators that can run at the same time,
+   *  1 runs the operators one by one in graph order.
+   * \param threads_per_op The number of threads used by each operator,
+   *  0 splits the available cores evenly between the streams.
+   */
+  void SetInterOpParallelism(int num_streams, int threads_per_op);
+
   /*!
    * \brief Initialize the graph executor with graph and context.
    * \param graph_json The execution graph.
@@ -112,6 +137,13 @@ class TVM_DLL GraphRuntime : public ModuleNode {
    * \param data_in The input data.
    */
   void SetInput(int index, DLTensor* data_in);
+  /*!
+   * \brief set index-th input to the graph and mark it as a parameter,
+   *  which is shared by the sessions of this runtime.
+   * \param index The input index.
+   * \param data_in The input data.
+   */
+  void SetParam(int index, DLTensor* data_in);
   /*!
    * \brief set index-th input to the graph without copying the data
    * \param index The input index.
@@ -153,13 +185,20 @@ class TVM_DLL GraphRuntime : public ModuleNode {
   /*!
    * \brief Load parameters from binary stream
    * \param strm The input stream.
+   * \param mapping The mapped file strm reads from, or nullptr. When given, parameters
+   *  saved with aligned data are aliased instead of copied if they live on CPU.
    */
-  void LoadParams(dmlc::Stream* strm);
+  void LoadParams(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapping = nullptr);
   /*!
    * \brief Load parameters from parameter blob.
    * \param param_blob A binary blob of parameter.
    */
   void LoadParams(const std::string& param_blob);
+  /*!
+   * \brief Load parameters from a file by memory mapping it.
+   * \param path The path of the parameter file.
+   */
+  void LoadParamsFromFile(const std::string& path);
 
   /*!
    * \brief Share parameters from pre-existing GraphRuntime instance.
@@ -169,6 +208,27 @@ class TVM_DLL GraphRuntime : public ModuleNode {
    */
   void ShareParams(const GraphRuntime& other, dmlc::Stream* strm);
 
+  /*!
+   * \brief Create an execution session of this runtime.
+   *
+   *  The session shares the graph, the compiled module and the parameters
+   *  with this runtime and only allocates the storage of the other entries,
+   *  so sessions can run concurrently on different threads.
+   *
+   * \param shared_inputs Names of additional inputs to share, e.g. weights
+   *  set with set_input instead of load_params.
+   * \return The session, which is also a GraphRuntime.
+   */
+  Module CreateSession(const std::vector<std::string>& shared_inputs);
+
+  /*!
+   * \brief Run the graph on an idle session, creating one if all are busy.
+   *  This function can be called from multiple threads at the same time.
+   * \param args The input index or name followed by the input data, for each input.
+   * \return The outputs of the graph, copied out of the session.
+   */
+  Array<NDArray> RunInSession(const TVMArgs& args);
+
   /*!
    * \brief Get total number of nodes.
    * \return Total number of nodes.
@@ -269,6 +329,7 @@ class TVM_DLL GraphRuntime : public ModuleNode {
   struct GraphAttr {
     size_t storage_num_not_alloctaed{0};
     std::vector<int> storage_id;
+    std::vector<int64_t> storage_offset;
     std::vector<int> device_index;
     std::vector<std::string> dltype;
     std::vector<std::vector<int64_t>> shape;
@@ -305,6 +366,14 @@ class TVM_DLL GraphRuntime : public ModuleNode {
           reader->Read(&shape);
           CHECK(!reader->NextArrayItem());
           bitmask |= 4;
+        } else if (key == "storage_offset") {
+          reader->BeginArray();
+          CHECK(reader->NextArrayItem());
+          reader->Read(&type);
+          CHECK_EQ(type, "list_int");
+          CHECK(reader->NextArrayItem());
+          reader->Read(&storage_offset);
+          CHECK(!reader->NextArrayItem());
         } else if (key == "device_index") {
           reader->BeginArray();
           CHECK(reader->NextArrayItem());
@@ -363,10 +432,16 @@ class TVM_DLL GraphRuntime : public ModuleNode {
     }
     CHECK_EQ(bitmask, 1 | 2 | 4 | 8 | 16) << "invalid format";
   }
-  /*! \brief Setup the temporal storage */
-  void SetupStorage();
+  /*!
+   * \brief Setup the temporal storage.
+   * \param shared_entries The data entries shared with another runtime, indexed by entry id.
+   *  The storage referred only by shared entries is not allocated.
+   */
+  void SetupStorage(const std::vector<NDArray>& shared_entries = {});
   /*! \brief Setup the executors. */
   void SetupOpExecs();
+  /*! \brief Setup the dependencies between operators used by inter-operator parallelism. */
+  void SetupOpDependencies();
   /*!
    * \brief Create an execution function given input.
    * \param attrs The node attributes.
@@ -408,6 +483,21 @@ class TVM_DLL GraphRuntime : public ModuleNode {
   std::vector<size_t> data_alignment_;
   /*! \brief Operator on each node. */
   std::vector<std::function<void()>> op_execs_;
+  /*! \brief Operators depending on each node, used by inter-operator parallelism. */
+  std::vector<std::vector<uint32_t>> op_successors_;
+  /*! \brief Number of operators each node depends on. */
+  std::vector<uint32_t> op_num_deps_;
+  /*! \brief The inter-operator parallel executor, null when operators run in order. */
+  class InterOpExecutor;
+  std::unique_ptr<InterOpExecutor> inter_op_;
+  /*! \brief Entry ids of the inputs that hold parameters. */
+  std::unordered_set<uint32_t> param_eids_;
+  /*! \brief Whether this runtime is a session sharing the parameters of another one. */
+  bool is_session_{false};
+  /*! \brief Idle sessions used by RunInSession. */
+  std::vector<Module> idle_sessions_;
+  /*! \brief Protects idle_sessions_. */
+  std::mutex session_mutex_;
 };
 
 std::vector<TVMContext> GetAllContext(const TVMArgs& args);
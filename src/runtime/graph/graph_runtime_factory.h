@@ -111,7 +111,7 @@ class TVM_DLL GraphRuntimeFactory : public runtime::ModuleNode {
     for (const auto& key : keys) {
       int in_idx = graph_runtime->GetInputIndex(key);
       if (in_idx >= 0) {
-        graph_runtime->SetInput(in_idx, const_cast<DLTensor*>(value[key].operator->()));
+        graph_runtime->SetParam(in_idx, const_cast<DLTensor*>(value[key].operator->()));
       }
     }
   }
@@ -95,6 +95,7 @@ void InitContextFunctions(std::function<void*(const char*)> fgetsymbol) {
   TVM_INIT_CONTEXT_FUNC(TVMBackendFreeWorkspace);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelLaunch);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelBarrier);
+  TVM_INIT_CONTEXT_FUNC(TVMBackendParallelGetChunk);
 
 #undef TVM_INIT_CONTEXT_FUNC
 }
@@ -0,0 +1,189 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_file.cc
+ */
+#include "mapped_file.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/memory_io.h>
+#include <tvm/runtime/c_runtime_api.h>
+
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace tvm {
+namespace runtime {
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+  std::shared_ptr<MappedFile> file(new MappedFile());
+#if defined(_WIN32)
+  std::ifstream fs(path, std::ios::in | std::ios::binary);
+  CHECK(!fs.fail()) << "Cannot open " << path;
+  fs.seekg(0, std::ios::end);
+  file->size_ = static_cast<size_t>(fs.tellg());
+  fs.seekg(0, std::ios::beg);
+  file->buffer_.reset(new char[file->size_ + kTVMNDArrayDataAlignment]);
+  size_t misalign = reinterpret_cast<size_t>(file->buffer_.get()) % kTVMNDArrayDataAlignment;
+  file->data_ =
+      file->buffer_.get() + (kTVMNDArrayDataAlignment - misalign) % kTVMNDArrayDataAlignment;
+  fs.read(file->data_, file->size_);
+  CHECK(!fs.fail()) << "Cannot read " << path;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Cannot open " << path << ": " << strerror(errno);
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path << ": " << strerror(errno);
+  file->size_ = static_cast<size_t>(st.st_size);
+  if (file->size_ != 0) {
+    // A private writable mapping: writes, e.g. updating a parameter in place, trigger
+    // copy-on-write and never reach the file.
+    void* ptr = mmap(nullptr, file->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    CHECK(ptr != MAP_FAILED) << "Cannot map " << path << ": " << strerror(err);
+    file->data_ = static_cast<char*>(ptr);
+  } else {
+    close(fd);
+  }
+#endif
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+#endif
+}
+
+static void MappedNDArrayDeleter(Object* obj) {
+  auto* ptr = static_cast<NDArray::Container*>(obj);
+  delete static_cast<std::shared_ptr<MappedFile>*>(ptr->manager_ctx);
+  delete ptr;
+}
+
+NDArray MappedFile::CreateNDArray(size_t offset, std::vector<int64_t> shape, DLDataType dtype) {
+  DLContext cpu_ctx;
+  cpu_ctx.device_type = kDLCPU;
+  cpu_ctx.device_id = 0;
+  NDArray::Container* container =
+      new NDArray::Container(data_ + offset, std::move(shape), dtype, cpu_ctx);
+  container->SetDeleter(MappedNDArrayDeleter);
+  container->manager_ctx = new std::shared_ptr<MappedFile>(shared_from_this());
+  NDArray ret(GetObjectPtr<Object>(container));
+  // RAII in effect, now run the check.
+  CHECK_LE(offset + GetDataSize(*ret.operator->()), size_)
+      << "Tensor data is out of the bounds of the mapped file";
+  return ret;
+}
+
+void SaveAlignedDLTensor(dmlc::SeekStream* strm, const DLTensor* tensor) {
+  uint64_t header = kTVMNDArrayAlignedMagic;
+  strm->Write(header);
+  // Like SaveDLTensor, the data is always saved as a CPU array.
+  DLContext cpu_ctx;
+  cpu_ctx.device_type = kDLCPU;
+  cpu_ctx.device_id = 0;
+  strm->Write(cpu_ctx);
+  strm->Write(tensor->ndim);
+  strm->Write(tensor->dtype);
+  strm->WriteArray(tensor->shape, tensor->ndim);
+  int64_t data_byte_size = static_cast<int64_t>(GetDataSize(*tensor));
+  strm->Write(data_byte_size);
+  // The data offset is absolute so the reader can seek to it, the gap is zero filled.
+  size_t pos = strm->Tell() + sizeof(uint64_t);
+  uint64_t data_offset =
+      (pos + kTVMNDArrayDataAlignment - 1) / kTVMNDArrayDataAlignment * kTVMNDArrayDataAlignment;
+  strm->Write(data_offset);
+  std::vector<char> padding(data_offset - pos, 0);
+  if (!padding.empty()) strm->Write(padding.data(), padding.size());
+
+  if (DMLC_IO_NO_ENDIAN_SWAP && tensor->ctx.device_type == kDLCPU && tensor->strides == nullptr &&
+      tensor->byte_offset == 0) {
+    strm->Write(tensor->data, data_byte_size);
+  } else {
+    std::vector<uint8_t> bytes(data_byte_size);
+    CHECK_EQ(
+        TVMArrayCopyToBytes(const_cast<DLTensor*>(tensor), dmlc::BeginPtr(bytes), data_byte_size),
+        0)
+        << TVMGetLastError();
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      dmlc::ByteSwap(dmlc::BeginPtr(bytes), tensor->dtype.bits / 8,
+                     data_byte_size / (tensor->dtype.bits / 8));
+    }
+    strm->Write(dmlc::BeginPtr(bytes), data_byte_size);
+  }
+}
+
+NDArray LoadAlignedDLTensor(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapping) {
+  uint64_t header;
+  DLContext ctx;
+  int ndim;
+  DLDataType dtype;
+  CHECK(strm->Read(&header)) << "Invalid DLTensor file format";
+  CHECK(header == kTVMNDArrayAlignedMagic) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&ctx)) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&ndim)) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&dtype)) << "Invalid DLTensor file format";
+  CHECK_EQ(ctx.device_type, kDLCPU) << "Invalid DLTensor context: can only save as CPU tensor";
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0) {
+    CHECK(strm->ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
+  }
+  int64_t data_byte_size;
+  uint64_t data_offset;
+  CHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&data_offset)) << "Invalid DLTensor file format";
+  int64_t num_elems = 1;
+  int elem_bytes = (dtype.bits * dtype.lanes + 7) / 8;
+  for (int64_t dim : shape) {
+    num_elems *= dim;
+  }
+  CHECK(data_byte_size == num_elems * elem_bytes) << "Invalid DLTensor file format";
+  strm->Seek(data_offset);
+
+  if (mapping != nullptr && DMLC_IO_NO_ENDIAN_SWAP &&
+      reinterpret_cast<size_t>(mapping->data() + data_offset) % kTVMNDArrayDataAlignment == 0) {
+    strm->Seek(data_offset + data_byte_size);
+    return mapping->CreateNDArray(data_offset, shape, dtype);
+  }
+  NDArray ret = NDArray::Empty(shape, dtype, ctx);
+  if (data_byte_size != 0) {
+    CHECK(strm->Read(ret->data, data_byte_size)) << "Invalid DLTensor file format";
+  }
+  if (!DMLC_IO_NO_ENDIAN_SWAP) {
+    dmlc::ByteSwap(ret->data, dtype.bits / 8, num_elems * dtype.lanes);
+  }
+  return ret;
+}
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_file.h
+ * \brief Memory mapped files and an aligned tensor layout whose data can alias them.
+ */
+#ifndef TVM_RUNTIME_MAPPED_FILE_H_
+#define TVM_RUNTIME_MAPPED_FILE_H_
+
+#include <dmlc/io.h>
+#include <tvm/runtime/ndarray.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief Magic number of an NDArray saved with aligned data. */
+constexpr uint64_t kTVMNDArrayAlignedMagic = 0xDD5E40F096B4A140;
+/*! \brief Alignment of the tensor data in the aligned layout, equal to kAllocAlignment. */
+constexpr size_t kTVMNDArrayDataAlignment = 128;
+
+/*!
+ * \brief A private, copy-on-write mapping of a whole file.
+ *
+ *  Pages are only read on first access and stay shared with other processes mapping
+ *  the same file until they are written. Platforms without mmap read the file into an
+ *  aligned buffer instead.
+ */
+class MappedFile : public std::enable_shared_from_this<MappedFile> {
+ public:
+  /*!
+   * \brief Map a file.
+   * \param path The path of the file.
+   * \return The mapping.
+   */
+  static std::shared_ptr<MappedFile> Open(const std::string& path);
+
+  ~MappedFile();
+
+  /*! \return The start of the mapping. */
+  char* data() const { return data_; }
+  /*! \return The size of the mapping. */
+  size_t size() const { return size_; }
+
+  /*!
+   * \brief Create a CPU array that aliases the mapping and keeps it alive.
+   * \param offset The byte offset of the data in the file.
+   * \param shape The shape of the array.
+   * \param dtype The data type of the array.
+   * \return The array.
+   */
+  NDArray CreateNDArray(size_t offset, std::vector<int64_t> shape, DLDataType dtype);
+
+ private:
+  MappedFile() = default;
+  /*! \brief The start of the mapped data. */
+  char* data_{nullptr};
+  /*! \brief The size of the mapped data. */
+  size_t size_{0};
+  /*! \brief The fallback buffer when the file is read rather than mapped. */
+  std::unique_ptr<char[]> buffer_;
+};
+
+/*!
+ * \brief Save a DLTensor with its data starting at a multiple of kTVMNDArrayDataAlignment
+ *  from the beginning of the stream, so a mapping of the saved file can alias it.
+ * \param strm The output stream.
+ * \param tensor The tensor to save.
+ */
+void SaveAlignedDLTensor(dmlc::SeekStream* strm, const DLTensor* tensor);
+
+/*!
+ * \brief Load a tensor saved by SaveAlignedDLTensor.
+ * \param strm The input stream.
+ * \param mapping The mapping strm reads from, where position 0 of strm is the start of the
+ *  mapping. The result aliases the mapping when given, otherwise the data is copied.
+ * \return The CPU array.
+ */
+NDArray LoadAlignedDLTensor(dmlc::SeekStream* strm,
+                            const std::shared_ptr<MappedFile>& mapping = nullptr);
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_MAPPED_FILE_H_
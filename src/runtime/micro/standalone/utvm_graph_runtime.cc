@@ -70,6 +70,18 @@ void ParseAttrs(const picojson::object& jattr, GraphAttr* attr) {
       attr->storage_id[i] = static_cast<int>(jstorage_id[i].get<double>());
     }
   }
+  if (jattr.count("storage_offset")) {
+    for (const auto& joffset_ : jattr.at("storage_offset").get<picojson::array>()) {
+      if (joffset_.is<std::string>()) {
+        continue;
+      }
+      const auto& joffset = joffset_.get<picojson::array>();
+      attr->storage_offset.resize(joffset.size());
+      for (size_t i = 0; i < joffset.size(); ++i) {
+        attr->storage_offset[i] = static_cast<int64_t>(joffset[i].get<double>());
+      }
+    }
+  }
   for (const auto& jshape_ : jattr.at("shape").get<picojson::array>()) {
     if (jshape_.is<std::string>()) {
       continue;
@@ -143,9 +155,11 @@ NDArray NDArray::Empty(const DynArray<int64_t>& shape, DLDataType dtype, DLConte
   return r;
 }
 
-NDArray NDArray::CreateView(const DynArray<int64_t>& shape, DLDataType dtype) {
+NDArray NDArray::CreateView(const DynArray<int64_t>& shape, DLDataType dtype,
+                            size_t byte_offset) {
   NDArray r;
-  r.storage_ = storage_;
+  // shares the ownership of the storage, but points at the offset.
+  r.storage_ = std::shared_ptr<void>(storage_, static_cast<char*>(storage_.get()) + byte_offset);
   r.shape_ = shape;
   r.dtype_ = dtype;
   r.ctx_ = ctx_;
@@ -200,6 +214,7 @@ DSOModule::DSOModule(const std::string& name) {
   TVM_INIT_CONTEXT_FUNC(TVMBackendAllocWorkspace);
   TVM_INIT_CONTEXT_FUNC(TVMBackendFreeWorkspace);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelLaunch);
+  TVM_INIT_CONTEXT_FUNC(TVMBackendParallelGetChunk);
 // TODO(tulloch): implement these functions?
 // TVM_INIT_CONTEXT_FUNC(TVMFuncCall);
 // TVM_INIT_CONTEXT_FUNC(TVMBackendGetFuncFromEnv);
@@ -289,6 +304,10 @@ void MicroGraphRuntime::SetupStorage() {
     size_t bits = t.bits * t.lanes;
     assert(bits % 8U == 0U || bits == 1U);
     size_t bytes = ((bits + 7U) / 8U) * size;
+    // entries planned into an arena are placed at an offset of the storage.
+    if (attrs_.storage_offset.size()) {
+      bytes += static_cast<size_t>(attrs_.storage_offset[i]);
+    }
 
     uint32_t sid = static_cast<uint32_t>(storage_id);
     if (sid >= pool_entry.size()) {
@@ -316,7 +335,8 @@ void MicroGraphRuntime::SetupStorage() {
   for (size_t i = 0; i < data_entry_.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
     assert(static_cast<size_t>(storage_id) < storage_pool_.size());
-    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    size_t offset = attrs_.storage_offset.size() ? attrs_.storage_offset[i] : 0;
+    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i], offset);
   }
 }
 
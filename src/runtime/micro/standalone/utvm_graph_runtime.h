@@ -55,6 +55,8 @@ struct GraphAttr {
   DynArray<int> storage_id;
   DynArray<std::string> dltype;
   DynArray<DynArray<int64_t>> shape;
+  // byte offsets in the storage, set by the arena memory planner
+  DynArray<int64_t> storage_offset;
 };
 
 // Memory pool entry.
@@ -95,8 +97,8 @@ class NDArray {
  public:
   // initialize NDArray with shape/dtype/ctx
   static NDArray Empty(const DynArray<int64_t>& shape, DLDataType dtype, DLContext ctx);
-  // create a view of the NDArray storage, with the given shape/dtype
-  NDArray CreateView(const DynArray<int64_t>& shape, DLDataType dtype);
+  // create a view of the NDArray storage at the given byte offset, with the given shape/dtype
+  NDArray CreateView(const DynArray<int64_t>& shape, DLDataType dtype, size_t byte_offset = 0);
   // Copy into the internal storage.
   void CopyFrom(DLTensor* src);
   // Copy out of the internal storage
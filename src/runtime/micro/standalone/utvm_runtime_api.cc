@@ -53,3 +53,16 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
   flambda(0, &env, cdata);
   return 0;
 }
+
+int TVMBackendParallelGetChunk(int64_t* counter, int64_t base, int64_t extent,
+                               int64_t chunk_size, int num_task, int guided, int64_t* begin,
+                               int64_t* end) {
+  // The parallel loops run in a single task, which takes all the iterations at once.
+  if (*counter >= base + extent) {
+    return 0;
+  }
+  *begin = *counter - base;
+  *end = extent;
+  *counter = base + extent;
+  return 1;
+}
@@ -46,6 +46,12 @@ typedef int (*FTVMParallelLambda)(int task_id, TVMParallelGroupEnv* penv, void*
 TVM_MICRO_RUNTIME_API_BACKEND_API int TVMBackendParallelLaunch(FTVMParallelLambda flambda,
                                                                void* cdata, int num_task);
 
+TVM_MICRO_RUNTIME_API_BACKEND_API int TVMBackendParallelGetChunk(int64_t* counter, int64_t base,
+                                                                 int64_t extent,
+                                                                 int64_t chunk_size, int num_task,
+                                                                 int guided, int64_t* begin,
+                                                                 int64_t* end);
+
 TVM_MICRO_RUNTIME_API_BACKEND_API void TVMAPISetLastError(const char* msg);
 TVM_MICRO_RUNTIME_API_BACKEND_API const char* TVMGetLastError(void);
 
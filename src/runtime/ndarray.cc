@@ -162,19 +162,29 @@ struct NDArray::Internal {
   }
 };
 
-NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype) {
+NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype,
+                            size_t relative_byte_offset) {
   CHECK(data_ != nullptr);
   CHECK(get_mutable()->dl_tensor.strides == nullptr) << "Can only create view for compact tensor";
   NDArray ret = Internal::Create(shape, dtype, get_mutable()->dl_tensor.ctx);
   ret.get_mutable()->dl_tensor.byte_offset = this->get_mutable()->dl_tensor.byte_offset;
   size_t curr_size = GetDataSize(this->get_mutable()->dl_tensor);
   size_t view_size = GetDataSize(ret.get_mutable()->dl_tensor);
-  CHECK_LE(view_size, curr_size)
+  CHECK_LE(view_size + relative_byte_offset, curr_size)
       << "Tries to create a view that has bigger memory than current one";
   // increase ref count
   get_mutable()->IncRef();
   ret.get_mutable()->manager_ctx = get_mutable();
   ret.get_mutable()->dl_tensor.data = get_mutable()->dl_tensor.data;
+  if (DeviceAPI::SupportsPointerArithmetic(get_mutable()->dl_tensor.ctx.device_type)) {
+    // Like the VM storage, the offset is applied to the data pointer so that
+    // kernels requiring a zero byte_offset can use the view.
+    ret.get_mutable()->dl_tensor.data =
+        static_cast<char*>(get_mutable()->dl_tensor.data) + relative_byte_offset;
+  } else {
+    // The data of the device is an opaque handle, which must stay the base of the allocation.
+    ret.get_mutable()->dl_tensor.byte_offset += relative_byte_offset;
+  }
   return ret;
 }
 
@@ -33,6 +33,7 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <exception>
 #include <memory>
 #include <string>
 #include <utility>
@@ -634,11 +635,7 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
 RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn) {
   RPCCode code = RPCCode::kCallFunc;
   while (code != RPCCode::kReturn && code != RPCCode::kShutdown && code != RPCCode::kCopyAck) {
-    while (writer_.bytes_available() != 0) {
-      writer_.ReadWithCallback(
-          [this](const void* data, size_t size) { return channel_->Send(data, size); },
-          writer_.bytes_available());
-    }
+    this->FlushWriter();
     size_t bytes_needed = handler_->BytesNeeded();
     if (bytes_needed != 0) {
       size_t n = reader_.WriteWithCallback(
@@ -656,6 +653,57 @@ RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncod
   return code;
 }
 
+void RPCEndpoint::FlushWriter() {
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback(
+        [this](const void* data, size_t size) { return channel_->Send(data, size); },
+        writer_.bytes_available());
+  }
+}
+
+void RPCEndpoint::AddPendingReply(PendingReply reply) {
+  // Push the request out right away so that the remote can start on it.
+  this->FlushWriter();
+  pending_.emplace_back(std::move(reply));
+  // Bound the replies queued up in the channel. Requests written while a
+  // large reply is in flight are small, so neither side can block the
+  // other on a full channel.
+  if (pending_.size() > kRPCMaxPendingRequests) {
+    this->WaitPendingReplies(kRPCMaxPendingRequests);
+  }
+}
+
+void RPCEndpoint::HandleOnePendingReply() {
+  PendingReply reply = std::move(pending_.front());
+  pending_.pop_front();
+  if (reply.code == RPCCode::kCopyAck) {
+    RPCCode code = HandleUntilReturnEvent(true, [](TVMArgs) {});
+    CHECK(code == RPCCode::kCopyAck) << "code=" << static_cast<int>(code);
+    handler_->ReadArray(reply.copy_to, reply.nbytes);
+    handler_->FinishCopyAck();
+  } else {
+    RPCSession::FEncodeReturn encode_return = reply.encode_return;
+    if (encode_return == nullptr) encode_return = [](TVMArgs) {};
+    RPCCode code = HandleUntilReturnEvent(true, encode_return);
+    CHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+  }
+}
+
+void RPCEndpoint::WaitPendingReplies(size_t max_pending) {
+  std::exception_ptr error;
+  while (pending_.size() > max_pending) {
+    try {
+      this->HandleOnePendingReply();
+    } catch (const dmlc::Error&) {
+      if (error == nullptr) error = std::current_exception();
+      // Drain the rest, the destinations of pending copies are only valid
+      // until the request that issued them returns.
+      max_pending = 0;
+    }
+  }
+  if (error != nullptr) std::rethrow_exception(error);
+}
+
 void RPCEndpoint::Init() {
   // callback to flush the writer.
   auto flush_writer = [this]() {
@@ -684,11 +732,18 @@ void RPCEndpoint::Init() {
     handler_->Write(code);
     handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
 
-    code = HandleUntilReturnEvent(true, [rv](TVMArgs args) {
+    // Frees have nothing to return, no need to wait for them in async mode.
+    if (async_mode_ && (code == RPCCode::kFreeHandle || code == RPCCode::kDevFreeData)) {
+      AddPendingReply(PendingReply());
+      return;
+    }
+    PendingReply reply;
+    reply.encode_return = [rv](TVMArgs args) {
       CHECK_EQ(args.size(), 1);
       *rv = args[0];
-    });
-    CHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+    };
+    AddPendingReply(std::move(reply));
+    WaitPendingReplies(0);
   });
 }
 
@@ -706,6 +761,14 @@ RPCEndpoint::~RPCEndpoint() { this->Shutdown(); }
 
 void RPCEndpoint::Shutdown() {
   if (channel_ != nullptr) {
+    // Consume the replies of deferred requests so the remote does not write into a closed channel.
+    try {
+      WaitPendingReplies(0);
+    } catch (const dmlc::Error& e) {
+      // The errors of deferred requests have nowhere else to go at this point.
+      LOG(WARNING) << "Error in a deferred RPC request of " << name_
+                   << " during shutdown: " << e.what();
+    }
     RPCCode code = RPCCode::kShutdown;
     uint64_t packet_nbytes = sizeof(code);
 
@@ -772,8 +835,8 @@ void RPCEndpoint::InitRemoteSession(TVMArgs args) {
   handler_->WriteArray(protocol_ver.data(), length);
   handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
 
-  code = HandleUntilReturnEvent(true, [](TVMArgs args) {});
-  CHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+  AddPendingReply(PendingReply());
+  WaitPendingReplies(0);
 }
 
 // Get remote function with name
@@ -795,20 +858,36 @@ void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_v
   handler_->Write(handle);
   handler_->SendPackedSeq(arg_values, arg_type_codes, num_args, true);
 
-  code = HandleUntilReturnEvent(true, encode_return);
-  CHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+  PendingReply reply;
+  reply.encode_return = encode_return;
+  AddPendingReply(std::move(reply));
+  WaitPendingReplies(0);
 }
 
-void RPCEndpoint::CopyToRemote(void* from, size_t from_offset, void* to, size_t to_offset,
-                               size_t data_size, TVMContext ctx_to, DLDataType type_hint) {
+void RPCEndpoint::SetAsyncMode(bool async_mode, size_t copy_chunk_bytes) {
   std::lock_guard<std::mutex> lock(mutex_);
-  RPCCode code = RPCCode::kCopyToRemote;
-  uint64_t handle = reinterpret_cast<uint64_t>(to);
-  uint64_t offset = static_cast<uint64_t>(to_offset);
-  uint64_t size = static_cast<uint64_t>(data_size);
+  if (!async_mode) WaitPendingReplies(0);
+  async_mode_ = async_mode;
+  copy_chunk_bytes_ = copy_chunk_bytes;
+}
+
+void RPCEndpoint::Synchronize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  WaitPendingReplies(0);
+}
+
+size_t RPCEndpoint::CopyChunkBytes(size_t nbytes, DLDataType type_hint) const {
+  if (copy_chunk_bytes_ == 0 || nbytes <= copy_chunk_bytes_) return nbytes;
+  // The remote swaps the endianness per element, keep the elements whole.
+  size_t elem_bytes = std::max((type_hint.bits * type_hint.lanes + 7) / 8, 1);
+  return std::max(copy_chunk_bytes_ / elem_bytes, static_cast<size_t>(1)) * elem_bytes;
+}
 
+void RPCEndpoint::WriteCopyToRemote(char* from, uint64_t handle, uint64_t offset, uint64_t size,
+                                    TVMContext ctx_to, DLDataType type_hint) {
+  RPCCode code = RPCCode::kCopyToRemote;
   uint64_t packet_nbytes = sizeof(code) + sizeof(handle) + sizeof(offset) + sizeof(size) +
-                           sizeof(ctx_to) + sizeof(type_hint) + data_size;
+                           sizeof(ctx_to) + sizeof(type_hint) + size;
 
   handler_->Write(packet_nbytes);
   handler_->Write(code);
@@ -817,19 +896,12 @@ void RPCEndpoint::CopyToRemote(void* from, size_t from_offset, void* to, size_t
   handler_->Write(size);
   handler_->Write(ctx_to);
   handler_->Write(type_hint);
-  handler_->WriteArray(reinterpret_cast<char*>(from) + from_offset, data_size);
-
-  CHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
+  handler_->WriteArray(from, size);
 }
 
-void RPCEndpoint::CopyFromRemote(void* from, size_t from_offset, void* to, size_t to_offset,
-                                 size_t data_size, TVMContext ctx_from, DLDataType type_hint) {
-  std::lock_guard<std::mutex> lock(mutex_);
+void RPCEndpoint::WriteCopyFromRemote(uint64_t handle, uint64_t offset, uint64_t size,
+                                      TVMContext ctx_from, DLDataType type_hint) {
   RPCCode code = RPCCode::kCopyFromRemote;
-  uint64_t handle = reinterpret_cast<uint64_t>(from);
-  uint64_t offset = static_cast<uint64_t>(from_offset);
-  uint64_t size = static_cast<uint64_t>(data_size);
-
   uint64_t packet_nbytes = sizeof(code) + sizeof(handle) + sizeof(offset) + sizeof(size) +
                            sizeof(ctx_from) + sizeof(type_hint);
 
@@ -840,11 +912,45 @@ void RPCEndpoint::CopyFromRemote(void* from, size_t from_offset, void* to, size_
   handler_->Write(size);
   handler_->Write(ctx_from);
   handler_->Write(type_hint);
+}
 
-  TVMRetValue rv;
-  CHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
-  handler_->ReadArray(reinterpret_cast<char*>(to) + to_offset, data_size);
-  handler_->FinishCopyAck();
+void RPCEndpoint::CopyToRemote(void* from, size_t from_offset, void* to, size_t to_offset,
+                               size_t data_size, TVMContext ctx_to, DLDataType type_hint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  char* data = reinterpret_cast<char*>(from) + from_offset;
+  uint64_t handle = reinterpret_cast<uint64_t>(to);
+  size_t chunk_bytes = CopyChunkBytes(data_size, type_hint);
+  // All chunks are sent before the first acknowledgement is read.
+  size_t begin = 0;
+  do {
+    size_t nbytes = std::min(chunk_bytes, data_size - begin);
+    WriteCopyToRemote(data + begin, handle, to_offset + begin, nbytes, ctx_to, type_hint);
+    AddPendingReply(PendingReply());
+    begin += nbytes;
+  } while (begin < data_size);
+
+  if (!async_mode_) WaitPendingReplies(0);
+}
+
+void RPCEndpoint::CopyFromRemote(void* from, size_t from_offset, void* to, size_t to_offset,
+                                 size_t data_size, TVMContext ctx_from, DLDataType type_hint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  char* data = reinterpret_cast<char*>(to) + to_offset;
+  uint64_t handle = reinterpret_cast<uint64_t>(from);
+  size_t chunk_bytes = CopyChunkBytes(data_size, type_hint);
+  size_t begin = 0;
+  do {
+    size_t nbytes = std::min(chunk_bytes, data_size - begin);
+    WriteCopyFromRemote(handle, from_offset + begin, nbytes, ctx_from, type_hint);
+    PendingReply reply;
+    reply.code = RPCCode::kCopyAck;
+    reply.copy_to = data + begin;
+    reply.nbytes = nbytes;
+    AddPendingReply(std::move(reply));
+    begin += nbytes;
+  } while (begin < data_size);
+
+  WaitPendingReplies(0);
 }
 
 // SysCallEventHandler functions
@@ -1022,6 +1128,9 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
 
   bool IsLocalSession() const final { return false; }
 
+  /*! \return The client endpoint of the session. */
+  const std::shared_ptr<RPCEndpoint>& endpoint() const { return endpoint_; }
+
  private:
   std::shared_ptr<RPCEndpoint> endpoint_;
 };
@@ -1030,5 +1139,20 @@ std::shared_ptr<RPCSession> CreateClientSession(std::shared_ptr<RPCEndpoint> end
   return std::make_shared<RPCClientSession>(endpoint);
 }
 
+TVM_REGISTER_GLOBAL("rpc.SessionSetAsyncMode")
+    .set_body_typed([](Module sess, bool async_mode, int64_t copy_chunk_bytes) {
+      CHECK_GE(copy_chunk_bytes, 0) << "copy_chunk_bytes must be non-negative";
+      // Sessions that do not go through a channel are always synchronous.
+      auto* client = dynamic_cast<RPCClientSession*>(RPCModuleGetSession(sess).get());
+      if (client != nullptr) {
+        client->endpoint()->SetAsyncMode(async_mode, static_cast<size_t>(copy_chunk_bytes));
+      }
+    });
+
+TVM_REGISTER_GLOBAL("rpc.SessionSynchronize").set_body_typed([](Module sess) {
+  auto* client = dynamic_cast<RPCClientSession*>(RPCModuleGetSession(sess).get());
+  if (client != nullptr) client->endpoint()->Synchronize();
+});
+
 }  // namespace runtime
 }  // namespace tvm
@@ -26,6 +26,7 @@
 
 #include <tvm/runtime/packed_func.h>
 
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -61,9 +62,22 @@ enum class TrackerCode : int {
   kGetPendingMatchKeys = 7
 };
 
+/*! \brief Default size of the chunks large copies are split into. */
+constexpr size_t kRPCDefaultCopyChunkBytes = 1 << 20;
+/*! \brief Maximum number of requests a client keeps in flight before it waits for replies. */
+constexpr size_t kRPCMaxPendingRequests = 64;
+
 /*!
  * \brief Communication endpoints to connect local and remote RPC sessions.
  *        An endpoint can either be a client or a server.
+ *
+ *  The server handles requests strictly in order, so a client can pipeline
+ *  them: it writes several requests back to back and consumes the replies
+ *  in the same order later. Large copies are split into chunks that are all
+ *  sent before the first reply is read, and in async mode copies to the
+ *  remote and frees return without waiting for their replies at all.
+ *  Errors of such deferred requests are raised by the next request that
+ *  waits for its reply.
  */
 class RPCEndpoint {
  public:
@@ -150,6 +164,19 @@ class RPCEndpoint {
   void CopyFromRemote(void* from, size_t from_offset, void* to, size_t to_offset, size_t nbytes,
                       TVMContext ctx_from, DLDataType type_hint);
 
+  /*!
+   * \brief Configure the pipelining of the client.
+   * \param async_mode Whether copies to the remote and frees return before they are acknowledged.
+   * \param copy_chunk_bytes The size of the chunks large copies are split into,
+   *  0 disables chunking.
+   */
+  void SetAsyncMode(bool async_mode, size_t copy_chunk_bytes);
+  /*!
+   * \brief Wait for the replies of all requests in flight.
+   *  Raises the first error reported by the remote for a deferred request.
+   */
+  void Synchronize();
+
   /*!
    * \brief Call a remote defined system function with arguments.
    * \param fcode The function code.
@@ -171,9 +198,36 @@ class RPCEndpoint {
 
  private:
   class EventHandler;
+  /*! \brief A request whose reply has not been consumed yet. */
+  struct PendingReply {
+    /*! \brief The expected reply, kReturn or kCopyAck. */
+    RPCCode code{RPCCode::kReturn};
+    /*! \brief Destination of the data of a kCopyAck. */
+    char* copy_to{nullptr};
+    /*! \brief The number of bytes of the kCopyAck data. */
+    size_t nbytes{0};
+    /*! \brief Receives the return value, can be nullptr. */
+    RPCSession::FEncodeReturn encode_return;
+  };
   // Handle events until receives a return
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn);
+  // Flush the written requests into the channel.
+  void FlushWriter();
+  // Record a request that was just written, waiting for old ones if too many are in flight.
+  void AddPendingReply(PendingReply reply);
+  // Consume the replies until at most max_pending requests are in flight.
+  void WaitPendingReplies(size_t max_pending);
+  // Consume the reply of the oldest request in flight.
+  void HandleOnePendingReply();
+  // Write one kCopyToRemote request.
+  void WriteCopyToRemote(char* from, uint64_t handle, uint64_t offset, uint64_t size,
+                         TVMContext ctx_to, DLDataType type_hint);
+  // Write one kCopyFromRemote request.
+  void WriteCopyFromRemote(uint64_t handle, uint64_t offset, uint64_t size, TVMContext ctx_from,
+                           DLDataType type_hint);
+  // Split a copy of nbytes into chunks of whole elements.
+  size_t CopyChunkBytes(size_t nbytes, DLDataType type_hint) const;
   // Initalization
   void Init();
   // Shutdown
@@ -192,6 +246,12 @@ class RPCEndpoint {
   std::string name_;
   // The remote key
   std::string remote_key_;
+  // Requests in flight, in the order of their replies.
+  std::deque<PendingReply> pending_;
+  // Whether copies to the remote and frees do not wait for their replies.
+  bool async_mode_{false};
+  // The size of the chunks large copies are split into.
+  size_t copy_chunk_bytes_{kRPCDefaultCopyChunkBytes};
 };
 
 /*!
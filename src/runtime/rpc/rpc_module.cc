@@ -24,8 +24,12 @@
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <vector>
 #if defined(_M_X64) || defined(__x86_64__)
 #include <immintrin.h>
 #endif
@@ -205,6 +209,24 @@ class RPCModuleNode final : public ModuleNode {
     }
   }
 
+  PackedFunc GetAdaptiveTimeEvaluator(const std::string& name, TVMContext ctx, int number,
+                                      int min_repeat, int max_repeat, int min_repeat_ms,
+                                      double max_rel_ci, const std::string& f_preproc_name) {
+    InitRemoteFunc(&remote_get_adaptive_time_evaluator_, "runtime.RPCAdaptiveTimeEvaluator");
+    // Remove session mask because we pass ctx by parts.
+    int dev_type = ctx.device_type;
+    CHECK_EQ(dev_type / kRPCSessMask, sess_->table_index() + 1)
+        << "ValueError: Need to pass the matched remote context to "
+        << "RPCModule.GetAdaptiveTimeEvaluator";
+    ctx.device_type = static_cast<DLDeviceType>(ctx.device_type % kRPCSessMask);
+
+    Optional<Module> mod = module_handle_ != nullptr ? Optional<Module>(GetRef<Module>(this))
+                                                     : Optional<Module>(nullptr);
+    return remote_get_adaptive_time_evaluator_(mod, name, static_cast<int>(ctx.device_type),
+                                               ctx.device_id, number, min_repeat, max_repeat,
+                                               min_repeat_ms, max_rel_ci, f_preproc_name);
+  }
+
   Module LoadModule(std::string name) {
     InitRemoteFunc(&remote_load_module_, "tvm.rpc.server.load_module");
     return remote_load_module_(name);
@@ -241,6 +263,10 @@ class RPCModuleNode final : public ModuleNode {
   // remote function to get time evaluator
   TypedPackedFunc<PackedFunc(Optional<Module>, std::string, int, int, int, int, int, std::string)>
       remote_get_time_evaluator_;
+  // remote function to get adaptive time evaluator
+  TypedPackedFunc<PackedFunc(Optional<Module>, std::string, int, int, int, int, int, int, double,
+                             std::string)>
+      remote_get_adaptive_time_evaluator_;
   // remote function getter for modules.
   TypedPackedFunc<PackedFunc(Module, std::string, bool)> remote_mod_get_function_;
   // remote function getter for load module
@@ -398,6 +424,162 @@ PackedFunc WrapTimeEvaluator(PackedFunc pf, TVMContext ctx, int number, int repe
   return PackedFunc(ftimer);
 }
 
+/*!
+ * \brief The relative half width of the distribution-free 95% confidence interval of the median.
+ * \param costs The sorted costs.
+ * \return The half width of the interval divided by the median.
+ */
+static double MedianRelativeCI(const std::vector<double>& costs) {
+  int n = static_cast<int>(costs.size());
+  double median = n % 2 == 1 ? costs[n / 2] : (costs[n / 2 - 1] + costs[n / 2]) / 2;
+  if (median <= 0) {
+    return 0;
+  }
+  // The interval between the order statistics of ranks (n - 1.96 sqrt(n)) / 2 and
+  // 1 + (n + 1.96 sqrt(n)) / 2 covers the median with a probability of at least 95%.
+  double half_width = 1.96 * std::sqrt(static_cast<double>(n)) / 2;
+  int lo = std::max(static_cast<int>(std::floor(n / 2.0 - half_width)) - 1, 0);
+  int hi = std::min(static_cast<int>(std::ceil(1 + n / 2.0 + half_width)) - 1, n - 1);
+  return (costs[hi] - costs[lo]) / 2 / median;
+}
+
+/*!
+ * \brief Drop the costs further than three scaled median absolute deviations from the median.
+ * \param costs The costs in the order of measurement.
+ * \return The kept costs in the order of measurement.
+ */
+static std::vector<double> DropOutliers(const std::vector<double>& costs) {
+  auto median_of = [](std::vector<double> values) {
+    size_t n = values.size();
+    std::sort(values.begin(), values.end());
+    return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+  };
+  double median = median_of(costs);
+  std::vector<double> deviations;
+  for (double cost : costs) {
+    deviations.push_back(std::fabs(cost - median));
+  }
+  // 1.4826 scales the MAD to the standard deviation of a normal distribution
+  double bound = 3 * 1.4826 * median_of(deviations);
+  if (bound <= 0) {
+    return costs;
+  }
+  std::vector<double> kept;
+  for (double cost : costs) {
+    if (std::fabs(cost - median) <= bound) {
+      kept.push_back(cost);
+    }
+  }
+  return kept;
+}
+
+/*!
+ * \brief Repeat a measurement until the median is stable, then drop the outliers.
+ * \param fmeasure The function that takes one measurement and returns its cost.
+ * \param min_repeat The minimum number of repeats before checking the confidence interval.
+ * \param max_repeat The maximum number of repeats.
+ * \param max_rel_ci The maximum half width of the confidence interval relative to the median.
+ * \return The kept costs in the order of measurement.
+ */
+static std::vector<double> RepeatUntilStable(const std::function<double()>& fmeasure,
+                                             int min_repeat, int max_repeat, double max_rel_ci) {
+  std::vector<double> costs, sorted_costs;
+  while (static_cast<int>(costs.size()) < max_repeat) {
+    double cost = fmeasure();
+    costs.push_back(cost);
+    sorted_costs.insert(std::upper_bound(sorted_costs.begin(), sorted_costs.end(), cost), cost);
+    if (static_cast<int>(costs.size()) >= min_repeat &&
+        MedianRelativeCI(sorted_costs) <= max_rel_ci) {
+      break;
+    }
+  }
+  return DropOutliers(costs);
+}
+
+/*!
+ * \brief Pack the costs into a byte array of doubles.
+ * \param costs The costs.
+ * \param rv The return value.
+ */
+static void ReturnCosts(const std::vector<double>& costs, TVMRetValue* rv) {
+  std::ostringstream os;
+  for (double cost : costs) {
+    os.write(reinterpret_cast<const char*>(&cost), sizeof(cost));
+  }
+  std::string blob = os.str();
+  TVMByteArray arr;
+  arr.size = blob.length();
+  arr.data = blob.data();
+  *rv = arr;
+}
+
+PackedFunc WrapAdaptiveTimeEvaluator(PackedFunc pf, TVMContext ctx, int number, int min_repeat,
+                                     int max_repeat, int min_repeat_ms, double max_rel_ci,
+                                     PackedFunc f_preproc) {
+  CHECK(pf != nullptr);
+  CHECK_GT(number, 0);
+  CHECK_GT(min_repeat, 0);
+  CHECK_GE(max_repeat, min_repeat);
+  CHECK_GT(max_rel_ci, 0);
+  CHECK_NE(static_cast<int>(ctx.device_type), static_cast<int>(kDLMicroDev))
+      << "The adaptive time evaluator does not support the micro backend";
+
+  auto ftimer = [pf, ctx, number, min_repeat, max_repeat, min_repeat_ms, max_rel_ci, f_preproc](
+                    TVMArgs args, TVMRetValue* rv) mutable {
+    TVMRetValue temp;
+    // Run `number` times and return the average cost in seconds
+    auto time_runs = [&]() {
+      auto tbegin = std::chrono::high_resolution_clock::now();
+      for (int i = 0; i < number; ++i) {
+        pf.CallPacked(args, &temp);
+      }
+      DeviceAPI::Get(ctx)->StreamSync(ctx, nullptr);
+      auto tend = std::chrono::high_resolution_clock::now();
+      return std::chrono::duration_cast<std::chrono::duration<double>>(tend - tbegin).count() /
+             number;
+    };
+
+    // skip first time call, to activate lazy compilation components.
+    pf.CallPacked(args, &temp);
+    DeviceAPI::Get(ctx)->StreamSync(ctx, nullptr);
+
+    // Calibrate `number` against min_repeat_ms. These runs also warm up the device and are
+    // discarded.
+    if (min_repeat_ms > 0) {
+      double duration_ms = time_runs() * number * 1000;
+      while (duration_ms < min_repeat_ms) {
+        number = static_cast<int>(std::max((min_repeat_ms / (duration_ms / number) + 1),
+                                           number * 1.618));  // 1.618 is chosen by random
+        duration_ms = time_runs() * number * 1000;
+      }
+    }
+
+    auto measure = [&]() {
+      if (f_preproc != nullptr) {
+        f_preproc.CallPacked(args, &temp);
+      }
+      return time_runs();
+    };
+    // return the time.
+    ReturnCosts(RepeatUntilStable(measure, min_repeat, max_repeat, max_rel_ci), rv);
+  };
+  return PackedFunc(ftimer);
+}
+
+/*!
+ * \brief Get the preprocessing function of a time evaluator from the global registry.
+ * \param f_preproc_name The name of the function, empty for no preprocessing.
+ */
+static PackedFunc GetTimeEvaluatorPreproc(const std::string& f_preproc_name) {
+  PackedFunc f_preproc;
+  if (!f_preproc_name.empty()) {
+    auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
+    CHECK(pf_preproc != nullptr) << "Cannot find " << f_preproc_name << " in the global function";
+    f_preproc = *pf_preproc;
+  }
+  return f_preproc;
+}
+
 TVM_REGISTER_GLOBAL("runtime.RPCTimeEvaluator")
     .set_body_typed([](Optional<Module> opt_mod, std::string name, int device_type, int device_id,
                        int number, int repeat, int min_repeat_ms, std::string f_preproc_name) {
@@ -411,30 +593,48 @@ TVM_REGISTER_GLOBAL("runtime.RPCTimeEvaluator")
           return static_cast<RPCModuleNode*>(m.operator->())
               ->GetTimeEvaluator(name, ctx, number, repeat, min_repeat_ms, f_preproc_name);
         } else {
-          PackedFunc f_preproc;
-          if (!f_preproc_name.empty()) {
-            auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
-            CHECK(pf_preproc != nullptr)
-                << "Cannot find " << f_preproc_name << " in the global function";
-            f_preproc = *pf_preproc;
-          }
           return WrapTimeEvaluator(m.GetFunction(name, false), ctx, number, repeat, min_repeat_ms,
-                                   f_preproc);
+                                   GetTimeEvaluatorPreproc(f_preproc_name));
         }
       } else {
         auto* pf = runtime::Registry::Get(name);
         CHECK(pf != nullptr) << "Cannot find " << name << " in the global function";
-        PackedFunc f_preproc;
-        if (!f_preproc_name.empty()) {
-          auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
-          CHECK(pf_preproc != nullptr)
-              << "Cannot find " << f_preproc_name << " in the global function";
-          f_preproc = *pf_preproc;
+        return WrapTimeEvaluator(*pf, ctx, number, repeat, min_repeat_ms,
+                                 GetTimeEvaluatorPreproc(f_preproc_name));
+      }
+    });
+
+TVM_REGISTER_GLOBAL("runtime.RPCAdaptiveTimeEvaluator")
+    .set_body_typed([](Optional<Module> opt_mod, std::string name, int device_type, int device_id,
+                       int number, int min_repeat, int max_repeat, int min_repeat_ms,
+                       double max_rel_ci, std::string f_preproc_name) {
+      TVMContext ctx;
+      ctx.device_type = static_cast<DLDeviceType>(device_type);
+      ctx.device_id = device_id;
+      if (opt_mod.defined()) {
+        Module m = opt_mod.value();
+        if (m->type_key() == "rpc") {
+          return static_cast<RPCModuleNode*>(m.operator->())
+              ->GetAdaptiveTimeEvaluator(name, ctx, number, min_repeat, max_repeat, min_repeat_ms,
+                                         max_rel_ci, f_preproc_name);
         }
-        return WrapTimeEvaluator(*pf, ctx, number, repeat, min_repeat_ms, f_preproc);
+        return WrapAdaptiveTimeEvaluator(m.GetFunction(name, false), ctx, number, min_repeat,
+                                         max_repeat, min_repeat_ms, max_rel_ci,
+                                         GetTimeEvaluatorPreproc(f_preproc_name));
       }
+      auto* pf = runtime::Registry::Get(name);
+      CHECK(pf != nullptr) << "Cannot find " << name << " in the global function";
+      return WrapAdaptiveTimeEvaluator(*pf, ctx, number, min_repeat, max_repeat, min_repeat_ms,
+                                       max_rel_ci, GetTimeEvaluatorPreproc(f_preproc_name));
     });
 
+// Apply the stopping rule of the adaptive time evaluator to the costs returned by `fmeasure`.
+TVM_REGISTER_GLOBAL("testing.adaptive_repeat").set_body([](TVMArgs args, TVMRetValue* rv) {
+  PackedFunc fmeasure = args[0];
+  auto measure = [&fmeasure]() -> double { return fmeasure(); };
+  ReturnCosts(RepeatUntilStable(measure, args[1], args[2], args[3]), rv);
+});
+
 TVM_REGISTER_GLOBAL("cache_flush_cpu_non_first_arg").set_body([](TVMArgs args, TVMRetValue* rv) {
   CPUCacheFlush(1, args);
 });
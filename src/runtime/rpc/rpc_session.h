@@ -330,6 +330,29 @@ struct RemoteSpace {
 PackedFunc WrapTimeEvaluator(PackedFunc f, TVMContext ctx, int number, int repeat,
                              int min_repeat_ms, PackedFunc f_preproc = nullptr);
 
+/*!
+ * \brief Wrap a timer function that repeats the measurement until the result is stable.
+ *
+ * Unlike WrapTimeEvaluator, the number of repeats is not fixed. After the first call and the
+ * runs that calibrate `number` against `min_repeat_ms` (all discarded as warm-up), the timer
+ * keeps adding repeats until the distribution-free 95% confidence interval of the median cost
+ * is within `max_rel_ci` of the median, or `max_repeat` repeats have been taken. The repeats
+ * further than three scaled median absolute deviations from the median are dropped as outliers.
+ *
+ * \param f The function argument.
+ * \param ctx The context.
+ * \param number The number of times to run this function for taking average in one repeat.
+ * \param min_repeat The minimum number of repeats before checking the confidence interval.
+ * \param max_repeat The maximum number of repeats.
+ * \param min_repeat_ms The minimum duration of one `repeat` in milliseconds.
+ * \param max_rel_ci The maximum half width of the confidence interval relative to the median.
+ * \param f_preproc The function to be executed before each repeat, e.g. to flush the caches.
+ * \return f_timer A timer function which returns the kept costs as a byte array of doubles.
+ */
+PackedFunc WrapAdaptiveTimeEvaluator(PackedFunc f, TVMContext ctx, int number, int min_repeat,
+                                     int max_repeat, int min_repeat_ms, double max_rel_ci,
+                                     PackedFunc f_preproc = nullptr);
+
 /*!
  * \brief Create a Global RPC module that refers to the session.
  * \param sess The RPC session of the global module.
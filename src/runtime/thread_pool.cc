@@ -60,6 +60,63 @@ uint32_t GetSpinCount() {
 
 }  // namespace
 
+/*! \brief The scheduling policy used to distribute tasks of a parallel launch. */
+enum class ThreadPoolScheduler : int {
+  /*! \brief Task i is pushed to worker i, one task per worker. */
+  kStatic = 0,
+  /*!
+   * \brief Task ids are split into per-worker ranges,
+   *  idle workers steal from the back of the ranges of busy workers.
+   */
+  kWorkStealing = 1,
+};
+
+/*!
+ * \brief Global scheduler configuration, shared by the pools of all master threads.
+ */
+class ThreadPoolSchedulerConfig {
+ public:
+  ThreadPoolSchedulerConfig() {
+    const char* kind = getenv("TVM_THREAD_POOL_SCHEDULER");
+    if (kind != nullptr) {
+      kind_.store(static_cast<int>(ParseKind(kind)));
+    }
+    const char* tasks_per_worker = getenv("TVM_THREAD_POOL_TASKS_PER_WORKER");
+    if (tasks_per_worker != nullptr) {
+      tasks_per_worker_.store(std::max(atoi(tasks_per_worker), 1));
+    }
+  }
+
+  ThreadPoolScheduler kind() const { return static_cast<ThreadPoolScheduler>(kind_.load()); }
+
+  int tasks_per_worker() const { return tasks_per_worker_.load(); }
+
+  void Update(ThreadPoolScheduler kind, int tasks_per_worker) {
+    CHECK_GE(tasks_per_worker, 1) << "tasks_per_worker must be positive";
+    kind_.store(static_cast<int>(kind));
+    tasks_per_worker_.store(tasks_per_worker);
+  }
+
+  static ThreadPoolScheduler ParseKind(const std::string& kind) {
+    if (kind == "static") return ThreadPoolScheduler::kStatic;
+    if (kind == "work_stealing") return ThreadPoolScheduler::kWorkStealing;
+    LOG(FATAL) << "Unknown thread pool scheduler " << kind
+               << ", candidates are: static, work_stealing";
+    return ThreadPoolScheduler::kStatic;
+  }
+
+  static ThreadPoolSchedulerConfig* Global() {
+    static ThreadPoolSchedulerConfig inst;
+    return &inst;
+  }
+
+ private:
+  // The scheduler kind.
+  std::atomic<int> kind_{static_cast<int>(ThreadPoolScheduler::kStatic)};
+  // Number of tasks created per worker when the launch leaves num_task to the runtime.
+  std::atomic<int> tasks_per_worker_{1};
+};
+
 // stride in the page, fit to cache line.
 constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
 
@@ -78,10 +135,11 @@ class ParallelLauncher {
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
-      if (need_sync) {
-        delete[] sync_counter_;
-        sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
-      }
+    }
+    if (need_sync && num_task > sync_capacity_) {
+      delete[] sync_counter_;
+      sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
+      sync_capacity_ = num_task;
     }
     if (need_sync) {
       for (int i = 0; i < num_task; ++i) {
@@ -136,6 +194,8 @@ class ParallelLauncher {
   std::atomic<bool> has_error_;
   // The counter page.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  // Number of tasks the counter page can host.
+  int sync_capacity_{0};
   // The error message
   std::vector<std::string> par_errors_;
 };
@@ -195,6 +255,20 @@ class SpscTaskQueue {
     return true;
   }
 
+  /*!
+   * \brief Try to push a task into the queue without waiting for a free slot.
+   * \param input The task to be enqueued.
+   * \return Whether the task is enqueued.
+   */
+  bool TryPush(const Task& input) {
+    if (!Enqueue(input)) return false;
+    if (pending_.fetch_add(1) == -1) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.notify_one();
+    }
+    return true;
+  }
+
   /*!
    * \brief Signal to terminate the worker.
    */
@@ -254,34 +328,136 @@ class SpscTaskQueue {
   std::condition_variable cv_;
 };
 
+/*!
+ * \brief A contiguous range of task ids owned by one worker.
+ *
+ *  The owner pops task ids one at a time from the front while thieves
+ *  steal the back half of the remaining range. The bounds and the epoch of
+ *  the launch they belong to are packed in one word so that every update is
+ *  a single compare-and-swap.
+ *
+ *  A worker may still be stealing for a finished launch when the master
+ *  publishes the ranges of the next one, so the ids stolen by a thief are
+ *  only installed in its own range when that range is empty and belongs to
+ *  the same launch. A stale thief can then neither overwrite the new range
+ *  nor hand out ids of a finished launch.
+ */
+class StealableTaskRange {
+ public:
+  /*! \brief The maximum number of task ids of a launch. */
+  static constexpr int32_t kMaxNumTask = 1 << 24;
+
+  /*!
+   * \brief Publish the range of a new launch, only called by the master before waking the
+   *  workers of the launch.
+   * \param epoch The epoch of the launch.
+   * \param begin The first task id.
+   * \param end One past the last task id.
+   */
+  void Reset(uint32_t epoch, int32_t begin, int32_t end) {
+    bounds_.store(Pack(epoch, begin, end), std::memory_order_release);
+  }
+
+  /*!
+   * \brief Install stolen task ids, only called by the owner.
+   * \param epoch The epoch of the launch the ids were stolen from.
+   * \param begin The first task id.
+   * \param end One past the last task id.
+   * \return Whether the ids were installed, which requires the range to be empty and to
+   *  belong to the same launch.
+   */
+  bool Install(uint32_t epoch, int32_t begin, int32_t end) {
+    uint64_t bounds = bounds_.load(std::memory_order_acquire);
+    while (Epoch(bounds) == epoch && Begin(bounds) >= End(bounds)) {
+      if (bounds_.compare_exchange_weak(bounds, Pack(epoch, begin, end),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Pop the first task id of the range.
+   * \param task_id The popped task id.
+   * \return Whether a task id was popped.
+   */
+  bool PopFront(int32_t* task_id) {
+    uint64_t bounds = bounds_.load(std::memory_order_acquire);
+    while (Begin(bounds) < End(bounds)) {
+      if (bounds_.compare_exchange_weak(bounds,
+                                        Pack(Epoch(bounds), Begin(bounds) + 1, End(bounds)),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+        *task_id = Begin(bounds);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Steal the back half of the range.
+   * \param epoch The epoch of the launch the ids belong to.
+   * \param begin The first stolen task id.
+   * \param end One past the last stolen task id.
+   * \return Whether anything was stolen.
+   */
+  bool StealBack(uint32_t* epoch, int32_t* begin, int32_t* end) {
+    uint64_t bounds = bounds_.load(std::memory_order_acquire);
+    while (Begin(bounds) < End(bounds)) {
+      int32_t split = End(bounds) - (End(bounds) - Begin(bounds) + 1) / 2;
+      if (bounds_.compare_exchange_weak(bounds, Pack(Epoch(bounds), Begin(bounds), split),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+        *epoch = Epoch(bounds);
+        *begin = split;
+        *end = End(bounds);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  // 16 bits of epoch, then 24 bits for each bound.
+  static uint64_t Pack(uint32_t epoch, int32_t begin, int32_t end) {
+    return (static_cast<uint64_t>(epoch & 0xFFFFU) << 48) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(begin)) << 24) |
+           static_cast<uint32_t>(end);
+  }
+  static uint32_t Epoch(uint64_t bounds) { return static_cast<uint32_t>(bounds >> 48); }
+  static int32_t Begin(uint64_t bounds) {
+    return static_cast<int32_t>((bounds >> 24) & 0xFFFFFFU);
+  }
+  static int32_t End(uint64_t bounds) { return static_cast<int32_t>(bounds & 0xFFFFFFU); }
+
+  // the cache line paddings keep the ranges of different workers apart
+  typedef char cache_line_pad_t[kL1CacheBytes];
+  cache_line_pad_t pad0_;
+  std::atomic<uint64_t> bounds_{0};
+  cache_line_pad_t pad1_;
+};
+
 // The thread pool
 class ThreadPool {
  public:
-  ThreadPool() : num_workers_(tvm::runtime::threading::MaxConcurrency()) {
-    for (int i = 0; i < num_workers_; ++i) {
-      // The SpscTaskQueue only hosts ONE item at a time
-      queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
-    }
+  ThreadPool() {
     const char* exclude_worker0 = getenv("TVM_EXCLUDE_WORKER0");
     if (exclude_worker0 && atoi(exclude_worker0) == 0) {
       exclude_worker0_ = false;
     }
-    threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
-        new tvm::runtime::threading::ThreadGroup(
-            num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
-            exclude_worker0_ /* include_main_thread */));
+    StartWorkers(tvm::runtime::threading::MaxConcurrency());
     num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
   }
-  ~ThreadPool() {
-    for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
-      q->SignalForKill();
-    }
-    threads_.reset();
-  }
+  ~ThreadPool() { StopWorkers(); }
   int Launch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync) {
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
     CHECK(!launcher->is_worker)
         << "Cannot launch parallel job inside worker, consider fuse then parallel";
+    const ThreadPoolSchedulerConfig* config = ThreadPoolSchedulerConfig::Global();
+    if (config->kind() == ThreadPoolScheduler::kWorkStealing) {
+      return LaunchWorkStealing(launcher, flambda, cdata, num_task, need_sync,
+                                config->tasks_per_worker());
+    }
     if (num_task == 0) {
       num_task = num_workers_used_;
     }
@@ -311,18 +487,94 @@ class ThreadPool {
     return res;
   }
 
+  /*!
+   * \brief Launch with the work-stealing scheduler.
+   *
+   *  The task ids are split into one contiguous range per used worker.
+   *  Each worker drains its own range and then steals half of the remaining
+   *  range of another worker, so a slow or descheduled worker only delays
+   *  the tasks it has actually started.
+   *
+   *  When num_task is left to the runtime, tasks_per_worker tasks are created
+   *  for each worker to give the scheduler room to balance. Such over-decomposed
+   *  launches cannot use TVMBackendParallelBarrier since not all tasks run at once.
+   */
+  int LaunchWorkStealing(ParallelLauncher* launcher, FTVMParallelLambda flambda, void* cdata,
+                         int num_task, int need_sync, int tasks_per_worker) {
+    bool sync = need_sync != 0;
+    if (num_task == 0) {
+      num_task = num_workers_used_ * tasks_per_worker;
+      // Barriers require every task to be live at the same time.
+      sync = sync && tasks_per_worker == 1;
+    } else if (sync) {
+      CHECK_LE(num_task, num_workers_used_)
+          << "Request parallel sync task larger than number of threads used "
+          << " workers=" << num_workers_used_ << " request=" << num_task;
+    }
+    CHECK_LT(num_task, StealableTaskRange::kMaxNumTask)
+        << "Too many tasks for the work-stealing scheduler: " << num_task;
+    launcher->Init(flambda, cdata, num_task, sync);
+    // Only the ranges of this launch carry the new epoch, see StealableTaskRange.
+    ++launch_epoch_;
+    int num_ranges = std::min(num_task, num_workers_used_);
+    for (int i = 0; i < num_ranges; ++i) {
+      ranges_[i]->Reset(launch_epoch_, static_cast<int64_t>(num_task) * i / num_ranges,
+                        static_cast<int64_t>(num_task) * (i + 1) / num_ranges);
+    }
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    tsk.task_id = kStealTaskId;
+    for (int i = exclude_worker0_; i < num_ranges; ++i) {
+      // A full queue means the worker has a pending wake up and will look for work anyway.
+      queues_[i]->TryPush(tsk);
+    }
+    if (exclude_worker0_) {
+      RunStealableTasks(launcher, 0);
+    }
+    return launcher->WaitForJobs();
+  }
+
   static ThreadPool* ThreadLocal() { return dmlc::ThreadLocalStore<ThreadPool>::Get(); }
 
-  void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads) {
+  void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads,
+                                 int core_offset) {
+    // A pool bound to a partition of the cores only keeps the workers of its partition,
+    // the others would oversubscribe the cores of the other partitions.
+    if (core_offset >= 0 && nthreads > 0 && nthreads != num_workers_) {
+      StopWorkers();
+      StartWorkers(nthreads);
+    }
     // this will also reset the affinity of the ThreadGroup
     // may use less than the MaxConcurrency number of workers
-    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_);
+    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_, core_offset);
     // if MaxConcurrency restricted the number of workers (e.g., due to
     // hyperthreading), respect the restriction
     num_workers_used_ = std::min(num_workers_, num_workers_used_);
   }
 
  private:
+  // Create num_workers workers with their queues and task ranges.
+  void StartWorkers(int num_workers) {
+    num_workers_ = num_workers;
+    for (int i = 0; i < num_workers_; ++i) {
+      // The SpscTaskQueue only hosts ONE item at a time
+      queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
+      ranges_.emplace_back(std::unique_ptr<StealableTaskRange>(new StealableTaskRange()));
+    }
+    threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
+        new tvm::runtime::threading::ThreadGroup(
+            num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
+            exclude_worker0_ /* include_main_thread */));
+  }
+  // Stop and join all workers, no launch of this pool may be in progress.
+  void StopWorkers() {
+    for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
+      q->SignalForKill();
+    }
+    threads_.reset();
+    queues_.clear();
+    ranges_.clear();
+  }
   // Internal worker function.
   void RunWorker(int worker_id) {
     SpscTaskQueue* queue = queues_[worker_id].get();
@@ -334,6 +586,10 @@ class ThreadPool {
     static size_t spin_count = GetSpinCount();
     while (queue->Pop(&task, spin_count)) {
       CHECK(task.launcher != nullptr);
+      if (task.task_id == kStealTaskId) {
+        RunStealableTasks(task.launcher, worker_id);
+        continue;
+      }
       TVMParallelGroupEnv* penv = &(task.launcher->env);
       void* cdata = task.launcher->cdata;
       if ((*task.launcher->flambda)(task.task_id, penv, cdata) == 0) {
@@ -343,12 +599,53 @@ class ThreadPool {
       }
     }
   }
-  int num_workers_;
+  // Drain the own range of worker_id, then steal from other ranges until all are empty.
+  void RunStealableTasks(ParallelLauncher* launcher, int worker_id) {
+    StealableTaskRange* own = ranges_[worker_id].get();
+    uint32_t epoch;
+    int32_t task_id, begin, end;
+    while (true) {
+      while (own->PopFront(&task_id)) {
+        RunTask(launcher, task_id);
+      }
+      bool stolen = false;
+      for (int i = 1; i < num_workers_ && !stolen; ++i) {
+        int victim = (worker_id + i) % num_workers_;
+        if (ranges_[victim]->StealBack(&epoch, &begin, &end)) {
+          // Publish the rest of the stolen ids for other thieves. The own range may already
+          // hold the ids of a newer launch, the stolen ids are then run here.
+          if (own->Install(epoch, begin + 1, end)) {
+            end = begin + 1;
+          }
+          for (int32_t id = begin; id < end; ++id) {
+            RunTask(launcher, id);
+          }
+          stolen = true;
+        }
+      }
+      if (!stolen) return;
+    }
+  }
+  // Run one task, the launcher fields are read after the task id is claimed.
+  static void RunTask(ParallelLauncher* launcher, int32_t task_id) {
+    if ((*launcher->flambda)(task_id, &(launcher->env), launcher->cdata) == 0) {
+      launcher->SignalJobFinish();
+    } else {
+      launcher->SignalJobError(task_id);
+    }
+  }
+  // Task id of the wake up message used by the work-stealing scheduler.
+  static constexpr int32_t kStealTaskId = -1;
+  int num_workers_{0};
   // number of workers used (can be restricted with affinity pref)
   int num_workers_used_;
   // if or not to exclude worker 0 and use master to run task 0
   bool exclude_worker0_{true};
+  // epoch of the last work-stealing launch, tags the task ranges of the launch
+  uint32_t launch_epoch_{0};
   std::vector<std::unique_ptr<SpscTaskQueue> > queues_;
+  // task ranges of the work-stealing scheduler, one per worker
+  std::vector<std::unique_ptr<StealableTaskRange> > ranges_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
 
@@ -356,9 +653,24 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRe
   threading::ThreadGroup::AffinityMode mode =
       static_cast<threading::ThreadGroup::AffinityMode>(static_cast<int>(args[0]));
   int nthreads = args[1];
-  ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads);
+  int core_offset = -1;
+  if (args.size() > 2) {
+    core_offset = args[2];
+  }
+  ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads, core_offset);
 });
 
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_scheduler")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      std::string kind = args[0];
+      int tasks_per_worker = 1;
+      if (args.size() > 1) {
+        tasks_per_worker = args[1];
+      }
+      ThreadPoolSchedulerConfig::Global()->Update(ThreadPoolSchedulerConfig::ParseKind(kind),
+                                                  tasks_per_worker);
+    });
+
 }  // namespace runtime
 }  // namespace tvm
 
@@ -385,6 +697,9 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
 #pragma omp barrier
 #else
   using tvm::runtime::kSyncStride;
+  CHECK(penv->sync_handle != nullptr)
+      << "Parallel barrier is not supported when the work-stealing thread pool creates more "
+      << "than one task per worker, set TVM_THREAD_POOL_TASKS_PER_WORKER=1";
   int num_task = penv->num_task;
   std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
   int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
@@ -399,3 +714,31 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
 #endif
   return 0;
 }
+
+int TVMBackendParallelGetChunk(int64_t* counter, int64_t base, int64_t extent,
+                               int64_t chunk_size, int num_task, int guided, int64_t* begin,
+                               int64_t* end) {
+  static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t),
+                "The iteration counter must be usable as an atomic");
+  std::atomic<int64_t>* next = reinterpret_cast<std::atomic<int64_t>*>(counter);
+  chunk_size = std::max<int64_t>(chunk_size, 1);
+  num_task = std::max(num_task, 1);
+  // The counter must stop exactly at the end of the entry, where the next entry starts,
+  // so the chunks are taken by compare-and-swap rather than fetch_add.
+  int64_t last_iter = base + extent;
+  int64_t first = next->load(std::memory_order_relaxed);
+  while (first < last_iter) {
+    int64_t size = chunk_size;
+    if (guided) {
+      // Guided: each chunk takes its share of the remaining iterations, as in OpenMP.
+      size = std::max(chunk_size, (last_iter - first + num_task - 1) / num_task);
+    }
+    int64_t last = std::min(first + size, last_iter);
+    if (next->compare_exchange_weak(first, last, std::memory_order_relaxed)) {
+      *begin = first - base;
+      *end = last - base;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -60,7 +60,7 @@ class ThreadGroup::Impl {
     }
   }
 
-  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0) {
+  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0, int core_offset) {
     int num_workers_used = 0;
     if (mode == kLittle) {
       num_workers_used = little_count_;
@@ -84,7 +84,7 @@ class ThreadGroup::Impl {
     if (val == nullptr || atoi(val) == 1) {
       // Do not set affinity if there are more workers than found cores
       if (sorted_order_.size() >= static_cast<unsigned int>(num_workers_)) {
-        SetAffinity(exclude_worker0, mode == kLittle);
+        SetAffinity(exclude_worker0, mode == kLittle, core_offset, num_workers_used);
       } else {
         LOG(WARNING) << "The thread affinity cannot be set when the number of workers"
                      << "is larger than the number of available cores in the system.";
@@ -97,7 +97,11 @@ class ThreadGroup::Impl {
   // bind worker threads to disjoint cores
   // if worker 0 is offloaded to master, i.e. exclude_worker0 is true,
   // the master thread is bound to core 0.
-  void SetAffinity(bool exclude_worker0, bool reverse = false) {
+  // core_offset shifts the cores in the sorted order, so that several
+  // groups can be bound to disjoint partitions of the cores; the master
+  // thread then stays on the cores of its partition. A negative core_offset
+  // binds from the first core and leaves the master free to migrate.
+  void SetAffinity(bool exclude_worker0, bool reverse, int core_offset, int num_workers_used) {
 #if defined(__ANDROID__)
 #ifndef CPU_SET
 #define CPU_SETSIZE 1024
@@ -114,13 +118,10 @@ class ThreadGroup::Impl {
 #if defined(__linux__) || defined(__ANDROID__)
     CHECK_GE(sorted_order_.size(), num_workers_);
 
+    bool partition = core_offset >= 0;
+    core_offset = std::max(core_offset, 0);
     for (unsigned i = 0; i < threads_.size(); ++i) {
-      unsigned core_id;
-      if (reverse) {
-        core_id = sorted_order_[sorted_order_.size() - (i + exclude_worker0) - 1];
-      } else {
-        core_id = sorted_order_[i + exclude_worker0];
-      }
+      unsigned core_id = CoreId(i + exclude_worker0 + core_offset, reverse);
       cpu_set_t cpuset;
       CPU_ZERO(&cpuset);
       CPU_SET(core_id, &cpuset);
@@ -135,8 +136,34 @@ class ThreadGroup::Impl {
       // Typically, the OS will schedule the master thread to run at core 0,
       // which is idle, when other workers are running.
       // See the comment inside SetMasterThreadFullCpuAffinity function to get more detail.
-      SetMasterThreadFullCpuAffinity(reverse);
+      if (!partition) {
+        SetMasterThreadFullCpuAffinity(reverse);
+      } else {
+        SetMasterThreadPartitionAffinity(reverse, core_offset, num_workers_used);
+      }
+    }
+#endif
+  }
+
+  // the core at the given position of the sorted order, wrapping around.
+  unsigned CoreId(unsigned pos, bool reverse) const {
+    pos %= sorted_order_.size();
+    return reverse ? sorted_order_[sorted_order_.size() - pos - 1] : sorted_order_[pos];
+  }
+
+  // Bind the master thread to the partition of cores used by this group.
+  void SetMasterThreadPartitionAffinity(bool reverse, int core_offset, int num_workers_used) {
+#if defined(__linux__) || defined(__ANDROID__)
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int i = 0; i < num_workers_used; ++i) {
+      CPU_SET(CoreId(core_offset + i, reverse), &cpuset);
     }
+#if defined(__ANDROID__)
+    sched_setaffinity(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#else
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
 #endif
   }
 
@@ -231,8 +258,9 @@ ThreadGroup::ThreadGroup(int num_workers, std::function<void(int)> worker_callba
 ThreadGroup::~ThreadGroup() { delete impl_; }
 void ThreadGroup::Join() { impl_->Join(); }
 
-int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0) {
-  return impl_->Configure(mode, nthreads, exclude_worker0);
+int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0,
+                           int core_offset) {
+  return impl_->Configure(mode, nthreads, exclude_worker0, core_offset);
 }
 
 void Yield() { std::this_thread::yield(); }
@@ -37,6 +37,7 @@
 #include <utility>
 #include <vector>
 
+#include "../mapped_file.h"
 #include "serialize_util.h"
 
 namespace tvm {
@@ -240,7 +241,7 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
   strm->Write(glbs);
 }
 
-void Executable::SaveConstantSection(dmlc::Stream* strm) {
+void Executable::SaveConstantSection(dmlc::SeekStream* strm) {
   std::vector<DLTensor*> arrays;
   for (const auto& obj : this->constants) {
     const auto cell = Downcast<runtime::NDArray>(obj);
@@ -248,7 +249,7 @@ void Executable::SaveConstantSection(dmlc::Stream* strm) {
   }
   strm->Write(static_cast<uint64_t>(this->constants.size()));
   for (const auto& it : arrays) {
-    runtime::SaveDLTensor(strm, it);
+    runtime::SaveAlignedDLTensor(strm, it);
   }
 
   // Save the const to device mapping.
@@ -484,23 +485,34 @@ runtime::Module Executable::Load(const std::string& code, const runtime::Module
   exec->lib = lib;
   exec->code_ = code;
   dmlc::MemoryStringStream strm(&exec->code_);
+  exec->LoadSections(&strm, nullptr);
+  return runtime::Module(exec);
+}
+
+runtime::Module Executable::LoadFromFile(const std::string& path, const runtime::Module lib) {
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  std::shared_ptr<MappedFile> mapping = MappedFile::Open(path);
+  dmlc::MemoryFixedSizeStream strm(mapping->data(), mapping->size());
+  exec->LoadSections(&strm, mapping);
+  return runtime::Module(exec);
+}
 
+void Executable::LoadSections(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapping) {
   // Load header.
-  LoadHeader(&strm);
+  LoadHeader(strm);
 
   // Global section.
-  exec->LoadGlobalSection(&strm);
+  LoadGlobalSection(strm);
 
   // Constant section.
-  exec->LoadConstantSection(&strm);
+  LoadConstantSection(strm, mapping);
 
   // Primitive names that will be invoked by `InvokePacked` instructions.
-  exec->LoadPrimitiveOpNames(&strm);
+  LoadPrimitiveOpNames(strm);
 
   // Code section.
-  exec->LoadCodeSection(&strm);
-
-  return runtime::Module(exec);
+  LoadCodeSection(strm);
 }
 
 void Executable::LoadGlobalSection(dmlc::Stream* strm) {
@@ -511,7 +523,8 @@ void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   }
 }
 
-void Executable::LoadConstantSection(dmlc::Stream* strm) {
+void Executable::LoadConstantSection(dmlc::SeekStream* strm,
+                                     const std::shared_ptr<MappedFile>& mapping) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
@@ -519,9 +532,19 @@ void Executable::LoadConstantSection(dmlc::Stream* strm) {
   size_t size = static_cast<size_t>(sz);
   // Load each of the constants.
   for (size_t i = 0; i < size; i++) {
-    runtime::NDArray constant;
-    STREAM_CHECK(constant.Load(strm), "constant");
-    this->constants.push_back(constant);
+    // Executables saved before the aligned layout hold plain NDArray records, which are told
+    // apart by their magic number and copied rather than aliased.
+    size_t pos = strm->Tell();
+    uint64_t magic;
+    STREAM_CHECK(strm->Read(&magic), "constant");
+    strm->Seek(pos);
+    if (magic == runtime::kTVMNDArrayMagic) {
+      runtime::NDArray constant;
+      STREAM_CHECK(constant.Load(strm), "constant");
+      this->constants.push_back(constant);
+    } else {
+      this->constants.push_back(runtime::LoadAlignedDLTensor(strm, mapping));
+    }
   }
 
   // Load the const to device mapping.
@@ -821,6 +844,11 @@ TVM_REGISTER_GLOBAL("runtime.Load_Executable")
       return Executable::Load(code, lib);
     });
 
+TVM_REGISTER_GLOBAL("runtime.Load_ExecutableFromFile")
+    .set_body_typed([](std::string path, runtime::Module lib) {
+      return Executable::LoadFromFile(path, lib);
+    });
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -21,9 +21,11 @@
  * \file tvm/runtime/vm/memory_manager.cc
  * \brief Allocate and manage memory for the runtime.
  */
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "naive_allocator.h"
@@ -159,6 +161,16 @@ Allocator* MemoryManager::GetAllocator(TVMContext ctx) {
   return it->second.get();
 }
 
+AllocatorStats MemoryManager::GetStats(TVMContext ctx) { return GetAllocator(ctx)->Stats(); }
+
+void MemoryManager::TrimAll() {
+  MemoryManager* m = MemoryManager::Global();
+  std::lock_guard<std::mutex> lock(m->mu_);
+  for (auto& it : m->allocators_) {
+    it.second->Trim(0);
+  }
+}
+
 NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLContext ctx) {
   VerifyDataType(dtype);
   NDArray::Container* container = new NDArray::Container(nullptr, shape, dtype, ctx);
@@ -172,6 +184,37 @@ NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLContext
   return NDArray(GetObjectPtr<Object>(container));
 }
 
+TVM_REGISTER_GLOBAL("runtime.VMAllocatorStats").set_body([](TVMArgs args, TVMRetValue* rv) {
+  TVMContext ctx;
+  ctx.device_type = static_cast<DLDeviceType>(args[0].operator int());
+  ctx.device_id = args[1];
+  std::string name = args[2];
+  AllocatorStats stats = MemoryManager::GetStats(ctx);
+  if (name == "hits") {
+    *rv = static_cast<int64_t>(stats.hits);
+  } else if (name == "misses") {
+    *rv = static_cast<int64_t>(stats.misses);
+  } else if (name == "allocated_bytes") {
+    *rv = static_cast<int64_t>(stats.allocated_bytes);
+  } else if (name == "pooled_bytes") {
+    *rv = static_cast<int64_t>(stats.pooled_bytes);
+  } else if (name == "trimmed_bytes") {
+    *rv = static_cast<int64_t>(stats.trimmed_bytes);
+  } else if (name == "requested_bytes") {
+    *rv = static_cast<int64_t>(stats.requested_bytes);
+  } else if (name == "served_bytes") {
+    *rv = static_cast<int64_t>(stats.served_bytes);
+  } else if (name == "fragmentation") {
+    *rv = stats.Fragmentation();
+  } else {
+    LOG(FATAL) << "Unknown allocator statistic: " << name;
+  }
+});
+
+TVM_REGISTER_GLOBAL("runtime.VMAllocatorTrimAll").set_body_typed([]() {
+  MemoryManager::TrimAll();
+});
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
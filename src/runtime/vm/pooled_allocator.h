@@ -26,73 +26,287 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
 namespace vm {
 
+/*!
+ * \brief A size-class caching allocator.
+ *
+ *  Requests are rounded up to size classes, four per power of two and at least one page,
+ *  so buffers of slightly different sizes, as produced by dynamic shapes, can be reused
+ *  while the internal waste stays below 25%. Small buffers are first cached per thread to
+ *  avoid taking the shared lock; the rest go to a shared free list per size class. When the
+ *  cached bytes exceed the high-water mark, the per-thread caches are drained into the
+ *  shared free lists and the largest free buffers are returned to the device. The
+ *  high-water mark is read from TVM_VM_POOL_HIGH_WATER_MARK_MB, 0 means unbounded.
+ */
 class PooledAllocator final : public Allocator {
  public:
   static constexpr size_t kDefaultPageSize = 4096;
+  /*! \brief The largest size class kept in the per-thread caches. */
+  static constexpr size_t kThreadCacheMaxBufferSize = 1 << 20;
+  /*! \brief The number of buffers each per-thread cache can hold. */
+  static constexpr size_t kThreadCacheCapacity = 8;
 
-  explicit PooledAllocator(TVMContext ctx, size_t page_size = kDefaultPageSize)
-      : Allocator(kPooled), page_size_(page_size), used_memory_(0), ctx_(ctx) {}
+  explicit PooledAllocator(TVMContext ctx, size_t page_size = kDefaultPageSize,
+                           size_t high_water_mark = DefaultHighWaterMark())
+      : Allocator(kPooled),
+        page_size_(page_size),
+        high_water_mark_(high_water_mark),
+        id_(NextId()),
+        shared_(std::make_shared<SharedState>()),
+        ctx_(ctx) {
+    shared_->owner = this;
+  }
 
   ~PooledAllocator() { ReleaseAll(); }
 
   Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
-    std::lock_guard<std::mutex> lock(mu_);
-    size_t size = ((nbytes + page_size_ - 1) / page_size_) * page_size_;
-    auto&& it = memory_pool_.find(size);
-    if (it != memory_pool_.end() && !it->second.empty()) {
-      auto&& pool = it->second;
-      auto ret = pool.back();
-      pool.pop_back();
-      return ret;
-    }
+    size_t size = SizeClass(nbytes);
+    requested_bytes_.fetch_add(nbytes, std::memory_order_relaxed);
+    served_bytes_.fetch_add(size, std::memory_order_relaxed);
     Buffer buf;
+    if (PopThreadCache(size, &buf) || PopPool(size, &buf)) {
+      pooled_bytes_.fetch_sub(size, std::memory_order_relaxed);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return buf;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
     buf.ctx = ctx_;
     buf.size = size;
-    buf.data = DeviceAPI::Get(ctx_)->AllocDataSpace(ctx_, size, alignment, type_hint);
+    alignment = std::max(alignment, static_cast<size_t>(kAllocAlignment));
+    try {
+      buf.data = DeviceAPI::Get(ctx_)->AllocDataSpace(ctx_, size, alignment, type_hint);
+    } catch (const dmlc::Error&) {
+      // The device may be out of memory because of the cached buffers, retry after dropping them.
+      Trim(0);
+      buf.data = DeviceAPI::Get(ctx_)->AllocDataSpace(ctx_, size, alignment, type_hint);
+    }
     used_memory_.fetch_add(size, std::memory_order_relaxed);
     DLOG(INFO) << "allocate " << size << " B, used memory " << used_memory_ << " B";
     return buf;
   }
 
   void Free(const Buffer& buffer) override {
-    std::lock_guard<std::mutex> lock(mu_);
-    if (memory_pool_.find(buffer.size) == memory_pool_.end()) {
-      memory_pool_.emplace(buffer.size, std::vector<Buffer>{});
-    }
-    memory_pool_.at(buffer.size).push_back(buffer);
+    pooled_bytes_.fetch_add(buffer.size, std::memory_order_relaxed);
+    if (PushThreadCache(buffer)) return;
+    std::lock_guard<std::mutex> lock(shared_->mu);
+    memory_pool_[buffer.size].push_back(buffer);
     DLOG(INFO) << "reclaim buffer " << buffer.size;
+    if (high_water_mark_ != 0 && pooled_bytes_.load(std::memory_order_relaxed) > high_water_mark_) {
+      DrainThreadCachesLocked();
+      TrimLocked(high_water_mark_);
+    }
   }
 
   size_t UsedMemory() const override { return used_memory_.load(std::memory_order_relaxed); }
 
+  AllocatorStats Stats() const override {
+    AllocatorStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.allocated_bytes = used_memory_.load(std::memory_order_relaxed);
+    stats.pooled_bytes = pooled_bytes_.load(std::memory_order_relaxed);
+    stats.trimmed_bytes = trimmed_bytes_.load(std::memory_order_relaxed);
+    stats.requested_bytes = requested_bytes_.load(std::memory_order_relaxed);
+    stats.served_bytes = served_bytes_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  void Trim(size_t target_bytes = 0) override {
+    std::lock_guard<std::mutex> lock(shared_->mu);
+    DrainThreadCachesLocked();
+    TrimLocked(target_bytes);
+  }
+
+  /*!
+   * \brief Round a request up to its size class.
+   * \param nbytes The requested number of bytes.
+   * \return The size of the buffer serving the request.
+   */
+  size_t SizeClass(size_t nbytes) const {
+    if (nbytes <= page_size_) return page_size_;
+    // 2^msb < nbytes <= 2^(msb + 1), split each power of two into four classes.
+    size_t msb = 0;
+    while ((static_cast<size_t>(2) << msb) < nbytes) ++msb;
+    size_t step = std::max(page_size_, (static_cast<size_t>(1) << msb) >> 2);
+    return (nbytes + step - 1) / step * step;
+  }
+
  private:
+  /*!
+   * \brief The lock of an allocator and the allocator itself, shared with the per-thread
+   *  caches so that a thread exiting while the allocator is destroyed can still tell
+   *  whether the allocator is alive.
+   */
+  struct SharedState {
+    std::mutex mu;
+    /*! \brief The allocator, nullptr once it is destroyed. */
+    PooledAllocator* owner{nullptr};
+  };
+
+  /*! \brief Free buffers cached by one thread for one allocator. */
+  struct ThreadCache {
+    std::shared_ptr<SharedState> shared;
+    /*!
+     * \brief Protects buffers. Only contended when another thread drains the cache, which
+     *  takes it after the shared lock; the owning thread never holds it while taking the
+     *  shared lock.
+     */
+    std::mutex mu;
+    std::vector<Buffer> buffers;
+
+    ~ThreadCache() {
+      std::lock_guard<std::mutex> lock(shared->mu);
+      if (shared->owner != nullptr) shared->owner->ReleaseThreadCacheLocked(this);
+    }
+  };
+
+  /*!
+   * \brief Get the calling thread's cache of this allocator.
+   * \param create Whether to create the cache when it does not exist.
+   * \return The cache, nullptr when it does not exist and create is false.
+   */
+  ThreadCache* GetThreadCache(bool create) {
+    // Keyed by a unique id rather than the address, so an allocator created at the address
+    // of a destroyed one never sees its stale cache.
+    static thread_local std::unordered_map<uint64_t, std::unique_ptr<ThreadCache>> caches;
+    auto it = caches.find(id_);
+    if (it != caches.end()) return it->second.get();
+    if (!create) return nullptr;
+    std::unique_ptr<ThreadCache> cache(new ThreadCache());
+    cache->shared = shared_;
+    cache->buffers.reserve(kThreadCacheCapacity);
+    {
+      std::lock_guard<std::mutex> lock(shared_->mu);
+      thread_caches_.insert(cache.get());
+    }
+    return caches.emplace(id_, std::move(cache)).first->second.get();
+  }
+
+  bool PopThreadCache(size_t size, Buffer* buf) {
+    if (size > kThreadCacheMaxBufferSize) return false;
+    ThreadCache* cache = GetThreadCache(false);
+    if (cache == nullptr) return false;
+    std::lock_guard<std::mutex> lock(cache->mu);
+    for (size_t i = cache->buffers.size(); i != 0; --i) {
+      if (cache->buffers[i - 1].size == size) {
+        *buf = cache->buffers[i - 1];
+        cache->buffers.erase(cache->buffers.begin() + (i - 1));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool PushThreadCache(const Buffer& buffer) {
+    if (buffer.size > kThreadCacheMaxBufferSize) return false;
+    ThreadCache* cache = GetThreadCache(true);
+    std::lock_guard<std::mutex> lock(cache->mu);
+    if (cache->buffers.size() == kThreadCacheCapacity) return false;
+    cache->buffers.push_back(buffer);
+    return true;
+  }
+
+  bool PopPool(size_t size, Buffer* buf) {
+    std::lock_guard<std::mutex> lock(shared_->mu);
+    auto it = memory_pool_.find(size);
+    if (it == memory_pool_.end() || it->second.empty()) return false;
+    *buf = it->second.back();
+    it->second.pop_back();
+    return true;
+  }
+
+  /*! \brief Move the buffers of a cache back to the shared pool, under the shared lock. */
+  void DrainThreadCacheLocked(ThreadCache* cache) {
+    std::lock_guard<std::mutex> lock(cache->mu);
+    for (const Buffer& buf : cache->buffers) memory_pool_[buf.size].push_back(buf);
+    cache->buffers.clear();
+  }
+
+  /*! \brief Move the buffers of all threads back to the shared pool, under the shared lock. */
+  void DrainThreadCachesLocked() {
+    for (ThreadCache* cache : thread_caches_) DrainThreadCacheLocked(cache);
+  }
+
+  /*! \brief Release the cache of an exiting thread, under the shared lock. */
+  void ReleaseThreadCacheLocked(ThreadCache* cache) {
+    DrainThreadCacheLocked(cache);
+    thread_caches_.erase(cache);
+  }
+
+  /*! \brief Free the largest pooled buffers until at most target_bytes stay cached. */
+  void TrimLocked(size_t target_bytes) {
+    for (auto it = memory_pool_.rbegin(); it != memory_pool_.rend(); ++it) {
+      auto& pool = it->second;
+      while (!pool.empty() && pooled_bytes_.load(std::memory_order_relaxed) > target_bytes) {
+        FreeDeviceBuffer(pool.back());
+        pooled_bytes_.fetch_sub(pool.back().size, std::memory_order_relaxed);
+        trimmed_bytes_.fetch_add(pool.back().size, std::memory_order_relaxed);
+        pool.pop_back();
+      }
+    }
+  }
+
+  void FreeDeviceBuffer(const Buffer& buf) {
+    DeviceAPI::Get(buf.ctx)->FreeDataSpace(buf.ctx, buf.data);
+    used_memory_.fetch_sub(buf.size, std::memory_order_relaxed);
+  }
+
   void ReleaseAll() {
-    std::lock_guard<std::mutex> lock(mu_);
+    std::lock_guard<std::mutex> lock(shared_->mu);
+    DrainThreadCachesLocked();
+    thread_caches_.clear();
+    // The caches of the threads still alive release nothing from now on.
+    shared_->owner = nullptr;
     for (auto const& it : memory_pool_) {
-      auto const& pool = it.second;
-      for (auto const& buf : pool) {
-        DeviceAPI::Get(buf.ctx)->FreeDataSpace(buf.ctx, buf.data);
-      }
+      for (auto const& buf : it.second) FreeDeviceBuffer(buf);
     }
     memory_pool_.clear();
     used_memory_ = 0;
+    pooled_bytes_ = 0;
     DLOG(INFO) << "release all buffers";
   }
 
+  static size_t DefaultHighWaterMark() {
+    const char* val = getenv("TVM_VM_POOL_HIGH_WATER_MARK_MB");
+    if (val == nullptr) return 0;
+    return static_cast<size_t>(atoll(val)) << 20;
+  }
+
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next_id{0};
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
  private:
   size_t page_size_;
-  std::atomic<size_t> used_memory_;
-  std::unordered_map<size_t, std::vector<Buffer> > memory_pool_;
-  std::mutex mu_;
+  size_t high_water_mark_;
+  uint64_t id_;
+  std::atomic<size_t> used_memory_{0};
+  std::atomic<size_t> pooled_bytes_{0};
+  std::atomic<size_t> trimmed_bytes_{0};
+  std::atomic<size_t> requested_bytes_{0};
+  std::atomic<size_t> served_bytes_{0};
+  std::atomic<size_t> hits_{0};
+  std::atomic<size_t> misses_{0};
+  /*! \brief The shared free lists, ordered by size class so trimming starts from the largest. */
+  std::map<size_t, std::vector<Buffer> > memory_pool_;
+  /*! \brief The per-thread caches alive for this allocator. */
+  std::unordered_set<ThreadCache*> thread_caches_;
+  /*! \brief The lock of the pool and the caches, outlives the allocator. */
+  std::shared_ptr<SharedState> shared_;
   TVMContext ctx_;
 };
 
@@ -169,6 +169,10 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       inputs_.erase(func_name);
       inputs_.emplace(func_name, func_args);
     });
+  } else if (name == "get_num_executed_instructions") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int64_t>(num_executed_instructions_);
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc([sptr_to_self, name](TVMArgs args, TVMRetValue* rv) {});
@@ -185,8 +189,13 @@ inline TVMContext VirtualMachine::GetContext(Index device_type) const {
 }
 
 void VirtualMachine::PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func) {
-  auto frame = VMFrame(ret_pc, func_index_, arg_count, code_, vm_func.register_file_size);
-  frames_.push_back(frame);
+  frames_.emplace_back(ret_pc, func_index_, arg_count, code_, 0);
+  auto& register_file = frames_.back().register_file;
+  if (!free_register_files_.empty()) {
+    register_file.swap(free_register_files_.back());
+    free_register_files_.pop_back();
+  }
+  register_file.resize(vm_func.register_file_size);
 }
 
 Index VirtualMachine::PopFrame() {
@@ -196,6 +205,9 @@ Index VirtualMachine::PopFrame() {
   code_ = fr.code;
   pc_ = fr.pc;
   auto call_stack_size = frames_.size();
+  // Release the registers but keep their storage for the next call.
+  frames_.back().register_file.clear();
+  free_register_files_.push_back(std::move(frames_.back().register_file));
   frames_.pop_back();
   return call_stack_size;
 }
@@ -241,25 +253,31 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
     }
   }
 
-  std::vector<TVMValue> values(arity);
-  std::vector<int> codes(arity);
-  runtime::TVMArgsSetter setter(values.data(), codes.data());
+  // The scratch buffers only grow, so packed calls stop allocating after the first run.
+  if (packed_values_.size() < arity) {
+    packed_values_.resize(arity);
+    packed_codes_.resize(arity);
+  }
+  runtime::TVMArgsSetter setter(packed_values_.data(), packed_codes_.data());
   int idx = 0;
   for (Index i = 0; i < arg_count; i++) {
     if (const auto* dt_cell = args[i].as<ADTObj>()) {
       for (size_t fi = 0; fi < dt_cell->size; ++fi) {
-        auto obj = (*dt_cell)[fi];
-        auto nd_array = Downcast<NDArray>(obj);
-        setter(idx++, nd_array);
+        const ObjectRef& obj = (*dt_cell)[fi];
+        CHECK(obj->IsInstance<NDArray::ContainerType>())
+            << "Packed function arguments must be NDArrays, but received: " << obj->GetTypeKey();
+        setter(idx++, obj);
       }
     } else {
-      auto nd_array = Downcast<NDArray>(args[i]);
-      setter(idx++, nd_array);
+      CHECK(args[i]->IsInstance<NDArray::ContainerType>())
+          << "Packed function arguments must be NDArrays, but received: "
+          << args[i]->GetTypeKey();
+      setter(idx++, args[i]);
     }
   }
 
   TVMRetValue rv;
-  func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+  func.CallPacked(TVMArgs(packed_values_.data(), packed_codes_.data(), arity), &rv);
 }
 
 void VirtualMachine::LoadExecutable(const Executable* exec) {
@@ -306,7 +324,7 @@ inline void VirtualMachine::WriteRegister(Index r, const ObjectRef& val) {
   frames_.back().register_file[r] = val;
 }
 
-inline ObjectRef VirtualMachine::ReadRegister(Index r) const {
+inline const ObjectRef& VirtualMachine::ReadRegister(Index r) const {
   return frames_.back().register_file[r];
 }
 
@@ -342,6 +360,20 @@ inline int64_t VirtualMachine::LoadScalarInt(Index r) const {
   return result;
 }
 
+const NDArray& VirtualMachine::GetScalarConstant(std::unordered_map<int64_t, NDArray>* cache,
+                                                 int64_t val, DLDataType dtype) {
+  auto it = cache->find(val);
+  if (it != cache->end()) return it->second;
+  NDArray tensor = NDArray::Empty({1}, dtype, {kDLCPU, 0});
+  if (dtype.bits == 64) {
+    reinterpret_cast<int64_t*>(tensor->data)[0] = val;
+  } else {
+    CHECK_EQ(dtype.bits, 32);
+    reinterpret_cast<int32_t*>(tensor->data)[0] = static_cast<int32_t>(val);
+  }
+  return cache->emplace(val, tensor).first->second;
+}
+
 void VirtualMachine::RunLoop() {
   CHECK(this->exec_);
   CHECK(this->code_);
@@ -351,12 +383,11 @@ void VirtualMachine::RunLoop() {
   main_loop:
     auto const& instr = code_[this->pc_];
     DLOG(INFO) << "Executing(" << pc_ << "): " << instr;
+    ++num_executed_instructions_;
 
     switch (instr.op) {
       case Opcode::Move: {
-        ObjectRef from_obj;
-        from_obj = ReadRegister(instr.from);
-        WriteRegister(instr.dst, from_obj);
+        WriteRegister(instr.dst, ReadRegister(instr.from));
         pc_++;
         goto main_loop;
       }
@@ -381,18 +412,19 @@ void VirtualMachine::RunLoop() {
         goto main_loop;
       }
       case Opcode::LoadConsti: {
-        auto tensor = NDArray::Empty({1}, {kDLInt, 64, 1}, {kDLCPU, 0});
-        reinterpret_cast<int64_t*>(tensor->data)[0] = instr.load_consti.val;
-        WriteRegister(instr.dst, tensor);
+        // Scalar constants are immutable, so one tensor per value is shared by all executions.
+        WriteRegister(instr.dst,
+                      GetScalarConstant(&consti_pool_, instr.load_consti.val, {kDLInt, 64, 1}));
         pc_++;
         goto main_loop;
       }
       case Opcode::Invoke: {
-        std::vector<ObjectRef> args;
+        arg_scratch_.clear();
         for (Index i = 0; i < instr.num_args; ++i) {
-          args.push_back(ReadRegister(instr.invoke_args_registers[i]));
+          arg_scratch_.push_back(ReadRegister(instr.invoke_args_registers[i]));
         }
-        InvokeGlobal(exec_->functions[instr.func_index], args);
+        InvokeGlobal(exec_->functions[instr.func_index], arg_scratch_);
+        arg_scratch_.clear();
         frames_.back().caller_return_register = instr.dst;
         goto main_loop;
       }
@@ -401,16 +433,16 @@ void VirtualMachine::RunLoop() {
         CHECK_LE(instr.packed_index, packed_funcs_.size());
         const auto& func = packed_funcs_[instr.packed_index];
         const auto& arity = instr.arity;
-        std::vector<ObjectRef> args;
+        arg_scratch_.clear();
         for (Index i = 0; i < arity; ++i) {
           DLOG(INFO) << "arg" << i << " $" << instr.packed_args[i];
-          auto arg = ReadRegister(instr.packed_args[i]);
-          args.push_back(arg);
+          arg_scratch_.push_back(ReadRegister(instr.packed_args[i]));
         }
 
         // We no longer need to write the registers back, we write directly
         // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        InvokePacked(instr.packed_index, func, arity, instr.output_size, arg_scratch_);
+        arg_scratch_.clear();
         pc_++;
         goto main_loop;
       }
@@ -418,14 +450,15 @@ void VirtualMachine::RunLoop() {
         auto object = ReadRegister(instr.closure);
         const auto* closure = object.as<VMClosureObj>();
 
-        std::vector<ObjectRef> args;
-        for (auto free_var : closure->free_vars) {
-          args.push_back(free_var);
+        arg_scratch_.clear();
+        for (const auto& free_var : closure->free_vars) {
+          arg_scratch_.push_back(free_var);
         }
         for (Index i = 0; i < instr.num_closure_args; ++i) {
-          args.push_back(ReadRegister(instr.closure_args[i]));
+          arg_scratch_.push_back(ReadRegister(instr.closure_args[i]));
         }
-        InvokeGlobal(exec_->functions[closure->func_index], args);
+        InvokeGlobal(exec_->functions[closure->func_index], arg_scratch_);
+        arg_scratch_.clear();
         frames_.back().caller_return_register = instr.dst;
         goto main_loop;
       }
@@ -441,9 +474,7 @@ void VirtualMachine::RunLoop() {
         auto object = ReadRegister(instr.get_tag.object);
         const auto& adt = Downcast<ADT>(object);
         auto tag = adt.tag();
-        auto tag_tensor = NDArray::Empty({1}, {kDLInt, 32, 1}, {kDLCPU, 0});
-        reinterpret_cast<int32_t*>(tag_tensor->data)[0] = tag;
-        WriteRegister(instr.dst, tag_tensor);
+        WriteRegister(instr.dst, GetScalarConstant(&tag_pool_, tag, {kDLInt, 32, 1}));
         pc_++;
         goto main_loop;
       }
@@ -496,12 +527,13 @@ void VirtualMachine::RunLoop() {
         goto main_loop;
       }
       case Opcode::AllocADT: {
-        std::vector<ObjectRef> fields;
+        arg_scratch_.clear();
         for (Index i = 0; i < instr.num_fields; ++i) {
-          fields.push_back(ReadRegister(instr.datatype_fields[i]));
+          arg_scratch_.push_back(ReadRegister(instr.datatype_fields[i]));
         }
-        ObjectRef obj = ADT(instr.constructor_tag, fields);
+        ObjectRef obj = ADT(instr.constructor_tag, arg_scratch_.begin(), arg_scratch_.end());
         WriteRegister(instr.dst, obj);
+        arg_scratch_.clear();
         pc_++;
         goto main_loop;
       }
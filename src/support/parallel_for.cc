@@ -24,7 +24,10 @@
 #include <dmlc/logging.h>
 #include <tvm/support/parallel_for.h>
 
+#include <algorithm>
+#include <atomic>
 #include <future>
+#include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -47,16 +50,31 @@ std::vector<std::vector<int>> rr_partitioner(int begin, int end, int step, int n
   return ret;
 }
 
+namespace {
+
+bool GLOBAL_PARALLEL_FOR_FLAG{false};
+std::mutex M_GLOBAL_PARALLEL_FOR_FLAG;
+
+/*! \brief Mark the start of a parallel loop, nested loops are rejected. */
+void EnterParallelFor() {
+  std::unique_lock<std::mutex> l(M_GLOBAL_PARALLEL_FOR_FLAG);
+  CHECK(!GLOBAL_PARALLEL_FOR_FLAG) << "There's another parallel_for running. Maybe you're "
+                                   << "currently inside another parallel_for loop.";
+  GLOBAL_PARALLEL_FOR_FLAG = true;
+}
+
+/*! \brief Mark the end of a parallel loop. */
+void ExitParallelFor() {
+  std::unique_lock<std::mutex> l(M_GLOBAL_PARALLEL_FOR_FLAG);
+  CHECK(GLOBAL_PARALLEL_FOR_FLAG);
+  GLOBAL_PARALLEL_FOR_FLAG = false;
+}
+
+}  // namespace
+
 void parallel_for(int begin, int end, const std::function<void(int)>& f, int step,
                   const PartitionerFuncType partitioner) {
-  static bool GLOBAL_PARALLEL_FOR_FLAG{false};
-  static std::mutex M_GLOBAL_PARALLEL_FOR_FLAG;
-  {
-    std::unique_lock<std::mutex> l(M_GLOBAL_PARALLEL_FOR_FLAG);
-    CHECK(!GLOBAL_PARALLEL_FOR_FLAG) << "There's another parallel_for running. Maybe you're "
-                                     << "currently inside another parallel_for loop.";
-    GLOBAL_PARALLEL_FOR_FLAG = true;
-  }
+  EnterParallelFor();
 
   int default_num_threads = std::thread::hardware_concurrency();
   const auto& run_partitions = partitioner(begin, end, step, default_num_threads);
@@ -79,11 +97,48 @@ void parallel_for(int begin, int end, const std::function<void(int)>& f, int ste
   for (auto&& thread : threads) {
     thread.join();
   }
-  {
-    std::unique_lock<std::mutex> l(M_GLOBAL_PARALLEL_FOR_FLAG);
-    CHECK(GLOBAL_PARALLEL_FOR_FLAG);
-    GLOBAL_PARALLEL_FOR_FLAG = false;
+  ExitParallelFor();
+  try {
+    for (auto&& i : res_vec) {
+      i.get();
+    }
+  } catch (const std::exception& e) {
+    LOG(FATAL) << "Parallel_for error with " << e.what();
+  }
+}
+
+void parallel_for_dynamic(int begin, int end, int num_threads,
+                          const std::function<void(int)>& f) {
+  CHECK_LE(begin, end) << "Infinite loop condition with begin: " << begin << " end: " << end;
+  if (num_threads <= 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, end - begin);
+  if (num_threads == 0) {
+    return;
+  }
+  EnterParallelFor();
+
+  std::atomic<int> next{begin};
+  auto worker = [&next, end, &f]() {
+    for (int i = next++; i < end; i = next++) {
+      f(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  std::vector<std::future<void>> res_vec;
+  res_vec.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    std::packaged_task<void()> task(worker);
+    res_vec.emplace_back(task.get_future());
+    threads.emplace_back(std::move(task));
+  }
+
+  for (auto&& thread : threads) {
+    thread.join();
   }
+  ExitParallelFor();
   try {
     for (auto&& i : res_vec) {
       i.get();
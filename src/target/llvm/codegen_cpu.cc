@@ -26,9 +26,11 @@
 
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/tir/analysis.h>
+#include <tvm/tir/stmt_functor.h>
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 #include "../func_registry_generator.h"
@@ -79,6 +81,11 @@ void CodeGenCPU::Init(const std::string& module_name, llvm::TargetMachine* tm,
       t_int_, {ftype_tvm_parallel_lambda_->getPointerTo(), t_void_p_, t_int_}, false);
   ftype_tvm_parallel_barrier_ =
       llvm::FunctionType::get(t_int_, {t_int_, t_tvm_parallel_group_env_->getPointerTo()}, false);
+  ftype_tvm_parallel_get_chunk_ = llvm::FunctionType::get(
+      t_int_,
+      {t_int64_->getPointerTo(), t_int64_, t_int64_, t_int64_, t_int_, t_int_,
+       t_int64_->getPointerTo(), t_int64_->getPointerTo()},
+      false);
   ftype_tvm_static_init_callback_ = llvm::FunctionType::get(t_int_, {t_void_p_}, false);
   ftype_tvm_static_init_ =
       llvm::FunctionType::get(t_int_,
@@ -109,6 +116,9 @@ void CodeGenCPU::Init(const std::string& module_name, llvm::TargetMachine* tm,
     f_tvm_parallel_barrier_ =
         llvm::Function::Create(ftype_tvm_parallel_barrier_, llvm::Function::ExternalLinkage,
                                "TVMBackendParallelBarrier", module_.get());
+    f_tvm_parallel_get_chunk_ =
+        llvm::Function::Create(ftype_tvm_parallel_get_chunk_, llvm::Function::ExternalLinkage,
+                               "TVMBackendParallelGetChunk", module_.get());
   }
   this->InitGlobalContext(dynamic_lookup);
   target_c_runtime_ = target_c_runtime;
@@ -389,6 +399,8 @@ void CodeGenCPU::InitGlobalContext(bool dynamic_lookup) {
           InitContextPtr(ftype_tvm_parallel_launch_->getPointerTo(), "__TVMBackendParallelLaunch");
       gv_tvm_parallel_barrier_ = InitContextPtr(ftype_tvm_parallel_barrier_->getPointerTo(),
                                                 "__TVMBackendParallelBarrier");
+      gv_tvm_parallel_get_chunk_ = InitContextPtr(ftype_tvm_parallel_get_chunk_->getPointerTo(),
+                                                  "__TVMBackendParallelGetChunk");
       // Mark as context functions
       gv_func_map_["TVMBackendAllocWorkspace"] = nullptr;
       gv_func_map_["TVMBackendFreeWorkspace"] = nullptr;
@@ -510,8 +522,41 @@ void CodeGenCPU::CreateParallelLaunch(const Stmt& body, int num_task) {
                              "__tvm_parallel_lambda", module_.get());
   // allocate and setup the closure, call the closure.
   Array<Var> vfields = tir::UndefinedVars(body, {});
+  // The dynamically scheduled loops of the launch share an iteration counter among the tasks,
+  // which is reset before each launch and passed in the closure.
+  std::unordered_map<const VarNode*, Var> chunk_counters;
+  auto add_chunk_counters = [&](const Stmt& stmt) {
+    tir::PostOrderVisit(stmt, [&](const ObjectRef& node) {
+      const ForNode* loop = node.as<ForNode>();
+      if (loop == nullptr || loop->for_type != ForType::Parallel ||
+          chunk_counters.count(loop->loop_var.get())) {
+        return;
+      }
+      Var counter("chunk_counter", DataType::Handle());
+      llvm::Value* ptr = WithFunctionEntry([&]() { return builder_->CreateAlloca(t_int64_); });
+      builder_->CreateStore(llvm::ConstantInt::get(t_int64_, 0), ptr);
+      var_map_[counter.get()] = ptr;
+      vfields.push_back(counter);
+      chunk_counters[loop->loop_var.get()] = counter;
+    });
+  };
+  if (parallel_schedule_.kind != "static") {
+    add_chunk_counters(body);
+  }
+  tir::PostOrderVisit(body, [&](const ObjectRef& node) {
+    const AttrStmtNode* attr = node.as<AttrStmtNode>();
+    if (attr != nullptr && attr->attr_key == "pragma_parallel_schedule") {
+      const StringImmNode* kind = attr->value.as<StringImmNode>();
+      if (kind != nullptr && kind->value != "static") {
+        add_chunk_counters(attr->body);
+      }
+    }
+  });
   uint64_t nbytes;
   llvm::Value* cdata = PackClosureData(vfields, &nbytes);
+  for (const auto& kv : chunk_counters) {
+    var_map_.erase(kv.second.get());
+  }
 #if TVM_LLVM_VERSION >= 90
   auto launch_callee = llvm::FunctionCallee(ftype_tvm_parallel_launch_, RuntimeTVMParallelLaunch());
 #else
@@ -537,6 +582,7 @@ void CodeGenCPU::CreateParallelLaunch(const Stmt& body, int num_task) {
   new_vmap[par_env.num_task.get()] =
       builder_->CreateLoad(builder_->CreateInBoundsGEP(penv, {ConstInt32(0), ConstInt32(1)}));
   par_env.penv = penv;
+  par_env.chunk_counters = std::move(chunk_counters);
   std::swap(function_, f);
   std::swap(parallel_env_, par_env);
   std::swap(var_map_, new_vmap);
@@ -550,6 +596,82 @@ void CodeGenCPU::CreateParallelLaunch(const Stmt& body, int num_task) {
   builder_->SetInsertPoint(par_launch_end);
 }
 
+void CodeGenCPU::CreateParallelChunkFor(const ForNode* op) {
+  using llvm::BasicBlock;
+  DataType t = op->extent.dtype();
+  llvm::Value* one = llvm::ConstantInt::getSigned(DTypeToLLVMType(t), 1);
+  BasicBlock* pre_block = builder_->GetInsertBlock();
+  BasicBlock* chunk_begin = BasicBlock::Create(*ctx_, "chunk_begin", function_);
+  BasicBlock* chunk_body = BasicBlock::Create(*ctx_, "chunk_body", function_);
+  BasicBlock* chunk_end = BasicBlock::Create(*ctx_, "chunk_end", function_);
+  if (parallel_schedule_.kind == "static") {
+    // Task i runs the chunks i, i + num_task, i + 2 * num_task, ...
+    PrimExpr chunk_size = make_const(t, parallel_schedule_.chunk_size);
+    PrimExpr num_task = cast(t, parallel_env_.num_task);
+    PrimExpr task_id = cast(t, parallel_env_.task_id);
+    llvm::Value* first = MakeValue(task_id * chunk_size);
+    llvm::Value* stride = MakeValue(num_task * chunk_size);
+    builder_->CreateBr(chunk_begin);
+    builder_->SetInsertPoint(chunk_begin);
+    llvm::PHINode* begin = builder_->CreatePHI(first->getType(), 2);
+    begin->addIncoming(first, pre_block);
+    builder_->CreateCondBr(CreateLT(t, begin, MakeValue(op->extent)), chunk_body, chunk_end,
+                           md_very_likely_branch_);
+    builder_->SetInsertPoint(chunk_body);
+    Var begin_var("chunk_begin", t);
+    var_map_[begin_var.get()] = begin;
+    llvm::Value* end = MakeValue(min(begin_var + chunk_size, op->extent));
+    var_map_.erase(begin_var.get());
+    CreateSerialFor(begin, end, one, op->loop_var, op->body);
+    begin->addIncoming(CreateAdd(t, begin, stride), builder_->GetInsertBlock());
+    builder_->CreateBr(chunk_begin);
+  } else {
+    // The tasks take chunks from the shared iteration counter until the loop is done. The
+    // counter keeps growing over the entries of the loop within the launch, e.g. under a
+    // serial loop after a parallel_launch_point, and each task tracks where the current
+    // entry starts in base_ptr, which is 0 when the task starts.
+    auto it = parallel_env_.chunk_counters.find(op->loop_var.get());
+    CHECK(it != parallel_env_.chunk_counters.end());
+    llvm::Value* counter = MakeValue(it->second);
+    llvm::Value* base_ptr = WithFunctionEntry([&]() {
+      llvm::AllocaInst* base = builder_->CreateAlloca(t_int64_);
+      builder_->CreateStore(llvm::ConstantInt::get(t_int64_, 0), base);
+      return base;
+    });
+    llvm::Value* base = builder_->CreateLoad(base_ptr);
+    llvm::Value* begin_ptr = WithFunctionEntry([&]() { return builder_->CreateAlloca(t_int64_); });
+    llvm::Value* end_ptr = WithFunctionEntry([&]() { return builder_->CreateAlloca(t_int64_); });
+    int64_t chunk_size = std::max<int64_t>(parallel_schedule_.chunk_size, 1);
+    llvm::Value* extent = MakeValue(cast(DataType::Int(64), op->extent));
+    llvm::Value* num_task = MakeValue(parallel_env_.num_task);
+    int guided = parallel_schedule_.kind == "guided";
+#if TVM_LLVM_VERSION >= 90
+    auto chunk_callee =
+        llvm::FunctionCallee(ftype_tvm_parallel_get_chunk_, RuntimeTVMParallelGetChunk());
+#else
+    auto chunk_callee = RuntimeTVMParallelGetChunk();
+#endif
+    builder_->CreateBr(chunk_begin);
+    builder_->SetInsertPoint(chunk_begin);
+    llvm::Value* has_chunk = builder_->CreateCall(
+        chunk_callee, {counter, base, extent, llvm::ConstantInt::get(t_int64_, chunk_size),
+                       num_task, ConstInt32(guided), begin_ptr, end_ptr});
+    builder_->CreateCondBr(builder_->CreateICmpNE(has_chunk, ConstInt32(0)), chunk_body,
+                           chunk_end, md_very_likely_branch_);
+    builder_->SetInsertPoint(chunk_body);
+    llvm::Value* begin = builder_->CreateIntCast(builder_->CreateLoad(begin_ptr),
+                                                 DTypeToLLVMType(t), t.is_int());
+    llvm::Value* end =
+        builder_->CreateIntCast(builder_->CreateLoad(end_ptr), DTypeToLLVMType(t), t.is_int());
+    CreateSerialFor(begin, end, one, op->loop_var, op->body);
+    builder_->CreateBr(chunk_begin);
+    builder_->SetInsertPoint(chunk_end);
+    builder_->CreateStore(builder_->CreateAdd(base, extent), base_ptr);
+    return;
+  }
+  builder_->SetInsertPoint(chunk_end);
+}
+
 llvm::Value* CodeGenCPU::CreateStaticHandle() {
   llvm::GlobalVariable* gv = new llvm::GlobalVariable(
       *module_, t_void_p_, false, llvm::GlobalValue::PrivateLinkage, 0, "__tvm_static_handle");
@@ -773,6 +895,11 @@ llvm::Value* CodeGenCPU::RuntimeTVMParallelBarrier() {
   return GetContextPtr(gv_tvm_parallel_barrier_);
 }
 
+llvm::Value* CodeGenCPU::RuntimeTVMParallelGetChunk() {
+  if (f_tvm_parallel_get_chunk_ != nullptr) return f_tvm_parallel_get_chunk_;
+  return GetContextPtr(gv_tvm_parallel_get_chunk_);
+}
+
 void CodeGenCPU::AddStartupFunction() {
   if (registry_functions_.size() != 0) {
     CHECK(is_system_lib_) << "Loading of --system-lib modules is yet to be defined for C runtime";
@@ -929,6 +1056,23 @@ void CodeGenCPU::VisitStmt_(const AttrStmtNode* op) {
       this->VisitStmt(op->body);
     } else if (op->attr_key == "pragma_parallel_launch_point") {
       CreateParallelLaunch(op->body, 0);
+    } else if (op->attr_key == "pragma_parallel_schedule") {
+      const StringImmNode* kind = op->value.as<StringImmNode>();
+      CHECK(kind != nullptr && (kind->value == "static" || kind->value == "dynamic" ||
+                                kind->value == "guided"))
+          << "Pragma parallel_schedule expects static, dynamic or guided, but got " << op->value;
+      std::string prev_kind = parallel_schedule_.kind;
+      parallel_schedule_.kind = kind->value;
+      this->VisitStmt(op->body);
+      parallel_schedule_.kind = prev_kind;
+    } else if (op->attr_key == "pragma_parallel_chunk_size") {
+      const int64_t* chunk_size = as_const_int(op->value);
+      CHECK(chunk_size != nullptr && *chunk_size > 0)
+          << "Pragma parallel_chunk_size expects a positive constant, but got " << op->value;
+      int64_t prev_chunk_size = parallel_schedule_.chunk_size;
+      parallel_schedule_.chunk_size = *chunk_size;
+      this->VisitStmt(op->body);
+      parallel_schedule_.chunk_size = prev_chunk_size;
     } else if (op->attr_key == "pragma_parallel_barrier_when_finish") {
       CHECK(parallel_env_.penv != nullptr) << "Cannot run barrier without parallel environment";
       CHECK(!parallel_env_.in_parallel_loop)
@@ -975,7 +1119,11 @@ void CodeGenCPU::VisitStmt_(const ForNode* op) {
       CHECK(!parallel_env_.in_parallel_loop)
           << "Nested parallel loop is not supported by threadpool, try fuse them instead";
       parallel_env_.in_parallel_loop = true;
-      if (parallel_env_.stride_pattern) {
+      if (parallel_schedule_.kind != "static" || parallel_schedule_.chunk_size > 0) {
+        CHECK(!parallel_env_.stride_pattern)
+            << "Pragma parallel_stride_pattern cannot be combined with a chunked schedule";
+        CreateParallelChunkFor(op);
+      } else if (parallel_env_.stride_pattern) {
         CreateSerialFor(MakeValue(task_id), MakeValue(op->extent), MakeValue(num_task),
                         op->loop_var, op->body);
       } else {
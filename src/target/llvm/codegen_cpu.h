@@ -73,6 +73,7 @@ class CodeGenCPU : public CodeGenLLVM {
   llvm::FunctionType* ftype_tvm_api_set_last_error_{nullptr};
   llvm::FunctionType* ftype_tvm_parallel_launch_{nullptr};
   llvm::FunctionType* ftype_tvm_parallel_barrier_{nullptr};
+  llvm::FunctionType* ftype_tvm_parallel_get_chunk_{nullptr};
   llvm::FunctionType* ftype_tvm_register_system_symbol_{nullptr};
   // Lazy entry for function call.
   llvm::FunctionType* ftype_tvm_static_init_callback_{nullptr};
@@ -87,6 +88,15 @@ class CodeGenCPU : public CodeGenLLVM {
     bool in_parallel_loop{false};
     int parallel_loop_count{0};
     llvm::Value* penv{nullptr};
+    // The iteration counters of the dynamically scheduled loops, keyed by their loop variables.
+    std::unordered_map<const VarNode*, Var> chunk_counters;
+  };
+  // The scheduling policy of the parallel loops, set by the pragmas around them.
+  struct ParallelSchedule {
+    // "static", "dynamic" or "guided".
+    std::string kind{"static"};
+    // The number of iterations of a chunk, 0 for the default.
+    int64_t chunk_size{0};
   };
   // Get runtime functions
   void InitGlobalContext(bool dynamic_lookup);
@@ -97,6 +107,7 @@ class CodeGenCPU : public CodeGenLLVM {
   llvm::Value* RuntimeTVMAPISetLastError();
   llvm::Value* RuntimeTVMParallelLaunch();
   llvm::Value* RuntimeTVMParallelBarrier();
+  llvm::Value* RuntimeTVMParallelGetChunk();
   llvm::Value* CreateStaticHandle();
   llvm::Value* GetPackedFuncHandle(const std::string& str);
   llvm::Value* PackClosureData(const Array<Var>& fields, uint64_t* num_bytes);
@@ -115,6 +126,8 @@ class CodeGenCPU : public CodeGenLLVM {
   void CreateStaticInit(const std::string& init_fname, const Stmt& body);
   // Create parallel launch
   void CreateParallelLaunch(const Stmt& body, int num_task);
+  // Create a parallel loop that runs chunks of its iterations by the current parallel schedule.
+  void CreateParallelChunkFor(const ForNode* op);
   // Create a new compute scope.
   void CreateComputeScope(const AttrStmtNode* op);
   // Check if the call to packed function is successful
@@ -128,6 +141,7 @@ class CodeGenCPU : public CodeGenLLVM {
   llvm::GlobalVariable* gv_tvm_api_set_last_error_{nullptr};
   llvm::GlobalVariable* gv_tvm_parallel_launch_{nullptr};
   llvm::GlobalVariable* gv_tvm_parallel_barrier_{nullptr};
+  llvm::GlobalVariable* gv_tvm_parallel_get_chunk_{nullptr};
   std::unordered_map<String, llvm::GlobalVariable*> gv_func_map_;
   // context for direct dynamic lookup
   llvm::Function* f_tvm_func_call_{nullptr};
@@ -135,9 +149,12 @@ class CodeGenCPU : public CodeGenLLVM {
   llvm::Function* f_tvm_api_set_last_error_{nullptr};
   llvm::Function* f_tvm_parallel_launch_{nullptr};
   llvm::Function* f_tvm_parallel_barrier_{nullptr};
+  llvm::Function* f_tvm_parallel_get_chunk_{nullptr};
   llvm::Function* f_tvm_register_system_symbol_{nullptr};
   // Current parallel environment scope.
   ParallelEnv parallel_env_;
+  // Current scheduling policy of the parallel loops.
+  ParallelSchedule parallel_schedule_;
   // global to packed function handle
   std::unordered_map<std::string, llvm::GlobalVariable*> func_handle_map_;
   // List of symbols to be exported to TVM system lib.
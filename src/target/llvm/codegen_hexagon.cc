@@ -644,18 +644,6 @@ DMLC_ATTRIBUTE_UNUSED std::ostream& operator<<(std::ostream& os, const llvm::Mod
   return os;
 }
 
-void ProcessLLVMOptions(const std::vector<std::string>& llvm_vec) {
-  if (llvm_vec.empty()) return;
-
-  // LLVM options.
-  std::vector<const char*> starts;
-  std::transform(llvm_vec.begin(), llvm_vec.end(), std::back_inserter(starts),
-                 std::mem_fn(&std::string::c_str));
-  const char** args = &starts.front();
-
-  llvm::cl::ParseCommandLineOptions(llvm_vec.size(), args);
-}
-
 }  // namespace
 
 runtime::Module BuildHexagon(IRModule mod, Target target) {
@@ -700,7 +688,7 @@ runtime::Module BuildHexagon(IRModule mod, Target target) {
 
   // Process extra command line options for LLVM. Make sure it's only
   // done once.
-  static bool CallOnce = (ProcessLLVMOptions(llvm_options_vec), true);
+  static bool CallOnce = (ParseLLVMCommandLineOptions(llvm_options_vec), true);
   (void)CallOnce;
 
   std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target);
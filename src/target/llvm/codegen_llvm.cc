@@ -29,6 +29,11 @@
 #include <tvm/tir/op.h>
 
 #include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "../../arith/pattern_match.h"
 #include "../build_common.h"
@@ -257,7 +262,71 @@ class MPassManager : public llvm::legacy::PassManager {
 
 void CodeGenLLVM::InitPassManagerBuilder(llvm::PassManagerBuilder* builder) {}
 
+/*!
+ * \brief Set LLVM command line options in a scope and restore their previous values when the
+ *  scope exits. The options are global to the process, so a scope that sets options excludes
+ *  every other optimization, and a scope without options only excludes the ones that set some.
+ */
+class LLVMOptionScope {
+ public:
+  explicit LLVMOptionScope(const std::vector<std::pair<std::string, std::string>>& options) {
+    if (options.empty()) {
+      shared_lock_ = std::shared_lock<std::shared_timed_mutex>(LLVMOptionMutex());
+      return;
+    }
+#if TVM_LLVM_VERSION >= 110
+    lock_ = std::unique_lock<std::shared_timed_mutex>(LLVMOptionMutex());
+    llvm::StringMap<llvm::cl::Option*>& registered = llvm::cl::getRegisteredOptions();
+    for (const auto& kv : options) {
+      auto it = registered.find(kv.first);
+      CHECK(it != registered.end()) << "Unknown LLVM option " << kv.first;
+      llvm::cl::Option* opt = it->second;
+      // LLVM cannot read the value of an option back, only the values TVM set are known.
+      std::vector<std::string> values = GetLLVMCommandLineOptionValues(opt);
+      if (opt->getNumOccurrences() != 0 && values.empty()) {
+        LOG(WARNING) << "LLVM option " << kv.first << " was set outside of TVM, it is reset to "
+                     << "its default after the optimization";
+      }
+      saved_.emplace_back(opt, std::move(values));
+      CHECK(!opt->addOccurrence(0, kv.first, kv.second))
+          << "Invalid value " << kv.second << " of LLVM option " << kv.first;
+    }
+#else
+    LOG(FATAL) << "-llvm-options is only supported for LLVM >= 11.0";
+#endif
+  }
+
+  ~LLVMOptionScope() {
+#if TVM_LLVM_VERSION >= 110
+    for (const auto& it : saved_) {
+      llvm::cl::Option* opt = it.first;
+      opt->reset();
+      for (const std::string& value : it.second) {
+        opt->addOccurrence(0, opt->ArgStr, value);
+      }
+    }
+#endif
+  }
+
+ private:
+  std::shared_lock<std::shared_timed_mutex> shared_lock_;
+  std::unique_lock<std::shared_timed_mutex> lock_;
+  /*! \brief The options set in the scope and their previous values. */
+  std::vector<std::pair<llvm::cl::Option*, std::vector<std::string>>> saved_;
+};
+
 void CodeGenLLVM::Optimize() {
+  LLVMOptionScope option_scope(optimize_options_.llvm_options);
+#if TVM_LLVM_VERSION >= 110
+  if (optimize_options_.use_new_pass_manager) {
+    this->OptimizeNewPM();
+    return;
+  }
+#endif
+  this->OptimizeLegacy();
+}
+
+void CodeGenLLVM::OptimizeLegacy() {
   // pass manager
   FPassManager fpass(module_.get());
   MPassManager mpass;
@@ -268,15 +337,19 @@ void CodeGenLLVM::Optimize() {
 
   // place optimization pass
   llvm::PassManagerBuilder builder;
-  builder.OptLevel = 3;
+  builder.OptLevel = optimize_options_.opt_level;
 
+  if (builder.OptLevel == 0) {
+    builder.Inliner = llvm::createAlwaysInlinerLegacyPass();
+  } else {
 #if TVM_LLVM_VERSION >= 50
-  builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0, false);
+    builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0, false);
 #else
-  builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0);
+    builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0);
 #endif
-  builder.LoopVectorize = true;
-  builder.SLPVectorize = true;
+  }
+  builder.LoopVectorize = optimize_options_.loop_vectorize;
+  builder.SLPVectorize = optimize_options_.slp_vectorize;
   this->InitPassManagerBuilder(&builder);
 
 #if TVM_LLVM_VERSION >= 50
@@ -294,6 +367,56 @@ void CodeGenLLVM::Optimize() {
   mpass.run(*module_);
 }
 
+#if TVM_LLVM_VERSION >= 110
+void CodeGenLLVM::OptimizeNewPM() {
+#if TVM_LLVM_VERSION >= 140
+  using OptimizationLevel = llvm::OptimizationLevel;
+#else
+  using OptimizationLevel = llvm::PassBuilder::OptimizationLevel;
+#endif
+  const LLVMOptimizeOptions& options = optimize_options_;
+  llvm::PipelineTuningOptions pto;
+  pto.LoopVectorization = options.loop_vectorize;
+  pto.SLPVectorization = options.slp_vectorize;
+  llvm::Optional<llvm::PGOOptions> pgo;
+  if (!options.profile_generate.empty()) {
+    pgo = llvm::PGOOptions(options.profile_generate, "", "", llvm::PGOOptions::IRInstr);
+  } else if (!options.profile_use.empty()) {
+    pgo = llvm::PGOOptions(options.profile_use, "", "", llvm::PGOOptions::IRUse);
+  }
+#if TVM_LLVM_VERSION >= 120 && TVM_LLVM_VERSION < 130
+  llvm::PassBuilder pb(false, target_machine_, pto, pgo);
+#else
+  llvm::PassBuilder pb(target_machine_, pto, pgo);
+#endif
+
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+  llvm::ModulePassManager mpass;
+  if (!options.pass_pipeline.empty()) {
+    if (llvm::Error err = pb.parsePassPipeline(mpass, options.pass_pipeline)) {
+      LOG(FATAL) << "Invalid -pass-pipeline " << options.pass_pipeline << ": "
+                 << llvm::toString(std::move(err));
+    }
+  } else if (options.opt_level == 0) {
+    mpass.addPass(llvm::AlwaysInlinerPass());
+  } else {
+    static const OptimizationLevel levels[] = {OptimizationLevel::O0, OptimizationLevel::O1,
+                                               OptimizationLevel::O2, OptimizationLevel::O3};
+    mpass = pb.buildPerModuleDefaultPipeline(levels[options.opt_level]);
+  }
+  mpass.run(*module_, mam);
+}
+#endif
+
 int CodeGenLLVM::NativeVectorBits(const runtime::StorageScope& storage_scope) const {
   return native_vector_bits_;
 }
@@ -78,6 +78,11 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
    */
   virtual void Init(const std::string& module_name, llvm::TargetMachine* tm, llvm::LLVMContext* ctx,
                     bool system_lib, bool dynamic_lookup, bool target_c_runtime);
+  /*!
+   * \brief Set the options of the optimization pipeline run by Finish.
+   * \param options The options, usually parsed from the target.
+   */
+  void SetOptimizeOptions(LLVMOptimizeOptions options) { optimize_options_ = std::move(options); }
   /*!
    * \brief Compile and add function f to the current module.
    * \param f The function to be added.
@@ -197,6 +202,12 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   virtual void AddStartupFunction() {}
   // apply optimization on the module.
   virtual void Optimize();
+  // apply optimization on the module with the legacy pass manager.
+  void OptimizeLegacy();
+#if TVM_LLVM_VERSION >= 110
+  // apply optimization on the module with the new pass manager.
+  void OptimizeNewPM();
+#endif
   // Get the maximim storage align bits of buffer pointer given storage scope.
   virtual int NativeVectorBits(const runtime::StorageScope& storage_scope) const;
   // Get correct address space depending on the backend
@@ -290,6 +301,8 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   std::unique_ptr<llvm::MDBuilder> md_builder_;
   // llvm target machine
   llvm::TargetMachine* target_machine_{nullptr};
+  // The options of the optimization pipeline
+  LLVMOptimizeOptions optimize_options_;
   // llvm context
   llvm::LLVMContext* ctx_{nullptr};
   // helpful data types
@@ -24,6 +24,9 @@
 #ifdef TVM_LLVM_VERSION
 
 #include <tvm/runtime/registry.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <vector>
 
 #include "codegen_cpu.h"
 #include "llvm/MC/MCSubtargetInfo.h"
@@ -61,17 +64,110 @@ bool TargetHasFeature(const llvm::TargetMachine& tm, const std::string& feature)
   // return checkFeatures(MCInfo, std::string("+") + feature);
 #endif
 }
+
+/*!
+ * \brief Match an operand of a widened integer product, i.e. int32(x) where x is an integer of
+ *  at most 16 bits, possibly broadcast to the lanes of the product.
+ * \param e The operand.
+ * \return The narrow integer x broadcast to the lanes of e, or an undefined expression.
+ */
+PrimExpr MatchNarrowOperand(const PrimExpr& e) {
+  const PrimExpr* value = &e;
+  const BroadcastNode* broadcast = e.as<BroadcastNode>();
+  if (broadcast != nullptr) {
+    value = &broadcast->value;
+  }
+  const CastNode* cast = value->as<CastNode>();
+  if (cast == nullptr || cast->dtype.bits() != 32 ||
+      (!cast->value.dtype().is_int() && !cast->value.dtype().is_uint()) ||
+      cast->value.dtype().bits() > 16) {
+    return PrimExpr();
+  }
+  return broadcast != nullptr ? tir::Broadcast(cast->value, broadcast->lanes) : cast->value;
+}
+
+/*!
+ * \brief Flatten a sum of int32 vectors into its terms.
+ * \param e The sum.
+ * \param terms The terms to be appended to.
+ */
+void FlattenSum(const PrimExpr& e, std::vector<PrimExpr>* terms) {
+  if (const AddNode* add = e.as<AddNode>()) {
+    FlattenSum(add->a, terms);
+    FlattenSum(add->b, terms);
+  } else {
+    terms->push_back(e);
+  }
+}
+
+/*!
+ * \brief Whether an int32 vector expression is a product of two narrow integers.
+ * \param e The expression.
+ * \param a The first narrow operand, set on success.
+ * \param b The second narrow operand, set on success.
+ */
+bool MatchNarrowProduct(const PrimExpr& e, PrimExpr* a, PrimExpr* b) {
+  const MulNode* mul = e.as<MulNode>();
+  if (mul == nullptr) {
+    return false;
+  }
+  *a = MatchNarrowOperand(mul->a);
+  *b = MatchNarrowOperand(mul->b);
+  return a->defined() && b->defined();
+}
 }  // namespace
 
 class CodeGenX86_64 final : public CodeGenCPU {
  public:
+  void Init(const std::string& module_name, llvm::TargetMachine* tm, llvm::LLVMContext* ctx,
+            bool system_lib, bool dynamic_lookup, bool target_c_runtime) override;
   llvm::Value* VisitExpr_(const CastNode* op) override;
+  llvm::Value* VisitExpr_(const AddNode* op) override;
+  void VisitStmt_(const SeqStmtNode* op) override;
 
  private:
   llvm::Value* CallVectorIntrin(llvm::Intrinsic::ID id, size_t intrin_lanes, llvm::Type* result_ty,
                                 const std::vector<llvm::Value*>& args);
+  /*!
+   * \brief Emit a sum of int32 vectors with dot-product instructions for its terms that are
+   *  products of narrow integers.
+   * \param op The sum.
+   * \return The value of the sum, or nullptr if the sum has no such term or the target has no
+   *  suitable instruction.
+   */
+  llvm::Value* MakeNarrowDotProduct(const AddNode* op);
+  /*!
+   * \brief Interleave the lanes of vectors of the same type.
+   * \return The vector v0[0], v1[0], ..., v0[1], v1[1], ...
+   */
+  llvm::Value* CreateVecInterleave(const std::vector<llvm::Value*>& vecs);
+  /*!
+   * \brief The number of int32 lanes of the dot-product instructions of the target to use for a
+   *  sum of the given lanes, 0 if there is none.
+   */
+  int DotProductLanes(int lanes) const;
+
+  /*! \brief Whether the target has AVX512-VNNI. */
+  bool has_vnni_{false};
+  /*! \brief Whether the target has AVX512-BW. */
+  bool has_avx512bw_{false};
+  /*! \brief Whether the target has AVX512-VL, the 256-bit forms of the AVX512 instructions. */
+  bool has_avx512vl_{false};
 };
 
+void CodeGenX86_64::Init(const std::string& module_name, llvm::TargetMachine* tm,
+                         llvm::LLVMContext* ctx, bool system_lib, bool dynamic_lookup,
+                         bool target_c_runtime) {
+  CodeGenCPU::Init(module_name, tm, ctx, system_lib, dynamic_lookup, target_c_runtime);
+#if TVM_LLVM_VERSION >= 80
+  if (tm != nullptr) {
+    has_vnni_ = TargetHasFeature(*tm, "avx512vnni");
+    has_avx512bw_ = TargetHasFeature(*tm, "avx512bw");
+    has_avx512vl_ = TargetHasFeature(*tm, "avx512vl");
+  }
+#endif
+}
+
 llvm::Value* CodeGenX86_64::VisitExpr_(const CastNode* op) {
   // LLVM does not automatically generate the correct instruction sequences for
   // half -> float conversion (i.e. using AVX2/AVX-512 vectorized variants of
@@ -113,6 +209,226 @@ llvm::Value* CodeGenX86_64::VisitExpr_(const CastNode* op) {
   return CodeGenCPU::VisitExpr_(op);
 }
 
+int CodeGenX86_64::DotProductLanes(int lanes) const {
+  if (!has_vnni_ && !has_avx512bw_) {
+    return 0;
+  }
+  if (lanes % 16 == 0) {
+    return 16;
+  }
+  // vpmaddwd on ymm only needs AVX2, which comes with AVX512-BW
+  if (lanes % 8 == 0 && (has_avx512vl_ || !has_vnni_)) {
+    return 8;
+  }
+  return 0;
+}
+
+llvm::Value* CodeGenX86_64::CreateVecInterleave(const std::vector<llvm::Value*>& vecs) {
+  int num_elems = llvm::cast<llvm::VectorType>(vecs[0]->getType())->getNumElements();
+  int num_vecs = static_cast<int>(vecs.size());
+  llvm::Value* concat = CreateVecConcat(vecs);
+#if TVM_LLVM_VERSION >= 110
+  std::vector<int> indices;
+#else
+  std::vector<unsigned> indices;
+#endif
+  for (int i = 0; i < num_elems; ++i) {
+    for (int j = 0; j < num_vecs; ++j) {
+      indices.push_back(j * num_elems + i);
+    }
+  }
+  return builder_->CreateShuffleVector(concat, concat, indices);
+}
+
+llvm::Value* CodeGenX86_64::MakeNarrowDotProduct(const AddNode* op) {
+#if TVM_LLVM_VERSION >= 80
+  const DataType& dtype = op->dtype;
+  if (dtype.is_scalar() || !dtype.is_int() || dtype.bits() != 32) {
+    return nullptr;
+  }
+  int chunk = DotProductLanes(dtype.lanes());
+  if (chunk == 0) {
+    return nullptr;
+  }
+
+  // Split the terms into u8 x s8 products, which go to vpdpbusd four at a time, products whose
+  // operands fit in int16, which go to vpdpwssd or vpmaddwd two at a time, and the others.
+  std::vector<PrimExpr> terms;
+  FlattenSum(GetRef<PrimExpr>(op), &terms);
+  std::vector<std::pair<PrimExpr, PrimExpr>> byte_products, word_products;
+  std::vector<PrimExpr> others;
+  auto fits_int16 = [](const DataType& t) { return t.is_int() || t.bits() <= 8; };
+  for (const PrimExpr& term : terms) {
+    PrimExpr a, b;
+    if (!MatchNarrowProduct(term, &a, &b)) {
+      others.push_back(term);
+      continue;
+    }
+    if (a.dtype().is_int() && b.dtype().is_uint()) {
+      std::swap(a, b);
+    }
+    if (has_vnni_ && a.dtype().is_uint() && a.dtype().bits() == 8 && b.dtype().is_int() &&
+        b.dtype().bits() == 8) {
+      byte_products.emplace_back(a, b);
+    } else if (fits_int16(a.dtype()) && fits_int16(b.dtype())) {
+      word_products.emplace_back(a, b);
+    } else {
+      others.push_back(term);
+    }
+  }
+  if (byte_products.empty() && word_products.empty()) {
+    return nullptr;
+  }
+
+  int lanes = dtype.lanes();
+  llvm::Value* acc = nullptr;
+  for (const PrimExpr& term : others) {
+    llvm::Value* value = MakeValue(term);
+    acc = acc == nullptr ? value : builder_->CreateAdd(value, acc);
+  }
+  if (acc == nullptr) {
+    acc = llvm::Constant::getNullValue(DTypeToLLVMType(dtype));
+  }
+  // The narrow operands as vectors of the given integer type, sign or zero extended.
+  auto make_operands = [&](const std::vector<std::pair<PrimExpr, PrimExpr>>& products,
+                           int bits) {
+    std::vector<std::pair<llvm::Value*, llvm::Value*>> values;
+    for (const auto& p : products) {
+      llvm::Type* type = DTypeToLLVMType(DataType::Int(bits, lanes));
+      llvm::Value* a = MakeValue(p.first);
+      llvm::Value* b = MakeValue(p.second);
+      a = p.first.dtype().is_int() ? builder_->CreateSExt(a, type) : builder_->CreateZExt(a, type);
+      b = p.second.dtype().is_int() ? builder_->CreateSExt(b, type) : builder_->CreateZExt(b, type);
+      values.emplace_back(a, b);
+    }
+    return values;
+  };
+  auto byte_values = make_operands(byte_products, 8);
+  auto word_values = make_operands(word_products, 16);
+  llvm::Type* chunk_type = DTypeToLLVMType(DataType::Int(32, chunk));
+
+  // Pack the operands of the products [begin, begin + group) into the 32-bit lanes of a chunk,
+  // padding the missing products with zeros.
+  auto pack = [&](const std::vector<std::pair<llvm::Value*, llvm::Value*>>& values, int bits,
+                  size_t begin, int offset) {
+    int group = 32 / bits;
+    llvm::Value* zero = llvm::Constant::getNullValue(DTypeToLLVMType(DataType::Int(bits, chunk)));
+    std::vector<llvm::Value*> a, b;
+    for (size_t i = begin; i < begin + group; ++i) {
+      a.push_back(i < values.size() ? CreateVecSlice(values[i].first, offset, chunk) : zero);
+      b.push_back(i < values.size() ? CreateVecSlice(values[i].second, offset, chunk) : zero);
+    }
+    return std::make_pair(builder_->CreateBitCast(CreateVecInterleave(a), chunk_type),
+                          CreateVecInterleave(b));
+  };
+
+  std::vector<llvm::Value*> results;
+  for (int offset = 0; offset < lanes; offset += chunk) {
+    llvm::Value* sum = CreateVecSlice(acc, offset, chunk);
+    for (size_t i = 0; i < byte_values.size(); i += 4) {
+      auto operands = pack(byte_values, 8, i, offset);
+      llvm::Function* f = llvm::Intrinsic::getDeclaration(
+          module_.get(), chunk == 16 ? ::llvm::Intrinsic::x86_avx512_vpdpbusd_512
+                                     : ::llvm::Intrinsic::x86_avx512_vpdpbusd_256);
+      sum = builder_->CreateCall(
+          f, {sum, operands.first, builder_->CreateBitCast(operands.second, chunk_type)});
+    }
+    for (size_t i = 0; i < word_values.size(); i += 2) {
+      auto operands = pack(word_values, 16, i, offset);
+      if (has_vnni_) {
+        llvm::Function* f = llvm::Intrinsic::getDeclaration(
+            module_.get(), chunk == 16 ? ::llvm::Intrinsic::x86_avx512_vpdpwssd_512
+                                       : ::llvm::Intrinsic::x86_avx512_vpdpwssd_256);
+        sum = builder_->CreateCall(
+            f, {sum, operands.first, builder_->CreateBitCast(operands.second, chunk_type)});
+      } else {
+        llvm::Function* f = llvm::Intrinsic::getDeclaration(
+            module_.get(), chunk == 16 ? ::llvm::Intrinsic::x86_avx512_pmaddw_d_512
+                                       : ::llvm::Intrinsic::x86_avx2_pmadd_wd);
+        llvm::Type* word_type = DTypeToLLVMType(DataType::Int(16, chunk * 2));
+        llvm::Value* a = builder_->CreateBitCast(operands.first, word_type);
+        sum = builder_->CreateAdd(sum, builder_->CreateCall(f, {a, operands.second}));
+      }
+    }
+    results.push_back(sum);
+  }
+  return CreateVecConcat(results);
+#else
+  return nullptr;
+#endif
+}
+
+llvm::Value* CodeGenX86_64::VisitExpr_(const AddNode* op) {
+  if (llvm::Value* value = MakeNarrowDotProduct(op)) {
+    return value;
+  }
+  return CodeGenCPU::VisitExpr_(op);
+}
+
+void CodeGenX86_64::VisitStmt_(const SeqStmtNode* op) {
+  if (!has_vnni_ && !has_avx512bw_) {
+    CodeGenCPU::VisitStmt_(op);
+    return;
+  }
+  // An unrolled reduction updates the same int32 vector once per step, as in
+  //   C[i] = C[i] + int32(A[k]) * int32(B[k, i]); C[i] = C[i] + int32(A[k + 1]) * ...
+  // Merge consecutive updates into one sum, so that their products can share one instruction.
+  auto match_update = [](const Stmt& stmt, PrimExpr* term) -> const StoreNode* {
+    const StoreNode* store = stmt.as<StoreNode>();
+    if (store == nullptr || !store->value.dtype().is_int() || store->value.dtype().bits() != 32 ||
+        store->value.dtype().is_scalar()) {
+      return nullptr;
+    }
+    const AddNode* add = store->value.as<AddNode>();
+    const LoadNode* load = add != nullptr ? add->a.as<LoadNode>() : nullptr;
+    if (load == nullptr || !load->buffer_var.same_as(store->buffer_var) ||
+        !StructuralEqual()(load->index, store->index) ||
+        !StructuralEqual()(load->predicate, store->predicate)) {
+      return nullptr;
+    }
+    PrimExpr a, b;
+    bool reads_buffer = false;
+    tir::PostOrderVisit(add->b, [&](const ObjectRef& node) {
+      if (const LoadNode* l = node.as<LoadNode>()) {
+        reads_buffer = reads_buffer || l->buffer_var.same_as(store->buffer_var);
+      }
+    });
+    if (reads_buffer || !MatchNarrowProduct(add->b, &a, &b)) {
+      return nullptr;
+    }
+    *term = add->b;
+    return store;
+  };
+
+  Array<Stmt> seq;
+  for (size_t i = 0; i < op->seq.size(); ++i) {
+    PrimExpr term;
+    const StoreNode* store = match_update(op->seq[i], &term);
+    if (store == nullptr) {
+      seq.push_back(op->seq[i]);
+      continue;
+    }
+    PrimExpr value = store->value;
+    size_t first = i;
+    for (; i + 1 < op->seq.size(); ++i) {
+      const StoreNode* next = match_update(op->seq[i + 1], &term);
+      if (next == nullptr || !next->buffer_var.same_as(store->buffer_var) ||
+          !StructuralEqual()(next->index, store->index) ||
+          !StructuralEqual()(next->predicate, store->predicate)) {
+        break;
+      }
+      value = value + term;
+    }
+    if (i == first) {
+      seq.push_back(op->seq[i]);
+    } else {
+      seq.push_back(Store(store->buffer_var, value, store->index, store->predicate));
+    }
+  }
+  SeqStmt merged(seq);
+  CodeGenCPU::VisitStmt_(merged.as<SeqStmtNode>());
+}
+
 llvm::Value* CodeGenX86_64::CallVectorIntrin(llvm::Intrinsic::ID id, size_t intrin_lanes,
                                              llvm::Type* result_ty,
                                              const std::vector<llvm::Value*>& args) {
@@ -30,6 +30,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 namespace tvm {
 namespace codegen {
@@ -141,6 +142,106 @@ std::unique_ptr<llvm::TargetMachine> GetLLVMTargetMachine(const Target& target,
   return std::unique_ptr<llvm::TargetMachine>(tm);
 }
 
+LLVMOptimizeOptions ParseLLVMOptimizeOptions(const Target& target) {
+  LLVMOptimizeOptions options;
+  if (Optional<Integer> v = target->GetAttr<Integer>("opt-level")) {
+    options.opt_level = v.value();
+    CHECK(options.opt_level >= 0 && options.opt_level <= 3)
+        << "invalid -opt-level option " << options.opt_level;
+  }
+  if (Optional<String> v = target->GetAttr<String>("pass-manager")) {
+    String value = v.value();
+    if (value == "new") {
+#if TVM_LLVM_VERSION < 110
+      LOG(FATAL) << "-pass-manager new is only supported for LLVM >= 11.0";
+#endif
+      options.use_new_pass_manager = true;
+    } else if (value == "legacy") {
+      options.use_new_pass_manager = false;
+    } else {
+      LOG(FATAL) << "invalid -pass-manager option " << value;
+    }
+  }
+  if (Optional<String> v = target->GetAttr<String>("pass-pipeline")) {
+    CHECK(options.use_new_pass_manager) << "-pass-pipeline requires -pass-manager=new";
+    options.pass_pipeline = v.value();
+  }
+  if (Optional<Bool> v = target->GetAttr<Bool>("vectorize-loops")) {
+    options.loop_vectorize = v.value();
+  }
+  if (Optional<Bool> v = target->GetAttr<Bool>("vectorize-slp")) {
+    options.slp_vectorize = v.value();
+  }
+  if (Optional<Array<String>> v = target->GetAttr<Array<String>>("llvm-options")) {
+    // The target parser does not allow another "=" in an attribute, use name:value instead.
+    for (const String& opt : v.value()) {
+      std::string s = opt;
+      size_t pos = s.find(':');
+      CHECK(pos != std::string::npos && pos != 0)
+          << "invalid -llvm-options entry " << s << ", expect name:value";
+      options.llvm_options.emplace_back(s.substr(0, pos), s.substr(pos + 1));
+    }
+  }
+  if (Optional<String> v = target->GetAttr<String>("profile-generate")) {
+    options.profile_generate = v.value();
+  }
+  if (Optional<String> v = target->GetAttr<String>("profile-use")) {
+    options.profile_use = v.value();
+  }
+  CHECK(options.profile_generate.empty() || options.profile_use.empty())
+      << "-profile-generate and -profile-use cannot be used together";
+  CHECK(options.use_new_pass_manager ||
+        (options.profile_generate.empty() && options.profile_use.empty()))
+      << "-profile-generate and -profile-use require -pass-manager=new";
+  return options;
+}
+
+/*! \brief The LLVM command line options set by ParseLLVMCommandLineOptions. */
+struct LLVMOptionEnv {
+  std::shared_timed_mutex mu;
+  std::unordered_map<const llvm::cl::Option*, std::vector<std::string>> values;
+
+  static LLVMOptionEnv* Global() {
+    static LLVMOptionEnv inst;
+    return &inst;
+  }
+};
+
+std::shared_timed_mutex& LLVMOptionMutex() { return LLVMOptionEnv::Global()->mu; }
+
+void ParseLLVMCommandLineOptions(const std::vector<std::string>& args) {
+  if (args.empty()) return;
+  LLVMOptionEnv* e = LLVMOptionEnv::Global();
+  std::unique_lock<std::shared_timed_mutex> lock(e->mu);
+  std::vector<const char*> argv;
+  for (const std::string& arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  llvm::cl::ParseCommandLineOptions(static_cast<int>(argv.size()), argv.data());
+
+  llvm::StringMap<llvm::cl::Option*>& registered = llvm::cl::getRegisteredOptions();
+  for (size_t i = 1; i < args.size(); ++i) {
+    llvm::StringRef arg(args[i]);
+    if (!arg.startswith("-")) continue;
+    std::pair<llvm::StringRef, llvm::StringRef> kv = arg.ltrim('-').split('=');
+    auto it = registered.find(kv.first);
+    if (it == registered.end()) continue;
+    std::vector<std::string>& values = e->values[it->second];
+    // Only the list options keep more than one value.
+    llvm::cl::NumOccurrencesFlag flag = it->second->getNumOccurrencesFlag();
+    if (flag != llvm::cl::ZeroOrMore && flag != llvm::cl::OneOrMore) {
+      values.clear();
+    }
+    values.push_back(kv.second.str());
+  }
+}
+
+std::vector<std::string> GetLLVMCommandLineOptionValues(const llvm::cl::Option* opt) {
+  LLVMOptionEnv* e = LLVMOptionEnv::Global();
+  auto it = e->values.find(opt);
+  return it != e->values.end() ? it->second : std::vector<std::string>();
+}
+
 std::string LLVMTargetToString(const Target& target) {
   std::ostringstream os;
   os << "llvm";
@@ -164,6 +265,33 @@ std::string LLVMTargetToString(const Target& target) {
   if (Optional<String> mfloat_abo = target->GetAttr<String>("mfloat-abi")) {
     os << " -mfloat-abi=" << mfloat_abo.value();
   }
+  if (Optional<String> jit = target->GetAttr<String>("jit")) {
+    os << " -jit=" << jit.value();
+  }
+  if (Optional<Integer> opt_level = target->GetAttr<Integer>("opt-level")) {
+    os << " -opt-level=" << opt_level.value()->value;
+  }
+  for (const char* key : {"pass-manager", "pass-pipeline", "profile-generate", "profile-use"}) {
+    if (Optional<String> value = target->GetAttr<String>(key)) {
+      os << " -" << key << "=" << value.value();
+    }
+  }
+  for (const char* key : {"vectorize-loops", "vectorize-slp"}) {
+    if (Optional<Bool> value = target->GetAttr<Bool>(key)) {
+      os << " -" << key << "=" << value.value()->value;
+    }
+  }
+  if (Optional<Array<String>> llvm_options = target->GetAttr<Array<String>>("llvm-options")) {
+    bool is_first = true;
+    os << " -llvm-options=";
+    for (const String& opt : llvm_options.value()) {
+      if (!is_first) {
+        os << ",";
+      }
+      is_first = false;
+      os << opt;
+    }
+  }
   return os.str();
 }
 
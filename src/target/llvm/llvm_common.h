@@ -25,9 +25,17 @@
 #define TVM_TARGET_LLVM_LLVM_COMMON_H_
 #ifdef TVM_LLVM_VERSION
 
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#if TVM_LLVM_VERSION >= 100
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#endif
 #include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/Value.h>
@@ -53,7 +61,11 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
+#if TVM_LLVM_VERSION >= 110
+#include <llvm/Passes/PassBuilder.h>
+#endif
 #include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/Utils/Cloning.h>
 #include <llvm/Transforms/Utils/ModuleUtils.h>
@@ -65,9 +77,12 @@
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Linker/Linker.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Host.h>
 #include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
@@ -75,8 +90,10 @@
 #include <llvm/Target/TargetOptions.h>
 
 #include <memory>
+#include <shared_mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace tvm {
 
@@ -111,6 +128,55 @@ void ParseLLVMTargetOptions(const Target& target, std::string* triple, std::stri
 std::unique_ptr<llvm::TargetMachine> GetLLVMTargetMachine(const Target& target,
                                                           bool allow_null = false);
 
+/*! \brief The options of the optimization pipeline of CodeGenLLVM. */
+struct LLVMOptimizeOptions {
+  /*! \brief The optimization level, from 0 to 3. */
+  int opt_level{3};
+  /*! \brief Whether to use the new pass manager instead of the legacy one. */
+  bool use_new_pass_manager{false};
+  /*! \brief The textual pipeline of the new pass manager, the default pipeline if empty. */
+  std::string pass_pipeline;
+  /*! \brief Whether to run the loop vectorizer. */
+  bool loop_vectorize{true};
+  /*! \brief Whether to run the SLP vectorizer. */
+  bool slp_vectorize{true};
+  /*! \brief The LLVM command line options set while the pipeline runs, as name-value pairs. */
+  std::vector<std::pair<std::string, std::string>> llvm_options;
+  /*! \brief The file the instrumented code writes its profile to, no instrumentation if empty. */
+  std::string profile_generate;
+  /*! \brief The indexed profile to optimize with, no profile if empty. */
+  std::string profile_use;
+};
+
+/*!
+ * \brief Parse the options of the optimization pipeline.
+ * \param target The TVM target
+ * \return The options, the defaults for the attributes that are not set
+ */
+LLVMOptimizeOptions ParseLLVMOptimizeOptions(const Target& target);
+
+/*!
+ * \brief Get the lock of the LLVM command line options, which are global to the process.
+ *  Changing an option takes the exclusive lock, running the passes that read them a shared one.
+ */
+std::shared_timed_mutex& LLVMOptionMutex();
+
+/*!
+ * \brief Set LLVM command line options for the rest of the process, as
+ *  llvm::cl::ParseCommandLineOptions does, and remember their values so that the options set
+ *  for a single optimization can be restored to them.
+ * \param args The arguments of the form -name=value, the first one is the program name.
+ */
+void ParseLLVMCommandLineOptions(const std::vector<std::string>& args);
+
+/*!
+ * \brief Get the values ParseLLVMCommandLineOptions gave to an option, the caller holds
+ *  LLVMOptionMutex().
+ * \param opt The option.
+ * \return The values in the order they were given, empty if the option was not set that way.
+ */
+std::vector<std::string> GetLLVMCommandLineOptionValues(const llvm::cl::Option* opt);
+
 /*!
  * \brief Convert the TVM's LLVM target to string by extracting only relevant fields
  * \param target The TVM target to be extracted
@@ -26,9 +26,14 @@
 #include <tvm/ir/module.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 #include <tvm/target/codegen.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <mutex>
+#include <string>
 
 #include "../../runtime/file_util.h"
 #include "../../runtime/library_module.h"
@@ -43,6 +48,107 @@ using runtime::PackedFunc;
 using runtime::TVMArgs;
 using runtime::TVMRetValue;
 
+/*!
+ * \brief An object cache of the JIT that keeps the compiled objects in a directory, so that the
+ *  same functions are not compiled again in later runs or by other processes.
+ *
+ *  The objects are keyed by the hash of the IR and the target. Only the modules generated by TVM
+ *  are cached, the helper modules of the JIT may hold the addresses of the current process.
+ */
+class LLVMObjectCache : public llvm::ObjectCache {
+ public:
+  /*!
+   * \param cache_dir The directory of the objects.
+   * \param target_key The string that identifies the target the objects are compiled for.
+   * \param source_file_name The source file name of the modules to be cached.
+   */
+  LLVMObjectCache(std::string cache_dir, std::string target_key, std::string source_file_name)
+      : cache_dir_(std::move(cache_dir)),
+        target_key_(std::move(target_key)),
+        source_file_name_(std::move(source_file_name)) {
+    std::error_code ecode = llvm::sys::fs::create_directories(cache_dir_);
+    CHECK_EQ(ecode.value(), 0) << "Cannot create the JIT cache directory " << cache_dir_ << ": "
+                               << ecode.message();
+  }
+
+  void notifyObjectCompiled(const llvm::Module* m, llvm::MemoryBufferRef obj) final {
+    if (m->getSourceFileName() != source_file_name_) return;
+    MissEntry* miss = LastMiss();
+    std::string path;
+    if (miss->cache == this && miss->module == m) {
+      path = std::move(miss->path);
+    } else {
+      path = GetObjectPath(*m);
+    }
+    *miss = MissEntry();
+    // Write to a temporary file first, so that other processes never read a partial object.
+    llvm::SmallString<128> tmp_path;
+    int fd;
+    if (llvm::sys::fs::createUniqueFile(path + ".tmp-%%%%%%", fd, tmp_path)) return;
+    {
+      llvm::raw_fd_ostream os(fd, true);
+      os << obj.getBuffer();
+    }
+    if (llvm::sys::fs::rename(tmp_path, path)) {
+      llvm::sys::fs::remove(tmp_path);
+    }
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* m) final {
+    if (m->getSourceFileName() != source_file_name_) return nullptr;
+    MissEntry* miss = LastMiss();
+    *miss = MissEntry();
+    std::string path = GetObjectPath(*m);
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (buffer) return std::move(buffer.get());
+    // After a miss the JIT compiles the module and notifies its object on the same thread, keep
+    // the path so that the IR is not printed and hashed again.
+    miss->cache = this;
+    miss->module = m;
+    miss->path = std::move(path);
+    return nullptr;
+  }
+
+ private:
+  /*! \brief The last module of a thread that missed the cache. */
+  struct MissEntry {
+    const LLVMObjectCache* cache{nullptr};
+    const llvm::Module* module{nullptr};
+    std::string path;
+  };
+
+  /*!
+   * \brief Get the last miss of the calling thread. Every lookup resets it, so an entry left by
+   *  a failed compile is never matched by a later module at the same address.
+   */
+  static MissEntry* LastMiss() {
+    static thread_local MissEntry entry;
+    return &entry;
+  }
+
+  std::string GetObjectPath(const llvm::Module& m) const {
+    std::string ir;
+    llvm::raw_string_ostream os(ir);
+    m.print(os, nullptr);
+    os.flush();
+    // The module identifier differs between the runs even if the code is the same.
+    llvm::StringRef content(ir);
+    if (content.startswith("; ModuleID")) {
+      content = content.split('\n').second;
+    }
+    llvm::SHA1 hasher;
+    hasher.update(target_key_);
+    hasher.update(content);
+    llvm::SmallString<128> path(cache_dir_);
+    llvm::sys::path::append(path, llvm::toHex(hasher.final()) + ".o");
+    return std::string(path.str());
+  }
+
+  std::string cache_dir_;
+  std::string target_key_;
+  std::string source_file_name_;
+};
+
 class LLVMModuleNode final : public runtime::ModuleNode {
  public:
   ~LLVMModuleNode() {
@@ -51,6 +157,20 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       ee_->runStaticConstructorsDestructors(true);
       delete ee_;
     }
+#if TVM_LLVM_VERSION >= 100
+    if (orc_jit_ != nullptr) {
+#if TVM_LLVM_VERSION >= 110
+      llvm::Error err = orc_jit_->deinitialize(orc_jit_->getMainJITDylib());
+#else
+      llvm::Error err = orc_jit_->runDestructors();
+#endif
+      if (err) {
+        LOG(WARNING) << "Failed to run the destructors of the JIT: "
+                     << llvm::toString(std::move(err));
+      }
+      orc_jit_.reset();
+    }
+#endif
   }
 
   const char* type_key() const { return "llvm"; }
@@ -68,9 +188,11 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       }
       return PackedFunc([target_triple](TVMArgs args, TVMRetValue* rv) { *rv = target_triple; });
     }
-    if (ee_ == nullptr) LazyInitJIT();
+    if (!jit_initialized_) LazyInitJIT();
 
-    std::lock_guard<std::mutex> lock(mutex_);
+    // The ORC JIT is thread safe, the lookups of the MCJIT engine are serialized.
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    if (ee_ != nullptr) lock.lock();
 
     TVMBackendPackedCFunc faddr;
     if (name == runtime::symbol::tvm_module_main) {
@@ -213,6 +335,7 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     // TODO(tqchen): remove the entry function behavior as it does not
     // makes sense when we start to use multiple modules.
     cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
+    cg->SetOptimizeOptions(ParseLLVMOptimizeOptions(target));
 
     for (const auto& f : funcs) {
       cg->AddFunction(f);
@@ -283,16 +406,35 @@ class LLVMModuleNode final : public runtime::ModuleNode {
  private:
   void LazyInitJIT() {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (ee_) {
+    if (jit_initialized_) {
       return;
     }
     if (!target_.defined()) {
       target_ = Target::Create("llvm");
     }
-    llvm::EngineBuilder builder(std::move(module_));
+    std::string jit_kind = target_->GetAttr<String>("jit").value_or("mcjit");
+    CHECK(jit_kind == "mcjit" || jit_kind == "orcjit") << "Unknown JIT kind " << jit_kind;
     std::string triple, mcpu, mattr;
     llvm::TargetOptions opt;
     ParseLLVMTargetOptions(target_, &triple, &mcpu, &mattr, &opt);
+    if (const char* cache_dir = std::getenv("TVM_LLVM_JIT_CACHE_DIR")) {
+      std::string target_key = std::to_string(TVM_LLVM_VERSION) + "/" + jit_kind + "/" + triple +
+                               "/" + mcpu + "/" + mattr;
+      object_cache_ = std::make_unique<LLVMObjectCache>(cache_dir, target_key,
+                                                        mptr_->getSourceFileName());
+    }
+
+    if (jit_kind == "orcjit") {
+#if TVM_LLVM_VERSION >= 100
+      InitORCJIT(triple, mcpu, mattr, opt);
+      jit_initialized_ = true;
+      return;
+#else
+      LOG(WARNING) << "The ORC JIT requires LLVM 10 or later, fall back to MCJIT";
+#endif
+    }
+
+    llvm::EngineBuilder builder(std::move(module_));
     builder.setEngineKind(llvm::EngineKind::JIT);
     builder.setOptLevel(llvm::CodeGenOpt::Aggressive);
     if (mcpu.length() != 0) {
@@ -317,8 +459,103 @@ class LLVMModuleNode final : public runtime::ModuleNode {
         << " and ExecutionEngine (" << layout.getStringRepresentation() << ")";
     ee_ = builder.create(tm.release());
     CHECK(ee_ != nullptr) << "Failed to initialize jit engine for " << mptr_->getTargetTriple();
+    if (object_cache_ != nullptr) {
+      ee_->setObjectCache(object_cache_.get());
+    }
     ee_->runStaticConstructorsDestructors(false);
+    InitContext();
+    jit_initialized_ = true;
+  }
 
+#if TVM_LLVM_VERSION >= 100
+  /*!
+   * \brief Initialize an ORC JIT that compiles each function when it is called for the first
+   *  time, on a pool of compile threads, instead of compiling the whole module upfront.
+   */
+  void InitORCJIT(const std::string& triple, const std::string& mcpu, const std::string& mattr,
+                  const llvm::TargetOptions& opt) {
+    // The JIT owns the context of its modules, so it gets a copy of the module through bitcode.
+    // The original module is kept to check the existence of the symbols.
+    std::string bitcode;
+    llvm::raw_string_ostream bitcode_os(bitcode);
+    llvm::WriteBitcodeToFile(*mptr_, bitcode_os);
+    bitcode_os.flush();
+    auto jit_ctx = std::make_unique<llvm::LLVMContext>();
+    auto jit_module = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(bitcode, mptr_->getModuleIdentifier()), *jit_ctx);
+    CHECK(jit_module) << "Failed to copy the module to the JIT: "
+                      << llvm::toString(jit_module.takeError());
+
+    llvm::orc::JITTargetMachineBuilder jtmb((llvm::Triple(triple)));
+    jtmb.setCPU(mcpu);
+    llvm::SmallVector<llvm::StringRef, 16> features;
+    llvm::StringRef(mattr).split(features, ',', -1, false);
+    jtmb.addFeatures(std::vector<std::string>(features.begin(), features.end()));
+    jtmb.setOptions(opt);
+    jtmb.setRelocationModel(llvm::Reloc::PIC_);
+    jtmb.setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+
+    llvm::orc::LLLazyJITBuilder builder;
+    builder.setJITTargetMachineBuilder(jtmb);
+    builder.setNumCompileThreads(std::max(runtime::threading::MaxConcurrency(), 1));
+    if (object_cache_ != nullptr) {
+      llvm::ObjectCache* cache = object_cache_.get();
+#if TVM_LLVM_VERSION >= 110
+      builder.setCompileFunctionCreator(
+          [cache](llvm::orc::JITTargetMachineBuilder jtmb)
+              -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+            return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(jtmb), cache);
+          });
+#else
+      builder.setCompileFunctionCreator(
+          [cache](llvm::orc::JITTargetMachineBuilder jtmb)
+              -> llvm::Expected<llvm::orc::IRCompileLayer::CompileFunction> {
+            return llvm::orc::ConcurrentIRCompiler(std::move(jtmb), cache);
+          });
+#endif
+    }
+    auto jit = builder.create();
+    CHECK(jit) << "Failed to initialize the ORC JIT for " << triple << ": "
+               << llvm::toString(jit.takeError());
+    orc_jit_ = std::move(jit.get());
+
+    const llvm::DataLayout& layout = orc_jit_->getDataLayout();
+    CHECK(layout == mptr_->getDataLayout())
+        << "Data layout mismatch between module("
+        << mptr_->getDataLayout().getStringRepresentation() << ")"
+        << " and ORC JIT (" << layout.getStringRepresentation() << ")";
+    // The runtime functions called by the module are resolved in the current process.
+    auto generator =
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(layout.getGlobalPrefix());
+    CHECK(generator) << llvm::toString(generator.takeError());
+    orc_jit_->getMainJITDylib().addGenerator(std::move(generator.get()));
+
+    llvm::Error err = orc_jit_->addLazyIRModule(
+        llvm::orc::ThreadSafeModule(std::move(jit_module.get()), std::move(jit_ctx)));
+    CHECK(!err) << "Failed to add the module to the ORC JIT: " << llvm::toString(std::move(err));
+#if TVM_LLVM_VERSION >= 110
+    err = orc_jit_->initialize(orc_jit_->getMainJITDylib());
+#else
+    err = orc_jit_->runConstructors();
+#endif
+    CHECK(!err) << "Failed to run the constructors of the JIT: "
+                << llvm::toString(std::move(err));
+    InitContext();
+  }
+
+  // Get symbol address from the ORC JIT.
+  uint64_t GetORCSymbolAddr(const std::string& name) const {
+    auto symbol = orc_jit_->lookup(name);
+    if (!symbol) {
+      LOG(WARNING) << llvm::toString(symbol.takeError());
+      return 0;
+    }
+    return symbol->getAddress();
+  }
+#endif
+
+  // Set the module context and the runtime function pointers of the jitted module.
+  void InitContext() {
     if (void** ctx_addr =
             reinterpret_cast<void**>(GetGlobalAddr(runtime::symbol::tvm_module_ctx))) {
       *ctx_addr = this;
@@ -330,6 +567,9 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   uint64_t GetGlobalAddr(const std::string& name) const {
     // first verifies if GV exists.
     if (mptr_->getGlobalVariable(name) != nullptr) {
+#if TVM_LLVM_VERSION >= 100
+      if (orc_jit_ != nullptr) return GetORCSymbolAddr(name);
+#endif
       return ee_->getGlobalValueAddress(name);
     } else {
       return 0;
@@ -338,6 +578,9 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   uint64_t GetFunctionAddr(const std::string& name) const {
     // first verifies if GV exists.
     if (mptr_->getFunction(name) != nullptr) {
+#if TVM_LLVM_VERSION >= 100
+      if (orc_jit_ != nullptr) return GetORCSymbolAddr(name);
+#endif
       return ee_->getFunctionAddress(name);
     } else {
       return 0;
@@ -348,8 +591,16 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   Target target_;
   // JIT lock
   std::mutex mutex_;
+  // Whether the JIT has been initialized
+  std::atomic<bool> jit_initialized_{false};
+  // The object cache of the JIT, must outlive the JIT.
+  std::unique_ptr<LLVMObjectCache> object_cache_;
   // execution engine
   llvm::ExecutionEngine* ee_{nullptr};
+#if TVM_LLVM_VERSION >= 100
+  // The ORC JIT, used instead of the execution engine with -jit=orcjit
+  std::unique_ptr<llvm::orc::LLLazyJIT> orc_jit_;
+#endif
   // The raw pointer to the module.
   llvm::Module* mptr_{nullptr};
   // The target machine
@@ -24,6 +24,8 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/target/target_info.h>
 
+#include <string>
+
 namespace tvm {
 
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
@@ -36,7 +38,17 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
                 << "head_address=" << op->head_address << ")";
     });
 
+TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
+    .set_dispatch<RegisterInfoNode>([](const ObjectRef& node, ReprPrinter* p) {
+      auto* op = static_cast<const RegisterInfoNode*>(node.get());
+      p->stream << "register-info("
+                << "num_registers=" << op->num_registers << ", "
+                << "register_bits=" << op->register_bits << ", "
+                << "max_unrolled_instructions=" << op->max_unrolled_instructions << ")";
+    });
+
 TVM_REGISTER_NODE_TYPE(MemoryInfoNode);
+TVM_REGISTER_NODE_TYPE(RegisterInfoNode);
 
 MemoryInfo GetMemoryInfo(const std::string& scope) {
   std::string fname = "tvm.info.mem." + scope;
@@ -48,4 +60,69 @@ MemoryInfo GetMemoryInfo(const std::string& scope) {
   }
 }
 
+RegisterInfo::RegisterInfo(int num_registers, int register_bits, int max_unrolled_instructions) {
+  auto n = make_object<RegisterInfoNode>();
+  n->num_registers = num_registers;
+  n->register_bits = register_bits;
+  n->max_unrolled_instructions = max_unrolled_instructions;
+  data_ = std::move(n);
+}
+
+// The vector register file of the CPU targeted by an llvm target.
+static RegisterInfo GetLLVMRegisterInfo(const Target& target) {
+  std::string mtriple = target->GetAttr<String>("mtriple", "").value();
+  std::string mcpu = target->GetAttr<String>("mcpu", "").value();
+  bool has_avx512 = mcpu == "skylake-avx512" || mcpu == "cascadelake" ||
+                    mcpu == "cooperlake" || mcpu.find("icelake") == 0;
+  bool has_avx2 = mcpu == "core-avx2" || mcpu == "haswell" || mcpu == "broadwell" ||
+                  mcpu == "skylake" || mcpu.find("znver") == 0;
+  bool has_neon = false;
+  if (Optional<Array<String>> mattr = target->GetAttr<Array<String>>("mattr")) {
+    for (const String& attr : mattr.value()) {
+      has_avx512 |= attr == "+avx512f";
+      has_avx2 |= attr == "+avx2";
+      has_neon |= attr == "+neon";
+    }
+  }
+  if (mtriple.find("aarch64") == 0 || mtriple.find("arm64") == 0) {
+    return RegisterInfo(32, 128, 512);
+  } else if (mtriple.find("arm") == 0 || mtriple.find("thumb") == 0) {
+    return RegisterInfo(has_neon ? 16 : 8, has_neon ? 128 : 32, 256);
+  } else if (has_avx512) {
+    return RegisterInfo(32, 512, 512);
+  } else if (has_avx2) {
+    return RegisterInfo(16, 256, 512);
+  }
+  return RegisterInfo(16, 128, 512);
+}
+
+RegisterInfo GetRegisterInfo(const Target& target) {
+  if (!target.defined()) {
+    return RegisterInfo(16, 128, 256);
+  }
+  std::string kind = target->kind->name;
+  if (const runtime::PackedFunc* f = runtime::Registry::Get("tvm.info.register." + kind)) {
+    RegisterInfo info = (*f)(target);
+    if (info.defined()) {
+      return info;
+    }
+  }
+  if (kind == "llvm") {
+    return GetLLVMRegisterInfo(target);
+  } else if (kind == "cuda" || kind == "nvptx" || kind == "rocm") {
+    // The register file is per thread and large, but every register used lowers the occupancy.
+    return RegisterInfo(64, 32, 1024);
+  } else if (kind == "opencl" || kind == "metal" || kind == "vulkan" || kind == "webgpu" ||
+             kind == "sdaccel" || kind == "aocl") {
+    return RegisterInfo(32, 32, 512);
+  } else if (kind == "hexagon") {
+    return RegisterInfo(32, 1024, 512);
+  }
+  return RegisterInfo(16, 128, 256);
+}
+
+TVM_REGISTER_GLOBAL("target.GetRegisterInfo").set_body_typed([](Optional<Target> target) {
+  return GetRegisterInfo(target.value_or(Target()));
+});
+
 }  // namespace tvm
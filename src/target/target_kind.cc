@@ -72,6 +72,15 @@ TVM_REGISTER_TARGET_KIND("llvm")
     .add_attr_option<Array<String>>("mattr")
     .add_attr_option<String>("mtriple")
     .add_attr_option<String>("mfloat-abi")
+    .add_attr_option<String>("jit")
+    .add_attr_option<Integer>("opt-level")
+    .add_attr_option<String>("pass-manager")
+    .add_attr_option<String>("pass-pipeline")
+    .add_attr_option<Bool>("vectorize-loops")
+    .add_attr_option<Bool>("vectorize-slp")
+    .add_attr_option<Array<String>>("llvm-options")
+    .add_attr_option<String>("profile-generate")
+    .add_attr_option<String>("profile-use")
     .set_default_keys({"cpu"})
     .set_device_type(kDLCPU);
 
@@ -23,12 +23,23 @@
  */
 // Unrolls the loop as in Halide pipeline.
 #include <tvm/arith/analyzer.h>
+#include <tvm/arith/pattern.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/target/target.h>
+#include <tvm/target/target_info.h>
+#include <tvm/tir/analysis.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
+#include <tvm/tir/op_attr_types.h>
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -43,6 +54,11 @@ struct UnrollLoopConfigNode : public tvm::AttrsNode<UnrollLoopConfigNode> {
   int auto_max_depth;
   int auto_max_extent;
   int explicit_unroll;
+  bool auto_cost_model;
+  int max_registers;
+  int max_unrolled_instructions;
+  int max_jam_factor;
+  bool record_decisions;
 
   TVM_DECLARE_ATTRS(UnrollLoopConfigNode, "tir.transform.UnrollLoopConfig") {
     TVM_ATTR_FIELD(auto_max_step)
@@ -57,6 +73,24 @@ struct UnrollLoopConfigNode : public tvm::AttrsNode<UnrollLoopConfigNode> {
     TVM_ATTR_FIELD(explicit_unroll)
         .describe("Whether to explicitly unroll the loop instead of setting a pragma")
         .set_default(true);
+    TVM_ATTR_FIELD(auto_cost_model)
+        .describe(
+            "Whether to decide the automatic unrolling by the estimated register pressure and "
+            "instruction count of the unrolled body instead of auto_max_step, and to unroll and "
+            "jam outer loops")
+        .set_default(false);
+    TVM_ATTR_FIELD(max_registers)
+        .describe("The register budget of the cost model, 0 to use the one of the target")
+        .set_default(0);
+    TVM_ATTR_FIELD(max_unrolled_instructions)
+        .describe("The instruction budget of the cost model, 0 to use the one of the target")
+        .set_default(0);
+    TVM_ATTR_FIELD(max_jam_factor)
+        .describe("The maximum number of copies of an outer loop body jammed by the cost model")
+        .set_default(4);
+    TVM_ATTR_FIELD(record_decisions)
+        .describe("Whether to mark the serial loops with the unrolling decision made on them")
+        .set_default(false);
   }
 };
 
@@ -68,6 +102,68 @@ class UnrollLoopConfig : public Attrs {
 TVM_REGISTER_NODE_TYPE(UnrollLoopConfigNode);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.UnrollLoop", UnrollLoopConfig);
 
+/*! \brief The estimated cost of a straight-line loop body. */
+struct LoopBodyCost {
+  /*! \brief Number of instructions, one per operation, load and store. */
+  int num_instructions{0};
+  /*!
+   * \brief Number of registers that hold the values live through the body: the stored
+   *  locations and the loaded values used more than once.
+   */
+  int num_registers{0};
+};
+
+/*! \brief Estimate the cost of a loop body on a register file. */
+class LoopBodyCostEstimator : public StmtExprVisitor {
+ public:
+  explicit LoopBodyCostEstimator(int register_bits) : register_bits_(register_bits) {}
+
+  LoopBodyCost Estimate(const Stmt& body) {
+    this->VisitStmt(body);
+    LoopBodyCost cost;
+    cost.num_instructions = num_instructions_;
+    for (const auto& kv : stored_) {
+      cost.num_registers += NumRegisters(kv.first.dtype());
+    }
+    for (const auto& kv : loaded_) {
+      if (kv.second > 1 && !stored_.count(kv.first)) {
+        cost.num_registers += NumRegisters(kv.first.dtype());
+      }
+    }
+    return cost;
+  }
+
+  void VisitExpr(const PrimExpr& e) final {
+    if (!e->IsInstance<VarNode>() && !e->IsInstance<IntImmNode>() &&
+        !e->IsInstance<FloatImmNode>() && !e->IsInstance<StringImmNode>()) {
+      ++num_instructions_;
+    }
+    StmtExprVisitor::VisitExpr(e);
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    ++loaded_[GetRef<PrimExpr>(op)];
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const StoreNode* op) final {
+    ++num_instructions_;
+    ++stored_[Load(op->value.dtype(), op->buffer_var, op->index, op->predicate)];
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+ private:
+  int NumRegisters(DataType t) const {
+    int bits = t.bits() * t.lanes();
+    return std::max((bits + register_bits_ - 1) / register_bits_, 1);
+  }
+
+  int register_bits_;
+  int num_instructions_{0};
+  std::unordered_map<PrimExpr, int, StructuralHash, StructuralEqual> loaded_;
+  std::unordered_map<PrimExpr, int, StructuralHash, StructuralEqual> stored_;
+};
+
 class LoopUnroller : public StmtExprMutator {
  public:
   explicit LoopUnroller(int auto_max_step, int auto_max_depth, int auto_max_extent,
@@ -77,6 +173,18 @@ class LoopUnroller : public StmtExprMutator {
         auto_max_extent_(auto_max_extent),
         explicit_unroll_(explicit_unroll) {}
 
+  /*!
+   * \brief Decide the automatic unrolling by the cost of the unrolled body on a register file,
+   *  and unroll and jam outer loops by up to max_jam_factor.
+   */
+  void EnableCostModel(RegisterInfo info, int max_jam_factor) {
+    register_info_ = std::move(info);
+    max_jam_factor_ = max_jam_factor;
+  }
+
+  /*! \brief Mark the serial loops with the unrolling decision made on them. */
+  void EnableRecordDecisions() { record_decisions_ = true; }
+
   Stmt VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == "pragma_auto_unroll_max_step") {
       int value = static_cast<int>(Downcast<Integer>(op->value)->value);
@@ -103,8 +211,16 @@ class LoopUnroller : public StmtExprMutator {
     bool auto_unroll = (op->for_type == ForType::Serial && value >= 0 && normal_loop_depth_ == 0 &&
                         unroll_depth_ <= auto_max_depth_);
 
-    auto_unroll =
-        auto_unroll && (value * step_count_ <= auto_max_step_ || value <= auto_max_extent_);
+    std::string decision;
+    if (register_info_.defined() && auto_unroll && op->for_type == ForType::Serial) {
+      LoopBodyCost cost;
+      bool fit = FitUnrolled(op, value, &cost);
+      auto_unroll = fit || value <= auto_max_extent_;
+      decision = CostToString(cost);
+    } else {
+      auto_unroll =
+          auto_unroll && (value * step_count_ <= auto_max_step_ || value <= auto_max_extent_);
+    }
 
     if (op->for_type == ForType::Unrolled) {
       CHECK_GE(value, 0) << "Cannot unroll non-constant loop";
@@ -121,15 +237,24 @@ class LoopUnroller : public StmtExprMutator {
     if ((auto_unroll && explicit_unroll_) ||
         // unroll loops with extent = 1, no matter how many steps in body
         (0 <= value && value <= auto_max_extent_ && auto_max_extent_ == 1)) {
-      return Unroll(op);
+      return Record(op, Unroll(op), "unroll" + decision);
     } else {
       if (auto_unroll) {
         if (op->for_type != ForType::Unrolled) {
-          return For(op->loop_var, op->min, op->extent, ForType::Unrolled, op->device_api,
-                     op->body);
+          return Record(op,
+                        For(op->loop_var, op->min, op->extent, ForType::Unrolled,
+                            op->device_api, op->body),
+                        "unroll_pragma" + decision);
         }
+        return stmt;
       }
-      return stmt;
+      if (register_info_.defined() && op->for_type == ForType::Serial && value > 1) {
+        Stmt jammed = UnrollAndJam(op, value);
+        if (jammed.defined()) {
+          return jammed;
+        }
+      }
+      return op->for_type == ForType::Serial ? Record(op, stmt, "keep" + decision) : stmt;
     }
   }
 
@@ -177,6 +302,165 @@ class LoopUnroller : public StmtExprMutator {
   }
 
  private:
+  // Whether the fully unrolled loop fits the register file, cost is the estimate of the body.
+  bool FitUnrolled(const ForNode* op, int value, LoopBodyCost* cost) {
+    if (ContainsLoop(op->body)) {
+      return false;
+    }
+    *cost = LoopBodyCostEstimator(register_info_->register_bits).Estimate(op->body);
+    // Rule out the long loops before building the unrolled body.
+    if (static_cast<int64_t>(cost->num_instructions) * value >
+        register_info_->max_unrolled_instructions) {
+      cost->num_instructions *= value;
+      return false;
+    }
+    *cost = LoopBodyCostEstimator(register_info_->register_bits).Estimate(Unroll(op));
+    return Fit(*cost);
+  }
+
+  bool Fit(const LoopBodyCost& cost) const {
+    return cost.num_registers <= register_info_->num_registers &&
+           cost.num_instructions <= register_info_->max_unrolled_instructions;
+  }
+
+  /*!
+   * \brief Unroll the outer loop op by a factor and jam the copies into the body of its inner
+   *  loop, so that the copies share the values that do not depend on the outer loop.
+   * \return The jammed loop nest, undefined when the loop cannot or need not be jammed.
+   */
+  Stmt UnrollAndJam(const ForNode* op, int value) {
+    Stmt body = op->body;
+    const AttrStmtNode* inner_decision = body.as<AttrStmtNode>();
+    if (inner_decision != nullptr && inner_decision->attr_key == attr::unroll_decision) {
+      body = inner_decision->body;
+    }
+    const ForNode* inner = body.as<ForNode>();
+    if (inner == nullptr || inner->for_type != ForType::Serial ||
+        ExprUseVar(inner->min, op->loop_var) || ExprUseVar(inner->extent, op->loop_var) ||
+        ContainsLoop(inner->body) || !HasOuterInvariantLoad(inner->body, op->loop_var)) {
+      return Stmt();
+    }
+    Var outer(op->loop_var->name_hint + ".outer", op->loop_var.dtype());
+    for (int factor = std::min(max_jam_factor_, value); factor > 1; --factor) {
+      if (value % factor != 0 || !CanJam(op, inner, factor)) continue;
+      Array<Stmt> copies;
+      Map<Var, PrimExpr> vmap;
+      for (int i = 0; i < factor; ++i) {
+        vmap.Set(op->loop_var, op->min + outer * make_const(outer.dtype(), factor) + i);
+        copies.push_back(Substitute(inner->body, vmap));
+      }
+      Stmt jammed = SeqStmt::Flatten(copies);
+      LoopBodyCost cost = LoopBodyCostEstimator(register_info_->register_bits).Estimate(jammed);
+      if (!Fit(cost)) continue;
+      Stmt ret = For(inner->loop_var, inner->min, inner->extent, inner->for_type,
+                     inner->device_api, jammed);
+      if (inner_decision != nullptr) {
+        ret = AttrStmt(inner_decision->node, inner_decision->attr_key, inner_decision->value, ret);
+      }
+      if (value == factor) {
+        ret = Substitute(ret, Map<Var, PrimExpr>({{outer, make_zero(outer.dtype())}}));
+      } else {
+        ret = For(outer, make_zero(outer.dtype()), make_const(outer.dtype(), value / factor),
+                  ForType::Serial, op->device_api, ret);
+      }
+      std::ostringstream os;
+      os << "unroll_and_jam(factor=" << factor << ")" << CostToString(cost);
+      return Record(op, ret, os.str());
+    }
+    return Stmt();
+  }
+
+  /*!
+   * \brief Whether the iterations of the outer loop op can run factor by factor in each
+   *  iteration of the inner loop.
+   *
+   *  Only the accesses to the written buffers can conflict. Each written buffer must be
+   *  accessed at a single scalar location a * i + b * j + c, where i and j are the outer and
+   *  inner loop variables, and the jam reorders the iterations (i1, j1) and (i2, j2) with
+   *  0 < i2 - i1 < factor and j1 > j2, which must not meet at the same location.
+   */
+  bool CanJam(const ForNode* op, const ForNode* inner, int factor) {
+    bool straight = true;
+    std::unordered_map<const VarNode*, PrimExpr> written;
+    PostOrderVisit(inner->body, [&](const ObjectRef& node) {
+      if (const StoreNode* store = node.as<StoreNode>()) {
+        auto it = written.find(store->buffer_var.get());
+        straight &= store->index.dtype().lanes() == 1 && is_one(store->predicate) &&
+                    (it == written.end() || StructuralEqual()(it->second, store->index)) &&
+                    SideEffect(store->value) <= CallEffectKind::kReadState &&
+                    SideEffect(store->index) <= CallEffectKind::kReadState;
+        written[store->buffer_var.get()] = store->index;
+      } else if (const IfThenElseNode* branch = node.as<IfThenElseNode>()) {
+        straight &= SideEffect(branch->condition) <= CallEffectKind::kReadState;
+      } else if (const AttrStmtNode* mark = node.as<AttrStmtNode>()) {
+        straight &= mark->attr_key == attr::unroll_decision;
+      } else if (node->IsInstance<StmtNode>()) {
+        straight &= node->IsInstance<SeqStmtNode>();
+      } else if (node->IsInstance<LetNode>()) {
+        straight = false;
+      }
+    });
+    if (!straight) return false;
+    bool same_location = true;
+    PostOrderVisit(inner->body, [&](const ObjectRef& node) {
+      if (const LoadNode* load = node.as<LoadNode>()) {
+        auto it = written.find(load->buffer_var.get());
+        same_location &= it == written.end() || StructuralEqual()(it->second, load->index);
+      }
+    });
+    if (!same_location) return false;
+    const int64_t* inner_extent = as_const_int(inner->extent);
+    for (const auto& kv : written) {
+      Array<PrimExpr> coeff =
+          arith::DetectLinearEquation(kv.second, {op->loop_var, inner->loop_var});
+      if (coeff.size() != 3) return false;
+      const int64_t* a = as_const_int(coeff[0]);
+      const int64_t* b = as_const_int(coeff[1]);
+      if (a == nullptr || b == nullptr) return false;
+      int64_t abs_a = std::abs(*a), abs_b = std::abs(*b);
+      bool safe = (abs_a == 0) != (abs_b == 0) || (*a > 0) != (*b > 0) ||
+                  abs_b > abs_a * (factor - 1) ||
+                  (inner_extent != nullptr && abs_a > abs_b * (*inner_extent - 1));
+      if (!safe) return false;
+    }
+    return true;
+  }
+
+  // Whether the body loads a value that does not depend on the loop variable.
+  static bool HasOuterInvariantLoad(const Stmt& body, const Var& loop_var) {
+    bool found = false;
+    PostOrderVisit(body, [&](const ObjectRef& node) {
+      if (const LoadNode* load = node.as<LoadNode>()) {
+        found |= !ExprUseVar(GetRef<PrimExpr>(load), loop_var);
+      }
+    });
+    return found;
+  }
+
+  static bool ContainsLoop(const Stmt& body) {
+    bool found = false;
+    PostOrderVisit(body, [&found](const ObjectRef& node) { found |= node->IsInstance<ForNode>(); });
+    return found;
+  }
+
+  std::string CostToString(const LoopBodyCost& cost) const {
+    if (!register_info_.defined()) {
+      return "";
+    }
+    std::ostringstream os;
+    os << " registers=" << cost.num_registers << "/" << register_info_->num_registers
+       << " instructions=" << cost.num_instructions << "/"
+       << register_info_->max_unrolled_instructions;
+    return os.str();
+  }
+
+  Stmt Record(const ForNode* op, Stmt stmt, const std::string& decision) {
+    if (!record_decisions_) {
+      return stmt;
+    }
+    return AttrStmt(op->loop_var, attr::unroll_decision, StringImm(decision), stmt);
+  }
+
   // returns the extent of the loop if it's a constant integer, otherwise return -1
   int GetExtent(const ForNode* op) {
     // constant folding.
@@ -198,6 +482,12 @@ class LoopUnroller : public StmtExprMutator {
   // this not not count the total steps, only count the number of loops
   int auto_max_extent_;
   bool explicit_unroll_;
+  // The register file of the cost model, undefined when the cost model is disabled.
+  RegisterInfo register_info_;
+  // The maximum number of copies jammed by the cost model.
+  int max_jam_factor_{0};
+  // Whether to mark the loops with the decisions.
+  bool record_decisions_{false};
   // Number of normal loops in scope
   int normal_loop_depth_{0};
   // number of unrolled cases in current scope.
@@ -208,9 +498,23 @@ class LoopUnroller : public StmtExprMutator {
   arith::Analyzer analyzer_;
 };
 
-Stmt UnrollLoop(Stmt stmt, UnrollLoopConfig cfg) {
-  Stmt ret = LoopUnroller(cfg->auto_max_step, cfg->auto_max_depth, cfg->auto_max_extent,
-                          cfg->explicit_unroll)(stmt);
+Stmt UnrollLoop(Stmt stmt, UnrollLoopConfig cfg, Target target) {
+  LoopUnroller unroller(cfg->auto_max_step, cfg->auto_max_depth, cfg->auto_max_extent,
+                        cfg->explicit_unroll);
+  if (cfg->auto_cost_model) {
+    RegisterInfo info = GetRegisterInfo(target);
+    if (cfg->max_registers > 0 || cfg->max_unrolled_instructions > 0) {
+      info = RegisterInfo(cfg->max_registers > 0 ? cfg->max_registers : info->num_registers,
+                          info->register_bits,
+                          cfg->max_unrolled_instructions > 0 ? cfg->max_unrolled_instructions
+                                                             : info->max_unrolled_instructions);
+    }
+    unroller.EnableCostModel(info, cfg->max_jam_factor);
+  }
+  if (cfg->record_decisions) {
+    unroller.EnableRecordDecisions();
+  }
+  Stmt ret = unroller(stmt);
   if (!ret.same_as(stmt)) {
     return ConvertSSA(ret);
   } else {
@@ -227,7 +531,9 @@ Pass UnrollLoop() {
     if (!cfg.defined()) {
       cfg = AttrsWithDefaultValues<UnrollLoopConfig>();
     }
-    n->body = UnrollLoop(std::move(f->body), cfg.value());
+    // The cost model uses the register file of the target of the function, if any.
+    Target target = f->GetAttr<Target>(tvm::attr::kTarget).value_or(Target::Current(true));
+    n->body = UnrollLoop(std::move(f->body), cfg.value(), target);
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.UnrollLoop", {});
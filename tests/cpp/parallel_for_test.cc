@@ -118,6 +118,38 @@ TEST(ParallelFor, Exception) {
   CHECK(exception);
 }
 
+TEST(ParallelFor, Dynamic) {
+  using tvm::support::parallel_for_dynamic;
+
+  std::vector<int> a(1000, 0);
+  // Iterations of very different costs
+  parallel_for_dynamic(0, 1000, 4, [&a](int i) {
+    int sum = 0;
+    for (int j = 0; j < (i % 10) * 1000; j++) {
+      sum += j % 3;
+    }
+    a[i] = i + (sum >= 0 ? 1 : 0);
+  });
+  for (int i = 0; i < 1000; i++) {
+    CHECK_EQ(a[i], i + 1);
+  }
+
+  // Empty range and the default number of threads
+  parallel_for_dynamic(5, 5, 0, [](int i) { LOG(FATAL) << "unreachable"; });
+  parallel_for_dynamic(0, 10, 0, [&a](int i) { a[i] = -i; });
+  for (int i = 0; i < 10; i++) {
+    CHECK_EQ(a[i], -i);
+  }
+
+  bool exception = false;
+  try {
+    parallel_for_dynamic(0, 100, 4, [](int i) { LOG(FATAL) << "error"; });
+  } catch (const std::exception& e) {
+    exception = true;
+  }
+  CHECK(exception);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
@@ -19,6 +19,8 @@
 
 #include <gtest/gtest.h>
 #include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <atomic>
 #include <memory>
@@ -64,6 +66,63 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
   }
 }
 
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  const auto* fconfig = tvm::runtime::Registry::Get("runtime.config_threadpool_scheduler");
+  ASSERT_TRUE(fconfig != nullptr);
+  for (int tasks_per_worker : {1, 4, 16}) {
+    (*fconfig)("work_stealing", tasks_per_worker);
+    for (size_t j = 0; j < 3; ++j) {
+      std::atomic<size_t> acc(0);
+      TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+      EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    }
+  }
+  (*fconfig)("static", 1);
+}
+
+struct TaskCounts {
+  explicit TaskCounts(int max_num_task) : counts(new std::atomic<int>[max_num_task]) {
+    for (int i = 0; i < max_num_task; ++i) {
+      counts[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  std::unique_ptr<std::atomic<int>[]> counts;
+  std::atomic<int> num_task{0};
+};
+
+static FTVMParallelLambda count_uneven_task = [](int task_id, TVMParallelGroupEnv* penv,
+                                                 void* cdata) -> int {
+  auto* data = reinterpret_cast<TaskCounts*>(cdata);
+  // uneven tasks keep some workers stealing while others finish
+  volatile size_t sink = 0;
+  for (int i = 0; i < (task_id % 7) * 200; ++i) {
+    sink = sink + i;
+  }
+  data->counts[task_id].fetch_add(1, std::memory_order_relaxed);
+  data->num_task.store(penv->num_task, std::memory_order_relaxed);
+  return 0;
+};
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealingStress) {
+  const auto* fconfig = tvm::runtime::Registry::Get("runtime.config_threadpool_scheduler");
+  ASSERT_TRUE(fconfig != nullptr);
+  const int max_tasks_per_worker = 8;
+  const int max_num_task = tvm::runtime::threading::MaxConcurrency() * max_tasks_per_worker;
+  // back to back launches, workers of a launch may still be stealing when the next starts
+  for (int j = 0; j < 2000; ++j) {
+    (*fconfig)("work_stealing", 1 + j % max_tasks_per_worker);
+    TaskCounts data(max_num_task);
+    ASSERT_EQ(TVMBackendParallelLaunch(count_uneven_task, &data, 0), 0);
+    int num_task = data.num_task.load(std::memory_order_relaxed);
+    ASSERT_GT(num_task, 0);
+    for (int i = 0; i < max_num_task; ++i) {
+      ASSERT_EQ(data.counts[i].load(std::memory_order_relaxed), i < num_task ? 1 : 0)
+          << "task " << i << " of launch " << j;
+    }
+  }
+  (*fconfig)("static", 1);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../../src/runtime/vm/pooled_allocator.h"
+
+using namespace tvm::runtime;
+using namespace tvm::runtime::vm;
+
+static TVMContext CPUContext() {
+  TVMContext ctx;
+  ctx.device_type = kDLCPU;
+  ctx.device_id = 0;
+  return ctx;
+}
+
+static DLDataType Float32() { return DLDataType{kDLFloat, 32, 1}; }
+
+TEST(PooledAllocator, SizeClass) {
+  PooledAllocator alloc(CPUContext(), 4096, 0);
+  EXPECT_EQ(alloc.SizeClass(1), 4096u);
+  EXPECT_EQ(alloc.SizeClass(4096), 4096u);
+  EXPECT_EQ(alloc.SizeClass(4097), 8192u);
+  EXPECT_EQ(alloc.SizeClass(1 << 20), size_t{1} << 20);
+  EXPECT_EQ(alloc.SizeClass((1 << 20) + 1), size_t{(1 << 20) + (1 << 18)});
+  EXPECT_EQ(alloc.SizeClass((1 << 20) + (1 << 18) + 1), size_t{(1 << 20) + (1 << 19)});
+}
+
+TEST(PooledAllocator, Reuse) {
+  PooledAllocator alloc(CPUContext(), 4096, 0);
+  // Both requests fall into the same size class, the second one reuses the buffer.
+  Buffer a = alloc.Alloc(3 << 20, 64, Float32());
+  alloc.Free(a);
+  Buffer b = alloc.Alloc((3 << 20) - 100, 64, Float32());
+  EXPECT_EQ(a.data, b.data);
+  AllocatorStats stats = alloc.Stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.pooled_bytes, 0u);
+  EXPECT_EQ(stats.allocated_bytes, a.size);
+  EXPECT_GT(stats.Fragmentation(), 0.0);
+  alloc.Free(b);
+  EXPECT_EQ(alloc.Stats().pooled_bytes, b.size);
+}
+
+TEST(PooledAllocator, HighWaterMark) {
+  const size_t kLimit = 8 << 20;
+  PooledAllocator alloc(CPUContext(), 4096, kLimit);
+  std::vector<Buffer> bufs;
+  for (int i = 0; i < 8; ++i) {
+    bufs.push_back(alloc.Alloc(2 << 20, 64, Float32()));
+  }
+  for (const Buffer& buf : bufs) alloc.Free(buf);
+  AllocatorStats stats = alloc.Stats();
+  EXPECT_LE(stats.pooled_bytes, kLimit);
+  EXPECT_EQ(stats.trimmed_bytes, 8 * (size_t{2} << 20) - stats.pooled_bytes);
+  EXPECT_EQ(stats.allocated_bytes, stats.pooled_bytes);
+  alloc.Trim(0);
+  EXPECT_EQ(alloc.Stats().allocated_bytes, 0u);
+}
+
+TEST(PooledAllocator, ThreadCache) {
+  PooledAllocator alloc(CPUContext(), 4096, 0);
+  auto worker = [&alloc]() {
+    for (int i = 0; i < 1000; ++i) {
+      Buffer small = alloc.Alloc(1024 + i % 7, 64, Float32());
+      Buffer large = alloc.Alloc(4 << 20, 64, Float32());
+      alloc.Free(large);
+      alloc.Free(small);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
+  AllocatorStats stats = alloc.Stats();
+  EXPECT_EQ(stats.hits + stats.misses, 8000u);
+  EXPECT_LE(stats.misses, 8u);
+  // Exited threads hand their cached buffers back, so everything can be trimmed.
+  alloc.Trim(0);
+  EXPECT_EQ(alloc.Stats().allocated_bytes, 0u);
+  EXPECT_EQ(alloc.Stats().pooled_bytes, 0u);
+}
+
+TEST(PooledAllocator, TrimThreadCacheOfLiveThread) {
+  PooledAllocator alloc(CPUContext(), 4096, 0);
+  std::mutex mu;
+  std::condition_variable cv;
+  bool freed = false, trimmed = false;
+  // The worker keeps its cached buffer while the main thread trims.
+  std::thread worker([&]() {
+    alloc.Free(alloc.Alloc(1024, 64, Float32()));
+    std::unique_lock<std::mutex> lock(mu);
+    freed = true;
+    cv.notify_all();
+    cv.wait(lock, [&]() { return trimmed; });
+  });
+  {
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [&]() { return freed; });
+  }
+  alloc.Trim(0);
+  EXPECT_EQ(alloc.Stats().allocated_bytes, 0u);
+  EXPECT_EQ(alloc.Stats().pooled_bytes, 0u);
+  {
+    std::lock_guard<std::mutex> lock(mu);
+    trimmed = true;
+  }
+  cv.notify_all();
+  worker.join();
+}
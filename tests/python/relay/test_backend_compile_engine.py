@@ -21,6 +21,7 @@ import tvm.testing
 from tvm import relay
 from tvm import autotvm
 from tvm import topi
+from tvm.contrib import graph_runtime, util
 from tvm.relay.testing import run_infer_type
 from tvm.relay.testing.temp_op_attr import TempOpAttr
 import tvm.testing
@@ -235,6 +236,98 @@ def test_compile_nhwc_pack():
     relay.build(mod, target="llvm")
 
 
+def test_persistent_compile_cache():
+    def get_mod():
+        x = relay.var("x", shape=(4, 8))
+        w = relay.var("w", shape=(16, 8))
+        y = relay.nn.relu(relay.nn.dense(x, w))
+        z = relay.exp(relay.add(y, relay.const(1.0)))
+        return tvm.IRModule.from_expr(relay.Function([x, w], z))
+
+    def build_and_run(config):
+        relay.backend.compile_engine.get().clear()
+        with tvm.transform.PassContext(opt_level=3,
+                                       config={"relay.backend.CompileCache": config}):
+            graph, lib, params = relay.build(get_mod(), "llvm")
+        m = graph_runtime.create(graph, lib, tvm.cpu())
+        m.set_input("x", x_np)
+        m.set_input("w", w_np)
+        m.run()
+        return m.get_output(0).asnumpy()
+
+    x_np = np.random.uniform(size=(4, 8)).astype("float32")
+    w_np = np.random.uniform(size=(16, 8)).astype("float32")
+    engine = relay.backend.compile_engine
+    temp = util.tempdir()
+    config = {"dir": temp.temp_dir}
+    engine.reset_persistent_cache_stats()
+    ref = build_and_run(config)
+    stats = engine.persistent_cache_stats()
+    assert stats["hits"] == 0
+    assert stats["insertions"] > 0
+    assert stats["bytes"] > 0
+
+    # A fresh engine reuses every lowered function from the disk.
+    engine.reset_persistent_cache_stats()
+    out = build_and_run(config)
+    stats = engine.persistent_cache_stats()
+    assert stats["misses"] == 0
+    assert stats["hits"] > 0
+    tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+    # A different salt is a different key.
+    engine.reset_persistent_cache_stats()
+    build_and_run({"dir": temp.temp_dir, "salt": "other"})
+    assert engine.persistent_cache_stats()["hits"] == 0
+
+    # Entries beyond the budget are evicted.
+    engine.reset_persistent_cache_stats()
+    build_and_run({"dir": temp.temp_dir, "max_bytes": 1, "salt": "evict"})
+    stats = engine.persistent_cache_stats()
+    assert stats["evictions"] >= stats["insertions"]
+    assert stats["bytes"] <= 1
+
+
+def test_parallel_build():
+    def get_mod():
+        x = relay.var("x", shape=(1, 3, 16, 16))
+        y = relay.nn.relu(relay.nn.conv2d(x, relay.const(np.ones((8, 3, 3, 3), "float32")),
+                                          padding=(1, 1)))
+        y = relay.nn.max_pool2d(y, pool_size=(2, 2), strides=(2, 2))
+        z = relay.sigmoid(relay.nn.batch_flatten(y))
+        z = relay.nn.softmax(relay.nn.dense(z, relay.const(np.ones((10, 512), "float32"))))
+        return tvm.IRModule.from_expr(relay.Function([x], relay.Tuple([z, relay.exp(y)])))
+
+    def build(config):
+        relay.backend.compile_engine.get().clear()
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            return relay.build(get_mod(), "llvm")
+
+    def run(graph, lib):
+        m = graph_runtime.create(graph, lib, tvm.cpu())
+        m.set_input("x", x_np)
+        m.run()
+        return [m.get_output(i).asnumpy() for i in range(m.get_num_outputs())]
+
+    x_np = np.random.uniform(size=(1, 3, 16, 16)).astype("float32")
+    graph, lib, _ = build({})
+    ref = run(graph, lib)
+    par_graph, par_lib, _ = build({"relay.backend.num_lower_threads": 4,
+                                   "tir.num_codegen_partitions": 3})
+    # Names are assigned as in a serial build.
+    assert par_graph == graph
+    assert len(par_lib.imported_modules) == 2
+    for out, expected in zip(run(par_graph, par_lib), ref):
+        tvm.testing.assert_allclose(out, expected, rtol=1e-5)
+
+    # The partitions are linked into a single library.
+    temp = util.tempdir()
+    path = temp.relpath("lib.so")
+    par_lib.export_library(path)
+    for out, expected in zip(run(par_graph, tvm.runtime.load_module(path)), ref):
+        tvm.testing.assert_allclose(out, expected, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_get_valid_implementations()
     test_select_implementation()
@@ -244,3 +337,5 @@ if __name__ == "__main__":
     test_compile_tuple_dup()
     test_compile_full()
     test_compile_nhwc_pack()
+    test_persistent_compile_cache()
+    test_parallel_build()
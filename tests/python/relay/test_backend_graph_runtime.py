@@ -141,6 +141,51 @@ def test_plan_memory():
     assert len(device_types) == 1
 
 
+def test_plan_memory_arena():
+    # large and small tensors alternate, the default planner cannot reuse
+    # the space of the large tensors for the small ones.
+    x = relay.var("x", shape=(64, 64))
+    y = relay.exp(x)
+    small = relay.sum(y, axis=1)
+    z = relay.add(y, relay.expand_dims(relay.exp(small), axis=1))
+    z = relay.exp(z)
+    small = relay.sum(z, axis=0)
+    z = relay.multiply(z, relay.exp(small))
+    func = relay.Function([x], z)
+    mod = tvm.IRModule.from_expr(func)
+    mod = relay.transform.InferType()(mod)
+    mod = relay.transform.FuseOps(0)(mod)
+
+    with tvm.transform.PassContext(config={"relay.GraphPlanMemory.use_arena": True}):
+        smap = relay.backend._backend.GraphPlanMemory(mod["main"])
+    for k, v in smap.items():
+        assert len(v) == 3
+        for offset in v[2]:
+            # the views must keep the 128-byte alignment that the kernels assert
+            assert offset.value % 128 == 0
+
+    # devices whose data pointers are opaque handles fall back to the default planner
+    with tvm.transform.PassContext(config={"relay.GraphPlanMemory.use_arena": True}):
+        smap = relay.backend._backend.GraphPlanMemory(mod["main"], tvm.opencl().device_type)
+    for k, v in smap.items():
+        assert len(v) == 2
+
+    default_bytes, arena_bytes, lower_bound = [
+        x.value for x in relay.backend._backend.GraphPlanMemoryFootprint(mod["main"])]
+    assert lower_bound <= arena_bytes <= default_bytes
+
+    data = np.random.uniform(size=(64, 64)).astype("float32")
+    outputs = []
+    for use_arena in [False, True]:
+        config = {"relay.GraphPlanMemory.use_arena": use_arena}
+        with tvm.transform.PassContext(opt_level=0, config=config):
+            graph, lib, params = relay.build(tvm.IRModule.from_expr(func), "llvm")
+        m = graph_runtime.create(graph, lib, tvm.cpu())
+        m.run(x=data)
+        outputs.append(m.get_output(0).asnumpy())
+    tvm.testing.assert_allclose(outputs[0], outputs[1], rtol=1e-5)
+
+
 @tvm.testing.uses_gpu
 def test_gru_like():
     def unit(rnn_dim):
@@ -181,6 +226,7 @@ def test_gru_like():
 
 if __name__ == "__main__":
     test_plan_memory()
+    test_plan_memory_arena()
     test_with_params()
     test_add_op_scalar()
     test_add_op_tensor()
@@ -697,5 +697,34 @@ def test_vm_reshape_tensor():
     y_np = np.array([8, 2, 8]).astype("int32")
     check_result([x_np, y_np], x_np.reshape([8, 2, 8]), mod)
 
+def test_vm_rerun_loop():
+    # Cached scalar constants and recycled frames must not leak state between runs.
+    mod = tvm.IRModule({})
+    sum_up = relay.GlobalVar('sum_up')
+    i = relay.var('i', shape=[], dtype='int32')
+    accum = relay.var('accum', shape=[], dtype='int32')
+    sb = ScopeBuilder()
+    with sb.if_scope(relay.equal(i, relay.const(0, 'int32'))):
+        sb.ret(accum)
+    with sb.else_scope():
+        one_less = relay.subtract(i, relay.const(1, 'int32'))
+        new_accum = relay.add(accum, i)
+        sb.ret(relay.Call(sum_up, [one_less, new_accum]))
+    mod[sum_up] = relay.Function([i, accum], sb.get())
+    iarg = relay.var('i', shape=[], dtype='int32')
+    aarg = relay.var('accum', shape=[], dtype='int32')
+    mod["main"] = relay.Function([iarg, aarg], sum_up(iarg, aarg))
+    exe = relay.vm.compile(mod, "llvm")
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    fcount = vm.module["get_num_executed_instructions"]
+    num_instrs = []
+    for loop_bound in [10, 3, 10]:
+        start = fcount()
+        res = vm.run(np.array(loop_bound, 'int32'), np.array(0, 'int32'))
+        num_instrs.append(fcount() - start)
+        assert res.asnumpy() == sum(range(1, loop_bound + 1))
+    assert num_instrs[0] == num_instrs[2]
+    assert num_instrs[1] < num_instrs[0]
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -16,6 +16,8 @@
 # under the License.
 # pylint: disable=invalid-name, missing-docstring, no-else-return
 """Unit tests for the Relay VM serialization and deserialization."""
+import struct
+
 import pytest
 import numpy as np
 
@@ -142,6 +144,60 @@ def test_save_load():
     tvm.testing.assert_allclose(res.asnumpy(), x_data + x_data)
 
 
+def test_load_from_file():
+    x = relay.var('x', shape=(10, 10))
+    c_data = np.random.rand(10, 10).astype('float32')
+    f = relay.Function([x], x + relay.const(c_data))
+    x_data = np.random.rand(10, 10).astype('float32')
+
+    code, lib = create_exec(f).save()
+    tmp = util.tempdir()
+    path_code = tmp.relpath("code.ro")
+    with open(path_code, "wb") as fo:
+        fo.write(code)
+
+    # the constants alias the mapped file
+    des_exec = _vm.Executable.load_exec_from_file(path_code, lib)
+    des_vm = _vm.VirtualMachine(des_exec, tvm.cpu())
+    res = des_vm.run(x_data)
+    tvm.testing.assert_allclose(res.asnumpy(), x_data + c_data)
+
+
+def test_load_unaligned_constants():
+    x = relay.var('x', shape=(10, 10))
+    c_data = np.random.rand(10, 10).astype('float32')
+    f = relay.Function([x], x + relay.const(c_data))
+    x_data = np.random.rand(10, 10).astype('float32')
+    code, lib = create_exec(f).save()
+    code = bytes(code)
+
+    # Rewrite the constants as the plain NDArray records of the earlier layout.
+    pos = 8 + 8 + struct.unpack_from("<Q", code, 8)[0]  # magic and version
+    num_globals, = struct.unpack_from("<Q", code, pos)
+    pos += 8
+    for _ in range(num_globals):
+        pos += 8 + struct.unpack_from("<Q", code, pos)[0]
+    num_consts, = struct.unpack_from("<Q", code, pos)
+    pos += 8
+    old_code = [code[:pos]]
+    for _ in range(num_consts):
+        ctx_and_dtype = code[pos + 8:pos + 24]
+        ndim, = struct.unpack_from("<i", code, pos + 16)
+        shape = code[pos + 24:pos + 24 + 8 * ndim]
+        pos += 24 + 8 * ndim
+        nbytes, data_offset = struct.unpack_from("<qQ", code, pos)
+        old_code += [struct.pack("<QQ", 0xDD5E40F096B4A13F, 0), ctx_and_dtype, shape,
+                     struct.pack("<q", nbytes), code[data_offset:data_offset + nbytes]]
+        pos = data_offset + nbytes
+    old_code.append(code[pos:])
+    old_code = bytearray(b"".join(old_code))
+
+    des_exec = _vm.Executable.load_exec(old_code, lib)
+    des_vm = _vm.VirtualMachine(des_exec, tvm.cpu())
+    res = des_vm.run(x_data)
+    tvm.testing.assert_allclose(res.asnumpy(), x_data + c_data)
+
+
 def test_const():
     c = relay.const(1.0, "float32")
     x = relay.var('x', shape=(10, 10), dtype='float32')
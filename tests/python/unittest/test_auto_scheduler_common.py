@@ -189,6 +189,19 @@ def get_tiled_matmul():
     return dag, s0
 
 
+def get_split_matmul(dag, factor, reorder=False, parallel=False):
+    """Split the outer axis of the matmul in `dag` by `factor` and return the new state"""
+    s = dag.get_init_state()
+    C = s.stage_ops[2]
+    i, j, k = s[C].iters
+    io, ii = s.split(C, i, [factor])
+    if reorder:
+        s.reorder(C, [io, j, k, ii])
+    if parallel:
+        s.parallel(C, io)
+    return s
+
+
 class PropagatingThread(threading.Thread):
     def run(self):
         self.exc = None
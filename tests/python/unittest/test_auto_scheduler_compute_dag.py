@@ -56,7 +56,43 @@ def test_estimate_flop():
     assert abs(dag.flop_ct - (2 * N ** 3 + 1234)) < 0.5
 
 
+def test_replay_cache():
+    A, B, C = matmul_auto_scheduler_test(512, 512, 512)
+    dag = auto_scheduler.ComputeDAG([A, B, C])
+
+    def make_state(last_step):
+        s = dag.get_init_state()
+        its0 = s.split(C, s[C].iters[0], [4, 8, 8])
+        its1 = s.split(C, s[C].iters[4], [8, 4, 4])
+        s.reorder(C, [its0[0], its1[0], its0[1], its1[1], its0[2], its1[2], its0[3], its1[3],
+                      s[C].iters[8]])
+        if last_step == "parallel":
+            s.parallel(C, its0[0])
+        else:
+            s.unroll(C, its1[3])
+        return s
+
+    def lower(s):
+        sch, args = dag.apply_steps_from_state(s)
+        return str(tvm.lower(sch, args, simple_mode=True)), str(dag.infer_bound_from_state(s))
+
+    s1, s2 = make_state("parallel"), make_state("unroll")
+    auto_scheduler.compute_dag.set_replay_cache_capacity(0)
+    expected = [lower(s1), lower(s2)]
+
+    auto_scheduler.compute_dag.set_replay_cache_capacity(256)
+    auto_scheduler.compute_dag.reset_replay_cache_stats()
+    # The first replay of s1 starts from scratch, the second one is restored completely
+    assert lower(s1) == expected[0]
+    # s2 shares all but the last step with s1
+    assert lower(s2) == expected[1]
+    stats = auto_scheduler.compute_dag.get_replay_cache_stats()
+    assert stats == {"hits": 3, "misses": 1, "reused_steps": 4 + 3 + 4,
+                     "replayed_steps": 4 + 1}
+
+
 if __name__ == "__main__":
     test_apply_steps()
     test_infer_bound()
     test_estimate_flop()
+    test_replay_cache()
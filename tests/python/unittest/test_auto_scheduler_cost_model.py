@@ -22,6 +22,7 @@ import tempfile
 import numpy as np
 
 import tvm
+import tvm.testing
 from tvm import auto_scheduler
 
 from test_auto_scheduler_common import matmul_auto_scheduler_test
@@ -76,6 +77,39 @@ def test_xgb_model():
         model.load(fp.name)
 
 
+def test_gbdt_model():
+    task, dag, inputs, results = get_sample_records(50)
+
+    model = auto_scheduler.GBDTModel(num_warmup_sample=-1)
+    model.update(inputs[:25], results[:25])
+    num_trees = model.num_trees()
+    assert num_trees > 0
+    # later updates continue boosting from the current trees
+    model.update(inputs[25:], results[25:])
+    assert model.num_trees() >= num_trees
+    preds = model.predict(task, [x.state for x in inputs])
+    assert len(preds) == len(inputs)
+
+    costs = [np.mean([x.value for x in res.costs]) for res in results]
+    throughputs = np.min(costs) / costs
+
+    rmse = np.sqrt(np.mean([np.square(pred - label) for pred, label in zip(preds, throughputs)]))
+    assert rmse <= 0.3
+
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, inputs, results)
+        model.update_from_file(fp.name)
+
+    with tempfile.NamedTemporaryFile() as fp:
+        model.save(fp.name)
+        loaded = auto_scheduler.GBDTModel()
+        loaded.load(fp.name)
+        tvm.testing.assert_allclose(
+            loaded.predict(task, [x.state for x in inputs]),
+            model.predict(task, [x.state for x in inputs]), rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_random_model()
     test_xgb_model()
+    test_gbdt_model()
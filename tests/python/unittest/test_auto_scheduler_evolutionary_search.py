@@ -16,6 +16,8 @@
 # under the License.
 """ Test evolutionary search. """
 
+import re
+
 import tvm
 from test_auto_scheduler_common import matmul_auto_scheduler_test
 from tvm import auto_scheduler, te
@@ -71,5 +73,44 @@ def test_evo_search():
     assert found
 
 
+class TileKCostModel(PythonBasedModel):
+    """A mock cost model that rates the states by the extent of the k.1 loop,
+    so that only the tile size mutations can improve the score."""
+    def predict(self, task, states):
+        scores = []
+        for state in states:
+            match = re.search(r"k\.1 \(0,(\d+)\)", str(state))
+            scores.append(float(match.group(1)) if match else 1.0)
+        return scores
+
+
+def test_adaptive_mutation():
+    workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, (64, 64, 64))
+    dag = auto_scheduler.ComputeDAG(workload_key)
+    task = auto_scheduler.SearchTask(dag, workload_key, tvm.target.create('llvm'))
+
+    policy = auto_scheduler.SketchPolicy(task, schedule_cost_model=TileKCostModel(), verbose=0)
+    prior_probs = {name: s["prob"] for name, s in policy.mutation_rule_stats().items()}
+    policy.evolutionary_search(policy.sample_initial_population(50), 16)
+    stats = policy.mutation_rule_stats()
+
+    assert stats["MutateTileSize"]["num_tries"] > 0
+    assert stats["MutateTileSize"]["num_improvements"] > 0
+    for name in ["MutateMaxUnrollFactor", "MutateParallel"]:
+        assert stats[name]["num_improvements"] == 0
+        assert stats[name]["reward"] == 0
+    assert stats["MutateTileSize"]["prob"] > prior_probs["MutateTileSize"]
+    assert abs(sum(s["prob"] for s in stats.values()) - 1) < 1e-6
+
+    # The fixed rule levels are used when the adaptation is disabled
+    policy = auto_scheduler.SketchPolicy(task, schedule_cost_model=TileKCostModel(), verbose=0,
+                                         params={"evolutionary_search_adaptive_mutation": 0})
+    policy.evolutionary_search(policy.sample_initial_population(50), 16)
+    stats = policy.mutation_rule_stats()
+    assert all(s["num_tries"] == 0 for s in stats.values())
+    assert abs(stats["MutateTileSize"]["prob"] - prior_probs["MutateTileSize"]) < 1e-6
+
+
 if __name__ == "__main__":
     test_evo_search()
+    test_adaptive_mutation()
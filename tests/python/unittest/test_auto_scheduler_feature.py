@@ -20,10 +20,12 @@
 import math
 import tempfile
 
+import numpy as np
+
 import tvm
 from tvm import te, auto_scheduler
 
-from test_auto_scheduler_common import matmul_auto_scheduler_test
+from test_auto_scheduler_common import matmul_auto_scheduler_test, get_split_matmul
 
 
 def fequal(a, b):
@@ -191,7 +193,43 @@ def test_gpu_feature():
         assert fequal(fea_dicts[0]['is_gpu'], 1.0)
 
 
+def test_feature_cache():
+    dag = auto_scheduler.ComputeDAG(matmul_auto_scheduler_test(128, 128, 128))
+    states = [get_split_matmul(dag, f, parallel=True) for f in [2, 4, 8, 16]]
+    task = auto_scheduler.SearchTask(dag, "test", tvm.target.create('llvm'))
+    feature = auto_scheduler.feature
+
+    feature.set_feature_cache_capacity(0)
+    feature.reset_feature_extraction_stats()
+    expected = feature.get_per_store_features_from_states(states, task)
+    stats = feature.get_feature_extraction_stats()
+    assert stats["cache_hits"] == 0 and stats["cache_misses"] == len(states)
+    assert stats["extraction_time"] > 0 and stats["time_per_state"] > 0
+
+    feature.set_feature_cache_capacity(1024)
+    feature.reset_feature_extraction_stats()
+    feature.get_per_store_features_from_states(states, task)
+    # A new copy of the same steps and a new state
+    states = [get_split_matmul(dag, 4, parallel=True),
+              get_split_matmul(dag, 32, parallel=True)] + states
+    fea = feature.get_per_store_features_from_states(states, task)
+    stats = feature.get_feature_extraction_stats()
+    assert stats["cache_hits"] == 5 and stats["cache_misses"] == 5
+    for x, y in zip(fea[2:], expected):
+        np.testing.assert_allclose(x, y)
+    np.testing.assert_allclose(fea[0], expected[1])
+
+    # The same steps on another DAG are not mixed up
+    dag2 = auto_scheduler.ComputeDAG(matmul_auto_scheduler_test(64, 128, 128))
+    task2 = auto_scheduler.SearchTask(dag2, "test", tvm.target.create('llvm'))
+    s = get_split_matmul(dag2, 2, parallel=True)
+    fea2 = feature.get_per_store_features_from_states([s], task2)[0]
+    assert feature.get_feature_extraction_stats()["cache_misses"] == 6
+    assert not np.allclose(fea2, expected[0])
+
+
 if __name__ == "__main__":
     test_cpu_matmul()
     test_cpu_fusion()
     test_gpu_feature()
+    test_feature_cache()
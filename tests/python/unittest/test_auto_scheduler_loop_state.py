@@ -17,13 +17,17 @@
 
 """Test loop state and schedule primitives"""
 
+import tempfile
+
 import numpy as np
 
 import tvm
 from tvm import auto_scheduler, te
 from tvm import topi
+from tvm.auto_scheduler import _ffi_api
 
-from test_auto_scheduler_common import matmul_auto_scheduler_test, conv2d_nchw_bn_relu_auto_scheduler_test
+from test_auto_scheduler_common import matmul_auto_scheduler_test, \
+    conv2d_nchw_bn_relu_auto_scheduler_test, get_split_matmul
 
 
 def test_split_fuse_reorder_annotation():
@@ -508,9 +512,36 @@ def test_rfactor():
     assert s2[C].iters[2].range.extent == 16
 
 
+def test_state_fingerprint():
+    A, B, C = matmul_auto_scheduler_test(N=512, M=512, K=512)
+    dag = auto_scheduler.ComputeDAG([A, B, C])
+
+    s0 = get_split_matmul(dag, 16, reorder=True)
+    assert s0.fingerprint() == get_split_matmul(dag, 16, reorder=True).fingerprint()
+    assert s0.fingerprint() != get_split_matmul(dag, 8, reorder=True).fingerprint()
+    assert s0.fingerprint() != get_split_matmul(dag, 16).fingerprint()
+    assert dag.get_init_state().fingerprint() != get_split_matmul(dag, 16).fingerprint()
+
+    # A copy extended with more steps gets a new fingerprint, the original keeps its own.
+    s1 = s0.copy()
+    s1.parallel(C, s1[C].iters[0])
+    assert s1.fingerprint() != s0.fingerprint()
+    assert s0.fingerprint() == get_split_matmul(dag, 16, reorder=True).fingerprint()
+
+    # States read back from a log have the same fingerprint.
+    task = auto_scheduler.SearchTask(dag, "test", tvm.target.create("llvm"))
+    inp = auto_scheduler.MeasureInput(task, s1.state_object)
+    res = auto_scheduler.MeasureResult([0.1], 0, "", 0.1, 0)
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, [inp], [res])
+        log_inputs, _ = auto_scheduler.RecordReader(fp.name).read_lines()
+    assert _ffi_api.StateFingerprint(log_inputs[0].state) == s1.fingerprint()
+
+
 if __name__ == "__main__":
     test_split_fuse_reorder_annotation()
     test_compute_at_root_inline()
     test_cache_read_write()
     test_follow_split_follow_fused_split()
     test_rfactor()
+    test_state_fingerprint()
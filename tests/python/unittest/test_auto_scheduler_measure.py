@@ -23,7 +23,8 @@ from tvm import te, auto_scheduler
 import tempfile
 import tvm.testing
 
-from test_auto_scheduler_common import matmul_auto_scheduler_test, get_tiled_matmul
+from test_auto_scheduler_common import matmul_auto_scheduler_test, get_tiled_matmul, \
+    get_split_matmul, PropagatingThread
 
 def record_common(dag, s):
     target = tvm.target.create("llvm")
@@ -45,6 +46,16 @@ def record_common(dag, s):
         assert s1 == s2
         assert not (s1 == dag.get_init_state())
 
+        # Round trip through the binary format
+        with tempfile.NamedTemporaryFile(suffix=".bin") as fbin:
+            assert auto_scheduler.convert_records(fp.name, fbin.name) == 1
+            log_reader = auto_scheduler.RecordReader(fbin.name)
+            assert log_reader.is_binary()
+            inputs, results = log_reader.read_lines()
+            assert len(inputs) == 1
+            assert s1 == dag.infer_bound_from_state(inputs[0].state)
+            assert results[0].error_no == 0 and results[0].costs[0].value == 0.1
+
 
 def test_record_split_reorder_fuse_annotation():
     if not tvm.testing.device_enabled("llvm"):
@@ -165,6 +176,64 @@ def test_record_pragma_storage_align_rfactor():
     record_common(dag, s)
 
 
+def test_binary_record_index():
+    A, B, C = matmul_auto_scheduler_test(64, 64, 64)
+    dag = auto_scheduler.ComputeDAG([A, B, C])
+    target = tvm.target.create("llvm")
+    tasks = [auto_scheduler.SearchTask(dag, key, target) for key in ["test_a", "test_b"]]
+
+    # (task index, split factor, cost, error_no)
+    configs = [(0, 2, 0.3, 0), (1, 4, 0.2, 0), (0, 8, 0.1, 2), (0, 16, 0.2, 0), (1, 32, 0.4, 0)]
+    records = [(auto_scheduler.MeasureInput(tasks[t], get_split_matmul(dag, factor)),
+                auto_scheduler.MeasureResult([cost, cost], error_no, "", 0.5, 1))
+               for t, factor, cost, error_no in configs]
+
+    for suffix in [".json", ".bin"]:
+        with tempfile.NamedTemporaryFile(suffix=suffix) as fp:
+            # Appended in two calls, the second one keeps the format of the file
+            auto_scheduler.save_records(fp.name, [r[0] for r in records[:2]],
+                                        [r[1] for r in records[:2]])
+            auto_scheduler.save_records(fp.name, [r[0] for r in records[2:]],
+                                        [r[1] for r in records[2:]])
+
+            reader = auto_scheduler.RecordReader(fp.name)
+            assert reader.is_binary() == (suffix == ".bin")
+            assert reader.num_records() == len(records)
+            assert reader.find_records("test_a") == [0, 2, 3]
+            assert reader.find_records("test_b") == [1, 4]
+            assert reader.find_records("test_c") == []
+
+            # Random access does not move the streaming position
+            streamed = []
+            for idx, (inp, res) in enumerate(reader):
+                ridx = len(records) - 1 - idx
+                rinp, rres = reader.read_record(ridx)
+                assert rinp.task.workload_key == records[ridx][0].task.workload_key
+                streamed.append(inp)
+            assert len(streamed) == len(records)
+            assert dag.infer_bound_from_state(reader.read_record(3)[0].state) == \
+                dag.infer_bound_from_state(records[3][0].state)
+
+            # The record with an error is skipped
+            inp, res = auto_scheduler.load_best(fp.name, "test_a")
+            assert res.costs[0].value == 0.2
+            assert dag.infer_bound_from_state(inp.state) == \
+                dag.infer_bound_from_state(records[3][0].state)
+            inp, res = auto_scheduler.load_best(fp.name)
+            assert res.costs[0].value == 0.2 and inp.task.workload_key == "test_b"
+            assert auto_scheduler.load_best(fp.name, "test_c") == (None, None)
+            assert auto_scheduler.load_best(fp.name, "test_a", tvm.target.create("cuda")) == \
+                (None, None)
+
+            # Conversion to the other format keeps all records
+            with tempfile.NamedTemporaryFile() as fout:
+                assert auto_scheduler.convert_records(fp.name, fout.name,
+                                                      suffix == ".json") == len(records)
+                other = auto_scheduler.RecordReader(fout.name)
+                assert other.is_binary() == (suffix == ".json")
+                assert other.find_records("test_a") == [0, 2, 3]
+
+
 def test_measure_local_builder_runner(enable_cpu_cache_flush=False):
     if not tvm.testing.device_enabled("llvm"):
         return
@@ -204,13 +273,75 @@ def test_measure_local_builder_rpc_runner(enable_cpu_cache_flush=False):
     assert mress[0].error_no == 0
 
 
+def test_measure_local_runner_adaptive_repeat():
+    if not tvm.testing.device_enabled("llvm"):
+        return
+
+    dag, s0 = get_tiled_matmul()
+    tgt = tvm.target.create("llvm")
+    task = auto_scheduler.SearchTask(dag, "test", tgt)
+
+    minp = auto_scheduler.MeasureInput(task, s0)
+    local_builder = auto_scheduler.LocalBuilder()
+    local_runner = auto_scheduler.LocalRunner(timeout=60, number=2, repeat=3, max_rel_ci=0.5,
+                                              max_repeat=10)
+
+    bress = local_builder.build([minp])
+    assert bress[0].error_no == 0
+    mress = local_runner.run([minp], bress)
+    assert mress[0].error_no == 0
+    assert 1 <= len(mress[0].costs) <= 10
+    if len(mress[0].costs) > 1:
+        assert "std:" in str(mress[0])
+
+
+def measure_pipeline_common():
+    workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, (64, 64, 64))
+    dag = auto_scheduler.ComputeDAG(workload_key)
+    task = auto_scheduler.SearchTask(dag, workload_key, tvm.target.create("llvm"))
+    policy = auto_scheduler.SketchPolicy(
+        task, verbose=0,
+        params={"evolutionary_search_population": 16, "evolutionary_search_num_iters": 1})
+
+    with tempfile.NamedTemporaryFile() as fp:
+        # Batches of two programs, built one batch ahead and run by two runners
+        tuning_options = auto_scheduler.TuningOptions(
+            num_measure_trials=6, num_measures_per_round=6, verbose=0,
+            builder=auto_scheduler.LocalBuilder(n_parallel=1),
+            runner=[auto_scheduler.LocalRunner(), auto_scheduler.LocalRunner()],
+            measure_callbacks=[auto_scheduler.RecordToFile(fp.name)], pipeline_depth=1)
+        auto_scheduler.measure.reset_measure_pipeline_stats()
+        auto_scheduler.auto_schedule(task, policy, tuning_options)
+        stats = auto_scheduler.measure.get_measure_pipeline_stats()
+
+        inputs, results = zip(*auto_scheduler.load_records(fp.name))
+        assert len(inputs) == 6
+        assert all(res.error_no == 0 for res in results)
+
+    assert stats["num_batches"] == 3
+    assert stats["build_time"] > 0 and stats["run_time"] > 0
+    assert 0 < stats["build_utilisation"] <= 1
+    assert 0 < stats["run_utilisation"] <= 1
+
+
+def test_measure_pipeline():
+    # wrap the search in a new thread to avoid the conflict
+    # between python's multiprocessing and tvm's thread pool
+    t = PropagatingThread(target=measure_pipeline_common)
+    t.start()
+    t.join()
+
+
 if __name__ == "__main__":
     test_record_split_reorder_fuse_annotation()
     test_record_compute_at_root_inline_cache_read_write()
     test_record_follow_split_follow_fused_split()
     test_record_pragma_storage_align_rfactor()
+    test_binary_record_index()
     test_measure_local_builder_runner(enable_cpu_cache_flush=True)
     test_measure_local_builder_runner(enable_cpu_cache_flush=False)
     test_measure_local_builder_rpc_runner(enable_cpu_cache_flush=True)
     test_measure_local_builder_rpc_runner(enable_cpu_cache_flush=False)
+    test_measure_local_runner_adaptive_repeat()
+    test_measure_pipeline()
 
@@ -24,7 +24,8 @@ import tempfile
 import tvm
 from tvm import auto_scheduler
 
-from test_auto_scheduler_common import matmul_auto_scheduler_test, PropagatingThread
+from test_auto_scheduler_common import matmul_auto_scheduler_test, min_nm_auto_scheduler_test, \
+    get_split_matmul, PropagatingThread
 
 def search_common(workload=matmul_auto_scheduler_test, target="llvm",
                   search_policy='empty', seed=random.randint(1, 1 << 30), runner='local',
@@ -144,9 +145,61 @@ def test_sketch_search_policy_cuda_xgbmodel_rpc_runner():
     t.join()
 
 
+def test_sketch_search_policy_transfer():
+    target = tvm.target.create("llvm")
+
+    def make_task(*shape):
+        workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, shape)
+        dag = auto_scheduler.ComputeDAG(workload_key)
+        return auto_scheduler.SearchTask(dag, workload_key, target)
+
+    src_task, dst_task = make_task(64, 64, 64), make_task(48, 48, 48)
+    assert src_task.compute_dag.get_structural_key() == dst_task.compute_dag.get_structural_key()
+    min_key = auto_scheduler.make_workload_key(min_nm_auto_scheduler_test, (64, 64))
+    assert src_task.compute_dag.get_structural_key() != \
+        auto_scheduler.ComputeDAG(min_key).get_structural_key()
+
+    def make_record(task, factor, cost, error_no=0):
+        s = get_split_matmul(task.compute_dag, factor, parallel=True)
+        return auto_scheduler.MeasureInput(task, s), \
+            auto_scheduler.MeasureResult([cost], error_no, "", cost, 1)
+
+    records = [make_record(src_task, 32, 0.2), make_record(src_task, 4, 0.1),
+               make_record(src_task, 8, 0.05, error_no=2)]
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, [r[0] for r in records], [r[1] for r in records])
+
+        policy = auto_scheduler.SketchPolicy(
+            dst_task, verbose=0,
+            init_search_callbacks=[auto_scheduler.PreloadSimilarStates(fp.name)])
+        states = policy.transferred_states()
+        # The failed record is skipped, the others are sorted by their costs
+        assert len(states) == 2
+        codes = [dst_task.compute_dag.print_python_code_from_state(s) for s in states]
+        assert "factor=4)" in codes[0]
+        # The split factor is adapted to the new extent
+        assert "factor=24)" in codes[1]
+
+        # The records of the task itself are not transferred
+        policy = auto_scheduler.SketchPolicy(
+            src_task, verbose=0,
+            init_search_callbacks=[auto_scheduler.PreloadSimilarStates(fp.name)])
+        assert len(policy.transferred_states()) == 0
+
+        # The transferred states join the search
+        policy = auto_scheduler.SketchPolicy(
+            dst_task, schedule_cost_model=auto_scheduler.GBDTModel(), verbose=0,
+            params={"evolutionary_search_population": 16, "evolutionary_search_num_iters": 1},
+            init_search_callbacks=[auto_scheduler.PreloadSimilarStates(fp.name)])
+        tuning_options = auto_scheduler.TuningOptions(num_measure_trials=1, verbose=0)
+        sch, args = auto_scheduler.auto_schedule(dst_task, policy, tuning_options)
+        tvm.lower(sch, args, simple_mode=True)
+
+
 if __name__ == "__main__":
     test_workload_registry_search_basic()
     test_sketch_search_policy_basic()
     test_sketch_search_policy_xgbmodel()
+    test_sketch_search_policy_transfer()
     test_sketch_search_policy_cuda_rpc_runner()
     test_sketch_search_policy_cuda_xgbmodel_rpc_runner()
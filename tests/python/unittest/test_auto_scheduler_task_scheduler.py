@@ -0,0 +1,97 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Test the task scheduler"""
+
+import tempfile
+
+import tvm
+import tvm.testing
+from tvm import auto_scheduler
+
+from test_auto_scheduler_common import matmul_auto_scheduler_test, PropagatingThread
+
+
+def make_tasks(shapes):
+    target = tvm.target.create("llvm")
+    tasks = []
+    for shape in shapes:
+        workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, shape)
+        dag = auto_scheduler.ComputeDAG(workload_key)
+        tasks.append(auto_scheduler.SearchTask(dag, workload_key, target))
+    return tasks
+
+
+def round_robin_common():
+    tasks = make_tasks([(16, 16, 16), (32, 32, 32), (64, 64, 64)])
+    policies = [auto_scheduler.EmptyPolicy(task) for task in tasks]
+    scheduler = auto_scheduler.TaskScheduler(tasks, search_policies=policies,
+                                             strategy="round-robin", verbose=0)
+    # EmptyPolicy proposes one state per round
+    tuning_options = auto_scheduler.TuningOptions(num_measure_trials=7, num_measures_per_round=4,
+                                                  verbose=0)
+    scheduler.tune(tuning_options)
+    assert scheduler.task_trials() == [3, 2, 2]
+    assert all(cost < 1e10 for cost in scheduler.best_costs())
+
+
+def gradient_common():
+    tasks = make_tasks([(32, 32, 32), (64, 64, 64)])
+    policies = [auto_scheduler.SketchPolicy(
+        task, verbose=0,
+        params={"evolutionary_search_population": 16, "evolutionary_search_num_iters": 1})
+                for task in tasks]
+    scheduler = auto_scheduler.TaskScheduler(tasks, task_weights=[1, 4],
+                                             search_policies=policies, verbose=0)
+
+    with tempfile.NamedTemporaryFile() as fp:
+        tuning_options = auto_scheduler.TuningOptions(
+            num_measure_trials=8, num_measures_per_round=2, verbose=0,
+            measure_callbacks=[auto_scheduler.RecordToFile(fp.name)])
+        scheduler.tune(tuning_options)
+
+        trials = scheduler.task_trials()
+        assert sum(trials) == 8
+        assert all(t > 0 for t in trials)
+        assert all(cost < 1e10 for cost in scheduler.best_costs())
+
+        # The records of all tasks go to the same log
+        keys = set(inp.task.workload_key for inp, _ in auto_scheduler.load_records(fp.name))
+        assert keys == set(task.workload_key for task in tasks)
+
+
+@tvm.testing.requires_llvm
+def test_task_scheduler_round_robin():
+    # wrap the search in a new thread to avoid the conflict
+    # between python's multiprocessing and tvm's thread pool
+    t = PropagatingThread(target=round_robin_common)
+    t.start()
+    t.join()
+
+
+@tvm.testing.requires_llvm
+def test_task_scheduler_gradient():
+    # wrap the search in a new thread to avoid the conflict
+    # between python's multiprocessing and tvm's thread pool
+    t = PropagatingThread(target=gradient_common)
+    t.start()
+    t.join()
+
+
+if __name__ == "__main__":
+    test_task_scheduler_round_robin()
+    test_task_scheduler_gradient()
@@ -111,9 +111,105 @@ def test_graph_simple():
             np.testing.assert_equal(out.asnumpy(), x_in + a)
             del mod
 
+    def check_session():
+        import threading
+        from tvm import relay
+        x = relay.var('x', shape=(1, 10))
+        y = relay.var('y', shape=(1, 10))
+        z = relay.add(x, y)
+        func = relay.Function([x, y], z)
+
+        x_in = np.ones((1, 10)).astype("float32")
+        params = {'x': x_in}
+        graph, lib, params = relay.build(func, target="llvm", params=params)
+
+        mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+        mod.load_params(relay.save_param_dict(params))
+
+        sessions = [mod.create_session() for _ in range(4)]
+        inputs = [np.random.uniform(size=(1, 10)).astype("float32") for _ in sessions]
+        for sess, a in zip(sessions, inputs):
+            sess.set_input("y", a)
+        for sess, a in zip(sessions, inputs):
+            sess.run()
+            np.testing.assert_equal(sess.get_output(0).asnumpy(), x_in + a)
+        # sessions share the parameters and cannot overwrite them
+        np.testing.assert_equal(sessions[0].get_input("x").asnumpy(), x_in)
+        try:
+            sessions[0].module["set_input"]("x", tvm.nd.array(x_in))
+            assert False
+        except tvm.error.TVMError:
+            pass
+
+        results = [None] * 8
+        def infer(i):
+            results[i] = mod.run_in_session(y=inputs[i % len(inputs)])[0].asnumpy()
+        threads = [threading.Thread(target=infer, args=(i,)) for i in range(len(results))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for i, out in enumerate(results):
+            np.testing.assert_equal(out, x_in + inputs[i % len(inputs)])
+
+    def check_inter_op():
+        from tvm import relay
+        x = relay.var('x', shape=(4, 16))
+        y = relay.var('y', shape=(4, 16))
+        branches = [relay.exp(x), relay.sqrt(y), relay.sigmoid(relay.add(x, y))]
+        z = relay.add(relay.add(branches[0], branches[1]), branches[2])
+        func = relay.Function([x, y], z)
+        # keep the branches as separate operators
+        with tvm.transform.PassContext(opt_level=0):
+            graph, lib, params = relay.build(func, target="llvm")
+
+        a = np.random.uniform(size=(4, 16)).astype("float32")
+        b = np.random.uniform(size=(4, 16)).astype("float32")
+        ref = graph_runtime.create(graph, lib, tvm.cpu(0))
+        ref.run(x=a, y=b)
+        expected = ref.get_output(0).asnumpy()
+
+        mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+        mod.set_inter_op_parallelism(3, 1)
+        for _ in range(10):
+            mod.run(x=a, y=b)
+            tvm.testing.assert_allclose(mod.get_output(0).asnumpy(), expected, rtol=1e-5)
+        mod.set_inter_op_parallelism(1)
+        mod.run(x=a, y=b)
+        tvm.testing.assert_allclose(mod.get_output(0).asnumpy(), expected, rtol=1e-5)
+
+    def check_load_params_from_file():
+        from tvm import relay
+        x = relay.var('x', shape=(1, 10))
+        y = relay.var('y', shape=(1, 10))
+        z = relay.add(x, y)
+        func = relay.Function([x, y], z)
+
+        x_in = np.random.uniform(size=(1, 10)).astype("float32")
+        graph, lib, params = relay.build(func, target="llvm", params={'x': x_in})
+        temp = util.tempdir()
+        a = np.random.uniform(size=(1, 10)).astype("float32")
+        for aligned in [False, True]:
+            path = temp.relpath("params_%d.bin" % aligned)
+            with open(path, "wb") as fo:
+                fo.write(relay.save_param_dict(params, aligned=aligned))
+            np.testing.assert_equal(
+                relay.load_param_dict(bytearray(open(path, "rb").read()))['x'].asnumpy(), x_in)
+            mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+            mod.load_params_from_file(path)
+            mod.run(y=a)
+            np.testing.assert_equal(mod.get_output(0).asnumpy(), x_in + a)
+            # sessions share the mapped parameters
+            sess = mod.create_session()
+            sess.run(y=a)
+            np.testing.assert_equal(sess.get_output(0).asnumpy(), x_in + a)
+
     check_verify()
     check_remote()
     check_sharing()
+    check_session()
+    check_inter_op()
+    check_load_params_from_file()
 
 if __name__ == "__main__":
     test_graph_simple()
@@ -15,6 +15,7 @@
 # specific language governing permissions and limitations
 # under the License.
 import time
+import struct
 import ctypes
 
 import tvm
@@ -59,6 +60,64 @@ def test_min_repeat_ms():
     assert ct > 10 + 2
 
 
+def test_adaptive_repeat():
+    calls = []
+
+    @tvm.register_func
+    def my_sleep():
+        calls.append(1)
+        time.sleep(0.001)
+
+    X = te.compute((), lambda : tvm.tir.call_packed("my_sleep"))
+    s = te.create_schedule(X.op)
+    func = tvm.build(s, [X])
+
+    x = tvm.nd.empty((), dtype="int32")
+    ftimer = func.time_evaluator(func.entry_name, tvm.cpu(), number=1, repeat=5,
+                                 max_rel_ci=0.2, max_repeat=30)
+    res = ftimer(x)
+
+    # the first call is discarded, and at most the repeats taken are kept
+    num_repeats = len(calls) - 1
+    assert 5 <= num_repeats <= 30
+    assert 0 < len(res.results) <= num_repeats
+    assert min(res.results) <= res.mean <= max(res.results)
+
+
+def test_adaptive_repeat_stopping_rule():
+    frepeat = tvm.get_global_func("testing.adaptive_repeat")
+
+    def repeat(costs, min_repeat=5, max_repeat=30, max_rel_ci=0.2):
+        calls = []
+
+        def measure():
+            calls.append(1)
+            return costs[len(calls) - 1]
+
+        blob = frepeat(measure, min_repeat, max_repeat, max_rel_ci)
+        return len(calls), list(struct.unpack("@" + "d" * (len(blob) // 8), blob))
+
+    # stable costs stop at the minimum number of repeats
+    num_repeats, results = repeat([0.01] * 30)
+    assert num_repeats == 5
+    assert results == [0.01] * 5
+
+    # every 5th repeat is disturbed: the repeats stop once the median is stable, and the
+    # disturbed ones are dropped as outliers
+    costs = [0.06 if i % 5 == 4 else 0.01 + 0.0001 * (i % 3) for i in range(30)]
+    num_repeats, results = repeat(costs)
+    assert num_repeats == 14
+    assert results == [c for c in costs[:num_repeats] if c < 0.06]
+
+    # costs that never settle run up to max_repeat and are all kept
+    costs = [0.01, 0.02] * 15
+    num_repeats, results = repeat(costs)
+    assert num_repeats == 30
+    assert results == costs
+
+
 if __name__ == "__main__":
     test_min_repeat_ms()
+    test_adaptive_repeat()
+    test_adaptive_repeat_stopping_rule()
 
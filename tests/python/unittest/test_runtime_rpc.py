@@ -131,6 +131,34 @@ def test_rpc_large_array():
     np.testing.assert_equal(b.asnumpy(), b_np)
 
 
+def test_rpc_async_mode():
+    if not tvm.runtime.enabled("rpc"):
+        return
+    @tvm.register_func("rpc.test.remote_sum")
+    def remote_sum(*args):
+        return float(sum(x.asnumpy().sum() for x in args))
+    server = rpc.Server("localhost")
+    remote = rpc.connect(server.host, server.port)
+    ctx = remote.cpu(0)
+    fsum = remote.get_function("rpc.test.remote_sum")
+    # chunk size that is not a multiple of the element size
+    remote.set_async_mode(True, copy_chunk_bytes=4098)
+    arrays = [np.random.uniform(size=(n, 17)).astype("float32") for n in (1, 100, 1000)]
+    for _ in range(10):
+        # copies and frees do not wait, the call sees all of them in order
+        remote_arrays = [tvm.nd.array(x, ctx) for x in arrays]
+        tvm.testing.assert_allclose(
+            fsum(*remote_arrays), sum(x.sum() for x in arrays), rtol=1e-4)
+        for x, y in zip(arrays, remote_arrays):
+            np.testing.assert_equal(y.asnumpy(), x)
+    b = tvm.nd.empty((1000, 17), "float32", ctx)
+    b.copyfrom(arrays[2])
+    remote.synchronize()
+    np.testing.assert_equal(b.asnumpy(), arrays[2])
+    remote.set_async_mode(False, copy_chunk_bytes=0)
+    np.testing.assert_equal(tvm.nd.array(arrays[1], ctx).asnumpy(), arrays[1])
+
+
 def test_rpc_echo():
     def check(remote):
         fecho = remote.get_function("testing.echo")
@@ -480,3 +508,4 @@ if __name__ == "__main__":
     test_rpc_tracker_register()
     test_rpc_tracker_request()
     test_rpc_large_array()
+    test_rpc_async_mode()
@@ -21,6 +21,7 @@ from tvm.contrib import util, clang
 import numpy as np
 import ctypes
 import math
+import os
 import re
 
 
@@ -226,6 +227,55 @@ def test_llvm_persist_parallel():
     check_llvm()
 
 
+@tvm.testing.requires_llvm
+def test_llvm_parallel_schedule():
+    n = 203
+    A = te.placeholder((n,), name='A')
+    k = te.reduce_axis((0, n), name='k')
+    B = te.compute((n,), lambda i: te.sum(A[k], axis=k, where=k <= i), name='B')
+
+    def check_llvm(kind, chunk_size):
+        s = te.create_schedule(B.op)
+        s[B].parallel(B.op.axis[0])
+        s[B].pragma(B.op.axis[0], "parallel_schedule", kind)
+        if chunk_size:
+            s[B].pragma(B.op.axis[0], "parallel_chunk_size", chunk_size)
+        f = tvm.build(s, [A, B], "llvm")
+        assert ("TVMBackendParallelGetChunk" in f.get_source()) == (kind != "static")
+        ctx = tvm.cpu(0)
+        a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+        b = tvm.nd.array(np.zeros(n, dtype=B.dtype), ctx)
+        # run twice to check that the shared iteration counter is reset on each launch
+        for _ in range(2):
+            f(a, b)
+            tvm.testing.assert_allclose(b.asnumpy(), np.cumsum(a.asnumpy()), rtol=1e-4)
+
+    def check_launch_point(kind):
+        # the parallel loop is entered once per iteration of i in each task
+        m = 5
+        A2 = te.placeholder((m, n), name='A2')
+        k2 = te.reduce_axis((0, n), name='k2')
+        C = te.compute((m, n), lambda i, j: te.sum(A2[i, k2], axis=k2, where=k2 <= j), name='C')
+        s = te.create_schedule(C.op)
+        i, j = C.op.axis
+        s[C].parallel(j)
+        s[C].pragma(i, "parallel_launch_point")
+        s[C].pragma(j, "parallel_schedule", kind)
+        s[C].pragma(j, "parallel_chunk_size", 3)
+        f = tvm.build(s, [A2, C], "llvm")
+        ctx = tvm.cpu(0)
+        a = tvm.nd.array(np.random.uniform(size=(m, n)).astype(A2.dtype), ctx)
+        c = tvm.nd.array(np.zeros((m, n), dtype=C.dtype), ctx)
+        for _ in range(2):
+            f(a, c)
+            tvm.testing.assert_allclose(c.asnumpy(), np.cumsum(a.asnumpy(), axis=1), rtol=1e-4)
+
+    for kind in ["static", "dynamic", "guided"]:
+        for chunk_size in [None, 1, 7]:
+            check_llvm(kind, chunk_size)
+        check_launch_point(kind)
+
+
 @tvm.testing.requires_llvm
 def test_llvm_flip_pipeline():
     def check_llvm(nn, base):
@@ -364,6 +414,95 @@ def test_multiple_func():
 
 
 
+@tvm.testing.requires_llvm
+def test_llvm_orc_jit():
+    if tvm.target.codegen.llvm_version_major() < 10:
+        return
+    n = 1024
+    A = te.placeholder((n,), name='A')
+    B = te.placeholder((n,), name='B')
+    C = te.compute(A.shape, lambda *i: A(*i) + B(*i), name='C')
+    s = te.create_schedule(C.op)
+    xo, xi = s[C].split(C.op.axis[0], factor=4)
+    s[C].parallel(xo)
+    s[C].vectorize(xi)
+
+    def check_llvm(cache_dir=None):
+        funcs = [tvm.lower(s, [A, B, C], name="fadd%d" % i) for i in range(3)]
+        m = tvm.build(funcs, "llvm -jit=orcjit")
+        ctx = tvm.cpu(0)
+        a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+        b = tvm.nd.array(np.random.uniform(size=n).astype(B.dtype), ctx)
+        c = tvm.nd.array(np.zeros(n, dtype=C.dtype), ctx)
+        # the functions are compiled on their first call
+        for i in range(3):
+            m["fadd%d" % i](a, b, c)
+            tvm.testing.assert_allclose(c.asnumpy(), a.asnumpy() + b.asnumpy())
+
+    check_llvm()
+
+    # The compiled objects are saved to and then loaded from the cache directory
+    temp = util.tempdir()
+    cache_dir = temp.relpath("jit_cache")
+    os.environ["TVM_LLVM_JIT_CACHE_DIR"] = cache_dir
+
+    def list_objects():
+        return {f: os.stat(os.path.join(cache_dir, f)).st_ino for f in os.listdir(cache_dir)}
+
+    try:
+        check_llvm()
+        objects = list_objects()
+        assert len(objects) > 0
+        # A miss would write each object again through a new temporary file, and so a new inode
+        check_llvm()
+        assert list_objects() == objects
+    finally:
+        del os.environ["TVM_LLVM_JIT_CACHE_DIR"]
+
+
+@tvm.testing.requires_llvm
+def test_llvm_optimize_pipeline():
+    n = 1024
+    A = te.placeholder((n,), name='A')
+    B = te.placeholder((n,), name='B')
+    C = te.compute(A.shape, lambda *i: A(*i) + B(*i), name='C')
+    # no explicit vectorization, only the LLVM vectorizers can produce vector code
+    s = te.create_schedule(C.op)
+
+    def check_llvm(options, vectorized=None):
+        m = tvm.build(s, [A, B, C], "llvm " + options)
+        if vectorized is not None:
+            assert ("x float>" in m.get_source()) == vectorized
+        ctx = tvm.cpu(0)
+        a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+        b = tvm.nd.array(np.random.uniform(size=n).astype(B.dtype), ctx)
+        c = tvm.nd.array(np.zeros(n, dtype=C.dtype), ctx)
+        m(a, b, c)
+        tvm.testing.assert_allclose(c.asnumpy(), a.asnumpy() + b.asnumpy())
+        return m
+
+    check_llvm("", True)
+    check_llvm("-opt-level=0", False)
+    check_llvm("-vectorize-loops=0 -vectorize-slp=0", False)
+    if tvm.target.codegen.llvm_version_major() < 11:
+        return
+    check_llvm("-pass-manager=new", True)
+    check_llvm("-pass-manager=new -opt-level=2 -llvm-options=slp-threshold:-4", True)
+    check_llvm("-pass-manager=new -vectorize-loops=0 -vectorize-slp=0", False)
+    check_llvm("-pass-manager=new -pass-pipeline=function(loop-vectorize)", True)
+    # the instrumented code counts the executions of its blocks
+    temp = util.tempdir()
+    m = tvm.build(s, [A, B, C],
+                  "llvm -pass-manager=new -profile-generate=" + temp.relpath("tvm.profraw"))
+    assert "__profc_" in m.get_source()
+    # the options survive the save and load of the module
+    m = check_llvm("-pass-manager=new -opt-level=2 -vectorize-slp=0")
+    path = temp.relpath("pipeline.ll")
+    m.save(path)
+    target = tvm.runtime.load_module(path).get_source().split("tvm_target")[1].split("\n")[0]
+    assert "-pass-manager=new" in target and "-vectorize-slp=0" in target
+
+
 @tvm.testing.requires_llvm
 def test_llvm_condition():
     def check_llvm(n, offset):
@@ -790,6 +929,8 @@ def test_llvm_crt_static_lib():
 
 if __name__ == "__main__":
     test_multiple_func()
+    test_llvm_orc_jit()
+    test_llvm_optimize_pipeline()
     test_llvm_large_uintimm()
     test_llvm_import()
     test_alignment()
@@ -797,6 +938,7 @@ if __name__ == "__main__":
     test_rank_zero_bound_checkers()
     test_llvm_bool()
     test_llvm_persist_parallel()
+    test_llvm_parallel_schedule()
     test_llvm_condition()
     test_llvm_vadd_pipeline()
     test_llvm_add_pipeline()
@@ -14,7 +14,9 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
+import tvm.testing
 from tvm import te
 import re
 
@@ -72,6 +74,72 @@ def test_fp16_to_fp32():
         'llvm', 9,
         not_match="vcvtph2ps")
 
+def has_cpu_feature(feature):
+    try:
+        with open("/proc/cpuinfo") as f:
+            return feature in f.read().split()
+    except IOError:
+        return False
+
+
+def test_int8_dot_product():
+    if tvm.target.codegen.llvm_version_major() < 8:
+        print("Skipping due to LLVM version being {} < 8".format(
+            tvm.target.codegen.llvm_version_major()))
+        return
+
+    def dense(target, dtype_a, dtype_b, lanes, match=None, not_match=None, run=False):
+        m, n, k = 8, 64, 64
+        A = te.placeholder((m, k), dtype=dtype_a, name='A')
+        B = te.placeholder((k, n), dtype=dtype_b, name='B')
+        r = te.reduce_axis((0, k), name='k')
+        C = te.compute((m, n), lambda i, j: te.sum(
+            A[i, r].astype("int32") * B[r, j].astype("int32"), axis=r), name='C')
+        s = te.create_schedule(C.op)
+        CC = s.cache_write(C, "global")
+        jo, ji = s[C].split(C.op.axis[1], factor=lanes)
+        s[CC].compute_at(s[C], jo)
+        ko, ki = s[CC].split(CC.op.reduce_axis[0], factor=4)
+        s[CC].reorder(ko, CC.op.axis[0], ki, CC.op.axis[1])
+        s[CC].unroll(ki)
+        s[CC].vectorize(CC.op.axis[1])
+        s[C].vectorize(ji)
+        f = tvm.build(s, [A, B, C], target)
+
+        assembly = f.get_source('asm').splitlines()
+        if match:
+            matches = [l for l in assembly if re.search(match, l)]
+            assert matches
+        if not_match:
+            not_matches = [l for l in assembly if re.search(not_match, l)]
+            assert not not_matches
+        if run:
+            ctx = tvm.cpu(0)
+            a_np = np.random.randint(-128, 128, size=(m, k)).astype("int32")
+            b_np = np.random.randint(-128, 128, size=(k, n)).astype("int32")
+            a_np = (a_np % 256 if dtype_a == "uint8" else a_np).astype(dtype_a)
+            b_np = (b_np % 256 if dtype_b == "uint8" else b_np).astype(dtype_b)
+            a = tvm.nd.array(a_np, ctx)
+            b = tvm.nd.array(b_np, ctx)
+            c = tvm.nd.array(np.zeros((m, n), dtype="int32"), ctx)
+            f(a, b, c)
+            tvm.testing.assert_allclose(
+                c.asnumpy(), np.dot(a_np.astype("int32"), b_np.astype("int32")))
+
+    run_vnni = has_cpu_feature("avx512_vnni")
+    dense('llvm -mcpu=cascadelake', "uint8", "int8", 16,
+          match="vpdpbusd.*zmm", not_match="vpmulld", run=run_vnni)
+    dense('llvm -mcpu=cascadelake', "uint8", "int8", 8, match="vpdpbusd.*ymm", run=run_vnni)
+    dense('llvm -mcpu=cascadelake', "int8", "int8", 16,
+          match="vpdpwssd.*zmm", not_match="vpdpbusd", run=run_vnni)
+    dense('llvm -mcpu=cascadelake', "int8", "uint8", 16, match="vpdpbusd", run=run_vnni)
+    dense('llvm -mcpu=cascadelake', "uint8", "int8", 12, not_match="vpdpbusd", run=run_vnni)
+    dense('llvm -mcpu=skylake-avx512', "uint8", "int8", 16,
+          match="vpmaddwd.*zmm", not_match="vpdpbusd",
+          run=has_cpu_feature("avx512bw"))
+    dense('llvm -mcpu=core-avx2', "uint8", "int8", 16, not_match="vpdpbusd")
+
 
 if __name__ == "__main__":
     test_fp16_to_fp32()
+    test_int8_dot_product()
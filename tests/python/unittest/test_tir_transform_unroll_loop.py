@@ -15,7 +15,9 @@
 # specific language governing permissions and limitations
 # under the License.
 import tvm
+import tvm.testing
 from tvm import te
+import numpy as np
 import os
 
 
@@ -110,7 +112,107 @@ def test_unroll_single_count_loops():
         ret = tvm.tir.transform.UnrollLoop()(mod)["main"].body
         assert ret == stmt
 
+def test_unroll_cost_model():
+    ib = tvm.tir.ir_builder.create()
+    n = te.size_var('n')
+    Ab = tvm.tir.decl_buffer((n, ), "float32")
+    Bb = tvm.tir.decl_buffer((n, ), "float32")
+    Aptr = ib.buffer_ptr(Ab)
+    Bptr = ib.buffer_ptr(Bb)
+    with ib.for_range(0, 8, name="i") as i:
+        Bptr[i] = Aptr[i] * 2.0
+    stmt = ib.get()
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([Ab, Bb], stmt))
+
+    def unroll(**config):
+        config.update({"auto_cost_model": True, "record_decisions": True})
+        with tvm.transform.PassContext(config={"tir.UnrollLoop": config}):
+            return tvm.tir.transform.UnrollLoop()(mod)["main"].body
+
+    # 8 copies of a load, a multiply and a store
+    ret = unroll(max_unrolled_instructions=24)
+    assert ret.attr_key == "unroll_decision"
+    assert ret.value.value.startswith("unroll registers=8/")
+    assert isinstance(ret.body, tvm.tir.SeqStmt)
+
+    ret = unroll(max_unrolled_instructions=23)
+    assert ret.value.value.startswith("keep")
+    assert isinstance(ret.body, tvm.tir.For)
+
+    # every stored location takes a register
+    ret = unroll(max_registers=7)
+    assert ret.value.value.startswith("keep")
+
+
+def test_unroll_and_jam():
+    def make_mod(store_index):
+        ib = tvm.tir.ir_builder.create()
+        Ab = tvm.tir.decl_buffer((8, ), "float32")
+        Bb = tvm.tir.decl_buffer((64, ), "float32")
+        Cb = tvm.tir.decl_buffer((8 * 64, ), "float32")
+        Aptr = ib.buffer_ptr(Ab)
+        Bptr = ib.buffer_ptr(Bb)
+        Cptr = ib.buffer_ptr(Cb)
+        with ib.for_range(0, 8, name="i") as i:
+            with ib.for_range(0, 64, name="j") as j:
+                index = store_index(i, j)
+                Cptr[index] = Cptr[index] + Aptr[i] * Bptr[j]
+        return tvm.IRModule.from_expr(tvm.tir.PrimFunc([Ab, Bb, Cb], ib.get()))
+
+    def unroll(mod, **config):
+        config.update({"auto_cost_model": True, "record_decisions": True})
+        with tvm.transform.PassContext(config={"tir.UnrollLoop": config}):
+            return tvm.tir.transform.UnrollLoop()(mod)["main"].body
+
+    # the copies share the load of B[j]
+    ret = unroll(make_mod(lambda i, j: i * 64 + j))
+    assert ret.value.value.startswith("unroll_and_jam(factor=4)")
+    outer = ret.body
+    assert outer.extent.value == 2
+    inner = outer.body
+    assert inner.attr_key == "unroll_decision" and inner.value.value.startswith("keep")
+    assert len(inner.body.body) == 4
+
+    # 4 copies take 4 accumulators and the shared load of B
+    ret = unroll(make_mod(lambda i, j: i * 64 + j), max_registers=4)
+    assert ret.value.value.startswith("unroll_and_jam(factor=2)")
+
+    ret = unroll(make_mod(lambda i, j: i * 64 + j), max_jam_factor=1)
+    assert ret.value.value.startswith("keep")
+
+    # the iteration (i, j + 1) writes the location that (i + 1, j) reads
+    ret = unroll(make_mod(lambda i, j: i + j))
+    assert ret.value.value.startswith("keep")
+
+    # the iterations of i accumulate into the same location
+    ret = unroll(make_mod(lambda i, j: j))
+    assert ret.value.value.startswith("unroll_and_jam")
+
+
+@tvm.testing.requires_llvm
+def test_unroll_and_jam_build():
+    n = 64
+    A = te.placeholder((n, n), name='A')
+    B = te.placeholder((n, n), name='B')
+    k = te.reduce_axis((0, n), name='k')
+    C = te.compute((n, n), lambda i, j: te.sum(A[i, k] * B[k, j], axis=k), name='C')
+    s = te.create_schedule(C.op)
+    i, j = C.op.axis
+    s[C].reorder(i, k, j)
+    with tvm.transform.PassContext(config={"tir.UnrollLoop": {"auto_cost_model": True}}):
+        f = tvm.build(s, [A, B, C], "llvm")
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=(n, n)).astype(A.dtype), ctx)
+    b = tvm.nd.array(np.random.uniform(size=(n, n)).astype(B.dtype), ctx)
+    c = tvm.nd.array(np.zeros((n, n), dtype=C.dtype), ctx)
+    f(a, b, c)
+    tvm.testing.assert_allclose(c.asnumpy(), np.dot(a.asnumpy(), b.asnumpy()), rtol=1e-4)
+
+
 if __name__ == "__main__":
     test_unroll_loop()
     test_unroll_fake_loop()
     test_unroll_single_count_loops()
+    test_unroll_cost_model()
+    test_unroll_and_jam()
+    test_unroll_and_jam_build()